@@ -0,0 +1,156 @@
+#include "Harness.hpp"
+
+#include <Dispatch.hpp>
+#include <ParallelFor.hpp>
+#include <ThreadPool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ * Thread counts to construct pools with: powers of two up to twice the hardware concurrency, and the hardware
+ * concurrency itself.
+ */
+static auto ThreadCounts(BenchmarkRunner const& runner) -> std::vector<size_t>
+{
+    size_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<size_t> counts = {hardware};
+    for (size_t count = 1; count <= 2 * hardware && !runner.Options().quick; count *= 2)
+    {
+        counts.push_back(count);
+    }
+    std::sort(counts.begin(), counts.end());
+    counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+    return counts;
+}
+
+/*
+ * Dispatch overhead at each thread count, through the same partitioning the dispatcher thread pool uses.
+ */
+static auto BenchmarkDispatch(BenchmarkRunner& runner) -> void
+{
+    for (size_t threads : ThreadCounts(runner))
+    {
+        ThreadPool pool(threads);
+
+        for (size_t height : runner.Sizes({1, 64, 4096, 262144}))
+        {
+            runner.Run("dispatch_row/empty", {{"height", height}, {"threads", threads}}, height, 0, [&]
+            {
+                DispatchRowAsync(pool, height, [](size_t y) { DoNotOptimize(y); }).Wait();
+            });
+        }
+
+        for (size_t n : runner.Sizes({16, 256, 2048}))
+        {
+            std::vector<float> output(n * n);
+            runner.Run("dispatch_element/store", {{"size", n}, {"threads", threads}}, n * n, n * n * sizeof(float), [&]
+            {
+                DispatchElementAsync(pool, n, n, [&](size_t y, size_t x) { output[y * n + x] = static_cast<float>(x); }).Wait();
+                DoNotOptimize(output.data());
+            });
+        }
+
+        // one empty task per thread, the smallest dispatch that still reaches every worker
+        runner.Run("dispatch_tasks/empty", {{"tasks", threads}, {"threads", threads}}, threads, 0, [&]
+        {
+            DispatchTasks(pool, threads, [](size_t t) { DoNotOptimize(t); }).Wait();
+        });
+    }
+}
+
+static auto BenchmarkParallelFor(BenchmarkRunner& runner) -> void
+{
+    for (size_t threads : ThreadCounts(runner))
+    {
+        ThreadPool pool(threads);
+
+        for (size_t n : runner.Sizes({256, 2048}))
+        {
+            std::vector<float> output(n * n);
+            for (auto [schedule, name] : {std::pair{Schedule::Static, "static"}, {Schedule::Dynamic, "dynamic"}, {Schedule::Guided, "guided"}})
+            {
+                runner.Run(std::string("parallel_for/") + name, {{"size", n}, {"threads", threads}}, n * n, n * n * sizeof(float), [&]
+                {
+                    ParallelFor(pool, IndexRange<2>{{0, 0}, {n, n}}, {16, 256}, [&](IndexRange<2> const& tile)
+                    {
+                        for (size_t y = tile.begin[0]; y < tile.end[0]; ++y)
+                        {
+                            for (size_t x = tile.begin[1]; x < tile.end[1]; ++x)
+                            {
+                                output[y * n + x] = static_cast<float>(x);
+                            }
+                        }
+                    }, schedule);
+                    DoNotOptimize(output.data());
+                });
+            }
+        }
+    }
+}
+
+static auto BenchmarkThreadPool(BenchmarkRunner& runner) -> void
+{
+    for (size_t threads : ThreadCounts(runner))
+    {
+        ThreadPool pool(threads);
+
+        for (size_t tasks : runner.Sizes({64, 4096}))
+        {
+            runner.Run("thread_pool/enqueue_wait", {{"tasks", tasks}, {"threads", threads}}, tasks, 0, [&]
+            {
+                for (size_t t = 0; t < tasks; ++t)
+                {
+                    pool.Enqueue([] {});
+                }
+                pool.Wait();
+            });
+        }
+
+        // tasks enqueued by a worker go to its own deque, and are stolen by the others
+        size_t tasks = 4096;
+        runner.Run("thread_pool/enqueue_from_worker", {{"tasks", tasks}, {"threads", threads}}, tasks, 0, [&]
+        {
+            pool.Enqueue([&]
+            {
+                for (size_t t = 0; t < tasks; ++t)
+                {
+                    pool.Enqueue([] {});
+                }
+            });
+            pool.Wait();
+        });
+
+        std::atomic<size_t> counter = 0;
+        runner.Run("thread_pool/producers", {{"tasks", tasks}, {"threads", threads}}, tasks, 0, [&]
+        {
+            std::vector<std::thread> producers;
+            for (size_t p = 0; p < 4; ++p)
+            {
+                producers.emplace_back([&]
+                {
+                    for (size_t t = 0; t < tasks / 4; ++t)
+                    {
+                        pool.Enqueue([&] { counter.fetch_add(1, std::memory_order_relaxed); });
+                    }
+                });
+            }
+            for (auto& producer : producers)
+            {
+                producer.join();
+            }
+            pool.Wait();
+        });
+    }
+}
+
+auto RunDispatchBenchmarks(BenchmarkRunner& runner) -> void
+{
+    BenchmarkDispatch(runner);
+    BenchmarkParallelFor(runner);
+    BenchmarkThreadPool(runner);
+}
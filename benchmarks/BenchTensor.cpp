@@ -0,0 +1,414 @@
+#include "Harness.hpp"
+
+#include <Tensor.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+static auto BenchmarkConstruction(BenchmarkRunner& runner) -> void
+{
+    for (size_t n : runner.Sizes({64, 512, 2048}))
+    {
+        BenchmarkParameters parameters = {{"size", n}};
+        size_t bytes = n * n * sizeof(float);
+
+        runner.Run("construct/value_initialized", parameters, n * n, bytes, [&]
+        {
+            Tensor<float, 2> tensor({n, n});
+            DoNotOptimize(tensor.Data());
+        });
+
+        runner.Run("construct/uninitialized", parameters, n * n, bytes, [&]
+        {
+            Tensor<float, 2> tensor({n, n}, Uninitialized);
+            DoNotOptimize(tensor.Data());
+        });
+
+        runner.Run("construct/fill", parameters, n * n, bytes, [&]
+        {
+            Tensor<float, 2> tensor({n, n}, 1.0f);
+            DoNotOptimize(tensor.Data());
+        });
+    }
+}
+
+static auto BenchmarkIndexing(BenchmarkRunner& runner) -> void
+{
+    for (size_t n : runner.Sizes({64, 512, 1024}))
+    {
+        BenchmarkParameters parameters = {{"size", n}};
+        Tensor<float, 2> tensor({n, n});
+        std::iota(tensor.Data(), tensor.Data() + n * n, 0.0f);
+
+        runner.Run("index/row_major", parameters, n * n, n * n * sizeof(float), [&]
+        {
+            float sum = 0.0f;
+            for (size_t y = 0; y < n; ++y)
+            {
+                for (size_t x = 0; x < n; ++x)
+                {
+                    sum += tensor({y, x});
+                }
+            }
+            DoNotOptimize(sum);
+        });
+
+        runner.Run("index/column_major", parameters, n * n, n * n * sizeof(float), [&]
+        {
+            float sum = 0.0f;
+            for (size_t x = 0; x < n; ++x)
+            {
+                for (size_t y = 0; y < n; ++y)
+                {
+                    sum += tensor({y, x});
+                }
+            }
+            DoNotOptimize(sum);
+        });
+
+        View<float, 2> view = tensor.Slice(Range{0, n}, Range{0, n / 2});
+        runner.Run("index/view", parameters, n * n / 2, n * n / 2 * sizeof(float), [&]
+        {
+            float sum = 0.0f;
+            for (size_t y = 0; y < n; ++y)
+            {
+                for (size_t x = 0; x < n / 2; ++x)
+                {
+                    sum += view({y, x});
+                }
+            }
+            DoNotOptimize(sum);
+        });
+    }
+}
+
+static auto BenchmarkSlicing(BenchmarkRunner& runner) -> void
+{
+    Tensor<float, 3> tensor({16, 64, 64});
+
+    runner.Run("slice/ranges", {{"order", 3}}, 1, 0, [&]
+    {
+        auto view = tensor.Slice(Range{1, 15}, Range{8, 56}, Range{8, 56});
+        DoNotOptimize(view);
+    });
+
+    runner.Run("slice/index_and_ranges", {{"order", 3}}, 1, 0, [&]
+    {
+        auto view = tensor.Slice(3, Range{8, 56}, Range{8, 56});
+        DoNotOptimize(view);
+    });
+
+    runner.Run("slice/nested", {{"order", 3}}, 1, 0, [&]
+    {
+        auto view = tensor.Slice(Range{1, 15}, Range{8, 56}, Range{8, 56}).Slice(2, Range{0, 16}, 4);
+        DoNotOptimize(view);
+    });
+}
+
+static auto BenchmarkCopy(BenchmarkRunner& runner) -> void
+{
+    for (size_t n : runner.Sizes({256, 1024, 4096}))
+    {
+        BenchmarkParameters parameters = {{"size", n}};
+        Tensor<float, 2> source({n, n}, 1.0f);
+        Tensor<float, 2> destination({n, n});
+        size_t bytes = 2 * n * n * sizeof(float);
+
+        runner.Run("copy/contiguous", parameters, n * n, bytes, [&]
+        {
+            CopyElementwise<Tensor<float, 2>, Tensor<float, 2>, 2>(source, destination);
+            DoNotOptimize(destination.Data());
+        });
+
+        View<float, 2> block = source.Slice(Range{0, n / 2}, Range{0, n / 2});
+        Tensor<float, 2> blockDestination({n / 2, n / 2});
+        runner.Run("copy/block_view", parameters, n * n / 4, bytes / 4, [&]
+        {
+            CopyElementwise<View<float, 2>, Tensor<float, 2>, 2>(block, blockDestination);
+            DoNotOptimize(blockDestination.Data());
+        });
+
+        View<float, 1> column = source.Slice(Range{0, n}, 0);
+        Tensor<float, 1> columnDestination({n});
+        runner.Run("copy/column_view", parameters, n, 2 * n * sizeof(float), [&]
+        {
+            CopyElementwise<View<float, 1>, Tensor<float, 1>, 1>(column, columnDestination);
+            DoNotOptimize(columnDestination.Data());
+        });
+
+        View<float, 2> transposed = source.Transpose();
+        runner.Run("copy/transpose", parameters, n * n, bytes, [&]
+        {
+            CopyElementwise<View<float, 2>, Tensor<float, 2>, 2>(transposed, destination);
+            DoNotOptimize(destination.Data());
+        });
+
+        Tensor<double, 2> converted({n, n});
+        runner.Run("copy/convert_float_double", parameters, n * n, n * n * (sizeof(float) + sizeof(double)), [&]
+        {
+            CopyElementwise<Tensor<float, 2>, Tensor<double, 2>, 2>(source, converted);
+            DoNotOptimize(converted.Data());
+        });
+
+        size_t halfBytes = n * n * (sizeof(float) + sizeof(Float16));
+        Tensor<Float16, 2> half({n, n});
+        runner.Run("copy/convert_float_half", parameters, n * n, halfBytes, [&]
+        {
+            CopyElementwise<Tensor<float, 2>, Tensor<Float16, 2>, 2>(source, half);
+            DoNotOptimize(half.Data());
+        });
+
+        runner.Run("copy/convert_half_float", parameters, n * n, halfBytes, [&]
+        {
+            CopyElementwise<Tensor<Float16, 2>, Tensor<float, 2>, 2>(half, destination);
+            DoNotOptimize(destination.Data());
+        });
+
+        Tensor<BFloat16, 2> bfloat({n, n});
+        runner.Run("copy/convert_float_bfloat16", parameters, n * n, halfBytes, [&]
+        {
+            CopyElementwise<Tensor<float, 2>, Tensor<BFloat16, 2>, 2>(source, bfloat);
+            DoNotOptimize(bfloat.Data());
+        });
+
+        Tensor<Float16, 2> halfBlock({n / 2, n / 2});
+        runner.Run("copy/convert_float_half_block_view", parameters, n * n / 4, halfBytes / 4, [&]
+        {
+            CopyElementwise<View<float, 2>, Tensor<Float16, 2>, 2>(block, halfBlock);
+            DoNotOptimize(halfBlock.Data());
+        });
+    }
+}
+
+static auto BenchmarkConv(BenchmarkRunner& runner) -> void
+{
+    // channels, spatial size, filters and kernel size of typical layers, from a wide input layer to a deep narrow one
+    struct Layer
+    {
+        size_t channels;
+        size_t size;
+        size_t filters;
+        size_t kernel;
+    };
+    std::vector<Layer> layers = {{3, 224, 16, 3}, {32, 56, 32, 3}, {128, 28, 128, 3}, {256, 14, 256, 3}};
+    if (runner.Options().quick)
+    {
+        layers.resize(1);
+    }
+
+    for (auto [channels, size, filters, kernel] : layers)
+    {
+        Tensor<float, 3> input({channels, size, size}, 1.0f);
+        Tensor<float, 4> weights({filters, channels, kernel, kernel}, 0.5f);
+        Tensor<float, 3> output({filters, size, size});
+        size_t bytes = (input.end() - input.begin() + output.end() - output.begin()) * sizeof(float);
+
+        for (auto [algorithm, name] : {std::pair{ConvAlgorithm::Direct, "direct"}, {ConvAlgorithm::Im2Col, "im2col"}})
+        {
+            BenchmarkParameters parameters = {{"channels", channels}, {"size", size}, {"filters", filters}, {"kernel", kernel}};
+            Conv2DParameters convolution = {.padding = {kernel / 2, kernel / 2}, .algorithm = algorithm};
+            runner.Run(std::string("conv2d/") + name, parameters, filters * size * size, bytes, [&]
+            {
+                Conv2D(input, weights, output, convolution);
+                DoNotOptimize(output.Data());
+            });
+        }
+    }
+}
+
+static auto BenchmarkQuantize(BenchmarkRunner& runner) -> void
+{
+    for (size_t n : runner.Sizes({128, 512, 1024}))
+    {
+        BenchmarkParameters parameters = {{"size", n}};
+        Tensor<float, 2> a({n, n});
+        for (size_t i = 0; i < n * n; ++i)
+        {
+            a.Data()[i] = static_cast<float>(i % 251) * 0.01f - 1.0f;
+        }
+        Tensor<float, 2> product({n, n});
+
+        auto quantized = Quantize<int8_t>(a);
+        runner.Run("quantize/float_int8", parameters, n * n, n * n * (sizeof(float) + sizeof(int8_t)), [&]
+        {
+            auto result = Quantize<int8_t>(a, quantized.Scale(), quantized.ZeroPoint());
+            DoNotOptimize(result.Values().Data());
+        });
+
+        runner.Run("quantize/dequantize_int8_float", parameters, n * n, n * n * (sizeof(float) + sizeof(int8_t)), [&]
+        {
+            auto result = Dequantize(quantized);
+            DoNotOptimize(result.Data());
+        });
+
+        // one multiply-add per item, the matrices read once
+        runner.Run("matmul/float", parameters, n * n * n, 3 * n * n * sizeof(float), [&]
+        {
+            MatMul(a, a, product);
+            DoNotOptimize(product.Data());
+        });
+
+        auto activations = Quantize<uint8_t>(a);
+        Tensor<int32_t, 2> integers({n, n});
+        runner.Run("matmul/uint8_int8", parameters, n * n * n, n * n * (2 * sizeof(int8_t) + sizeof(int32_t)), [&]
+        {
+            MatMul(activations.Values(), quantized.Values(), integers);
+            DoNotOptimize(integers.Data());
+        });
+
+        runner.Run("matmul/int8_int8", parameters, n * n * n, n * n * (2 * sizeof(int8_t) + sizeof(int32_t)), [&]
+        {
+            MatMul(quantized.Values(), quantized.Values(), integers);
+            DoNotOptimize(integers.Data());
+        });
+
+        runner.Run("matmul/quantized", parameters, n * n * n, n * n * (2 * sizeof(int8_t) + sizeof(float)), [&]
+        {
+            auto result = MatMul(activations, quantized);
+            DoNotOptimize(result.Data());
+        });
+    }
+}
+
+static auto BenchmarkSparse(BenchmarkRunner& runner) -> void
+{
+    for (size_t n : runner.Sizes({1024, 4096, 16384}))
+    {
+        // 1% nonzeros, spread evenly apart from one dense row in every 256
+        CooMatrix<float> coo({n, n});
+        uint32_t state = 1;
+        for (size_t i = 0; i < n; ++i)
+        {
+            size_t count = i % 256 == 0 ? n / 4 : n / 100;
+            for (size_t e = 0; e < count; ++e)
+            {
+                state = state * 1664525 + 1013904223;
+                coo.Insert(i, state % n, 1.0f);
+            }
+        }
+        CsrMatrix<float> csr(coo);
+        CscMatrix<float> csc(coo);
+        size_t nonZeros = csr.NonZeros();
+        size_t sparseBytes = nonZeros * (sizeof(float) + sizeof(SparseIndex));
+        BenchmarkParameters parameters = {{"size", n}, {"nonzeros", nonZeros}};
+
+        Tensor<float, 1> x({n}, 1.0f);
+        Tensor<float, 1> y({n});
+        runner.Run("sparse/spmv_csr", parameters, nonZeros, sparseBytes + 2 * n * sizeof(float), [&]
+        {
+            MatMul(csr, x, y);
+            DoNotOptimize(y.Data());
+        });
+
+        size_t width = 64;
+        Tensor<float, 2> b({n, width}, 1.0f);
+        Tensor<float, 2> c({n, width});
+        runner.Run("sparse/spmm_csr", parameters, nonZeros * width, sparseBytes + 2 * n * width * sizeof(float), [&]
+        {
+            MatMul(csr, b, c);
+            DoNotOptimize(c.Data());
+        });
+
+        Tensor<float, 2> a({width, n}, 1.0f);
+        Tensor<float, 2> d({width, n});
+        runner.Run("sparse/dense_csc", parameters, nonZeros * width, sparseBytes + 2 * n * width * sizeof(float), [&]
+        {
+            MatMul(a, csc, d);
+            DoNotOptimize(d.Data());
+        });
+
+        if (n <= 4096)
+        {
+            Tensor<float, 2> dense = csr.ToDense();
+            runner.Run("sparse/spmm_dense_reference", parameters, n * n * width, (n * n + 2 * n * width) * sizeof(float), [&]
+            {
+                MatMul(dense, b, c);
+                DoNotOptimize(c.Data());
+            });
+        }
+    }
+}
+
+static auto BenchmarkChunked(BenchmarkRunner& runner) -> void
+{
+    std::string path = (std::filesystem::temp_directory_path() / "benchmark_chunked.chunks").string();
+    for (size_t n : runner.Sizes({128, 256, 512}))
+    {
+        // a quarter of the volume fits in the cache, so that every pass reads the file again
+        size_t chunk = 32;
+        size_t bytes = n * n * n * sizeof(float);
+        BenchmarkParameters parameters = {{"size", n}, {"chunk", chunk}};
+        {
+            ChunkedTensor<float, 3> chunked(path, {n, n, n}, {chunk, chunk, chunk}, {bytes / 4, 2});
+            chunked.ForEachChunk([](View<float, 3> block, std::array<size_t, 3>)
+            {
+                for (float& value : block)
+                {
+                    value = 1.0f;
+                }
+            }, ChunkAccess::ReadWrite);
+        }
+
+        ChunkedTensor<float, 3> chunked(path, {bytes / 4, 2});
+        std::atomic<size_t> total = 0;
+        auto sum = [&](auto block)
+        {
+            float partial = 0.0f;
+            for (float value : block)
+            {
+                partial += value;
+            }
+            total += static_cast<size_t>(partial);
+        };
+
+        runner.Run("chunked/for_each_chunk", parameters, n * n * n, bytes, [&]
+        {
+            chunked.ForEachChunk([&](View<float, 3> block, std::array<size_t, 3>)
+            {
+                sum(block);
+            });
+        });
+
+        // the same chunks one at a time, without reading ahead
+        runner.Run("chunked/slice_each_chunk", parameters, n * n * n, bytes, [&]
+        {
+            for (size_t i = 0; i < n; i += chunk)
+            {
+                for (size_t j = 0; j < n; j += chunk)
+                {
+                    for (size_t k = 0; k < n; k += chunk)
+                    {
+                        sum(chunked.Slice(Range{i, i + chunk}, Range{j, j + chunk}, Range{k, k + chunk}).view);
+                    }
+                }
+            }
+        });
+
+        // a block straddling chunks along every dimension, assembled into a copy
+        size_t half = chunk / 2;
+        size_t block = std::min(n - half, size_t{4} * chunk);
+        runner.Run("chunked/slice_assembled", parameters, block * block * block, block * block * block * sizeof(float), [&]
+        {
+            auto slice = chunked.Slice(Range{half, half + block}, Range{half, half + block}, Range{half, half + block});
+            DoNotOptimize(slice.view.Data());
+        });
+        DoNotOptimize(total.load());
+    }
+    std::filesystem::remove(path);
+}
+
+auto RunTensorBenchmarks(BenchmarkRunner& runner) -> void
+{
+    BenchmarkConstruction(runner);
+    BenchmarkIndexing(runner);
+    BenchmarkSlicing(runner);
+    BenchmarkCopy(runner);
+    BenchmarkConv(runner);
+    BenchmarkQuantize(runner);
+    BenchmarkSparse(runner);
+    BenchmarkChunked(runner);
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Prevent the compiler from optimizing away the computation of a value.
+ */
+template <typename T>
+inline auto DoNotOptimize(T const& value) -> void
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<char const volatile*>(&value);
+#endif
+}
+
+/*
+ * Named integer parameters of one benchmark run, such as a size or a thread count.
+ */
+using BenchmarkParameters = std::vector<std::pair<std::string, size_t>>;
+
+struct BenchmarkResult
+{
+    std::string name;
+    BenchmarkParameters parameters;
+    size_t iterations;
+    double nanoseconds;
+    double items;
+    double bytes;
+};
+
+struct BenchmarkOptions
+{
+    std::string filter;
+    std::string output;
+    double minimumSeconds = 0.1;
+    size_t repetitions = 5;
+    bool quick = false;
+};
+
+/*
+ * Minimal benchmark harness.
+ * Each benchmark is a callable performing one iteration. It is run once to warm up, then the iteration count is doubled
+ * until one batch takes at least the minimum time, and the median time per iteration over several batches is reported.
+ */
+class BenchmarkRunner
+{
+public:
+
+    explicit BenchmarkRunner(BenchmarkOptions options)
+        : mOptions(std::move(options))
+    {}
+
+    auto Options() const -> BenchmarkOptions const&
+    {
+        return mOptions;
+    }
+
+    /*
+     * Pick the sizes to run, keeping only the smallest in quick mode.
+     */
+    auto Sizes(std::vector<size_t> sizes) const -> std::vector<size_t>
+    {
+        if (mOptions.quick && !sizes.empty())
+        {
+            sizes.resize(1);
+        }
+        return sizes;
+    }
+
+    /*
+     * Measure `callable`, which processes `items` elements and `bytes` bytes per iteration.
+     */
+    template <typename Callable>
+    auto Run(std::string const& name, BenchmarkParameters const& parameters, size_t items, size_t bytes, Callable&& callable) -> void
+    {
+        std::string label = Label(name, parameters);
+        if (!mOptions.filter.empty() && label.find(mOptions.filter) == std::string::npos)
+        {
+            return;
+        }
+
+        callable();
+
+        double minimumSeconds = mOptions.quick ? mOptions.minimumSeconds / 10 : mOptions.minimumSeconds;
+        size_t iterations = 1;
+        while (Time(iterations, callable) < minimumSeconds && iterations < (size_t{1} << 30))
+        {
+            iterations *= 2;
+        }
+
+        size_t repetitions = mOptions.quick ? 1 : std::max<size_t>(mOptions.repetitions, 1);
+        std::vector<double> samples;
+        for (size_t i = 0; i < repetitions; ++i)
+        {
+            samples.push_back(Time(iterations, callable) / static_cast<double>(iterations) * 1e9);
+        }
+        std::sort(samples.begin(), samples.end());
+        double nanoseconds = samples[samples.size() / 2];
+
+        mResults.push_back({name, parameters, iterations, nanoseconds, static_cast<double>(items), static_cast<double>(bytes)});
+        std::cerr << label << ": " << nanoseconds << " ns" << std::endl;
+    }
+
+    /*
+     * Write every result as JSON, with the given context entries, to the output file or else to standard output.
+     */
+    auto Report(std::vector<std::pair<std::string, std::string>> const& context) const -> void
+    {
+        std::ostringstream json;
+        json << "{\n  \"context\": {";
+        for (size_t i = 0; i < context.size(); ++i)
+        {
+            json << (i ? ", " : "") << "\"" << context[i].first << "\": \"" << context[i].second << "\"";
+        }
+        json << "},\n  \"benchmarks\": [";
+
+        for (size_t i = 0; i < mResults.size(); ++i)
+        {
+            BenchmarkResult const& result = mResults[i];
+            json << (i ? "," : "") << "\n    {\"name\": \"" << result.name << "\", \"parameters\": {";
+            for (size_t p = 0; p < result.parameters.size(); ++p)
+            {
+                json << (p ? ", " : "") << "\"" << result.parameters[p].first << "\": " << result.parameters[p].second;
+            }
+            double seconds = result.nanoseconds * 1e-9;
+            json << "}, \"iterations\": " << result.iterations
+                 << ", \"ns_per_iteration\": " << result.nanoseconds
+                 << ", \"items_per_second\": " << (result.items > 0 ? result.items / seconds : 0.0)
+                 << ", \"bytes_per_second\": " << (result.bytes > 0 ? result.bytes / seconds : 0.0) << "}";
+        }
+        json << "\n  ]\n}\n";
+
+        if (mOptions.output.empty())
+        {
+            std::cout << json.str();
+        }
+        else
+        {
+            std::ofstream(mOptions.output) << json.str();
+        }
+    }
+
+private:
+
+    BenchmarkOptions mOptions;
+    std::vector<BenchmarkResult> mResults;
+
+    template <typename Callable>
+    static auto Time(size_t iterations, Callable& callable) -> double
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            callable();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static auto Label(std::string const& name, BenchmarkParameters const& parameters) -> std::string
+    {
+        std::string label = name;
+        for (auto const& [key, value] : parameters)
+        {
+            label += "/" + key + ":" + std::to_string(value);
+        }
+        return label;
+    }
+};
+
+auto RunTensorBenchmarks(BenchmarkRunner& runner) -> void;
+auto RunDispatchBenchmarks(BenchmarkRunner& runner) -> void;
@@ -0,0 +1,101 @@
+#include "Harness.hpp"
+
+#include <Dispatch.hpp>
+#include <Tensor.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+auto SimdLevelName(SimdLevel level) -> std::string
+{
+    switch (level)
+    {
+    case SimdLevel::SSE42:
+        return "SSE4.2";
+    case SimdLevel::AVX2:
+        return "AVX2";
+    case SimdLevel::AVX512:
+        return "AVX-512";
+    default:
+        return "Scalar";
+    }
+}
+
+auto main(int argc, char** argv) -> int
+{
+    BenchmarkOptions options;
+    ThreadPoolOptions poolOptions;
+    std::string affinity = "none";
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        auto value = [&](std::string const& prefix) { return argument.substr(prefix.size()); };
+
+        if (argument.starts_with("--filter="))
+        {
+            options.filter = value("--filter=");
+        }
+        else if (argument.starts_with("--out="))
+        {
+            options.output = value("--out=");
+        }
+        else if (argument.starts_with("--min-time="))
+        {
+            options.minimumSeconds = std::stod(value("--min-time="));
+        }
+        else if (argument.starts_with("--repetitions="))
+        {
+            options.repetitions = std::stoul(value("--repetitions="));
+        }
+        else if (argument.starts_with("--affinity="))
+        {
+            affinity = value("--affinity=");
+            if (affinity == "compact")
+            {
+                poolOptions.affinity = Affinity::Compact;
+            }
+            else if (affinity == "scatter")
+            {
+                poolOptions.affinity = Affinity::Scatter;
+            }
+            else if (affinity != "none")
+            {
+                std::cerr << "unknown affinity " << affinity << ", expected none, compact or scatter" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (argument == "--quick")
+        {
+            options.quick = true;
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--filter=substring] [--out=file.json] [--min-time=seconds] [--repetitions=count] [--affinity=none|compact|scatter] [--quick]" << std::endl;
+            return argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    ConfigureDispatcherThreadPool(poolOptions);
+
+    BenchmarkRunner runner(options);
+    RunTensorBenchmarks(runner);
+    RunDispatchBenchmarks(runner);
+
+#if defined(NDEBUG)
+    std::string build = "release";
+#else
+    std::string build = "debug";
+#endif
+
+    runner.Report({
+        {"hardware_concurrency", std::to_string(std::thread::hardware_concurrency())},
+        {"dispatcher_threads", std::to_string(GetDispatcherThreadPool().Threads())},
+        {"dispatcher_nodes", std::to_string(GetDispatcherThreadPool().Nodes())},
+        {"affinity", affinity},
+        {"simd_level", SimdLevelName(ActiveSimdLevel())},
+        {"build", build},
+    });
+    return EXIT_SUCCESS;
+}
@@ -2,65 +2,656 @@
 
 #include "ThreadPool.hpp"
 
-ThreadPool& GetDispatcherThreadPool() {
-    static ThreadPool pool;
-    return pool;
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * The pool used by Dispatch*, ParallelFor and the tensor operations, and the options its default is created with.
+ */
+struct DispatcherRegistry
+{
+    std::mutex mutex;
+    std::atomic<ThreadPool*> pool = nullptr;
+    std::unique_ptr<ThreadPool> owned;
+    ThreadPoolOptions options;
+};
+
+inline auto GetDispatcherRegistry() -> DispatcherRegistry&
+{
+    static DispatcherRegistry registry;
+    return registry;
 }
 
-template <typename Callable>
-auto DispatchElement(size_t height, size_t width, Callable&& callable) -> void
+/*
+ * Set the options the dispatcher thread pool is created with on first use, such as pinning its workers. Throws if the
+ * dispatcher thread pool is already in use.
+ */
+inline auto ConfigureDispatcherThreadPool(ThreadPoolOptions const& options) -> void
 {
-    ThreadPool& thread_pool = GetDispatcherThreadPool();
-    size_t num_threads = thread_pool.Threads();
+    DispatcherRegistry& registry = GetDispatcherRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+    if (registry.pool.load(std::memory_order_acquire) != nullptr)
+    {
+        throw std::runtime_error("the dispatcher thread pool is already in use");
+    }
+    registry.options = options;
+}
 
-    size_t num_tasks = (height < num_threads) ? height : num_threads;
+/*
+ * Have the dispatcher use a pool owned by the caller, which must outlive every use of it. Throws if the dispatcher
+ * thread pool is already in use.
+ */
+inline auto SetDispatcherThreadPool(ThreadPool& pool) -> void
+{
+    DispatcherRegistry& registry = GetDispatcherRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+    if (registry.pool.load(std::memory_order_acquire) != nullptr)
+    {
+        throw std::runtime_error("the dispatcher thread pool is already in use");
+    }
+    registry.pool.store(&pool, std::memory_order_release);
+}
 
-    size_t rows_per_task = height / num_tasks;
-    size_t remainder = height % num_tasks;
+inline ThreadPool& GetDispatcherThreadPool()
+{
+    DispatcherRegistry& registry = GetDispatcherRegistry();
+    if (ThreadPool* pool = registry.pool.load(std::memory_order_acquire))
+    {
+        return *pool;
+    }
 
-    for (size_t t = 0; t < num_tasks; ++t)
+    std::unique_lock<std::mutex> lock(registry.mutex);
+    if (registry.pool.load(std::memory_order_relaxed) == nullptr)
     {
-        size_t row_start = t * rows_per_task + std::min(t, remainder);
-        size_t extra = (t < remainder) ? 1 : 0;
-        size_t row_end = row_start + rows_per_task + extra;
+        registry.owned = std::make_unique<ThreadPool>(registry.options);
+        registry.pool.store(registry.owned.get(), std::memory_order_release);
+    }
+    return *registry.pool.load(std::memory_order_relaxed);
+}
+
+/*
+ * Completion state shared by the tasks of one dispatch and the handles to it.
+ * Counts down the tasks still pending, keeps the first exception thrown by any of them, and runs the registered
+ * completion callbacks once the last one finishes. While tasks are pending the state keeps itself alive, so a dispatch
+ * may outlive every handle to it.
+ */
+class DispatchState
+{
+public:
+
+    using Callback = std::function<void(std::exception_ptr)>;
+
+private:
+
+    ThreadPool* pool_;
+    std::atomic<size_t> pending_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_done_;
+    bool done_ = false;
+    std::exception_ptr exception_;
+    std::vector<Callback> callbacks_;
+    std::shared_ptr<DispatchState> self_;
+
+#if TENSOR_POOL_METRICS
+    static inline std::atomic<size_t> live_ = 0;
+#endif
+
+public:
+
+    DispatchState(ThreadPool& pool, size_t pending)
+        : pool_(&pool)
+        , pending_(pending)
+    {
+#if TENSOR_POOL_METRICS
+        live_.fetch_add(1, std::memory_order_relaxed);
+#endif
+    }
+
+    DispatchState(DispatchState const&) = delete;
+    DispatchState& operator=(DispatchState const&) = delete;
+
+    virtual ~DispatchState()
+    {
+#if TENSOR_POOL_METRICS
+        live_.fetch_sub(1, std::memory_order_relaxed);
+#endif
+    }
+
+#if TENSOR_POOL_METRICS
+    /*
+     * Number of dispatch states currently alive, across all pools.
+     */
+    static auto Live() -> size_t
+    {
+        return live_.load(std::memory_order_relaxed);
+    }
+#endif
+
+    auto Pool() const -> ThreadPool&
+    {
+        return *pool_;
+    }
+
+    /*
+     * Keep the state alive until its last pending task finishes.
+     */
+    auto Retain(std::shared_ptr<DispatchState> self) -> void
+    {
+        self_ = std::move(self);
+    }
+
+    /*
+     * Record that one pending task finished, having thrown `error` if it is set.
+     */
+    auto Finish(std::exception_ptr error = nullptr) -> void
+    {
+        if (error)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!exception_)
+            {
+                exception_ = error;
+            }
+        }
+
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        {
+            return;
+        }
+
+        // the state may only be released once the callbacks have run and the waiters have been woken
+        std::shared_ptr<DispatchState> self;
+        std::vector<Callback> callbacks;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            callbacks.swap(callbacks_);
+            self = std::move(self_);
+        }
+        for (Callback& callback : callbacks)
+        {
+            callback(exception_);
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_ = true;
+        }
+        cv_done_.notify_all();
+    }
+
+    /*
+     * Call `callback` with the dispatch's exception, or a null one, once every task finished. Runs on the thread which
+     * finished the last task, or right away on the calling thread if that already happened.
+     */
+    auto OnComplete(Callback callback) -> void
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (pending_.load(std::memory_order_acquire) > 0)
+            {
+                callbacks_.emplace_back(std::move(callback));
+                return;
+            }
+        }
+        callback(exception_);
+    }
+
+    auto IsDone() -> bool
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return done_;
+    }
+
+    /*
+     * Add tasks to a dispatch which has not completed yet.
+     */
+    auto Add(size_t count) -> void
+    {
+        pending_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /*
+     * Block until the dispatch completed. A worker of the pool runs pending tasks meanwhile, as its own dispatch may
+     * be queued behind it, which makes waiting from inside a task safe.
+     */
+    auto Wait() -> void
+    {
+#if TENSOR_POOL_METRICS
+        uint64_t start = MetricsClock();
+#endif
+        if (pool_->IsWorkerThread())
+        {
+            pool_->RunPendingTasksUntil([this]()
+            {
+                return pending_.load(std::memory_order_acquire) == 0;
+            });
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_done_.wait(lock, [this]()
+            {
+                return done_;
+            });
+        }
+#if TENSOR_POOL_METRICS
+        pool_->RecordWait(MetricsClock() - start);
+#endif
+    }
+
+    auto Exception() -> std::exception_ptr
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return exception_;
+    }
+};
+
+/*
+ * A dispatch state which also owns the body its tasks run, as the body must stay alive until the last one finished.
+ */
+template <typename Body>
+class DispatchJob : public DispatchState
+{
+private:
+
+    Body body_;
+
+public:
+
+    template <typename Function>
+    DispatchJob(ThreadPool& pool, size_t pending, Function&& body)
+        : DispatchState(pool, pending)
+        , body_(std::forward<Function>(body))
+    {}
+
+    auto Run(size_t task) -> void
+    {
+        try
+        {
+            body_(task);
+        }
+        catch (...)
+        {
+            Finish(std::current_exception());
+            return;
+        }
+        Finish();
+    }
+};
+
+/*
+ * Handle to the completion of one asynchronous dispatch.
+ * Waiting on a handle only waits for the tasks of its own dispatch, rather than for the whole pool to go idle, so
+ * callers on different threads sharing the pool do not wait on each other's work. Handles are cheap to copy, and a
+ * default-constructed handle is already complete.
+ */
+class DispatchHandle
+{
+private:
+
+    std::shared_ptr<DispatchState> state_;
+
+public:
+
+    DispatchHandle() = default;
+
+    explicit DispatchHandle(std::shared_ptr<DispatchState> state)
+        : state_(std::move(state))
+    {}
+
+    auto IsDone() const -> bool
+    {
+        return !state_ || state_->IsDone();
+    }
+
+    /*
+     * The pool the dispatch runs on, or the dispatcher thread pool for an empty handle.
+     */
+    auto Pool() const -> ThreadPool&
+    {
+        return state_ ? state_->Pool() : GetDispatcherThreadPool();
+    }
+
+    /*
+     * Block until every task of the dispatch finished, then rethrow the first exception any of them threw.
+     */
+    auto Wait() const -> void
+    {
+        if (!state_)
+        {
+            return;
+        }
+        state_->Wait();
+        if (std::exception_ptr exception = state_->Exception())
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    /*
+     * Schedule `callable` on the pool once this dispatch completes, and return a handle to its completion.
+     * If this dispatch failed, the continuation is skipped and its handle fails with the same exception.
+     */
+    template <typename Callable>
+    auto Then(Callable&& callable) const -> DispatchHandle;
 
-        thread_pool.Enqueue([=, &callable]()
+    /*
+     * Register a raw completion callback; see DispatchState::OnComplete.
+     */
+    auto OnComplete(DispatchState::Callback callback) const -> void
+    {
+        if (state_)
+        {
+            state_->OnComplete(std::move(callback));
+        }
+        else
+        {
+            callback(nullptr);
+        }
+    }
+};
+
+/*
+ * Enqueue `count` tasks on `pool`, the t-th of which calls `body(t)`, and return a handle to their completion.
+ * Dispatched from outside the pool, task t goes to worker t, so that the same band of a buffer is handled by the same
+ * worker every time: the worker, and with pinned workers the NUMA node, which first touched it. Dispatched from a
+ * worker, the tasks stay on that worker's own deque.
+ */
+template <typename Body>
+auto DispatchTasks(ThreadPool& pool, size_t count, Body&& body) -> DispatchHandle
+{
+    if (count == 0)
+    {
+        return {};
+    }
+
+    auto job = std::make_shared<DispatchJob<std::decay_t<Body>>>(pool, count, std::forward<Body>(body));
+    job->Retain(job);
+
+    // tasks only carry the job's address and their index, so they are stored inline
+    DispatchJob<std::decay_t<Body>>* raw_job = job.get();
+    bool nested = pool.IsWorkerThread();
+    for (size_t t = 0; t < count; ++t)
+    {
+        try
+        {
+            auto task = [raw_job, t]()
+            {
+                raw_job->Run(t);
+            };
+            if (nested)
+            {
+                pool.Enqueue(task);
+            }
+            else
+            {
+                pool.EnqueueTo(t, task);
+            }
+        }
+        catch (...)
+        {
+            for (; t < count; ++t)
+            {
+                raw_job->Finish(std::current_exception());
+            }
+        }
+    }
+    return DispatchHandle(std::move(job));
+}
+
+/*
+ * Scoped group of tasks run on the dispatcher thread pool.
+ * Tasks may be added from any thread until the group is waited on, and from tasks of the group at any time. Waiting
+ * from a task of the pool runs pending tasks meanwhile rather than blocking, so parallel code can start groups of its
+ * own at any depth. The group waits for its tasks when it goes out of scope, after which it may be reused.
+ */
+class TaskGroup
+{
+private:
+
+    ThreadPool* pool_;
+    std::shared_ptr<DispatchState> state_;
+
+public:
+
+    explicit TaskGroup(ThreadPool& pool = GetDispatcherThreadPool())
+        : pool_(&pool)
+        , state_(Open(pool))
+    {}
+
+    TaskGroup(TaskGroup const&) = delete;
+    TaskGroup& operator=(TaskGroup const&) = delete;
+
+    ~TaskGroup()
+    {
+        try
+        {
+            Join(false);
+        }
+        catch (...)
+        {
+        }
+    }
+
+    template <typename Callable>
+    auto Run(Callable&& callable) -> void
+    {
+        DispatchState* state = state_.get();
+        state->Add(1);
+        try
         {
-            for (size_t y = row_start; y < row_end; ++y)
+            pool_->Enqueue([state, callable = std::forward<Callable>(callable)]() mutable
             {
-                for (size_t x = 0; x < width; ++x)
+                try
                 {
-                    callable(y, x);
+                    callable();
                 }
-            }
+                catch (...)
+                {
+                    state->Finish(std::current_exception());
+                    return;
+                }
+                state->Finish();
+            });
+        }
+        catch (...)
+        {
+            state->Finish();
+            throw;
+        }
+    }
+
+    /*
+     * Wait for every task run so far, then rethrow the first exception any of them threw.
+     */
+    auto Wait() -> void
+    {
+        Join(true);
+    }
+
+private:
+
+    /*
+     * Wait for the current state, and open the next one if the group is to be reused; the destructor does not, as
+     * nothing would ever finish it.
+     */
+    auto Join(bool reopen) -> void
+    {
+        // release the group's own hold on the state, which kept it from completing between tasks; running tasks may
+        // still add to the group until the last of them finished
+        std::shared_ptr<DispatchState> state = state_;
+        state->Finish();
+        state->Wait();
+
+        state_ = reopen ? Open(*pool_) : nullptr;
+        DispatchHandle(std::move(state)).Wait();
+    }
+
+    static auto Open(ThreadPool& pool) -> std::shared_ptr<DispatchState>
+    {
+        auto state = std::make_shared<DispatchState>(pool, 1);
+        state->Retain(state);
+        return state;
+    }
+};
+
+template <typename Callable>
+auto DispatchHandle::Then(Callable&& callable) const -> DispatchHandle
+{
+    ThreadPool& pool = Pool();
+
+    auto body = [callable = std::forward<Callable>(callable)](size_t) mutable
+    {
+        callable();
+    };
+    auto job = std::make_shared<DispatchJob<decltype(body)>>(pool, 1, std::move(body));
+    job->Retain(job);
+
+    DispatchJob<decltype(body)>* raw_job = job.get();
+    OnComplete([raw_job](std::exception_ptr error)
+    {
+        if (error)
+        {
+            raw_job->Finish(error);
+            return;
+        }
+        try
+        {
+            raw_job->Pool().Enqueue([raw_job]()
+            {
+                raw_job->Run(0);
+            });
+        }
+        catch (...)
+        {
+            raw_job->Finish(std::current_exception());
+        }
+    });
+    return DispatchHandle(std::move(job));
+}
+
+/*
+ * Return a handle which completes once all of `handles` completed, failing with the first exception among them.
+ * Waiting on it helps the pool of the first handle still running, rather than the dispatcher thread pool.
+ */
+inline auto WhenAll(std::vector<DispatchHandle> const& handles) -> DispatchHandle
+{
+    if (handles.empty())
+    {
+        return {};
+    }
+
+    auto owner = std::find_if(handles.begin(), handles.end(), [](DispatchHandle const& handle)
+    {
+        return !handle.IsDone();
+    });
+    ThreadPool& pool = (owner != handles.end() ? *owner : handles.front()).Pool();
+
+    auto join = std::make_shared<DispatchState>(pool, handles.size());
+    join->Retain(join);
+
+    DispatchState* raw_join = join.get();
+    for (DispatchHandle const& handle : handles)
+    {
+        handle.OnComplete([raw_join](std::exception_ptr error)
+        {
+            raw_join->Finish(error);
         });
     }
+    return DispatchHandle(std::move(join));
+}
 
-    thread_pool.Wait();
+/*
+ * Run `callable` once on the dispatcher thread pool, such as a read or write to overlap with computation.
+ */
+template <typename Callable>
+auto DispatchAsync(Callable&& callable) -> DispatchHandle
+{
+    return DispatchTasks(GetDispatcherThreadPool(), 1, [callable = std::forward<Callable>(callable)](size_t) mutable
+    {
+        callable();
+    });
 }
 
+/*
+ * Call `callable(y)` for every row y in [0, height) on `thread_pool`, split into one contiguous block of rows per thread,
+ * without waiting for the calls to finish. The callable is moved into the dispatch, so it may be a temporary.
+ */
 template <typename Callable>
-auto DispatchRow(size_t height, Callable&& callable) -> void
+auto DispatchRowAsync(ThreadPool& thread_pool, size_t height, Callable&& callable) -> DispatchHandle
 {
-    ThreadPool& thread_pool = GetDispatcherThreadPool();
-    size_t num_threads = thread_pool.Threads();
-    size_t num_tasks = (height < num_threads) ? height : num_threads;
-    size_t rows_per_task = height / num_tasks;
-    size_t remainder = height % num_tasks;
+    size_t num_tasks = std::min(height, thread_pool.Threads());
+    size_t rows_per_task = num_tasks > 0 ? height / num_tasks : 0;
+    size_t remainder = num_tasks > 0 ? height % num_tasks : 0;
 
-    for (size_t t = 0; t < num_tasks; ++t)
+    return DispatchTasks(thread_pool, num_tasks, [=, callable = std::forward<Callable>(callable)](size_t t) mutable
     {
         size_t row_start = t * rows_per_task + std::min(t, remainder);
         size_t extra = (t < remainder) ? 1 : 0;
         size_t row_end = row_start + rows_per_task + extra;
 
-        thread_pool.Enqueue([=, &callable]()
+        for (size_t y = row_start; y < row_end; ++y)
         {
-            for (size_t y = row_start; y < row_end; ++y)
-            {
-                callable(y);
-            }
-        });
-    }
-    thread_pool.Wait();
+            callable(y);
+        }
+    });
+}
+
+/*
+ * DispatchRowAsync on the dispatcher thread pool.
+ */
+template <typename Callable>
+auto DispatchRowAsync(size_t height, Callable&& callable) -> DispatchHandle
+{
+    return DispatchRowAsync(GetDispatcherThreadPool(), height, std::forward<Callable>(callable));
+}
+
+/*
+ * Call `callable(y, x)` for every element of a height x width grid on `thread_pool`, split by rows as in
+ * DispatchRowAsync.
+ */
+template <typename Callable>
+auto DispatchElementAsync(ThreadPool& thread_pool, size_t height, size_t width, Callable&& callable) -> DispatchHandle
+{
+    return DispatchRowAsync(thread_pool, height, [width, callable = std::forward<Callable>(callable)](size_t y) mutable
+    {
+        for (size_t x = 0; x < width; ++x)
+        {
+            callable(y, x);
+        }
+    });
+}
+
+template <typename Callable>
+auto DispatchElementAsync(size_t height, size_t width, Callable&& callable) -> DispatchHandle
+{
+    return DispatchElementAsync(GetDispatcherThreadPool(), height, width, std::forward<Callable>(callable));
+}
+
+template <typename Callable>
+auto DispatchElement(size_t height, size_t width, Callable&& callable) -> void
+{
+    DispatchElementAsync(height, width, [&callable](size_t y, size_t x)
+    {
+        callable(y, x);
+    }).Wait();
+}
+
+template <typename Callable>
+auto DispatchRow(size_t height, Callable&& callable) -> void
+{
+    DispatchRowAsync(height, [&callable](size_t y)
+    {
+        callable(y);
+    }).Wait();
 }
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "Dispatch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/*
+ * A half-open box of indices, [begin[d], end[d]) in every dimension d.
+ */
+template <size_t N>
+struct IndexRange
+{
+    std::array<size_t, N> begin;
+    std::array<size_t, N> end;
+
+    auto Extent(size_t dimension) const -> size_t
+    {
+        return end[dimension] > begin[dimension] ? end[dimension] - begin[dimension] : 0;
+    }
+
+    auto Size() const -> size_t
+    {
+        size_t size = 1;
+        for (size_t d = 0; d < N; ++d)
+        {
+            size *= Extent(d);
+        }
+        return size;
+    }
+};
+
+/*
+ * How the tiles of a ParallelFor are handed out to threads.
+ * Static gives every thread an equal, contiguous share up front, which is cheapest when tiles cost the same. Dynamic has
+ * threads take one tile at a time from a shared counter, which balances tiles of uneven cost. Guided takes shrinking
+ * batches, a fraction of the remaining tiles each, which balances nearly as well with fewer atomic operations.
+ */
+enum class Schedule
+{
+    Static,
+    Dynamic,
+    Guided,
+};
+
+/*
+ * Call `callable` with sub-ranges of `range` covering it exactly once, in parallel on `thread_pool`.
+ * The range is cut into tiles of the given shape, clipped at its end; each call receives one tile, so the callable runs
+ * its own inner loops, which the compiler can vectorize. Tiles are numbered in row-major order, and tiles which are
+ * adjacent in that order are preferably given to the same thread. Loops may be nested, see TaskGroup.
+ */
+template <size_t N, typename Callable>
+auto ParallelFor(ThreadPool& thread_pool, IndexRange<N> const& range, std::array<size_t, N> const& tile, Callable&& callable, Schedule schedule = Schedule::Static) -> void
+{
+    std::array<size_t, N> tile_shape{};
+    std::array<size_t, N> tile_counts{};
+    size_t num_tiles = 1;
+    for (size_t d = 0; d < N; ++d)
+    {
+        tile_shape[d] = std::max<size_t>(tile[d], 1);
+        tile_counts[d] = (range.Extent(d) + tile_shape[d] - 1) / tile_shape[d];
+        num_tiles *= tile_counts[d];
+    }
+    if (num_tiles == 0)
+    {
+        return;
+    }
+
+    auto run_tiles = [&](size_t first, size_t last)
+    {
+        for (size_t t = first; t < last; ++t)
+        {
+            IndexRange<N> sub_range;
+            size_t index = t;
+            for (size_t d = N; d-- > 0;)
+            {
+                size_t position = index % tile_counts[d];
+                index /= tile_counts[d];
+                sub_range.begin[d] = range.begin[d] + position * tile_shape[d];
+                sub_range.end[d] = std::min(sub_range.begin[d] + tile_shape[d], range.end[d]);
+            }
+            callable(sub_range);
+        }
+    };
+
+    size_t num_tasks = std::min(thread_pool.Threads(), num_tiles);
+    if (num_tasks <= 1)
+    {
+        run_tiles(0, num_tiles);
+        return;
+    }
+
+    std::atomic<size_t> next_tile = 0;
+
+    DispatchTasks(thread_pool, num_tasks, [=, &run_tiles, &next_tile](size_t t)
+    {
+        switch (schedule)
+        {
+        case Schedule::Static:
+        {
+            size_t tiles_per_task = num_tiles / num_tasks;
+            size_t remainder = num_tiles % num_tasks;
+            size_t first = t * tiles_per_task + std::min(t, remainder);
+            run_tiles(first, first + tiles_per_task + (t < remainder ? 1 : 0));
+            break;
+        }
+        case Schedule::Dynamic:
+        {
+            for (size_t first; (first = next_tile.fetch_add(1, std::memory_order_relaxed)) < num_tiles;)
+            {
+                run_tiles(first, first + 1);
+            }
+            break;
+        }
+        case Schedule::Guided:
+        {
+            size_t first = next_tile.load(std::memory_order_relaxed);
+            while (first < num_tiles)
+            {
+                size_t batch = std::max<size_t>((num_tiles - first) / (2 * num_tasks), 1);
+                if (next_tile.compare_exchange_weak(first, first + batch, std::memory_order_relaxed))
+                {
+                    run_tiles(first, std::min(first + batch, num_tiles));
+                    first = next_tile.load(std::memory_order_relaxed);
+                }
+            }
+            break;
+        }
+        }
+    }).Wait();
+}
+
+/*
+ * ParallelFor on the dispatcher thread pool.
+ */
+template <size_t N, typename Callable>
+auto ParallelFor(IndexRange<N> const& range, std::array<size_t, N> const& tile, Callable&& callable, Schedule schedule = Schedule::Static) -> void
+{
+    ParallelFor(GetDispatcherThreadPool(), range, tile, std::forward<Callable>(callable), schedule);
+}
+
+/*
+ * One-dimensional ParallelFor over [begin, end), in tiles of `grain` indices.
+ */
+template <typename Callable>
+auto ParallelFor(size_t begin, size_t end, size_t grain, Callable&& callable, Schedule schedule = Schedule::Static) -> void
+{
+    ParallelFor(IndexRange<1>{{begin}, {end}}, {grain}, std::forward<Callable>(callable), schedule);
+}
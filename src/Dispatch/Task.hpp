@@ -0,0 +1,124 @@
+#pragma once
+
+#include "ThreadPoolMetrics.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Type-erased, fixed-size unit of work.
+ * Small, trivially copyable callables (e.g. lambdas capturing indices and references) are stored inline, so creating a
+ * task never allocates. Other callables are moved to the heap and released after they run. A Task is itself trivially
+ * copyable, which lets the scheduler queues move it around as plain words.
+ */
+class alignas(16) Task
+{
+public:
+
+#if TENSOR_POOL_METRICS
+    static constexpr size_t capacity = 64 - sizeof(void (*)(void*)) - sizeof(uint64_t);
+#else
+    static constexpr size_t capacity = 64 - sizeof(void (*)(void*));
+#endif
+
+private:
+
+    std::array<std::byte, capacity> storage_{};
+    void (*invoke_)(void*) = nullptr;
+#if TENSOR_POOL_METRICS
+    uint64_t enqueue_time_ = 0;
+#endif
+
+public:
+
+    Task() = default;
+
+    template <typename Function>
+    static auto Create(Function&& function) -> Task
+    {
+        using Callable = std::decay_t<Function>;
+
+        Task task;
+        if constexpr (IsInline<Callable>())
+        {
+            ::new (static_cast<void*>(task.storage_.data())) Callable(std::forward<Function>(function));
+            task.invoke_ = [](void* storage)
+            {
+                (*std::launder(static_cast<Callable*>(storage)))();
+            };
+        }
+        else
+        {
+            Callable* callable = new Callable(std::forward<Function>(function));
+            std::memcpy(task.storage_.data(), &callable, sizeof(callable));
+            task.invoke_ = [](void* storage)
+            {
+                Callable* callable;
+                std::memcpy(&callable, storage, sizeof(callable));
+                std::unique_ptr<Callable> owner(callable);
+                (*owner)();
+            };
+        }
+        return task;
+    }
+
+    template <typename Function, typename... Arguments>
+    static auto Create(Function&& function, Arguments&&... args) -> Task
+    {
+        return Create([function = std::forward<Function>(function), ... args = std::forward<Arguments>(args)]() mutable
+        {
+            std::invoke(function, args...);
+        });
+    }
+
+    /*
+     * Whether a callable of the given type is stored without a heap allocation.
+     */
+    template <typename Callable>
+    static constexpr auto IsInline() -> bool
+    {
+        return sizeof(Callable) <= capacity
+            && alignof(Callable) <= alignof(Task)
+            && std::is_trivially_copyable_v<Callable>
+            && std::is_trivially_destructible_v<Callable>;
+    }
+
+#if TENSOR_POOL_METRICS
+    /*
+     * When the task was enqueued, in nanoseconds on the metrics clock.
+     */
+    auto EnqueueTime() const -> uint64_t
+    {
+        return enqueue_time_;
+    }
+
+    auto SetEnqueueTime(uint64_t time) -> void
+    {
+        enqueue_time_ = time;
+    }
+#endif
+
+    explicit operator bool() const
+    {
+        return invoke_ != nullptr;
+    }
+
+    /*
+     * Run the stored callable. A task must be run exactly once, as heap-stored callables are released afterwards.
+     */
+    auto operator()() -> void
+    {
+        invoke_(storage_.data());
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<Task>);
+static_assert(sizeof(Task) == 64);
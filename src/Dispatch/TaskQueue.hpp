@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Task.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+
+/*
+ * Bounded lock-free multi-producer, multi-consumer task queue.
+ * Used as the inbox through which threads outside of a pool hand tasks to a worker, and from which idle workers steal.
+ *
+ * Based on Dmitry Vyukov's bounded MPMC queue: every cell carries a sequence number which tells producers and consumers
+ * whether the cell is free for the current lap of the ring.
+ */
+class TaskQueue
+{
+private:
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        Task task;
+    };
+
+    size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> enqueue_position_;
+    alignas(64) std::atomic<size_t> dequeue_position_;
+
+public:
+
+    explicit TaskQueue(size_t capacity = 256)
+        : mask_(std::bit_ceil(capacity) - 1)
+        , cells_(new Cell[mask_ + 1])
+        , enqueue_position_(0)
+        , dequeue_position_(0)
+    {
+        for (size_t i = 0; i <= mask_; ++i)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    TaskQueue(TaskQueue const&) = delete;
+    TaskQueue& operator=(TaskQueue const&) = delete;
+
+    /*
+     * Append a task, returning false if the queue is full.
+     */
+    auto TryPush(Task const& task) -> bool
+    {
+        size_t position = enqueue_position_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = cells_[position & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+            if (difference == 0)
+            {
+                if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.task = task;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /*
+     * Remove the oldest task, returning false if the queue is empty.
+     */
+    auto TryPop(Task& task) -> bool
+    {
+        size_t position = dequeue_position_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = cells_[position & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+            if (difference == 0)
+            {
+                if (dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    task = cell.task;
+                    cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = dequeue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /*
+     * Approximate number of tasks in the queue.
+     */
+    auto Size() const -> size_t
+    {
+        size_t enqueued = enqueue_position_.load(std::memory_order_relaxed);
+        size_t dequeued = dequeue_position_.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+};
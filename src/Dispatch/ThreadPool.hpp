@@ -1,109 +1,353 @@
 #pragma once
 
+#include "Task.hpp"
+#include "TaskQueue.hpp"
+#include "ThreadPoolMetrics.hpp"
+#include "Topology.hpp"
+#include "WorkStealingDeque.hpp"
+
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
-#include <functional>
+#include <cstdint>
+#include <latch>
+#include <limits>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <stdexcept>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+/*
+ * Hint to the processor that the calling thread is busy-waiting.
+ */
+inline auto CpuRelax() -> void
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/*
+ * Work-stealing thread pool.
+ * Every worker owns a lock-free deque for tasks enqueued from inside the pool, and a lock-free inbox for tasks enqueued
+ * from outside of it. An idle worker first drains its own deque and inbox, then steals from the other workers, spins for
+ * a short while, and finally parks until new work arrives.
+ * Workers may be pinned to CPUs, see ThreadPoolOptions. Pinned workers know their NUMA node, and steal from workers on
+ * their own node before crossing to another one.
+ */
 class ThreadPool
 {
 private:
 
+    static constexpr size_t spin_count = 256;
+    static constexpr size_t any_worker = std::numeric_limits<size_t>::max();
+
+    struct Worker
+    {
+        WorkStealingDeque deque;
+        TaskQueue inbox;
+        WorkerPlacement placement;
+        // the other workers in the order to steal from them, nearest first
+        std::vector<size_t> victims;
+#if TENSOR_POOL_METRICS
+        TaskCounters counters;
+#endif
+    };
+
+    struct WorkerContext
+    {
+        ThreadPool* pool = nullptr;
+        size_t index = 0;
+#if TENSOR_POOL_METRICS
+        size_t depth = 0;
+#endif
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
     std::vector<std::thread> threads_;
-    std::queue<std::function<void()>> tasks_;
-    std::mutex queue_mutex_;
+    size_t nodes_;
+
+    std::atomic<bool> stop_;
+    std::atomic<size_t> unfinished_tasks_;
+    std::atomic<int64_t> queued_tasks_;
+    std::atomic<size_t> sleeping_workers_;
+    std::atomic<size_t> next_worker_;
+
+    std::mutex sleep_mutex_;
     std::condition_variable cv_;
+    std::mutex finished_mutex_;
     std::condition_variable cv_finished_;
-    bool stop_;
-    size_t unfinished_tasks_;
+
+#if TENSOR_POOL_METRICS
+    std::atomic<uint64_t> start_time_;
+    std::atomic<uint64_t> tasks_enqueued_;
+    std::atomic<int64_t> peak_queue_depth_;
+    std::atomic<uint64_t> waits_;
+    std::atomic<uint64_t> wait_ns_;
+    TaskCounters external_;
+#endif
 
 public:
 
     ThreadPool(size_t thread_count = std::max(std::thread::hardware_concurrency(), 1u))
-        : stop_(false)
+        : ThreadPool(ThreadPoolOptions{.threads = std::max<size_t>(thread_count, 1), .affinity = Affinity::None, .cpus = {}})
+    {}
+
+    explicit ThreadPool(ThreadPoolOptions const& options)
+        : nodes_(1)
+        , stop_(false)
         , unfinished_tasks_(0)
+        , queued_tasks_(0)
+        , sleeping_workers_(0)
+        , next_worker_(0)
+#if TENSOR_POOL_METRICS
+        , start_time_(MetricsClock())
+        , tasks_enqueued_(0)
+        , peak_queue_depth_(0)
+        , waits_(0)
+        , wait_ns_(0)
+#endif
     {
-        auto worker = [this]()
+        // only look up the topology when it matters, as that reads from the file system
+        bool detect = options.threads == 0 || options.affinity != Affinity::None;
+        std::vector<WorkerPlacement> placements = PlaceWorkers(options, detect ? DetectTopology() : CpuTopology{});
+        size_t thread_count = placements.size();
+
+        for (size_t i = 0; i < thread_count; ++i)
         {
-            while (true)
-            {
-                std::function<void()> task;
+            workers_.emplace_back(std::make_unique<Worker>());
+            workers_[i]->placement = placements[i];
+            nodes_ = std::max(nodes_, placements[i].node + 1);
+        }
 
+        for (size_t i = 0; i < thread_count; ++i)
+        {
+            for (bool same_node : {true, false})
+            {
+                for (size_t j = 1; j < thread_count; ++j)
                 {
-                    std::unique_lock<std::mutex> lock(this->queue_mutex_);
-
-                    // wait until a stop is requested or until there's a task to complete
-                    this->cv_.wait(lock, [this]
-                    {
-                        return this->stop_ || !this->tasks_.empty();
-                    });
-
-                    // if stopping and there are no tasks to complete, exit the loop
-                    if (this->stop_ && this->tasks_.empty())
+                    size_t victim = (i + j) % thread_count;
+                    if ((placements[victim].node == placements[i].node) == same_node)
                     {
-                        return;
+                        workers_[i]->victims.push_back(victim);
                     }
-
-                    // retrieve the next task from the queue
-                    task = std::move(this->tasks_.front());
-                    this->tasks_.pop();
                 }
+            }
+        }
 
-                // execute the task
-                task();
-
-                // upon task completion, update count of unfinished tasks
+        // start the worker threads, and wait for those to be pinned to have tried, so that WorkerCpu reports where the
+        // workers actually run
+        auto pinned = std::count_if(placements.begin(), placements.end(), [](WorkerPlacement const& placement)
+        {
+            return placement.cpu != AnyCpu;
+        });
+        std::latch pinning(pinned);
+        for (size_t i = 0; i < thread_count; ++i)
+        {
+            threads_.emplace_back([this, i, &pinning]()
+            {
+                WorkerPlacement& placement = workers_[i]->placement;
+                if (placement.cpu != AnyCpu)
                 {
-                    std::unique_lock<std::mutex> lock(this->queue_mutex_);
-                    --unfinished_tasks_;
-                    if (unfinished_tasks_ == 0)
+                    if (!PinCurrentThread(placement.cpu))
                     {
-                        cv_finished_.notify_all();
+                        placement.cpu = AnyCpu;
                     }
+                    pinning.count_down();
                 }
-            }
-        };
-
-        // start the worker threads
-        for (size_t i = 0; i < thread_count; ++i)
-        {
-            threads_.emplace_back(worker);
+                WorkerLoop(i);
+            });
         }
+        pinning.wait();
     }
 
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
     auto Threads() const
     {
         return threads_.size();
     }
 
+    /*
+     * Number of NUMA nodes the workers are spread over; 1 unless the workers are pinned.
+     */
+    auto Nodes() const -> size_t
+    {
+        return nodes_;
+    }
+
+    auto WorkerNode(size_t worker) const -> size_t
+    {
+        return workers_[worker]->placement.node;
+    }
+
+    /*
+     * The CPU a worker is pinned to, or AnyCpu if it was not placed on one or the operating system refused to pin it.
+     */
+    auto WorkerCpu(size_t worker) const -> size_t
+    {
+        return workers_[worker]->placement.cpu;
+    }
+
+    /*
+     * Whether the calling thread is one of this pool's workers.
+     */
+    auto IsWorkerThread() const -> bool
+    {
+        return CurrentWorker().pool == this;
+    }
+
     template <typename Function, typename... Arguments>
     void Enqueue(Function&& function, Arguments&&... args)
     {
+        Submit(Task::Create(std::forward<Function>(function), std::forward<Arguments>(args)...), any_worker);
+    }
+
+    /*
+     * Enqueue a task for a specific worker, such as the one on the NUMA node holding the memory it works on. The task
+     * goes through the worker's inbox, so an idle worker may still steal it rather than let it wait.
+     */
+    template <typename Function, typename... Arguments>
+    void EnqueueTo(size_t worker, Function&& function, Arguments&&... args)
+    {
+        Submit(Task::Create(std::forward<Function>(function), std::forward<Arguments>(args)...), worker % workers_.size());
+    }
+    /*
+     * Run one pending task on the calling thread, if there is any. A worker of this pool looks in its own queues first,
+     * any other thread steals from the workers. Returns whether a task was run.
+     */
+    auto TryRunPendingTask() -> bool
+    {
+        Task task;
+        WorkerContext& context = CurrentWorker();
+        bool found = context.pool == this ? FindTask(context.index, task) : StealTask(task);
+        if (found)
         {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
+            RunTask(task);
+        }
+        return found;
+    }
 
-            if (stop_)
+    /*
+     * Run pending tasks on the calling thread until `done()` holds.
+     * Meant for a worker which waits on work it enqueued itself: blocking would take the worker away from the very tasks
+     * it waits for, and with every worker waiting that way the pool would deadlock. Between tasks the waiter spins
+     * briefly, then yields to the threads running the rest of its work.
+     */
+    template <typename Predicate>
+    auto RunPendingTasksUntil(Predicate&& done) -> void
+    {
+        size_t idle = 0;
+        while (!done())
+        {
+            if (TryRunPendingTask())
             {
-                throw std::runtime_error("cannot enqueue on a stopped thread pool");
+                idle = 0;
+            }
+            else if (++idle < spin_count)
+            {
+                CpuRelax();
+            }
+            else
+            {
+                std::this_thread::yield();
             }
-
-            tasks_.emplace(std::bind(std::forward<Function>(function), std::forward<Arguments>(args)...));
-            ++unfinished_tasks_;
         }
-        cv_.notify_one();
     }
 
     void Wait()
     {
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        cv_finished_.wait(lock, [this]()
+#if TENSOR_POOL_METRICS
+        uint64_t start = MetricsClock();
+#endif
         {
-            return unfinished_tasks_ == 0;
-        });
+            std::unique_lock<std::mutex> lock(finished_mutex_);
+            cv_finished_.wait(lock, [this]()
+            {
+                return unfinished_tasks_.load(std::memory_order_acquire) == 0;
+            });
+        }
+#if TENSOR_POOL_METRICS
+        RecordWait(MetricsClock() - start);
+#endif
+    }
+
+    /*
+     * Account for a thread having waited on work of this pool for the given time.
+     */
+    auto RecordWait([[maybe_unused]] uint64_t nanoseconds) -> void
+    {
+#if TENSOR_POOL_METRICS
+        waits_.fetch_add(1, std::memory_order_relaxed);
+        wait_ns_.fetch_add(nanoseconds, std::memory_order_relaxed);
+#endif
+    }
+
+    /*
+     * Snapshot of the metrics collected since construction or the last ResetMetrics. Only the queue depth is known when
+     * metrics are compiled out.
+     */
+    auto Metrics() const -> ThreadPoolMetrics
+    {
+        ThreadPoolMetrics metrics;
+        metrics.queue_depth = static_cast<uint64_t>(std::max<int64_t>(queued_tasks_.load(std::memory_order_relaxed), 0));
+#if TENSOR_POOL_METRICS
+        metrics.enabled = true;
+        metrics.elapsed_ns = MetricsClock() - start_time_.load(std::memory_order_relaxed);
+        metrics.tasks_enqueued = tasks_enqueued_.load(std::memory_order_relaxed);
+        metrics.peak_queue_depth = static_cast<uint64_t>(peak_queue_depth_.load(std::memory_order_relaxed));
+        metrics.waits = waits_.load(std::memory_order_relaxed);
+        metrics.wait_ns = wait_ns_.load(std::memory_order_relaxed);
+
+        auto collect = [&](TaskCounters const& counters) -> uint64_t
+        {
+            for (size_t i = 0; i < LatencyHistogram::bucket_count; ++i)
+            {
+                metrics.latency.buckets[i] += counters.latency[i].load(std::memory_order_relaxed);
+            }
+            uint64_t tasks = counters.tasks.load(std::memory_order_relaxed);
+            metrics.tasks_completed += tasks;
+            return tasks;
+        };
+
+        for (auto const& worker : workers_)
+        {
+            ThreadPoolMetrics::Worker& snapshot = metrics.workers.emplace_back();
+            snapshot.tasks = collect(worker->counters);
+            snapshot.busy_ns = std::min(worker->counters.busy_ns.load(std::memory_order_relaxed), metrics.elapsed_ns);
+            snapshot.idle_ns = metrics.elapsed_ns - snapshot.busy_ns;
+        }
+        metrics.external_tasks = collect(external_);
+#endif
+        return metrics;
+    }
+
+    /*
+     * Restart collecting metrics from zero. Tasks running meanwhile may be counted in either period.
+     */
+    auto ResetMetrics() -> void
+    {
+#if TENSOR_POOL_METRICS
+        start_time_.store(MetricsClock(), std::memory_order_relaxed);
+        tasks_enqueued_.store(0, std::memory_order_relaxed);
+        peak_queue_depth_.store(0, std::memory_order_relaxed);
+        waits_.store(0, std::memory_order_relaxed);
+        wait_ns_.store(0, std::memory_order_relaxed);
+        for (auto& worker : workers_)
+        {
+            worker->counters.Reset();
+        }
+        external_.Reset();
+#endif
     }
 
     ~ThreadPool()
@@ -114,8 +358,8 @@ public:
     void Shutdown()
     {
         {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            stop_ = true;
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            stop_.store(true, std::memory_order_release);
         }
         cv_.notify_all();
 
@@ -127,4 +371,197 @@ public:
             }
         }
     }
+
+private:
+
+    static auto CurrentWorker() -> WorkerContext&
+    {
+        static thread_local WorkerContext context;
+        return context;
+    }
+
+    auto Submit(Task task, size_t target) -> void
+    {
+        if (stop_.load(std::memory_order_acquire))
+        {
+            throw std::runtime_error("cannot enqueue on a stopped thread pool");
+        }
+
+        unfinished_tasks_.fetch_add(1, std::memory_order_relaxed);
+#if TENSOR_POOL_METRICS
+        task.SetEnqueueTime(MetricsClock());
+        tasks_enqueued_.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+        WorkerContext& context = CurrentWorker();
+        if (target != any_worker)
+        {
+            if (!workers_[target]->inbox.TryPush(task))
+            {
+                PushToInbox(task);
+            }
+        }
+        else if (context.pool == this)
+        {
+            // enqueued from one of our own workers, keep the task local so it stays cache-hot
+            workers_[context.index]->deque.Push(task);
+        }
+        else
+        {
+            PushToInbox(task);
+        }
+
+        int64_t queue_depth = queued_tasks_.fetch_add(1, std::memory_order_seq_cst) + 1;
+#if TENSOR_POOL_METRICS
+        int64_t peak = peak_queue_depth_.load(std::memory_order_relaxed);
+        while (queue_depth > peak && !peak_queue_depth_.compare_exchange_weak(peak, queue_depth, std::memory_order_relaxed))
+        {
+        }
+#else
+        static_cast<void>(queue_depth);
+#endif
+        if (sleeping_workers_.load(std::memory_order_seq_cst) > 0)
+        {
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            cv_.notify_one();
+        }
+    }
+
+    auto PushToInbox(Task const& task) -> void
+    {
+        size_t worker_count = workers_.size();
+        size_t start = next_worker_.fetch_add(1, std::memory_order_relaxed);
+
+        // distribute round-robin, skipping over full inboxes
+        while (true)
+        {
+            for (size_t i = 0; i < worker_count; ++i)
+            {
+                if (workers_[(start + i) % worker_count]->inbox.TryPush(task))
+                {
+                    return;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    auto FindTask(size_t index, Task& task) -> bool
+    {
+        Worker& self = *workers_[index];
+        if (self.deque.Pop(task) || self.inbox.TryPop(task))
+        {
+            return true;
+        }
+
+        for (size_t victim_index : self.victims)
+        {
+            Worker& victim = *workers_[victim_index];
+            if (victim.deque.Steal(task) || victim.inbox.TryPop(task))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto StealTask(Task& task) -> bool
+    {
+        for (auto& victim : workers_)
+        {
+            if (victim->deque.Steal(task) || victim->inbox.TryPop(task))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto RunTask(Task& task) -> void
+    {
+        queued_tasks_.fetch_sub(1, std::memory_order_relaxed);
+
+#if TENSOR_POOL_METRICS
+        uint64_t start = MetricsClock();
+        WorkerContext& context = CurrentWorker();
+        TaskCounters& counters = context.pool == this ? workers_[context.index]->counters : external_;
+        counters.latency[LatencyHistogram::Bucket(start - task.EnqueueTime())].fetch_add(1, std::memory_order_relaxed);
+        ++context.depth;
+#endif
+
+        // execute the task
+        task();
+
+#if TENSOR_POOL_METRICS
+        // tasks run by a waiting task take up part of its own time, so only the outermost one counts as busy time
+        if (--context.depth == 0)
+        {
+            counters.busy_ns.fetch_add(MetricsClock() - start, std::memory_order_relaxed);
+        }
+        counters.tasks.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+        // upon task completion, update count of unfinished tasks
+        if (unfinished_tasks_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            std::unique_lock<std::mutex> lock(finished_mutex_);
+            cv_finished_.notify_all();
+        }
+    }
+
+    auto WorkerLoop(size_t index) -> void
+    {
+        WorkerContext& context = CurrentWorker();
+        context.pool = this;
+        context.index = index;
+
+        Task task;
+        while (true)
+        {
+            // spin briefly before parking, as new work tends to arrive in bursts
+            bool found = false;
+            for (size_t spin = 0; spin < spin_count && !found; ++spin)
+            {
+                found = FindTask(index, task);
+                if (!found)
+                {
+                    if (stop_.load(std::memory_order_acquire))
+                    {
+                        break;
+                    }
+                    CpuRelax();
+                }
+            }
+
+            if (found)
+            {
+                RunTask(task);
+                continue;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(sleep_mutex_);
+                sleeping_workers_.fetch_add(1, std::memory_order_seq_cst);
+
+                // wait until a stop is requested or until there's a task to complete
+                cv_.wait(lock, [this]()
+                {
+                    return stop_.load(std::memory_order_acquire) || queued_tasks_.load(std::memory_order_seq_cst) > 0;
+                });
+                sleeping_workers_.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            // if stopping and there are no tasks to complete, exit the loop
+            if (stop_.load(std::memory_order_acquire) && queued_tasks_.load(std::memory_order_acquire) <= 0)
+            {
+                if (FindTask(index, task))
+                {
+                    RunTask(task);
+                    continue;
+                }
+                context.pool = nullptr;
+                return;
+            }
+        }
+    }
 };
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Thread pool metrics are compiled in when TENSOR_POOL_METRICS is defined to 1. They cost a few clock reads and
+ * uncontended atomic increments per task, which is small next to real work but noticeable on empty tasks, so they are
+ * left out by default.
+ */
+#ifndef TENSOR_POOL_METRICS
+#define TENSOR_POOL_METRICS 0
+#endif
+
+/*
+ * Nanoseconds on the steady clock.
+ */
+inline auto MetricsClock() -> uint64_t
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/*
+ * Histogram of durations in nanoseconds, with power of two buckets: bucket 0 counts durations below 2ns, and bucket i
+ * those in [2^i, 2^(i+1)) ns. The last bucket also counts everything longer.
+ */
+struct LatencyHistogram
+{
+    static constexpr size_t bucket_count = 40;
+
+    std::array<uint64_t, bucket_count> buckets{};
+
+    static auto Bucket(uint64_t nanoseconds) -> size_t
+    {
+        size_t bucket = nanoseconds > 1 ? std::bit_width(nanoseconds) - 1 : 0;
+        return bucket < bucket_count ? bucket : bucket_count - 1;
+    }
+
+    auto Count() const -> uint64_t
+    {
+        uint64_t count = 0;
+        for (uint64_t bucket : buckets)
+        {
+            count += bucket;
+        }
+        return count;
+    }
+
+    /*
+     * Upper bound of the bucket holding the given quantile, in nanoseconds; 0 if the histogram is empty.
+     */
+    auto Quantile(double quantile) const -> uint64_t
+    {
+        uint64_t count = Count();
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(count - 1));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucket_count; ++i)
+        {
+            seen += buckets[i];
+            if (seen > rank)
+            {
+                return uint64_t{2} << i;
+            }
+        }
+        return uint64_t{2} << (bucket_count - 1);
+    }
+};
+
+/*
+ * Snapshot of a thread pool's metrics, from its construction or its last ResetMetrics.
+ */
+struct ThreadPoolMetrics
+{
+    struct Worker
+    {
+        uint64_t tasks = 0;
+        uint64_t busy_ns = 0;
+        uint64_t idle_ns = 0;
+    };
+
+    bool enabled = false;
+    uint64_t elapsed_ns = 0;
+
+    uint64_t tasks_enqueued = 0;
+    uint64_t tasks_completed = 0;
+    uint64_t queue_depth = 0;
+    uint64_t peak_queue_depth = 0;
+
+    // time from enqueueing a task to it starting to run
+    LatencyHistogram latency;
+
+    // threads blocked in Wait, on the pool or on a dispatch
+    uint64_t waits = 0;
+    uint64_t wait_ns = 0;
+
+    // tasks run by threads outside of the pool while they wait
+    uint64_t external_tasks = 0;
+
+    std::vector<Worker> workers;
+
+    /*
+     * Fraction of the workers' time spent running tasks.
+     */
+    auto Utilization() const -> double
+    {
+        uint64_t busy = 0;
+        uint64_t total = 0;
+        for (Worker const& worker : workers)
+        {
+            busy += worker.busy_ns;
+            total += worker.busy_ns + worker.idle_ns;
+        }
+        return total > 0 ? static_cast<double>(busy) / static_cast<double>(total) : 0.0;
+    }
+
+    auto ToJson() const -> std::string
+    {
+        std::ostringstream json;
+        json << "{\"enabled\": " << (enabled ? "true" : "false")
+             << ", \"elapsed_ns\": " << elapsed_ns
+             << ", \"tasks_enqueued\": " << tasks_enqueued
+             << ", \"tasks_completed\": " << tasks_completed
+             << ", \"queue_depth\": " << queue_depth
+             << ", \"peak_queue_depth\": " << peak_queue_depth
+             << ", \"latency_ns\": {\"p50\": " << latency.Quantile(0.5)
+             << ", \"p90\": " << latency.Quantile(0.9)
+             << ", \"p99\": " << latency.Quantile(0.99)
+             << ", \"buckets\": [";
+        for (size_t i = 0; i < LatencyHistogram::bucket_count; ++i)
+        {
+            json << (i ? ", " : "") << latency.buckets[i];
+        }
+        json << "]}, \"waits\": " << waits
+             << ", \"wait_ns\": " << wait_ns
+             << ", \"external_tasks\": " << external_tasks
+             << ", \"utilization\": " << Utilization()
+             << ", \"workers\": [";
+        for (size_t i = 0; i < workers.size(); ++i)
+        {
+            json << (i ? ", " : "") << "{\"tasks\": " << workers[i].tasks << ", \"busy_ns\": " << workers[i].busy_ns
+                 << ", \"idle_ns\": " << workers[i].idle_ns << "}";
+        }
+        json << "]}";
+        return json.str();
+    }
+};
+
+/*
+ * Live counters of the tasks run by one thread. Each worker has its own, so they are only contended by snapshots.
+ */
+struct alignas(64) TaskCounters
+{
+    std::atomic<uint64_t> tasks = 0;
+    std::atomic<uint64_t> busy_ns = 0;
+    std::array<std::atomic<uint64_t>, LatencyHistogram::bucket_count> latency{};
+
+    auto Reset() -> void
+    {
+        tasks.store(0, std::memory_order_relaxed);
+        busy_ns.store(0, std::memory_order_relaxed);
+        for (auto& bucket : latency)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+};
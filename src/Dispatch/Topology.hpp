@@ -0,0 +1,274 @@
+#pragma once
+
+#include <Expect.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/*
+ * Marks a worker which is not pinned to any CPU.
+ */
+inline constexpr size_t AnyCpu = std::numeric_limits<size_t>::max();
+
+/*
+ * The CPUs this process may run on, grouped by NUMA node.
+ */
+struct CpuTopology
+{
+    std::vector<std::vector<size_t>> nodes;
+
+    auto Cpus() const -> size_t
+    {
+        size_t cpus = 0;
+        for (auto const& node : nodes)
+        {
+            cpus += node.size();
+        }
+        return cpus;
+    }
+
+    /*
+     * The node holding the given CPU, or node 0 if it is unknown.
+     */
+    auto NodeOf(size_t cpu) const -> size_t
+    {
+        for (size_t node = 0; node < nodes.size(); ++node)
+        {
+            if (std::find(nodes[node].begin(), nodes[node].end(), cpu) != nodes[node].end())
+            {
+                return node;
+            }
+        }
+        return 0;
+    }
+};
+
+/*
+ * Parse a Linux CPU list such as "0-3,8,10-11".
+ */
+inline auto ParseCpuList(std::string const& list) -> std::vector<size_t>
+{
+    std::vector<size_t> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        range.erase(std::remove_if(range.begin(), range.end(), [](char c) { return c == ' ' || c == '\n'; }), range.end());
+        if (range.empty())
+        {
+            continue;
+        }
+
+        size_t dash = range.find('-');
+        size_t first = std::stoul(range.substr(0, dash));
+        size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+        for (size_t cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+/*
+ * Detect the NUMA nodes and the CPUs of each which this process is allowed to run on. Systems without NUMA information
+ * report a single node holding every CPU.
+ */
+inline auto DetectTopology() -> CpuTopology
+{
+    CpuTopology topology;
+
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool restricted = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    auto is_allowed = [&](size_t cpu)
+    {
+        return !restricted || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed));
+    };
+
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string node_list;
+    if (online && std::getline(online, node_list))
+    {
+        for (size_t node : ParseCpuList(node_list))
+        {
+            std::ifstream cpu_list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            std::string list;
+            std::vector<size_t> cpus;
+            if (cpu_list && std::getline(cpu_list, list))
+            {
+                for (size_t cpu : ParseCpuList(list))
+                {
+                    if (is_allowed(cpu))
+                    {
+                        cpus.push_back(cpu);
+                    }
+                }
+            }
+            if (!cpus.empty())
+            {
+                topology.nodes.push_back(std::move(cpus));
+            }
+        }
+    }
+
+    if (topology.nodes.empty() && restricted)
+    {
+        std::vector<size_t> cpus;
+        for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        if (!cpus.empty())
+        {
+            topology.nodes.push_back(std::move(cpus));
+        }
+    }
+#endif
+
+    if (topology.nodes.empty())
+    {
+        std::vector<size_t> cpus(std::max(std::thread::hardware_concurrency(), 1u));
+        for (size_t cpu = 0; cpu < cpus.size(); ++cpu)
+        {
+            cpus[cpu] = cpu;
+        }
+        topology.nodes.push_back(std::move(cpus));
+    }
+    return topology;
+}
+
+/*
+ * Pin the calling thread to a single CPU. Returns false where pinning is not supported or was refused.
+ */
+inline auto PinCurrentThread(size_t cpu) -> bool
+{
+#if defined(_WIN32)
+    if (cpu >= sizeof(DWORD_PTR) * 8)
+    {
+        return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << cpu) != 0;
+#elif defined(__linux__)
+    if (cpu >= CPU_SETSIZE)
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    static_cast<void>(cpu);
+    return false;
+#endif
+}
+
+/*
+ * How the workers of a thread pool are pinned to CPUs.
+ * None leaves placement to the operating system. Compact fills the CPUs of one node before moving on to the next, which
+ * keeps workers sharing caches close together. Scatter deals workers out to the nodes in turn, which spreads memory
+ * bandwidth across all of them. Explicit pins worker i to the i-th of the given CPUs. Workers beyond the number of CPUs
+ * wrap around.
+ */
+enum class Affinity
+{
+    None,
+    Compact,
+    Scatter,
+    Explicit,
+};
+
+struct ThreadPoolOptions
+{
+    // number of workers; 0 starts one per CPU the process may run on
+    size_t threads = 0;
+    Affinity affinity = Affinity::None;
+    // the CPUs for Affinity::Explicit
+    std::vector<size_t> cpus;
+};
+
+/*
+ * Where one worker runs: the CPU it is pinned to, or AnyCpu, and the NUMA node it belongs to.
+ */
+struct WorkerPlacement
+{
+    size_t cpu = AnyCpu;
+    size_t node = 0;
+};
+
+/*
+ * Place the workers of a pool with the given options on the given topology. Unpinned workers all belong to node 0.
+ */
+inline auto PlaceWorkers(ThreadPoolOptions const& options, CpuTopology const& topology) -> std::vector<WorkerPlacement>
+{
+    Expect(options.affinity != Affinity::Explicit || !options.cpus.empty(), "explicit affinity needs at least one CPU");
+
+    size_t threads = options.threads > 0 ? options.threads : std::max<size_t>(topology.Cpus(), 1);
+    std::vector<WorkerPlacement> placements(threads);
+
+    switch (options.affinity)
+    {
+    case Affinity::None:
+        break;
+    case Affinity::Compact:
+    {
+        std::vector<size_t> order;
+        for (auto const& node : topology.nodes)
+        {
+            order.insert(order.end(), node.begin(), node.end());
+        }
+        for (size_t i = 0; i < threads && !order.empty(); ++i)
+        {
+            placements[i].cpu = order[i % order.size()];
+            placements[i].node = topology.NodeOf(placements[i].cpu);
+        }
+        break;
+    }
+    case Affinity::Scatter:
+    {
+        std::vector<size_t> taken(topology.nodes.size(), 0);
+        for (size_t i = 0; i < threads && !topology.nodes.empty(); ++i)
+        {
+            size_t node = i % topology.nodes.size();
+            auto const& cpus = topology.nodes[node];
+            placements[i].cpu = cpus[taken[node]++ % cpus.size()];
+            placements[i].node = node;
+        }
+        break;
+    }
+    case Affinity::Explicit:
+    {
+        for (size_t i = 0; i < threads; ++i)
+        {
+            placements[i].cpu = options.cpus[i % options.cpus.size()];
+            placements[i].node = topology.NodeOf(placements[i].cpu);
+        }
+        break;
+    }
+    }
+    return placements;
+}
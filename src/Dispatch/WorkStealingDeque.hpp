@@ -0,0 +1,204 @@
+#pragma once
+
+#include "Task.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+ * Fixed-size slot holding one Task as a sequence of atomic words.
+ * Lets a thief read a slot while the owner may be reusing it without a data race; a torn read is always discarded by
+ * the caller, as it only happens when the thief loses the race for the slot.
+ */
+class TaskSlot
+{
+private:
+
+    static constexpr size_t word_count = sizeof(Task) / sizeof(std::uintptr_t);
+    using Words = std::array<std::uintptr_t, word_count>;
+
+    std::array<std::atomic<std::uintptr_t>, word_count> words_;
+
+public:
+
+    auto Store(Task const& task) -> void
+    {
+        Words words = std::bit_cast<Words>(task);
+        for (size_t i = 0; i < word_count; ++i)
+        {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    auto Load() const -> Task
+    {
+        Words words;
+        for (size_t i = 0; i < word_count; ++i)
+        {
+            words[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        return std::bit_cast<Task>(words);
+    }
+};
+
+/*
+ * Lock-free Chase-Lev work-stealing deque.
+ * The owning worker pushes and pops tasks at the bottom, while any other thread may steal from the top. The buffer
+ * grows on demand; retired buffers are kept until destruction, as a concurrent thief may still be reading them.
+ *
+ * Based on "Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop, Cohen, Zappa Nardelli, 2013).
+ */
+class WorkStealingDeque
+{
+private:
+
+    class Buffer
+    {
+    private:
+
+        size_t capacity_;
+        std::unique_ptr<TaskSlot[]> slots_;
+
+    public:
+
+        explicit Buffer(size_t capacity)
+            : capacity_(capacity)
+            , slots_(new TaskSlot[capacity])
+        {}
+
+        auto Capacity() const -> size_t
+        {
+            return capacity_;
+        }
+
+        auto Store(int64_t index, Task const& task) -> void
+        {
+            slots_[static_cast<size_t>(index) & (capacity_ - 1)].Store(task);
+        }
+
+        auto Load(int64_t index) const -> Task
+        {
+            return slots_[static_cast<size_t>(index) & (capacity_ - 1)].Load();
+        }
+    };
+
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+    std::atomic<Buffer*> buffer_;
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+
+public:
+
+    explicit WorkStealingDeque(size_t capacity = 256)
+        : top_(0)
+        , bottom_(0)
+    {
+        buffers_.emplace_back(std::make_unique<Buffer>(std::bit_ceil(capacity)));
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(WorkStealingDeque const&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque const&) = delete;
+
+    /*
+     * Push a task onto the bottom of the deque. Owner only.
+     */
+    auto Push(Task const& task) -> void
+    {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+
+        if (bottom - top > static_cast<int64_t>(buffer->Capacity()) - 1)
+        {
+            buffer = Grow(buffer, top, bottom);
+        }
+
+        buffer->Store(bottom, task);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    /*
+     * Pop a task from the bottom of the deque. Owner only.
+     */
+    auto Pop(Task& task) -> bool
+    {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            // empty, restore the bottom
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        task = buffer->Load(bottom);
+        if (top == bottom)
+        {
+            // last task, race against thieves for it
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /*
+     * Steal a task from the top of the deque. Any thread.
+     * May fail spuriously when racing with another thief or the owner.
+     */
+    auto Steal(Task& task) -> bool
+    {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+        {
+            return false;
+        }
+
+        Buffer* buffer = buffer_.load(std::memory_order_acquire);
+        Task stolen = buffer->Load(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return false;
+        }
+        task = stolen;
+        return true;
+    }
+
+    /*
+     * Approximate number of tasks in the deque.
+     */
+    auto Size() const -> size_t
+    {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+
+private:
+
+    auto Grow(Buffer* buffer, int64_t top, int64_t bottom) -> Buffer*
+    {
+        auto grown = std::make_unique<Buffer>(buffer->Capacity() * 2);
+        for (int64_t i = top; i < bottom; ++i)
+        {
+            grown->Store(i, buffer->Load(i));
+        }
+        Buffer* result = grown.get();
+        buffers_.emplace_back(std::move(grown));
+        buffer_.store(result, std::memory_order_release);
+        return result;
+    }
+};
@@ -3,11 +3,33 @@
 #include <stdexcept>
 #include <string>
 
+/*
+ * Throw an exception with the given message. Kept apart from Expect, so that a check which holds is only a branch.
+ */
 template <typename Exception = std::runtime_error>
-auto Expect(bool assertion, std::string const& message = "internal error") -> void
+[[noreturn]] auto ThrowExpectation(char const* message) -> void
 {
-    if (!assertion)
+    throw Exception(message);
+}
+
+/*
+ * Check an assertion, throwing an Exception with the given message if it does not hold. A literal message is passed
+ * as a pointer, so a check that holds never builds a string.
+ */
+template <typename Exception = std::runtime_error>
+auto Expect(bool assertion, char const* message = "internal error") -> void
+{
+    if (!assertion) [[unlikely]]
+    {
+        ThrowExpectation<Exception>(message);
+    }
+}
+
+template <typename Exception = std::runtime_error>
+auto Expect(bool assertion, std::string const& message) -> void
+{
+    if (!assertion) [[unlikely]]
     {
-        throw Exception(message);
+        ThrowExpectation<Exception>(message.c_str());
     }
 }
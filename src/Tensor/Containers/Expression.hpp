@@ -0,0 +1,595 @@
+#pragma once
+
+#include "../Simd/Elementwise.hpp"
+#include "../Utilities/Copy.hpp"
+#include "../Utilities/Layout.hpp"
+#include "../Utilities/Operations.hpp"
+#include "../Utilities/Shape.hpp"
+#include "Forward.hpp"
+#include "Traits.hpp"
+
+#include <Dispatch.hpp>
+#include <Expect.hpp>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+template <typename T, size_t Order>
+class TerminalExpression;
+
+template <typename T>
+class ScalarExpression;
+
+template <typename Operation, typename Operand>
+class UnaryExpression;
+
+template <typename Operation, typename Left, typename Right>
+class BinaryExpression;
+
+template <typename T, size_t Order>
+struct TensorTraits<TerminalExpression<T, Order>>
+{
+    using value_type = T;
+    static constexpr size_t order = Order;
+    static constexpr bool has_offset = false;
+};
+
+template <typename T>
+struct TensorTraits<ScalarExpression<T>>
+{
+    using value_type = T;
+    static constexpr size_t order = 0;
+    static constexpr bool has_offset = false;
+};
+
+template <typename Operation, typename Operand>
+struct TensorTraits<UnaryExpression<Operation, Operand>>
+{
+    using value_type = std::invoke_result_t<Operation, typename TensorTraits<Operand>::value_type>;
+    static constexpr size_t order = TensorTraits<Operand>::order;
+    static constexpr bool has_offset = false;
+};
+
+template <typename Operation, typename Left, typename Right>
+struct TensorTraits<BinaryExpression<Operation, Left, Right>>
+{
+    using value_type = std::common_type_t<typename TensorTraits<Left>::value_type, typename TensorTraits<Right>::value_type>;
+    static constexpr size_t order = std::max(TensorTraits<Left>::order, TensorTraits<Right>::order);
+    static constexpr bool has_offset = false;
+};
+
+/*
+ * Any type with TensorTraits, i.e. a Tensor, a View, or a lazily evaluated expression over them.
+ */
+template <typename T>
+concept TensorLike = requires
+{
+    TensorTraits<std::remove_cvref_t<T>>::order;
+};
+
+/*
+ * An unevaluated expression node, as opposed to a container which holds or refers to elements.
+ */
+template <typename T>
+concept ExpressionNode = TensorLike<T> && std::remove_cvref_t<T>::is_expression;
+
+/*
+ * A scalar which can be combined with a tensor expression, and is broadcast to every element.
+ */
+template <typename T>
+concept ExpressionScalar = std::is_arithmetic_v<std::remove_cvref_t<T>> || IsHalfType<std::remove_cvref_t<T>>;
+
+/*
+ * Leaf of an expression, referring to the elements of a Tensor or View.
+ * Only the origin pointer, shape and strides are kept, so a leaf must not outlive the container it was created from.
+ */
+template <typename T, size_t Order>
+class TerminalExpression
+{
+private:
+
+    T const* mOrigin;
+    std::array<size_t, Order> mShape;
+    std::array<size_t, Order> mStrides;
+    bool mContiguous;
+
+public:
+
+    static constexpr bool is_expression = true;
+
+    TerminalExpression(T const* origin, std::array<size_t, Order> const& shape, std::array<size_t, Order> const& strides)
+        : mOrigin(origin)
+        , mShape(shape)
+        , mStrides(strides)
+        , mContiguous(::IsContiguous(shape, strides))
+    {}
+
+    auto Shape() const -> std::array<size_t, Order>
+    {
+        return mShape;
+    }
+
+    auto IsContiguous() const -> bool
+    {
+        return mContiguous;
+    }
+
+    auto operator()(std::array<size_t, Order> const& indices) const -> T
+    {
+        size_t index = 0;
+        for (size_t i = 0; i < Order; ++i)
+        {
+            index += indices[i] * mStrides[i];
+        }
+        return mOrigin[index];
+    }
+
+    /*
+     * Element at the given position in row-major order. Only valid for contiguous expressions.
+     */
+    auto Linear(size_t index) const -> T
+    {
+        return mOrigin[index];
+    }
+
+    auto Origin() const -> T const*
+    {
+        return mOrigin;
+    }
+
+    auto Strides() const -> std::array<size_t, Order>
+    {
+        return mStrides;
+    }
+};
+
+/*
+ * Leaf of an expression holding a single value, broadcast to every element.
+ */
+template <typename T>
+class ScalarExpression
+{
+private:
+
+    T mValue;
+
+public:
+
+    static constexpr bool is_expression = true;
+
+    explicit ScalarExpression(T value)
+        : mValue(value)
+    {}
+
+    auto Shape() const -> std::array<size_t, 0>
+    {
+        return {};
+    }
+
+    auto IsContiguous() const -> bool
+    {
+        return true;
+    }
+
+    template <size_t Order>
+    auto operator()(std::array<size_t, Order> const&) const -> T
+    {
+        return mValue;
+    }
+
+    auto Linear(size_t) const -> T
+    {
+        return mValue;
+    }
+
+    auto Value() const -> T
+    {
+        return mValue;
+    }
+};
+
+/*
+ * Expression applying an operation to every element of its operand.
+ */
+template <typename Operation, typename OperandType>
+class UnaryExpression
+{
+private:
+
+    OperandType mOperand;
+
+public:
+
+    static constexpr bool is_expression = true;
+
+    using value_type = TensorTraits<UnaryExpression>::value_type;
+    static constexpr size_t order = TensorTraits<UnaryExpression>::order;
+
+    explicit UnaryExpression(OperandType const& operand)
+        : mOperand(operand)
+    {}
+
+    auto Shape() const -> std::array<size_t, order>
+    {
+        return mOperand.Shape();
+    }
+
+    auto IsContiguous() const -> bool
+    {
+        return mOperand.IsContiguous();
+    }
+
+    auto operator()(std::array<size_t, order> const& indices) const -> value_type
+    {
+        return Operation{}(mOperand(indices));
+    }
+
+    auto Linear(size_t index) const -> value_type
+    {
+        return Operation{}(mOperand.Linear(index));
+    }
+
+    auto Operand() const -> OperandType const&
+    {
+        return mOperand;
+    }
+};
+
+/*
+ * Expression combining the elements of its two operands at equal positions. Either operand may be a scalar; otherwise
+ * both have the same shape, as operands of different shapes are broadcast to a common one when the expression is made.
+ */
+template <typename Operation, typename LeftType, typename RightType>
+class BinaryExpression
+{
+public:
+
+    static constexpr bool is_expression = true;
+
+    using value_type = TensorTraits<BinaryExpression>::value_type;
+    static constexpr size_t order = TensorTraits<BinaryExpression>::order;
+
+private:
+
+    LeftType mLeft;
+    RightType mRight;
+    std::array<size_t, order> mShape;
+
+public:
+
+    BinaryExpression(LeftType const& left, RightType const& right)
+        : mLeft(left)
+        , mRight(right)
+    {
+        if constexpr (TensorTraits<LeftType>::order == 0)
+        {
+            mShape = right.Shape();
+        }
+        else if constexpr (TensorTraits<RightType>::order == 0)
+        {
+            mShape = left.Shape();
+        }
+        else
+        {
+            Expect(left.Shape() == right.Shape(), "expression operands must have the same shape");
+            mShape = left.Shape();
+        }
+    }
+
+    auto Shape() const -> std::array<size_t, order>
+    {
+        return mShape;
+    }
+
+    auto IsContiguous() const -> bool
+    {
+        return mLeft.IsContiguous() && mRight.IsContiguous();
+    }
+
+    auto operator()(std::array<size_t, order> const& indices) const -> value_type
+    {
+        return Operation{}(static_cast<value_type>(mLeft(indices)), static_cast<value_type>(mRight(indices)));
+    }
+
+    auto Linear(size_t index) const -> value_type
+    {
+        return Operation{}(static_cast<value_type>(mLeft.Linear(index)), static_cast<value_type>(mRight.Linear(index)));
+    }
+
+    auto Left() const -> LeftType const&
+    {
+        return mLeft;
+    }
+
+    auto Right() const -> RightType const&
+    {
+        return mRight;
+    }
+};
+
+/*
+ * Wrap a Tensor or View in a leaf expression; expression nodes are returned as they are.
+ */
+template <TensorLike T>
+auto MakeExpression(T const& operand)
+{
+    if constexpr (ExpressionNode<T>)
+    {
+        return operand;
+    }
+    else
+    {
+        using value_type = TensorTraits<T>::value_type;
+        static constexpr size_t order = TensorTraits<T>::order;
+        return TerminalExpression<std::remove_const_t<value_type>, order>(Origin(operand), operand.Shape(), operand.Strides());
+    }
+}
+
+/*
+ * Rebuild an expression so that it has the given shape, which its own shape must broadcast to. Only the leaves change:
+ * each terminal is given strides of 0 along its broadcast dimensions, so the elements are repeated without being
+ * copied, and an expression which already has the shape is rebuilt unchanged.
+ */
+template <typename T, size_t Order, size_t TargetOrder>
+auto BroadcastExpression(TerminalExpression<T, Order> const& expression, std::array<size_t, TargetOrder> const& shape) -> TerminalExpression<T, TargetOrder>;
+
+template <typename T, size_t TargetOrder>
+auto BroadcastExpression(ScalarExpression<T> const& expression, std::array<size_t, TargetOrder> const& shape) -> ScalarExpression<T>;
+
+template <typename Operation, typename Operand, size_t TargetOrder>
+auto BroadcastExpression(UnaryExpression<Operation, Operand> const& expression, std::array<size_t, TargetOrder> const& shape);
+
+template <typename Operation, typename Left, typename Right, size_t TargetOrder>
+auto BroadcastExpression(BinaryExpression<Operation, Left, Right> const& expression, std::array<size_t, TargetOrder> const& shape);
+
+template <typename T, size_t Order, size_t TargetOrder>
+auto BroadcastExpression(TerminalExpression<T, Order> const& expression, std::array<size_t, TargetOrder> const& shape) -> TerminalExpression<T, TargetOrder>
+{
+    return TerminalExpression<T, TargetOrder>(expression.Origin(), shape, BroadcastStrides(expression.Shape(), expression.Strides(), shape));
+}
+
+template <typename T, size_t TargetOrder>
+auto BroadcastExpression(ScalarExpression<T> const& expression, std::array<size_t, TargetOrder> const&) -> ScalarExpression<T>
+{
+    return expression;
+}
+
+template <typename Operation, typename Operand, size_t TargetOrder>
+auto BroadcastExpression(UnaryExpression<Operation, Operand> const& expression, std::array<size_t, TargetOrder> const& shape)
+{
+    auto operand = BroadcastExpression(expression.Operand(), shape);
+    return UnaryExpression<Operation, decltype(operand)>(operand);
+}
+
+template <typename Operation, typename Left, typename Right, size_t TargetOrder>
+auto BroadcastExpression(BinaryExpression<Operation, Left, Right> const& expression, std::array<size_t, TargetOrder> const& shape)
+{
+    auto left = BroadcastExpression(expression.Left(), shape);
+    auto right = BroadcastExpression(expression.Right(), shape);
+    return BinaryExpression<Operation, decltype(left), decltype(right)>(left, right);
+}
+
+/*
+ * Wrap a scalar in a leaf expression, converting it to the given value type, so that e.g. a float tensor multiplied by
+ * a double literal remains a float expression.
+ */
+template <typename ValueType, ExpressionScalar T>
+auto MakeExpression(T const& operand)
+{
+    return ScalarExpression<ValueType>(static_cast<ValueType>(operand));
+}
+
+/*
+ * Evaluate the elements [start, stop) of a contiguous expression with a SIMD kernel.
+ * Only provided for a single operation between two same-typed leaves, or a leaf and a scalar, when a kernel exists for
+ * the value type and operation; other expressions are evaluated by the generic loop.
+ */
+template <typename Operation, typename T, size_t Order>
+    requires HasSimdKernel<T, Operation>
+auto EvaluateKernel(BinaryExpression<Operation, TerminalExpression<T, Order>, TerminalExpression<T, Order>> const& expression, T* output, size_t start, size_t stop) -> void
+{
+    SelectBinaryKernel<T, Operation>()(expression.Left().Origin() + start, expression.Right().Origin() + start, output + start, stop - start);
+}
+
+template <typename Operation, typename T, size_t Order>
+    requires HasSimdKernel<T, Operation>
+auto EvaluateKernel(BinaryExpression<Operation, TerminalExpression<T, Order>, ScalarExpression<T>> const& expression, T* output, size_t start, size_t stop) -> void
+{
+    SelectBinaryScalarKernel<T, Operation>()(expression.Left().Origin() + start, expression.Right().Value(), output + start, stop - start);
+}
+
+/*
+ * Byte addresses [first, last) spanned by the elements at `origin` with the given shape and strides.
+ */
+template <typename T, size_t Order>
+auto ElementSpan(T const* origin, std::array<size_t, Order> const& shape, std::array<size_t, Order> const& strides) -> std::array<uintptr_t, 2>
+{
+    uintptr_t first = reinterpret_cast<uintptr_t>(origin);
+    size_t extent = 0;
+    for (size_t i = 0; i < Order; ++i)
+    {
+        if (shape[i] == 0)
+        {
+            return {first, first};
+        }
+        extent += (shape[i] - 1) * strides[i];
+    }
+    return {first, first + (extent + 1) * sizeof(T)};
+}
+
+/*
+ * Check whether evaluating an expression elementwise into the given destination could overwrite an element before the
+ * expression reads it. A leaf laid out exactly like the destination is safe, as each of its elements is read just
+ * before the same element is written. Any other leaf whose elements span an overlapping range of memory counts as an
+ * overlap, even when interleaved strides keep the actual elements apart.
+ */
+template <typename T, size_t Order, typename Output, size_t OutputOrder>
+auto ExpressionOverlaps(TerminalExpression<T, Order> const& expression, Output const* output, std::array<size_t, OutputOrder> const& shape, std::array<size_t, OutputOrder> const& strides) -> bool
+{
+    auto span = ElementSpan(expression.Origin(), expression.Shape(), expression.Strides());
+    auto outputSpan = ElementSpan(output, shape, strides);
+    if (span[1] <= outputSpan[0] || outputSpan[1] <= span[0])
+    {
+        return false;
+    }
+
+    if constexpr (Order == OutputOrder && std::is_same_v<T, Output>)
+    {
+        if (expression.Origin() == output && expression.Shape() == shape)
+        {
+            auto expressionStrides = expression.Strides();
+            for (size_t i = 0; i < Order; ++i)
+            {
+                if (shape[i] > 1 && expressionStrides[i] != strides[i])
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T, typename Output, size_t OutputOrder>
+auto ExpressionOverlaps(ScalarExpression<T> const&, Output const*, std::array<size_t, OutputOrder> const&, std::array<size_t, OutputOrder> const&) -> bool
+{
+    return false;
+}
+
+template <typename Operation, typename Operand, typename Output, size_t OutputOrder>
+auto ExpressionOverlaps(UnaryExpression<Operation, Operand> const& expression, Output const* output, std::array<size_t, OutputOrder> const& shape, std::array<size_t, OutputOrder> const& strides) -> bool
+{
+    return ExpressionOverlaps(expression.Operand(), output, shape, strides);
+}
+
+template <typename Operation, typename Left, typename Right, typename Output, size_t OutputOrder>
+auto ExpressionOverlaps(BinaryExpression<Operation, Left, Right> const& expression, Output const* output, std::array<size_t, OutputOrder> const& shape, std::array<size_t, OutputOrder> const& strides) -> bool
+{
+    return ExpressionOverlaps(expression.Left(), output, shape, strides) || ExpressionOverlaps(expression.Right(), output, shape, strides);
+}
+
+/*
+ * Evaluate an expression into a destination Tensor or View of the same shape, in a single pass over the elements.
+ * When the destination and every leaf of the expression are contiguous, the elements are evaluated in a flat loop, or
+ * by a SIMD kernel for single operations which have one; otherwise, rows are walked with incremental offsets into the
+ * destination. Large evaluations are split across the dispatcher thread pool. When the destination overlaps a leaf of
+ * the expression other than at the same positions, as in `a += a.Transpose()`, the expression is evaluated into a
+ * temporary first, which is then copied into the destination.
+ */
+template <typename Expression, typename Destination>
+auto Evaluate(Expression const& expression, Destination& destination) -> void
+{
+    using value_type = std::remove_const_t<typename TensorTraits<Destination>::value_type>;
+    static constexpr size_t order = TensorTraits<Destination>::order;
+
+    Expect(expression.Shape() == destination.Shape(), "expression and destination must have the same shape");
+
+    auto shape = destination.Shape();
+    auto strides = destination.Strides();
+    size_t size = GetSize(shape);
+    if (size == 0)
+    {
+        return;
+    }
+
+    value_type* output = Origin(destination);
+    if (ExpressionOverlaps(expression, output, shape, strides))
+    {
+        Tensor<value_type, order> temporary(shape, Uninitialized);
+        Evaluate(expression, temporary);
+        CopyElementwise<Tensor<value_type, order>, Destination, order>(temporary, destination);
+        return;
+    }
+
+    size_t threads = size * sizeof(value_type) >= ParallelCopyThreshold ? GetDispatcherThreadPool().Threads() : 1;
+    bool parallel = threads > 1;
+
+    if (expression.IsContiguous() && IsContiguous(shape, strides))
+    {
+        auto evaluateBlock = [&](size_t start, size_t stop)
+        {
+            if constexpr (requires { EvaluateKernel(expression, output, start, stop); })
+            {
+                EvaluateKernel(expression, output, start, stop);
+            }
+            else
+            {
+                for (size_t i = start; i < stop; ++i)
+                {
+                    output[i] = static_cast<value_type>(expression.Linear(i));
+                }
+            }
+        };
+
+        if (parallel)
+        {
+            size_t blockLength = (size + threads - 1) / threads;
+            DispatchRow(threads, [&](size_t block)
+            {
+                evaluateBlock(std::min(block * blockLength, size), std::min((block + 1) * blockLength, size));
+            });
+        }
+        else
+        {
+            evaluateBlock(0, size);
+        }
+        return;
+    }
+
+    if constexpr (order > 0)
+    {
+        size_t rowLength = shape[order - 1];
+        size_t rowCount = size / rowLength;
+
+        // evaluate rows [first, last), unravelling the first row's index once and then stepping it like an odometer
+        auto evaluateRows = [&](size_t first, size_t last)
+        {
+            std::array<size_t, order> indices{};
+            size_t offset = 0;
+            for (size_t i = order - 1, row = first; i-- > 0;)
+            {
+                indices[i] = row % shape[i];
+                row /= shape[i];
+                offset += indices[i] * strides[i];
+            }
+            for (size_t row = first; row < last; ++row)
+            {
+                for (size_t x = 0; x < rowLength; ++x)
+                {
+                    indices[order - 1] = x;
+                    output[offset + x * strides[order - 1]] = static_cast<value_type>(expression(indices));
+                }
+                for (size_t i = order - 1; i-- > 0;)
+                {
+                    offset += strides[i];
+                    if (++indices[i] < shape[i])
+                    {
+                        break;
+                    }
+                    offset -= indices[i] * strides[i];
+                    indices[i] = 0;
+                }
+            }
+        };
+
+        if (parallel && rowCount > 1)
+        {
+            size_t blockCount = std::min(rowCount, threads);
+            size_t blockLength = (rowCount + blockCount - 1) / blockCount;
+            DispatchRow(blockCount, [&](size_t block)
+            {
+                evaluateRows(std::min(block * blockLength, rowCount), std::min((block + 1) * blockLength, rowCount));
+            });
+        }
+        else
+        {
+            evaluateRows(0, rowCount);
+        }
+    }
+}
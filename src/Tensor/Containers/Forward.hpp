@@ -1,9 +1,17 @@
 #pragma once
 
+#include "../Utilities/Allocator.hpp"
+
 #include <cstddef>
 
-template <typename T, size_t N>
+template <typename T, size_t N, typename Allocator = AlignedAllocator<T>>
 class Tensor;
 
 template <typename T, size_t N>
 class View;
+
+template <size_t... Extent>
+struct Extents;
+
+template <typename T, typename Shape>
+class StaticTensor;
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Tensor.hpp"
+
+#include <Expect.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Axis of a QuantizedTensor whose scale and zero point apply to every element.
+ */
+inline constexpr size_t PerTensor = static_cast<size_t>(-1);
+
+/*
+ * A tensor of 8-bit integers standing for real values, value = (q - zeroPoint) * scale, at a quarter of the memory of
+ * float. There is either one scale and zero point for the whole tensor, or one for each index along `axis`, such as
+ * each output channel of a weight matrix. Zero points lie within the range of T, so real zero is represented exactly.
+ * See Quantize and Dequantize in Operations/Quantize.hpp.
+ */
+template <typename T, size_t Order>
+class QuantizedTensor
+{
+    static_assert(std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t>, "quantized tensors hold int8_t or uint8_t");
+
+private:
+
+    Tensor<T, Order> mValues;
+    std::vector<float> mScales;
+    std::vector<int32_t> mZeroPoints;
+    size_t mAxis;
+
+    auto Validate() const -> void
+    {
+        Expect(mAxis == PerTensor || mAxis < Order, "quantization axis out of range");
+        size_t count = mAxis == PerTensor ? 1 : mValues.Shape()[mAxis];
+        Expect(mScales.size() == count && mZeroPoints.size() == count, "quantization needs one scale and zero point per index along its axis");
+        for (size_t i = 0; i < count; ++i)
+        {
+            Expect(std::isfinite(mScales[i]) && mScales[i] > 0.0f, "quantization scales must be positive and finite");
+            Expect(mZeroPoints[i] >= std::numeric_limits<T>::lowest() && mZeroPoints[i] <= std::numeric_limits<T>::max(), "quantization zero points must lie within the range of the value type");
+        }
+    }
+
+public:
+
+    using value_type = T;
+    static constexpr size_t order = Order;
+
+    QuantizedTensor(Tensor<T, Order> values, float scale, int32_t zeroPoint)
+        : mValues(std::move(values))
+        , mScales{scale}
+        , mZeroPoints{zeroPoint}
+        , mAxis(PerTensor)
+    {
+        Validate();
+    }
+
+    QuantizedTensor(Tensor<T, Order> values, std::vector<float> scales, std::vector<int32_t> zeroPoints, size_t axis)
+        : mValues(std::move(values))
+        , mScales(std::move(scales))
+        , mZeroPoints(std::move(zeroPoints))
+        , mAxis(axis)
+    {
+        Validate();
+    }
+
+    auto Values() -> Tensor<T, Order>&
+    {
+        return mValues;
+    }
+
+    auto Values() const -> Tensor<T, Order> const&
+    {
+        return mValues;
+    }
+
+    auto Shape() const -> std::array<size_t, Order>
+    {
+        return mValues.Shape();
+    }
+
+    /*
+     * The axis which scales and zero points vary along, or PerTensor.
+     */
+    auto Axis() const -> size_t
+    {
+        return mAxis;
+    }
+
+    auto Scales() const -> std::vector<float> const&
+    {
+        return mScales;
+    }
+
+    auto ZeroPoints() const -> std::vector<int32_t> const&
+    {
+        return mZeroPoints;
+    }
+
+    /*
+     * Scale and zero point of the given index along the axis; per-tensor quantization ignores the index.
+     */
+    auto Scale(size_t index = 0) const -> float
+    {
+        return mScales[mAxis == PerTensor ? 0 : index];
+    }
+
+    auto ZeroPoint(size_t index = 0) const -> int32_t
+    {
+        return mZeroPoints[mAxis == PerTensor ? 0 : index];
+    }
+};
@@ -0,0 +1,348 @@
+#pragma once
+
+#include "../Utilities/Layout.hpp"
+#include "Tensor.hpp"
+#include "Traits.hpp"
+
+#include <Expect.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Row or column index of a nonzero element of a sparse matrix. 32 bits are enough for any matrix dimension in practice
+ * and halve the size of the indices; the number of nonzeros is not limited.
+ */
+using SparseIndex = uint32_t;
+
+/*
+ * A sparse matrix in coordinate format: a list of (row, column, value) triplets in any order, which is the easiest to
+ * build incrementally. Triplets with the same coordinates are added together when converting to another format.
+ * Convert to CsrMatrix or CscMatrix for products.
+ */
+template <typename T>
+class CooMatrix
+{
+private:
+
+    std::array<size_t, 2> mShape;
+    std::vector<SparseIndex> mRows;
+    std::vector<SparseIndex> mColumns;
+    std::vector<T> mValues;
+
+public:
+
+    using value_type = T;
+
+    explicit CooMatrix(std::array<size_t, 2> const& shape)
+        : mShape(shape)
+    {
+        Expect(shape[0] <= std::numeric_limits<SparseIndex>::max() && shape[1] <= std::numeric_limits<SparseIndex>::max(), "sparse matrix dimensions must fit in SparseIndex");
+    }
+
+    /*
+     * The nonzero elements of a dense Tensor<T, 2> or View<T, 2>, in row-major order.
+     */
+    template <typename Dense>
+        requires(TensorTraits<std::remove_cvref_t<Dense>>::order == 2)
+    explicit CooMatrix(Dense const& dense)
+        : CooMatrix(dense.Shape())
+    {
+        auto strides = dense.Strides();
+        auto origin = Origin(dense);
+        for (size_t i = 0; i < mShape[0]; ++i)
+        {
+            for (size_t j = 0; j < mShape[1]; ++j)
+            {
+                T value = origin[i * strides[0] + j * strides[1]];
+                if (value != T{})
+                {
+                    Insert(i, j, value);
+                }
+            }
+        }
+    }
+
+    auto Reserve(size_t count) -> void
+    {
+        mRows.reserve(count);
+        mColumns.reserve(count);
+        mValues.reserve(count);
+    }
+
+    auto Insert(size_t row, size_t column, T value) -> void
+    {
+        Expect(row < mShape[0] && column < mShape[1], "sparse matrix coordinates out of range");
+        mRows.push_back(static_cast<SparseIndex>(row));
+        mColumns.push_back(static_cast<SparseIndex>(column));
+        mValues.push_back(value);
+    }
+
+    auto Shape() const -> std::array<size_t, 2>
+    {
+        return mShape;
+    }
+
+    auto NonZeros() const -> size_t
+    {
+        return mValues.size();
+    }
+
+    auto Rows() const -> std::vector<SparseIndex> const&
+    {
+        return mRows;
+    }
+
+    auto Columns() const -> std::vector<SparseIndex> const&
+    {
+        return mColumns;
+    }
+
+    auto Values() const -> std::vector<T> const&
+    {
+        return mValues;
+    }
+
+    auto ToDense() const -> Tensor<T, 2>
+    {
+        Tensor<T, 2> dense(mShape);
+        for (size_t e = 0; e < mValues.size(); ++e)
+        {
+            dense.Data()[mRows[e] * mShape[1] + mColumns[e]] += mValues[e];
+        }
+        return dense;
+    }
+};
+
+/*
+ * Whether a compressed sparse matrix groups its nonzeros by row, CSR, or by column, CSC.
+ */
+enum class SparseMajor
+{
+    Row,
+    Column,
+};
+
+/*
+ * A sparse matrix in compressed format. Nonzeros are grouped by the major index, rows for CSR and columns for CSC: those
+ * of major index r are at [Offsets()[r], Offsets()[r + 1]) of Indices(), holding their minor index in ascending order,
+ * and Values(). Duplicates are summed on construction, and explicit zeros of dense inputs are dropped.
+ * CSR suits products with dense matrices on the right, CSC products with dense matrices on the left; Transpose turns
+ * one into the other without moving any element.
+ */
+template <typename T, SparseMajor Major>
+class CompressedMatrix
+{
+private:
+
+    static constexpr size_t MajorAxis = Major == SparseMajor::Row ? 0 : 1;
+    static constexpr size_t MinorAxis = 1 - MajorAxis;
+
+    std::array<size_t, 2> mShape;
+    std::vector<size_t> mOffsets;
+    std::vector<SparseIndex> mIndices;
+    std::vector<T> mValues;
+
+    CompressedMatrix(std::array<size_t, 2> const& shape, std::vector<size_t> offsets, std::vector<SparseIndex> indices, std::vector<T> values)
+        : mShape(shape)
+        , mOffsets(std::move(offsets))
+        , mIndices(std::move(indices))
+        , mValues(std::move(values))
+    {}
+
+    /*
+     * Compress `count` triplets, given as (major, minor, value) by `triplet(e)`, with a counting sort on the major index
+     * followed by sorting and merging each group on the minor index.
+     */
+    template <typename Triplet>
+    auto Compress(size_t count, Triplet&& triplet) -> void
+    {
+        size_t majors = mShape[MajorAxis];
+        std::vector<size_t> offsets(majors + 1, 0);
+        for (size_t e = 0; e < count; ++e)
+        {
+            ++offsets[std::get<0>(triplet(e)) + 1];
+        }
+        for (size_t r = 0; r < majors; ++r)
+        {
+            offsets[r + 1] += offsets[r];
+        }
+
+        std::vector<std::pair<SparseIndex, T>> entries(count);
+        std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+        for (size_t e = 0; e < count; ++e)
+        {
+            auto [major, minor, value] = triplet(e);
+            entries[next[major]++] = {minor, value};
+        }
+
+        mOffsets.assign(majors + 1, 0);
+        mIndices.clear();
+        mValues.clear();
+        mIndices.reserve(count);
+        mValues.reserve(count);
+        for (size_t r = 0; r < majors; ++r)
+        {
+            auto first = entries.begin() + static_cast<std::ptrdiff_t>(offsets[r]);
+            auto last = entries.begin() + static_cast<std::ptrdiff_t>(offsets[r + 1]);
+            std::stable_sort(first, last, [](auto const& x, auto const& y)
+            {
+                return x.first < y.first;
+            });
+            size_t begin = mIndices.size();
+            for (auto entry = first; entry != last; ++entry)
+            {
+                if (mIndices.size() > begin && mIndices.back() == entry->first)
+                {
+                    mValues.back() += entry->second;
+                }
+                else
+                {
+                    mIndices.push_back(entry->first);
+                    mValues.push_back(entry->second);
+                }
+            }
+            mOffsets[r + 1] = mIndices.size();
+        }
+    }
+
+public:
+
+    using value_type = T;
+    static constexpr SparseMajor major = Major;
+
+    explicit CompressedMatrix(std::array<size_t, 2> const& shape)
+        : mShape(shape)
+        , mOffsets(shape[MajorAxis] + 1, 0)
+    {
+        Expect(shape[0] <= std::numeric_limits<SparseIndex>::max() && shape[1] <= std::numeric_limits<SparseIndex>::max(), "sparse matrix dimensions must fit in SparseIndex");
+    }
+
+    explicit CompressedMatrix(CooMatrix<T> const& coo)
+        : CompressedMatrix(coo.Shape())
+    {
+        auto const& rows = coo.Rows();
+        auto const& columns = coo.Columns();
+        auto const& values = coo.Values();
+        Compress(coo.NonZeros(), [&](size_t e)
+        {
+            return MajorAxis == 0 ? std::tuple{rows[e], columns[e], values[e]} : std::tuple{columns[e], rows[e], values[e]};
+        });
+    }
+
+    /*
+     * The same matrix in the other compressed format.
+     */
+    template <SparseMajor Other>
+        requires(Other != Major)
+    explicit CompressedMatrix(CompressedMatrix<T, Other> const& other)
+        : CompressedMatrix(other.Shape())
+    {
+        // each nonzero of the other format, in order, as (its major, its minor), which are our minor and major
+        std::vector<SparseIndex> otherMajors(other.NonZeros());
+        for (size_t r = 0; r + 1 < other.Offsets().size(); ++r)
+        {
+            for (size_t e = other.Offsets()[r]; e < other.Offsets()[r + 1]; ++e)
+            {
+                otherMajors[e] = static_cast<SparseIndex>(r);
+            }
+        }
+        Compress(other.NonZeros(), [&](size_t e)
+        {
+            return std::tuple{other.Indices()[e], otherMajors[e], other.Values()[e]};
+        });
+    }
+
+    /*
+     * The nonzero elements of a dense Tensor<T, 2> or View<T, 2>.
+     */
+    template <typename Dense>
+        requires(TensorTraits<std::remove_cvref_t<Dense>>::order == 2)
+    explicit CompressedMatrix(Dense const& dense)
+        : CompressedMatrix(dense.Shape())
+    {
+        auto strides = dense.Strides();
+        auto origin = Origin(dense);
+        for (size_t r = 0; r < mShape[MajorAxis]; ++r)
+        {
+            for (size_t c = 0; c < mShape[MinorAxis]; ++c)
+            {
+                T value = origin[r * strides[MajorAxis] + c * strides[MinorAxis]];
+                if (value != T{})
+                {
+                    mIndices.push_back(static_cast<SparseIndex>(c));
+                    mValues.push_back(value);
+                }
+            }
+            mOffsets[r + 1] = mIndices.size();
+        }
+    }
+
+    /*
+     * The transposed matrix in the other format, which has the same arrays.
+     */
+    auto Transpose() const& -> CompressedMatrix<T, Major == SparseMajor::Row ? SparseMajor::Column : SparseMajor::Row>
+    {
+        return {{mShape[1], mShape[0]}, mOffsets, mIndices, mValues};
+    }
+
+    auto Transpose() && -> CompressedMatrix<T, Major == SparseMajor::Row ? SparseMajor::Column : SparseMajor::Row>
+    {
+        return {{mShape[1], mShape[0]}, std::move(mOffsets), std::move(mIndices), std::move(mValues)};
+    }
+
+    auto Shape() const -> std::array<size_t, 2>
+    {
+        return mShape;
+    }
+
+    auto NonZeros() const -> size_t
+    {
+        return mValues.size();
+    }
+
+    auto Offsets() const -> std::vector<size_t> const&
+    {
+        return mOffsets;
+    }
+
+    auto Indices() const -> std::vector<SparseIndex> const&
+    {
+        return mIndices;
+    }
+
+    auto Values() const -> std::vector<T> const&
+    {
+        return mValues;
+    }
+
+    auto ToDense() const -> Tensor<T, 2>
+    {
+        Tensor<T, 2> dense(mShape);
+        auto strides = dense.Strides();
+        for (size_t r = 0; r < mShape[MajorAxis]; ++r)
+        {
+            for (size_t e = mOffsets[r]; e < mOffsets[r + 1]; ++e)
+            {
+                dense.Data()[r * strides[MajorAxis] + mIndices[e] * strides[MinorAxis]] = mValues[e];
+            }
+        }
+        return dense;
+    }
+
+    template <typename, SparseMajor>
+    friend class CompressedMatrix;
+};
+
+template <typename T>
+using CsrMatrix = CompressedMatrix<T, SparseMajor::Row>;
+
+template <typename T>
+using CscMatrix = CompressedMatrix<T, SparseMajor::Column>;
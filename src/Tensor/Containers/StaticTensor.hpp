@@ -0,0 +1,130 @@
+#pragma once
+
+#include "../Mixins/Arithmetic.hpp"
+#include "../Mixins/Indexable.hpp"
+#include "../Mixins/Iterable.hpp"
+#include "../Mixins/Printable.hpp"
+#include "../Mixins/Sliceable.hpp"
+#include "../Utilities/Copy.hpp"
+
+#include <Expect.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+/*
+ * A shape known at compile time, with its size and row-major strides.
+ */
+template <size_t... Extent>
+struct Extents
+{
+    static constexpr size_t order = sizeof...(Extent);
+    static constexpr std::array<size_t, order> shape = {Extent...};
+    static constexpr size_t size = (size_t{1} * ... * Extent);
+
+    static constexpr std::array<size_t, order> strides = []
+    {
+        std::array<size_t, order> strides{};
+        size_t stride = 1;
+        for (size_t i = order; i-- > 0;)
+        {
+            strides[i] = stride;
+            stride *= shape[i];
+        }
+        return strides;
+    }();
+};
+
+/*
+ * A dense tensor whose shape is fixed at compile time, with its elements stored inline rather than on the heap.
+ * Meant for small tensors, such as 4x4 transforms or convolution kernels, which are created often enough that an
+ * allocation per tensor would dominate. As the strides are constants, indexing folds down to constant offsets.
+ * StaticTensor slices into Views, takes part in arithmetic expressions and copies to and from any other container.
+ */
+template <typename T, size_t... Extent>
+class StaticTensor<T, Extents<Extent...>> : public Arithmetic<StaticTensor<T, Extents<Extent...>>>,
+                                            public Indexable<StaticTensor<T, Extents<Extent...>>>,
+                                            public Iterable<StaticTensor<T, Extents<Extent...>>>,
+                                            public Printable<StaticTensor<T, Extents<Extent...>>>,
+                                            public Sliceable<StaticTensor<T, Extents<Extent...>>, sizeof...(Extent)>
+{
+private:
+
+    using Layout = Extents<Extent...>;
+    static constexpr size_t Order = Layout::order;
+
+    std::array<T, Layout::size> mData{};
+
+public:
+
+    constexpr StaticTensor() = default;
+
+    constexpr StaticTensor(T fill)
+    {
+        mData.fill(fill);
+    }
+
+    /*
+     * Take the elements in row-major order.
+     */
+    constexpr StaticTensor(std::array<T, Layout::size> const& elements)
+        : mData(elements)
+    {}
+
+    template <TensorLike Other>
+    StaticTensor(Other const& other)
+    {
+        if constexpr (requires { std::bool_constant<(Other::Shape(), true)>{}; })
+        {
+            static_assert(Other::Shape() == Layout::shape, "shape does not match the static extents");
+        }
+        else
+        {
+            Expect(other.Shape() == Layout::shape, "shape does not match the static extents");
+        }
+
+        if constexpr (ExpressionNode<Other>)
+        {
+            Evaluate(other, *this);
+        }
+        else
+        {
+            CopyElementwise<Other, StaticTensor, Order>(other, *this);
+        }
+    }
+
+    template <ExpressionNode Expression>
+    StaticTensor& operator=(Expression const& expression)
+    {
+        Expect(expression.Shape() == Layout::shape, "shape does not match the static extents");
+        Evaluate(expression, *this);
+        return *this;
+    }
+
+    constexpr auto Data() -> T*
+    {
+        return mData.data();
+    }
+
+    constexpr auto Data() const -> const T*
+    {
+        return mData.data();
+    }
+
+    static constexpr auto Shape() -> std::array<size_t, Order>
+    {
+        return Layout::shape;
+    }
+
+    static constexpr auto Strides() -> std::array<size_t, Order>
+    {
+        return Layout::strides;
+    }
+
+    static constexpr auto Size() -> size_t
+    {
+        return Layout::size;
+    }
+};
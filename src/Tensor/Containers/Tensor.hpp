@@ -1,51 +1,152 @@
 #pragma once
 
+#include "../Mixins/Arithmetic.hpp"
 #include "../Mixins/Indexable.hpp"
+#include "../Mixins/Iterable.hpp"
 #include "../Mixins/Printable.hpp"
 #include "../Mixins/Sliceable.hpp"
+#include "../Utilities/Allocator.hpp"
 #include "../Utilities/Copy.hpp"
 #include "../Utilities/Shape.hpp"
 
+#include <Expect.hpp>
+
 #include <algorithm>
+#include <functional>
 #include <memory>
-
-template <typename T, size_t Order>
-class Tensor : public Indexable<Tensor<T, Order>>,
-               public Printable<Tensor<T, Order>>,
-               public Sliceable<Tensor<T, Order>, Order>
+#include <type_traits>
+
+template <typename T, size_t Order, typename Allocator>
+class Tensor : public Arithmetic<Tensor<T, Order, Allocator>>,
+               public Indexable<Tensor<T, Order, Allocator>>,
+               public Iterable<Tensor<T, Order, Allocator>>,
+               public Printable<Tensor<T, Order, Allocator>>,
+               public Sliceable<Tensor<T, Order, Allocator>, Order>
 {
 private:
 
+    using Deleter = AllocatorDeleter<T, Allocator>;
+    using Storage = std::unique_ptr<T[], Deleter>;
+
     std::array<size_t, Order> mShape;
     std::array<size_t, Order> mStrides;
     size_t mSize;
-    std::unique_ptr<T[]> mData;
+    Storage mData;
+
+    template <typename Construct>
+    static auto Allocate(size_t size, Construct&& construct) -> Storage
+    {
+        Allocator allocator;
+        T* data = allocator.allocate(size);
+        try
+        {
+            construct(data, size);
+        }
+        catch (...)
+        {
+            allocator.deallocate(data, size);
+            throw;
+        }
+        return Storage(data, Deleter{allocator, size, nullptr, nullptr});
+    }
+
+    static auto CopyConstruct(T const* source, T* destination, size_t size) -> void
+    {
+        ParallelInitialize(destination, size, [source, destination](T* first, size_t count) noexcept(std::is_nothrow_copy_constructible_v<T>)
+        {
+            std::uninitialized_copy_n(source + (first - destination), count, first);
+        });
+    }
+
+    static auto Adopt(T* data, size_t size, std::function<void(T*)> release) -> Storage
+    {
+        Expect(release != nullptr, "adopted buffers need a release function");
+        Expect(data != nullptr || size == 0, "adopted buffer is null");
+
+        // the storage never calls its deleter on a null buffer, such as that of an empty tensor, so release it now
+        if (data == nullptr)
+        {
+            release(nullptr);
+            return Storage(nullptr, Deleter{Allocator{}, size, nullptr, nullptr});
+        }
+
+        // the release function lives on the heap, so only adopted buffers pay for it
+        using Release = std::function<void(T*)>;
+        auto owner = std::make_unique<Release>(std::move(release));
+        auto invoke = [](T* pointer, void* context)
+        {
+            std::unique_ptr<Release> owner(static_cast<Release*>(context));
+            (*owner)(pointer);
+        };
+        return Storage(data, Deleter{Allocator{}, size, invoke, owner.release()});
+    }
 
 public:
 
+    using allocator_type = Allocator;
+
     Tensor(std::array<size_t, Order> const& shape)
         : mShape(shape)
+        , mStrides(GetStrides(mShape))
         , mSize(GetSize(mShape))
+        , mData(Allocate(mSize, [](T* data, size_t size)
+        {
+            ParallelInitialize(data, size, [](T* first, size_t count) noexcept(std::is_nothrow_default_constructible_v<T>)
+            {
+                std::uninitialized_value_construct_n(first, count);
+            });
+        }))
+    {}
+
+    Tensor(std::array<size_t, Order> const& shape, Uninitialized_t)
+        : mShape(shape)
         , mStrides(GetStrides(mShape))
-        , mData(new T[mSize])
+        , mSize(GetSize(mShape))
+        , mData(Allocate(mSize, [](T* data, size_t size)
+        {
+            std::uninitialized_default_construct_n(data, size);
+        }))
     {}
 
     Tensor(std::array<size_t, Order> const& shape, T fill)
-        : Tensor(shape)
-    {
-        std::fill_n(mData.get(), mSize, fill);
-    }
+        : mShape(shape)
+        , mStrides(GetStrides(mShape))
+        , mSize(GetSize(mShape))
+        , mData(Allocate(mSize, [&fill](T* data, size_t size)
+        {
+            ParallelInitialize(data, size, [&fill](T* first, size_t count) noexcept(std::is_nothrow_copy_constructible_v<T>)
+            {
+                std::uninitialized_fill_n(first, count, fill);
+            });
+        }))
+    {}
+
+    /*
+     * Adopt a buffer of already constructed elements, in dense row-major order, from elsewhere: a driver, a shared memory
+     * segment or another library. The elements are not copied, and `release` is called with the buffer once the tensor
+     * no longer needs it.
+     */
+    Tensor(T* data, std::array<size_t, Order> const& shape, std::function<void(T*)> release)
+        : mShape(shape)
+        , mStrides(GetStrides(mShape))
+        , mSize(GetSize(mShape))
+        , mData(Adopt(data, mSize, std::move(release)))
+    {}
 
     Tensor(Tensor const& other)
-        : Tensor(other.Shape())
-    {
-        std::copy_n(other.mData.get(), mSize, mData.get());
-    }
+        : mShape(other.mShape)
+        , mStrides(other.mStrides)
+        , mSize(other.mSize)
+        , mData(Allocate(mSize, [&other](T* data, size_t size)
+        {
+            CopyConstruct(other.mData.get(), data, size);
+        }))
+    {}
 
     Tensor(Tensor&& other) noexcept
         : mShape(other.mShape)
-        , mSize(other.mSize)
         , mStrides(other.mStrides)
+        , mSize(other.mSize)
         , mData(std::move(other.mData))
     {}
 
@@ -53,11 +154,25 @@ public:
     {
         if (this != &other)
         {
+            // reuse the existing buffer when it already has the right size
+            if (mData && mSize == other.mSize)
+            {
+                T const* source = other.mData.get();
+                ParallelInitialize(mData.get(), mSize, [source, destination = mData.get()](T* first, size_t count) noexcept(std::is_nothrow_copy_assignable_v<T>)
+                {
+                    std::copy_n(source + (first - destination), count, first);
+                });
+            }
+            else
+            {
+                mData = Allocate(other.mSize, [&other](T* data, size_t size)
+                {
+                    CopyConstruct(other.mData.get(), data, size);
+                });
+            }
             mShape = other.mShape;
             mSize = other.mSize;
             mStrides = other.mStrides;
-            mData.reset(new T[mSize]);
-            std::copy_n(other.mData.get(), mSize, mData.get());
         }
         return *this;
     }
@@ -74,11 +189,46 @@ public:
         return *this;
     }
 
-    template <typename Other>
+    template <TensorLike Other>
     Tensor(Other const& other)
-        : Tensor(other.Shape())
+        : Tensor(other.Shape(), Uninitialized)
+    {
+        if constexpr (ExpressionNode<Other>)
+        {
+            Evaluate(other, *this);
+        }
+        else
+        {
+            CopyElementwise<Other, std::remove_reference_t<decltype(*this)>, Order>(other, *this);
+        }
+    }
+
+    template <ExpressionNode Expression>
+    Tensor& operator=(Expression const& expression)
+    {
+        if (mData && mShape == expression.Shape())
+        {
+            // Evaluate goes through a temporary if the expression reads these elements at other positions
+            Evaluate(expression, *this);
+        }
+        else
+        {
+            // evaluate before releasing the current buffer, which the expression may refer to
+            *this = Tensor(expression);
+        }
+        return *this;
+    }
+
+    /*
+     * Give up ownership of the buffer, leaving this tensor empty. The returned pointer's deleter frees the buffer the way
+     * it was obtained.
+     */
+    auto Release() -> std::unique_ptr<T[], AllocatorDeleter<T, Allocator>>
     {
-        CopyElementwise<Other, std::remove_reference_t<decltype(*this)>, Order>(other, *this);
+        mShape = {};
+        mStrides = {};
+        mSize = 0;
+        return std::move(mData);
     }
 
     auto Data() -> T*
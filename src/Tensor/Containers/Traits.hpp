@@ -5,8 +5,8 @@
 template <typename T>
 struct TensorTraits;
 
-template <typename T, size_t N>
-struct TensorTraits<Tensor<T, N>>
+template <typename T, size_t N, typename Allocator>
+struct TensorTraits<Tensor<T, N, Allocator>>
 {
     using value_type = T;
     static constexpr size_t order = N;
@@ -20,3 +20,11 @@ struct TensorTraits<View<T, N>>
     static constexpr size_t order = N;
     static constexpr bool has_offset = true;
 };
+
+template <typename T, size_t... Extent>
+struct TensorTraits<StaticTensor<T, Extents<Extent...>>>
+{
+    using value_type = T;
+    static constexpr size_t order = sizeof...(Extent);
+    static constexpr bool has_offset = false;
+};
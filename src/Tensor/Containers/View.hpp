@@ -1,11 +1,15 @@
 #pragma once
 
+#include "../Mixins/Arithmetic.hpp"
 #include "../Mixins/Indexable.hpp"
+#include "../Mixins/Iterable.hpp"
 #include "../Mixins/Printable.hpp"
 #include "../Mixins/Sliceable.hpp"
 
 template <typename T, size_t Order>
-class View : public Indexable<View<T, Order>>,
+class View : public Arithmetic<View<T, Order>>,
+             public Indexable<View<T, Order>>,
+             public Iterable<View<T, Order>>,
              public Printable<View<T, Order>>,
              public Sliceable<View<T, Order>, Order>
 {
@@ -25,6 +29,17 @@ public:
         , mData(data)
     {}
 
+    /*
+     * Evaluate an expression into the elements referred to by this view.
+     * Unlike assigning another View, which rebinds this view, this writes through to the underlying data.
+     */
+    template <ExpressionNode Expression>
+    View& operator=(Expression const& expression)
+    {
+        Evaluate(expression, *this);
+        return *this;
+    }
+
     auto Data() -> T*
     {
         return mData;
@@ -0,0 +1,986 @@
+#pragma once
+
+#include "../Containers/Tensor.hpp"
+#include "../Containers/Traits.hpp"
+#include "../Containers/View.hpp"
+#include "../Mixins/Sliceable.hpp"
+#include "../Utilities/Copy.hpp"
+#include "TensorFile.hpp"
+
+#include <Dispatch.hpp>
+#include <Expect.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * A file read and written at explicit offsets, so that several threads may use it at once without sharing a position.
+ * Files which may not be written are opened for reading only, and fail on the first write.
+ */
+class ChunkFile
+{
+private:
+
+#if defined(_WIN32)
+    HANDLE mFile = INVALID_HANDLE_VALUE;
+#else
+    int mDescriptor = -1;
+#endif
+    bool mWritable = true;
+    std::string mPath;
+
+    // the most bytes passed to a single read or write call
+    static constexpr size_t MaximumTransfer = size_t{1} << 30;
+
+public:
+
+    /*
+     * Open an existing file, or create an empty one in place of whatever is at `path` when `create` is set.
+     */
+    ChunkFile(std::string const& path, bool create)
+        : mPath(path)
+    {
+#if defined(_WIN32)
+        DWORD disposition = create ? CREATE_ALWAYS : OPEN_EXISTING;
+        mFile = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (mFile == INVALID_HANDLE_VALUE && !create && GetLastError() == ERROR_ACCESS_DENIED)
+        {
+            mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            mWritable = false;
+        }
+        Expect(mFile != INVALID_HANDLE_VALUE, "failed to open chunked tensor file: " + path);
+#else
+        mDescriptor = open(path.c_str(), create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0644);
+        if (mDescriptor < 0 && !create && (errno == EACCES || errno == EROFS))
+        {
+            mDescriptor = open(path.c_str(), O_RDONLY);
+            mWritable = false;
+        }
+        Expect(mDescriptor >= 0, "failed to open chunked tensor file: " + path);
+#endif
+    }
+
+    ChunkFile(ChunkFile const&) = delete;
+    ChunkFile& operator=(ChunkFile const&) = delete;
+
+    ~ChunkFile()
+    {
+#if defined(_WIN32)
+        CloseHandle(mFile);
+#else
+        close(mDescriptor);
+#endif
+    }
+
+    auto IsWritable() const -> bool
+    {
+        return mWritable;
+    }
+
+    auto Size() const -> size_t
+    {
+#if defined(_WIN32)
+        LARGE_INTEGER size;
+        Expect(GetFileSizeEx(mFile, &size) != 0, "failed to read chunked tensor file: " + mPath);
+        return static_cast<size_t>(size.QuadPart);
+#else
+        struct stat status;
+        Expect(fstat(mDescriptor, &status) == 0, "failed to read chunked tensor file: " + mPath);
+        return static_cast<size_t>(status.st_size);
+#endif
+    }
+
+    /*
+     * Extend or truncate the file to `size` bytes. Bytes past the old end read as zero, and take no disk space on file
+     * systems with sparse files until they are written.
+     */
+    auto Resize(size_t size) -> void
+    {
+#if defined(_WIN32)
+        FILE_END_OF_FILE_INFO information;
+        information.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+        Expect(SetFileInformationByHandle(mFile, FileEndOfFileInfo, &information, sizeof(information)) != 0, "failed to resize chunked tensor file: " + mPath);
+#else
+        Expect(ftruncate(mDescriptor, static_cast<off_t>(size)) == 0, "failed to resize chunked tensor file: " + mPath);
+#endif
+    }
+
+    auto ReadAt(void* data, size_t size, size_t offset) const -> void
+    {
+        auto* bytes = static_cast<std::byte*>(data);
+        while (size > 0)
+        {
+            size_t transfer = std::min(size, MaximumTransfer);
+#if defined(_WIN32)
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+            DWORD done = 0;
+            bool read = ReadFile(mFile, bytes, static_cast<DWORD>(transfer), &done, &overlapped) != 0;
+            Expect(read && done > 0, "failed to read chunked tensor file: " + mPath);
+#else
+            ssize_t done = pread(mDescriptor, bytes, transfer, static_cast<off_t>(offset));
+            if (done < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            Expect(done > 0, "failed to read chunked tensor file: " + mPath);
+#endif
+            bytes += done;
+            size -= static_cast<size_t>(done);
+            offset += static_cast<size_t>(done);
+        }
+    }
+
+    auto WriteAt(void const* data, size_t size, size_t offset) const -> void
+    {
+        Expect(mWritable, "chunked tensor file is read-only: " + mPath);
+        auto const* bytes = static_cast<std::byte const*>(data);
+        while (size > 0)
+        {
+            size_t transfer = std::min(size, MaximumTransfer);
+#if defined(_WIN32)
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+            DWORD done = 0;
+            bool written = WriteFile(mFile, bytes, static_cast<DWORD>(transfer), &done, &overlapped) != 0;
+            Expect(written && done > 0, "failed to write chunked tensor file: " + mPath);
+#else
+            ssize_t done = pwrite(mDescriptor, bytes, transfer, static_cast<off_t>(offset));
+            if (done < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            Expect(done > 0, "failed to write chunked tensor file: " + mPath);
+#endif
+            bytes += done;
+            size -= static_cast<size_t>(done);
+            offset += static_cast<size_t>(done);
+        }
+    }
+};
+
+/*
+ * Chunked tensor file layout, in little-endian byte order:
+ *
+ *     ChunkedTensorHeader
+ *     uint64_t shape[order]
+ *     uint64_t chunkShape[order]
+ *     padding to dataOffset         a multiple of TensorFileAlignment
+ *     chunks                        chunkStride bytes each, in row-major order of their position in the tensor
+ *
+ * Each chunk holds the elements of one block of chunkShape in dense row-major order, followed by padding to the stride.
+ * Chunks on the far edges of the tensor are stored whole, with elements past the end of the tensor left unused.
+ */
+inline constexpr std::array<char, 8> ChunkedTensorMagic = {'T', 'E', 'N', 'S', 'C', 'H', 'N', 'K'};
+inline constexpr uint32_t ChunkedTensorVersion = 1;
+
+struct ChunkedTensorHeader
+{
+    std::array<char, 8> magic;
+    uint32_t version;
+    DataType dataType;
+    uint32_t order;
+    uint32_t elementSize;
+    uint64_t dataOffset;
+    uint64_t chunkStride;
+};
+
+static_assert(sizeof(ChunkedTensorHeader) == 40, "chunked tensor header must have no padding");
+
+struct ChunkedTensorOptions
+{
+    // bytes of chunks kept in memory; the least recently used chunks beyond it are evicted
+    size_t cacheBytes = size_t{1} << 30;
+    // threads reading chunks ahead of their use
+    size_t loaderThreads = 1;
+};
+
+/*
+ * Whether ForEachChunk may modify the chunks it visits, which are then written back to the file.
+ */
+enum class ChunkAccess
+{
+    ReadOnly,
+    ReadWrite,
+};
+
+/*
+ * A read-only View into part of a chunked tensor, and the Tensor holding its elements: a chunk in the cache, or a copy
+ * assembled from several chunks. The view, and any view sliced from it, must not outlive the owner.
+ */
+template <typename T, size_t Order>
+struct ChunkedSlice
+{
+    std::shared_ptr<Tensor<T, Order> const> owner;
+    View<T const, Order> view;
+};
+
+/*
+ * A tensor stored in a file as a grid of equally shaped chunks, for data too large to be held in memory at once.
+ * Chunks are read on first use into a cache limited to ChunkedTensorOptions::cacheBytes, from which the least recently
+ * used chunks are evicted, and modified chunks are written back when they are evicted or flushed. Chunks in use, by a
+ * slice or a call in progress, are never evicted, so the cache grows past its budget while more than that is in use.
+ * Chunks are read and written back without holding the cache lock, so threads using resident chunks never wait for
+ * the file.
+ * The chunk shape sets the unit of every read and write: slices which stay within one chunk view it in place, and
+ * blocks of the chunk shape are processed in parallel by ForEachChunk. All members may be called from several threads.
+ */
+template <typename T, size_t Order>
+class ChunkedTensor
+{
+private:
+
+    // the elements of a resident chunk, and the number of references to it handed out by Acquire
+    struct ChunkBuffer
+    {
+        Tensor<T, Order> tensor;
+        std::atomic<size_t> pins = 0;
+
+        explicit ChunkBuffer(std::array<size_t, Order> const& shape)
+            : tensor(shape, Uninitialized)
+        {}
+    };
+
+    // one reference to a chunk, which keeps it from being evicted; releasing it publishes the changes made through it
+    // to the thread which next writes the chunk back
+    struct ChunkPin
+    {
+        std::shared_ptr<ChunkBuffer> buffer;
+
+        explicit ChunkPin(std::shared_ptr<ChunkBuffer> pinned)
+            : buffer(std::move(pinned))
+        {
+            buffer->pins.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ~ChunkPin()
+        {
+            buffer->pins.fetch_sub(1, std::memory_order_release);
+        }
+    };
+
+    struct CachedChunk
+    {
+        // null while the chunk is being read, or written back on eviction
+        std::shared_ptr<ChunkBuffer> buffer;
+        std::list<size_t>::iterator recent;
+        bool dirty = false;
+    };
+
+    ChunkFile mFile;
+    std::array<size_t, Order> mShape{};
+    std::array<size_t, Order> mChunkShape{};
+    std::array<size_t, Order> mGrid{};
+    size_t mChunkCount = 0;
+    size_t mChunkBytes = 0;
+    size_t mChunkStride = 0;
+    size_t mDataOffset = 0;
+    size_t mCacheBytes;
+
+    std::mutex mMutex;
+    std::condition_variable mLoaded;
+    std::unordered_map<size_t, CachedChunk> mChunks;
+    // chunk indices, most recently used first, of the chunks which are resident or being read
+    std::list<size_t> mRecent;
+    size_t mResidentBytes = 0;
+    // chunks evicted from the cache whose write-back is in progress, still counted in mResidentBytes
+    size_t mWriting = 0;
+
+    // declared last, so that its threads stop before anything they use is destroyed
+    ThreadPool mLoader;
+
+    /*
+     * A pointer to the elements of a chunk which pins it while held, even past the lifetime of the ChunkedTensor.
+     * Called with the mutex held, so that no chunk is pinned while it is being evicted.
+     */
+    static auto Pin(std::shared_ptr<ChunkBuffer> const& buffer) -> std::shared_ptr<Tensor<T, Order>>
+    {
+        auto pin = std::make_shared<ChunkPin>(buffer);
+        return std::shared_ptr<Tensor<T, Order>>(pin, &buffer->tensor);
+    }
+
+    static auto IsPinned(ChunkBuffer const& buffer) -> bool
+    {
+        return buffer.pins.load(std::memory_order_acquire) > 0;
+    }
+
+    auto SetLayout(std::array<size_t, Order> const& shape, std::array<size_t, Order> const& chunkShape, size_t dataOffset) -> void
+    {
+        // the shapes may come from a file, so every size derived from them is checked for overflow
+        std::string const overflow = "chunked tensor is too large to address";
+        mShape = shape;
+        mChunkShape = chunkShape;
+        mChunkCount = 1;
+        size_t chunkSize = 1;
+        for (size_t i = 0; i < Order; ++i)
+        {
+            Expect(chunkShape[i] > 0, "chunk dimensions must not be zero");
+            mGrid[i] = shape[i] / chunkShape[i] + (shape[i] % chunkShape[i] != 0 ? 1 : 0);
+            mChunkCount = CheckedMultiply(mChunkCount, mGrid[i], overflow);
+            chunkSize = CheckedMultiply(chunkSize, chunkShape[i], overflow);
+        }
+        mChunkBytes = CheckedMultiply(chunkSize, sizeof(T), overflow);
+        mChunkStride = CheckedAdd(mChunkBytes, TensorFileAlignment - 1, overflow) / TensorFileAlignment * TensorFileAlignment;
+        mDataOffset = dataOffset;
+
+        // the end of the last chunk, which bounds every other chunk offset
+        CheckedAdd(mDataOffset, CheckedMultiply(mChunkCount, mChunkStride, overflow), overflow);
+    }
+
+    auto ChunkPosition(size_t index) const -> std::array<size_t, Order>
+    {
+        std::array<size_t, Order> position{};
+        for (size_t i = Order; i-- > 0;)
+        {
+            position[i] = index % mGrid[i];
+            index /= mGrid[i];
+        }
+        return position;
+    }
+
+    auto ChunkIndex(std::array<size_t, Order> const& position) const -> size_t
+    {
+        size_t index = 0;
+        for (size_t i = 0; i < Order; ++i)
+        {
+            index = index * mGrid[i] + position[i];
+        }
+        return index;
+    }
+
+    auto ChunkOffset(size_t index) const -> size_t
+    {
+        return mDataOffset + index * mChunkStride;
+    }
+
+    /*
+     * The part of chunk `index`, held in `chunk`, which lies within the tensor.
+     */
+    auto ChunkView(Tensor<T, Order>& chunk, size_t index) const -> View<T, Order>
+    {
+        auto position = ChunkPosition(index);
+        std::array<size_t, Order> extent{};
+        for (size_t i = 0; i < Order; ++i)
+        {
+            extent[i] = std::min(mChunkShape[i], mShape[i] - position[i] * mChunkShape[i]);
+        }
+        return View<T, Order>(chunk.Data(), extent, chunk.Strides(), 0);
+    }
+
+    /*
+     * Get chunk `index` from the cache, reading it from the file first if it is not resident, and mark it as modified
+     * when `write` is set. Threads asking for a chunk another thread is reading wait for it, rather than read it again.
+     * The chunk stays in memory for as long as the returned pointer is held.
+     */
+    auto Acquire(size_t index, bool write) -> std::shared_ptr<Tensor<T, Order>>
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        auto found = mChunks.find(index);
+        while (found != mChunks.end())
+        {
+            CachedChunk& cached = found->second;
+            if (cached.buffer)
+            {
+                mRecent.splice(mRecent.begin(), mRecent, cached.recent);
+                cached.dirty = cached.dirty || write;
+                return Pin(cached.buffer);
+            }
+            mLoaded.wait(lock);
+            found = mChunks.find(index);
+        }
+
+        // elements of unordered_map keep their address while others come and go, and this one is never evicted while
+        // it has no data; a chunk being written back is waited for like one being read, and read again afterwards
+        mRecent.push_front(index);
+        CachedChunk& cached = mChunks.emplace(index, CachedChunk{nullptr, mRecent.begin(), false}).first->second;
+        lock.unlock();
+
+        std::shared_ptr<ChunkBuffer> buffer;
+        try
+        {
+            buffer = std::make_shared<ChunkBuffer>(mChunkShape);
+            mFile.ReadAt(buffer->tensor.Data(), mChunkBytes, ChunkOffset(index));
+        }
+        catch (...)
+        {
+            lock.lock();
+            mRecent.erase(cached.recent);
+            mChunks.erase(index);
+            mLoaded.notify_all();
+            throw;
+        }
+
+        lock.lock();
+        cached.buffer = buffer;
+        cached.dirty = write;
+        mResidentBytes += mChunkBytes;
+        mLoaded.notify_all();
+        auto chunk = Pin(buffer);
+        Evict(lock);
+        return chunk;
+    }
+
+    /*
+     * Evict the least recently used chunks which are not in use until the cache fits its budget. Modified chunks are
+     * taken out of the cache while the mutex is held, and written back after it is released, so other threads only
+     * wait for them when they ask for one of those chunks. Called with the mutex held through `lock`, which is held
+     * again on return. If a write-back fails, its chunk stays in the cache as modified and the error is rethrown.
+     */
+    auto Evict(std::unique_lock<std::mutex>& lock) -> void
+    {
+        std::vector<std::pair<size_t, std::shared_ptr<ChunkBuffer>>> writes;
+        auto position = mRecent.end();
+        while (mResidentBytes - mWriting * mChunkBytes > mCacheBytes && position != mRecent.begin())
+        {
+            --position;
+            auto found = mChunks.find(*position);
+            CachedChunk& cached = found->second;
+
+            // chunks are only pinned with the mutex held, so one found unpinned here stays so
+            if (!cached.buffer || IsPinned(*cached.buffer))
+            {
+                continue;
+            }
+            if (cached.dirty)
+            {
+                writes.emplace_back(*position, std::move(cached.buffer));
+                cached.buffer = nullptr;
+                ++mWriting;
+            }
+            else
+            {
+                mResidentBytes -= mChunkBytes;
+                mChunks.erase(found);
+            }
+            position = mRecent.erase(position);
+        }
+        if (writes.empty())
+        {
+            return;
+        }
+
+        lock.unlock();
+        std::vector<std::exception_ptr> errors(writes.size());
+        for (size_t i = 0; i < writes.size(); ++i)
+        {
+            try
+            {
+                mFile.WriteAt(writes[i].second->tensor.Data(), mChunkBytes, ChunkOffset(writes[i].first));
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+        lock.lock();
+
+        std::exception_ptr error;
+        for (size_t i = 0; i < writes.size(); ++i)
+        {
+            CachedChunk& cached = mChunks.find(writes[i].first)->second;
+            if (errors[i])
+            {
+                mRecent.push_front(writes[i].first);
+                cached.recent = mRecent.begin();
+                cached.buffer = std::move(writes[i].second);
+                error = error ? error : errors[i];
+            }
+            else
+            {
+                mResidentBytes -= mChunkBytes;
+                mChunks.erase(writes[i].first);
+            }
+        }
+        mWriting -= writes.size();
+        mLoaded.notify_all();
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /*
+     * Evict chunks released since they were last considered for eviction.
+     */
+    auto Trim() -> void
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        Evict(lock);
+    }
+
+    /*
+     * The indices of the chunks overlapping the block [start, stop) of the tensor, in row-major order of their position.
+     */
+    auto OverlappingChunks(std::array<size_t, Order> const& start, std::array<size_t, Order> const& stop) const -> std::vector<size_t>
+    {
+        std::array<size_t, Order> low{};
+        std::array<size_t, Order> high{};
+        for (size_t i = 0; i < Order; ++i)
+        {
+            Expect(start[i] <= stop[i] && stop[i] <= mShape[i], "chunked tensor block out of range");
+            if (start[i] == stop[i])
+            {
+                return {};
+            }
+            low[i] = start[i] / mChunkShape[i];
+            high[i] = (stop[i] - 1) / mChunkShape[i] + 1;
+        }
+
+        std::vector<size_t> indices;
+        std::array<size_t, Order> position = low;
+        while (true)
+        {
+            indices.push_back(ChunkIndex(position));
+            size_t i = Order;
+            while (i-- > 0 && ++position[i] == high[i])
+            {
+                position[i] = low[i];
+            }
+            if (i == size_t(-1))
+            {
+                return indices;
+            }
+        }
+    }
+
+    /*
+     * Call `visit(index, first, last)` for every chunk overlapping the block [start, stop) of the tensor, with the
+     * overlap given as [first, last) in tensor coordinates. The chunks are visited in parallel.
+     */
+    template <typename Visit>
+    auto ForEachOverlap(std::array<size_t, Order> const& start, std::array<size_t, Order> const& stop, Visit&& visit) -> void
+    {
+        std::vector<size_t> indices = OverlappingChunks(start, stop);
+        DispatchRow(indices.size(), [&](size_t t)
+        {
+            auto chunkPosition = ChunkPosition(indices[t]);
+            std::array<size_t, Order> first{};
+            std::array<size_t, Order> last{};
+            for (size_t i = 0; i < Order; ++i)
+            {
+                first[i] = std::max(start[i], chunkPosition[i] * mChunkShape[i]);
+                last[i] = std::min(stop[i], (chunkPosition[i] + 1) * mChunkShape[i]);
+            }
+            visit(indices[t], first, last);
+        });
+        Trim();
+    }
+
+    /*
+     * Read the given chunks into the cache on the loader threads. A chunk which fails to load here is read again,
+     * and the error reported, when it is used.
+     */
+    auto PrefetchChunks(std::vector<size_t> indices) -> DispatchHandle
+    {
+        size_t count = indices.size();
+        return DispatchTasks(mLoader, count, [this, indices = std::move(indices)](size_t t)
+        {
+            try
+            {
+                Acquire(indices[t], false);
+            }
+            catch (...)
+            {
+            }
+        });
+    }
+
+public:
+
+    using value_type = T;
+    static constexpr size_t order = Order;
+
+    /*
+     * Create a chunked tensor file at `path`, replacing any file there, with every element zero.
+     * The file takes its full size at once, as a sparse file where the file system supports it.
+     */
+    ChunkedTensor(std::string const& path, std::array<size_t, Order> const& shape, std::array<size_t, Order> const& chunkShape, ChunkedTensorOptions const& options = {})
+        : mFile(path, true)
+        , mCacheBytes(options.cacheBytes)
+        , mLoader(options.loaderThreads)
+    {
+        static_assert(std::endian::native == std::endian::little, "tensor files are only supported on little-endian hosts");
+
+        size_t metadataSize = sizeof(ChunkedTensorHeader) + 2 * Order * sizeof(uint64_t);
+        SetLayout(shape, chunkShape, (metadataSize + TensorFileAlignment - 1) / TensorFileAlignment * TensorFileAlignment);
+
+        ChunkedTensorHeader header{};
+        header.magic = ChunkedTensorMagic;
+        header.version = ChunkedTensorVersion;
+        header.dataType = DataTypeOf<T>();
+        header.order = static_cast<uint32_t>(Order);
+        header.elementSize = static_cast<uint32_t>(sizeof(T));
+        header.dataOffset = mDataOffset;
+        header.chunkStride = mChunkStride;
+
+        std::array<uint64_t, 2 * Order> metadata{};
+        for (size_t i = 0; i < Order; ++i)
+        {
+            metadata[i] = shape[i];
+            metadata[Order + i] = chunkShape[i];
+        }
+        mFile.Resize(ChunkOffset(mChunkCount));
+        mFile.WriteAt(&header, sizeof(header), 0);
+        mFile.WriteAt(metadata.data(), sizeof(metadata), sizeof(header));
+    }
+
+    /*
+     * Open an existing chunked tensor file. Files which may not be written are opened for reading only.
+     * The element type and order must match the file.
+     */
+    explicit ChunkedTensor(std::string const& path, ChunkedTensorOptions const& options = {})
+        : mFile(path, false)
+        , mCacheBytes(options.cacheBytes)
+        , mLoader(options.loaderThreads)
+    {
+        static_assert(std::endian::native == std::endian::little, "tensor files are only supported on little-endian hosts");
+
+        size_t fileSize = mFile.Size();
+        size_t metadataSize = sizeof(ChunkedTensorHeader) + 2 * Order * sizeof(uint64_t);
+        Expect(fileSize >= metadataSize, "chunked tensor file is truncated: " + path);
+
+        ChunkedTensorHeader header;
+        mFile.ReadAt(&header, sizeof(header), 0);
+        Expect(header.magic == ChunkedTensorMagic, "not a chunked tensor file: " + path);
+        Expect(header.version == ChunkedTensorVersion, "unsupported chunked tensor file version: " + path);
+        Expect(header.dataType == DataTypeOf<T>() && header.elementSize == sizeof(T), "chunked tensor file element type does not match: " + path);
+        Expect(header.order == Order, "chunked tensor file order does not match: " + path);
+        Expect(header.dataOffset >= metadataSize && header.dataOffset % TensorFileAlignment == 0, "chunked tensor file data is misaligned: " + path);
+
+        std::array<uint64_t, 2 * Order> metadata{};
+        mFile.ReadAt(metadata.data(), sizeof(metadata), sizeof(header));
+        std::array<size_t, Order> shape{};
+        std::array<size_t, Order> chunkShape{};
+        for (size_t i = 0; i < Order; ++i)
+        {
+            shape[i] = static_cast<size_t>(metadata[i]);
+            chunkShape[i] = static_cast<size_t>(metadata[Order + i]);
+        }
+
+        SetLayout(shape, chunkShape, static_cast<size_t>(header.dataOffset));
+        Expect(header.chunkStride == mChunkStride, "chunked tensor file chunk stride does not match its chunk shape: " + path);
+        Expect(fileSize >= ChunkOffset(mChunkCount), "chunked tensor file data is truncated: " + path);
+    }
+
+    ChunkedTensor(ChunkedTensor const&) = delete;
+    ChunkedTensor& operator=(ChunkedTensor const&) = delete;
+
+    /*
+     * Write back modified chunks. Errors are lost here; call Flush first to see them.
+     */
+    ~ChunkedTensor()
+    {
+        mLoader.Wait();
+        try
+        {
+            Flush();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    auto Shape() const -> std::array<size_t, Order>
+    {
+        return mShape;
+    }
+
+    auto ChunkShape() const -> std::array<size_t, Order>
+    {
+        return mChunkShape;
+    }
+
+    /*
+     * The number of chunks along each dimension.
+     */
+    auto ChunkGrid() const -> std::array<size_t, Order>
+    {
+        return mGrid;
+    }
+
+    auto ChunkCount() const -> size_t
+    {
+        return mChunkCount;
+    }
+
+    /*
+     * Bytes of chunks currently held in the cache.
+     */
+    auto ResidentBytes() -> size_t
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        return mResidentBytes;
+    }
+
+    /*
+     * The block given by one Range per dimension, as a read-only view. A block within a single chunk is viewed in place,
+     * and the chunk stays in memory while the owner is held; other blocks are copied into a new Tensor. Use Write or
+     * ForEachChunk to change the tensor.
+     */
+    template <typename... Ranges>
+        requires(sizeof...(Ranges) == Order && (std::is_same_v<std::decay_t<Ranges>, Range> && ...))
+    auto Slice(Ranges... ranges) -> ChunkedSlice<T, Order>
+    {
+        std::array<Range, Order> block = {ranges...};
+        std::array<size_t, Order> start{};
+        std::array<size_t, Order> stop{};
+        std::array<size_t, Order> shape{};
+        bool single = true;
+        for (size_t i = 0; i < Order; ++i)
+        {
+            Expect(block[i].start <= block[i].stop && block[i].stop <= mShape[i], "chunked tensor slice out of range");
+            start[i] = block[i].start;
+            stop[i] = block[i].stop;
+            shape[i] = stop[i] - start[i];
+            single = single && shape[i] > 0 && start[i] / mChunkShape[i] == (stop[i] - 1) / mChunkShape[i];
+        }
+
+        if (single)
+        {
+            std::array<size_t, Order> position{};
+            for (size_t i = 0; i < Order; ++i)
+            {
+                position[i] = start[i] / mChunkShape[i];
+            }
+            auto chunk = Acquire(ChunkIndex(position), false);
+            auto strides = chunk->Strides();
+            size_t offset = 0;
+            for (size_t i = 0; i < Order; ++i)
+            {
+                offset += (start[i] - position[i] * mChunkShape[i]) * strides[i];
+            }
+            View<T const, Order> view(chunk->Data(), shape, strides, offset);
+            return {std::move(chunk), view};
+        }
+
+        auto copy = std::make_shared<Tensor<T, Order>>(shape, Uninitialized);
+        auto copyStrides = copy->Strides();
+        ForEachOverlap(start, stop, [&](size_t index, std::array<size_t, Order> const& first, std::array<size_t, Order> const& last)
+        {
+            auto chunk = Acquire(index, false);
+            auto chunkStrides = chunk->Strides();
+            auto chunkPosition = ChunkPosition(index);
+            std::array<size_t, Order> extent{};
+            size_t chunkOffset = 0;
+            size_t copyOffset = 0;
+            for (size_t i = 0; i < Order; ++i)
+            {
+                extent[i] = last[i] - first[i];
+                chunkOffset += (first[i] - chunkPosition[i] * mChunkShape[i]) * chunkStrides[i];
+                copyOffset += (first[i] - start[i]) * copyStrides[i];
+            }
+            View<T, Order> source(chunk->Data(), extent, chunkStrides, chunkOffset);
+            View<T, Order> destination(copy->Data(), extent, copyStrides, copyOffset);
+            CopyElementwise<View<T, Order>, View<T, Order>, Order>(source, destination);
+        });
+        View<T const, Order> view(copy->Data(), shape, copyStrides, 0);
+        return {std::move(copy), view};
+    }
+
+    /*
+     * Copy a Tensor or View into the block of the tensor starting at `origin`, through the cache.
+     * The file is updated when the chunks are evicted or flushed.
+     */
+    template <typename Container>
+    auto Write(std::array<size_t, Order> const& origin, Container const& source) -> void
+    {
+        static_assert(TensorTraits<Container>::order == Order, "Write takes a container of the same order");
+        static_assert(std::is_same_v<std::remove_const_t<typename TensorTraits<Container>::value_type>, T>, "Write takes a container of the same value type");
+        Expect(mFile.IsWritable(), "chunked tensor file is read-only");
+
+        auto shape = source.Shape();
+        auto sourceStrides = source.Strides();
+        std::array<size_t, Order> stop{};
+        for (size_t i = 0; i < Order; ++i)
+        {
+            Expect(origin[i] <= mShape[i] && shape[i] <= mShape[i] - origin[i], "chunked tensor block out of range");
+            stop[i] = origin[i] + shape[i];
+        }
+
+        // the source is only read from, through a view of its own elements
+        T* sourceOrigin = const_cast<T*>(Origin(source));
+        ForEachOverlap(origin, stop, [&](size_t index, std::array<size_t, Order> const& first, std::array<size_t, Order> const& last)
+        {
+            auto chunk = Acquire(index, true);
+            auto chunkStrides = chunk->Strides();
+            auto chunkPosition = ChunkPosition(index);
+            std::array<size_t, Order> extent{};
+            size_t chunkOffset = 0;
+            size_t sourceOffset = 0;
+            for (size_t i = 0; i < Order; ++i)
+            {
+                extent[i] = last[i] - first[i];
+                chunkOffset += (first[i] - chunkPosition[i] * mChunkShape[i]) * chunkStrides[i];
+                sourceOffset += (first[i] - origin[i]) * sourceStrides[i];
+            }
+            View<T, Order> part(sourceOrigin, extent, sourceStrides, sourceOffset);
+            View<T, Order> destination(chunk->Data(), extent, chunkStrides, chunkOffset);
+            CopyElementwise<View<T, Order>, View<T, Order>, Order>(part, destination);
+        });
+    }
+
+    /*
+     * Start reading the chunks overlapping a block, given by one Range per dimension, into the cache on the loader
+     * threads, so that a later Slice of it does not wait for the file. The returned handle completes once they are
+     * resident; it never fails, as errors are reported when the chunks are used. Prefetching more than the cache holds
+     * evicts the first chunks again.
+     */
+    template <typename... Ranges>
+        requires(sizeof...(Ranges) == Order && (std::is_same_v<std::decay_t<Ranges>, Range> && ...))
+    auto Prefetch(Ranges... ranges) -> DispatchHandle
+    {
+        std::array<Range, Order> block = {ranges...};
+        std::array<size_t, Order> start{};
+        std::array<size_t, Order> stop{};
+        for (size_t i = 0; i < Order; ++i)
+        {
+            start[i] = block[i].start;
+            stop[i] = block[i].stop;
+        }
+        std::vector<size_t> indices = OverlappingChunks(start, stop);
+        return PrefetchChunks(std::move(indices));
+    }
+
+    /*
+     * Call `callable(chunk, origin)` for every chunk, with a View of the part of the chunk within the tensor and the
+     * position of its first element in the tensor. Chunks are processed in row-major order of their position, in waves
+     * of one chunk per thread of the dispatcher thread pool, while the loader threads read the chunks of the next wave
+     * as far as the cache has room for both. With ChunkAccess::ReadWrite, changes made through the views are written
+     * back to the file.
+     */
+    template <typename Callable>
+    auto ForEachChunk(Callable&& callable, ChunkAccess access = ChunkAccess::ReadOnly) -> void
+    {
+        bool write = access == ChunkAccess::ReadWrite;
+        Expect(!write || mFile.IsWritable(), "chunked tensor file is read-only");
+
+        size_t wave = GetDispatcherThreadPool().Threads();
+        size_t capacity = std::max<size_t>(mCacheBytes / std::max<size_t>(mChunkBytes, 1), 1);
+        size_t ahead = capacity > wave ? std::min(wave, capacity - wave) : 0;
+
+        std::vector<DispatchHandle> prefetches;
+        auto finish = [&]()
+        {
+            for (DispatchHandle const& handle : prefetches)
+            {
+                handle.Wait();
+            }
+        };
+
+        try
+        {
+            for (size_t first = 0; first < mChunkCount; first += wave)
+            {
+                size_t last = std::min(first + wave, mChunkCount);
+                std::vector<size_t> next;
+                for (size_t index = last; index < std::min(last + ahead, mChunkCount); ++index)
+                {
+                    next.push_back(index);
+                }
+                prefetches.push_back(PrefetchChunks(std::move(next)));
+
+                DispatchRow(last - first, [&](size_t t)
+                {
+                    size_t index = first + t;
+                    auto chunk = Acquire(index, write);
+                    auto position = ChunkPosition(index);
+                    for (size_t i = 0; i < Order; ++i)
+                    {
+                        position[i] *= mChunkShape[i];
+                    }
+                    callable(ChunkView(*chunk, index), position);
+                });
+            }
+        }
+        catch (...)
+        {
+            finish();
+            throw;
+        }
+        finish();
+        Trim();
+    }
+
+    /*
+     * Write every modified chunk back to the file, and wait for write-backs on eviction in progress on other threads.
+     * Chunks still in use stay marked as modified, as they may change after this. The chunks are written without
+     * holding the cache lock, pinned so that they are not evicted meanwhile.
+     */
+    auto Flush() -> void
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        std::vector<std::pair<size_t, std::shared_ptr<Tensor<T, Order>>>> writes;
+        for (auto& [index, cached] : mChunks)
+        {
+            if (cached.buffer && cached.dirty)
+            {
+                cached.dirty = IsPinned(*cached.buffer);
+                writes.emplace_back(index, Pin(cached.buffer));
+            }
+        }
+        lock.unlock();
+
+        std::exception_ptr error;
+        for (size_t i = 0; i < writes.size(); ++i)
+        {
+            try
+            {
+                mFile.WriteAt(writes[i].second->Data(), mChunkBytes, ChunkOffset(writes[i].first));
+                writes[i].second = nullptr;
+            }
+            catch (...)
+            {
+                error = error ? error : std::current_exception();
+            }
+        }
+
+        lock.lock();
+        for (auto const& [index, chunk] : writes)
+        {
+            if (chunk)
+            {
+                mChunks.find(index)->second.dirty = true;
+            }
+        }
+        mLoaded.wait(lock, [this]()
+        {
+            return mWriting == 0;
+        });
+        lock.unlock();
+        writes.clear();
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+};
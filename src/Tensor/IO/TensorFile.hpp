@@ -0,0 +1,346 @@
+#pragma once
+
+#include "../Containers/Tensor.hpp"
+#include "../Containers/Traits.hpp"
+#include "../Containers/View.hpp"
+#include "../Utilities/Layout.hpp"
+
+#include <Expect.hpp>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Element types which can be stored in a tensor file.
+ */
+enum class DataType : uint32_t
+{
+    Int8 = 1,
+    UInt8 = 2,
+    Int16 = 3,
+    UInt16 = 4,
+    Int32 = 5,
+    UInt32 = 6,
+    Int64 = 7,
+    UInt64 = 8,
+    Float32 = 9,
+    Float64 = 10,
+    Float16 = 11,
+    BFloat16 = 12,
+};
+
+template <typename T>
+constexpr auto DataTypeOf() -> DataType
+{
+    using U = std::remove_cv_t<T>;
+    if constexpr (std::is_same_v<U, float>)
+    {
+        return DataType::Float32;
+    }
+    else if constexpr (std::is_same_v<U, double>)
+    {
+        return DataType::Float64;
+    }
+    else if constexpr (std::is_same_v<U, ::Float16>)
+    {
+        return DataType::Float16;
+    }
+    else if constexpr (std::is_same_v<U, ::BFloat16>)
+    {
+        return DataType::BFloat16;
+    }
+    else
+    {
+        static_assert(std::is_integral_v<U> && !std::is_same_v<U, bool>, "unsupported tensor file element type");
+        constexpr DataType types[] = {DataType::Int8, DataType::Int16, DataType::Int32, DataType::Int64};
+        constexpr size_t index = std::bit_width(sizeof(U)) - 1;
+        return static_cast<DataType>(static_cast<uint32_t>(types[index]) + (std::is_unsigned_v<U> ? 1 : 0));
+    }
+}
+
+/*
+ * Tensor file layout, in little-endian byte order:
+ *
+ *     TensorFileHeader
+ *     uint64_t shape[order]
+ *     uint64_t strides[order]       in elements
+ *     padding to dataOffset         a multiple of TensorFileAlignment
+ *     raw elements                  dataSize bytes, addressed through the strides
+ */
+inline constexpr std::array<char, 8> TensorFileMagic = {'T', 'E', 'N', 'S', 'O', 'R', '\0', '\0'};
+inline constexpr uint32_t TensorFileVersion = 1;
+inline constexpr size_t TensorFileAlignment = 64;
+
+struct TensorFileHeader
+{
+    std::array<char, 8> magic;
+    uint32_t version;
+    DataType dataType;
+    uint32_t order;
+    uint32_t elementSize;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+};
+
+static_assert(sizeof(TensorFileHeader) == 40, "tensor file header must have no padding");
+
+/*
+ * Write a Tensor or View to a tensor file. The elements are stored densely in row-major order, so views are gathered
+ * into a contiguous copy first.
+ */
+template <typename Container>
+auto Save(std::string const& path, Container const& container) -> void
+{
+    using T = std::remove_const_t<typename TensorTraits<Container>::value_type>;
+    constexpr size_t Order = TensorTraits<Container>::order;
+    static_assert(std::endian::native == std::endian::little, "tensor files are only supported on little-endian hosts");
+
+    auto shape = container.Shape();
+    if (!IsContiguous(shape, container.Strides()))
+    {
+        Save(path, Tensor<T, Order>(container));
+        return;
+    }
+
+    auto strides = GetStrides(shape);
+    size_t size = GetSize(shape);
+    size_t metadataSize = sizeof(TensorFileHeader) + 2 * Order * sizeof(uint64_t);
+
+    TensorFileHeader header{};
+    header.magic = TensorFileMagic;
+    header.version = TensorFileVersion;
+    header.dataType = DataTypeOf<T>();
+    header.order = static_cast<uint32_t>(Order);
+    header.elementSize = static_cast<uint32_t>(sizeof(T));
+    header.dataOffset = (metadataSize + TensorFileAlignment - 1) / TensorFileAlignment * TensorFileAlignment;
+    header.dataSize = size * sizeof(T);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    Expect(file.is_open(), "failed to open tensor file for writing: " + path);
+
+    std::array<uint64_t, 2 * Order + 1> metadata{};
+    for (size_t i = 0; i < Order; ++i)
+    {
+        metadata[i] = shape[i];
+        metadata[Order + i] = strides[i];
+    }
+    std::array<char, TensorFileAlignment> padding{};
+
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    file.write(reinterpret_cast<char const*>(metadata.data()), 2 * Order * sizeof(uint64_t));
+    file.write(padding.data(), static_cast<std::streamsize>(header.dataOffset - metadataSize));
+    file.write(reinterpret_cast<char const*>(Origin(container)), static_cast<std::streamsize>(header.dataSize));
+    Expect(file.good(), "failed to write tensor file: " + path);
+}
+
+/*
+ * A read-only file mapped into memory with private, copy-on-write pages: writes through the mapping are visible to this
+ * process only and never reach the file, and untouched pages are shared with every other process mapping the same file.
+ */
+class FileMapping
+{
+private:
+
+    std::byte* mData = nullptr;
+    size_t mSize = 0;
+#if defined(_WIN32)
+    HANDLE mFile = INVALID_HANDLE_VALUE;
+    HANDLE mMapping = nullptr;
+#endif
+
+public:
+
+    explicit FileMapping(std::string const& path)
+    {
+#if defined(_WIN32)
+        mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        Expect(mFile != INVALID_HANDLE_VALUE, "failed to open tensor file: " + path);
+
+        LARGE_INTEGER size;
+        GetFileSizeEx(mFile, &size);
+        mSize = static_cast<size_t>(size.QuadPart);
+
+        mMapping = CreateFileMappingA(mFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (mMapping != nullptr)
+        {
+            mData = static_cast<std::byte*>(MapViewOfFile(mMapping, FILE_MAP_COPY, 0, 0, 0));
+        }
+        if (mData == nullptr)
+        {
+            Close();
+            Expect(false, "failed to map tensor file: " + path);
+        }
+#else
+        int descriptor = open(path.c_str(), O_RDONLY);
+        Expect(descriptor >= 0, "failed to open tensor file: " + path);
+
+        struct stat status;
+        if (fstat(descriptor, &status) != 0 || status.st_size == 0)
+        {
+            close(descriptor);
+            Expect(false, "failed to read tensor file: " + path);
+        }
+        mSize = static_cast<size_t>(status.st_size);
+
+        void* address = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+        close(descriptor);
+        Expect(address != MAP_FAILED, "failed to map tensor file: " + path);
+        mData = static_cast<std::byte*>(address);
+#endif
+    }
+
+    FileMapping(FileMapping const&) = delete;
+    FileMapping& operator=(FileMapping const&) = delete;
+
+    ~FileMapping()
+    {
+        Close();
+    }
+
+    auto Data() const -> std::byte*
+    {
+        return mData;
+    }
+
+    auto Size() const -> size_t
+    {
+        return mSize;
+    }
+
+private:
+
+    auto Close() -> void
+    {
+#if defined(_WIN32)
+        if (mData != nullptr)
+        {
+            UnmapViewOfFile(mData);
+        }
+        if (mMapping != nullptr)
+        {
+            CloseHandle(mMapping);
+        }
+        if (mFile != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(mFile);
+        }
+#else
+        if (mData != nullptr)
+        {
+            munmap(mData, mSize);
+        }
+#endif
+        mData = nullptr;
+    }
+};
+
+/*
+ * A View into a memory-mapped tensor file, and the mapping which keeps it valid.
+ * The view, and any view sliced from it, must not outlive the owner.
+ */
+template <typename T, size_t Order>
+struct MappedTensor
+{
+    std::shared_ptr<FileMapping> owner;
+    View<T, Order> view;
+};
+
+/*
+ * Add or multiply sizes read from a file, throwing with the given message rather than wrapping around, so that a crafted
+ * header cannot make a bounds check pass.
+ */
+inline auto CheckedAdd(size_t a, size_t b, std::string const& message) -> size_t
+{
+    Expect(b <= SIZE_MAX - a, message);
+    return a + b;
+}
+
+inline auto CheckedMultiply(size_t a, size_t b, std::string const& message) -> size_t
+{
+    Expect(a == 0 || b <= SIZE_MAX / a, message);
+    return a * b;
+}
+
+/*
+ * Map a tensor file into memory and view its elements in place, without reading or copying them.
+ * Pages are loaded from the file on first access. Writing through the view modifies a private copy of the touched pages
+ * only. The element type and order must match the file.
+ */
+template <typename T, size_t Order>
+auto LoadMapped(std::string const& path) -> MappedTensor<T, Order>
+{
+    static_assert(std::endian::native == std::endian::little, "tensor files are only supported on little-endian hosts");
+
+    auto mapping = std::make_shared<FileMapping>(path);
+    size_t fileSize = mapping->Size();
+    Expect(fileSize >= sizeof(TensorFileHeader), "tensor file is truncated: " + path);
+
+    TensorFileHeader header;
+    std::memcpy(&header, mapping->Data(), sizeof(header));
+    Expect(header.magic == TensorFileMagic, "not a tensor file: " + path);
+    Expect(header.version == TensorFileVersion, "unsupported tensor file version: " + path);
+    Expect(header.dataType == DataTypeOf<T>() && header.elementSize == sizeof(T), "tensor file element type does not match: " + path);
+    Expect(header.order == Order, "tensor file order does not match: " + path);
+
+    size_t metadataSize = sizeof(TensorFileHeader) + 2 * Order * sizeof(uint64_t);
+    Expect(fileSize >= metadataSize, "tensor file is truncated: " + path);
+    Expect(header.dataOffset >= metadataSize && header.dataOffset % TensorFileAlignment == 0, "tensor file data is misaligned: " + path);
+    Expect(header.dataOffset <= fileSize && header.dataSize <= fileSize - header.dataOffset, "tensor file data is truncated: " + path);
+
+    std::array<uint64_t, 2 * Order + 1> metadata{};
+    std::memcpy(metadata.data(), mapping->Data() + sizeof(TensorFileHeader), 2 * Order * sizeof(uint64_t));
+
+    std::array<size_t, Order> shape{};
+    std::array<size_t, Order> strides{};
+    bool empty = false;
+    for (size_t i = 0; i < Order; ++i)
+    {
+        shape[i] = static_cast<size_t>(metadata[i]);
+        strides[i] = static_cast<size_t>(metadata[Order + i]);
+        empty = empty || shape[i] == 0;
+    }
+    if (!empty)
+    {
+        std::string const overflow = "tensor file strides address elements past its data: " + path;
+        size_t extent = 0;
+        for (size_t i = 0; i < Order; ++i)
+        {
+            extent = CheckedAdd(extent, CheckedMultiply(shape[i] - 1, strides[i], overflow), overflow);
+        }
+        Expect(CheckedMultiply(CheckedAdd(extent, 1, overflow), sizeof(T), overflow) <= header.dataSize, overflow);
+    }
+
+    T* data = reinterpret_cast<T*>(mapping->Data() + header.dataOffset);
+    return {std::move(mapping), View<T, Order>(data, shape, strides, 0)};
+}
+
+/*
+ * Read a tensor file into a newly allocated Tensor.
+ */
+template <typename T, size_t Order>
+auto Load(std::string const& path) -> Tensor<T, Order>
+{
+    return Tensor<T, Order>(LoadMapped<T, Order>(path).view);
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "../Containers/Tensor.hpp"
+#include "../Containers/View.hpp"
+#include "../Utilities/Layout.hpp"
+
+#include <Expect.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+/*
+ * DLPack is the common in-memory tensor exchange structure used by NumPy, PyTorch, JAX, TVM and others.
+ * When dlpack.h is available it is used directly; otherwise the subset of its ABI needed here is declared, with the same
+ * names and layout, so either can be passed across library boundaries.
+ */
+#if __has_include(<dlpack/dlpack.h>)
+#include <dlpack/dlpack.h>
+#else
+extern "C"
+{
+    typedef enum
+    {
+        kDLCPU = 1,
+        kDLCUDA = 2,
+        kDLCUDAHost = 3,
+    } DLDeviceType;
+
+    typedef struct
+    {
+        DLDeviceType device_type;
+        int32_t device_id;
+    } DLDevice;
+
+    typedef enum
+    {
+        kDLInt = 0U,
+        kDLUInt = 1U,
+        kDLFloat = 2U,
+        kDLBfloat = 4U,
+    } DLDataTypeCode;
+
+    typedef struct
+    {
+        uint8_t code;
+        uint8_t bits;
+        uint16_t lanes;
+    } DLDataType;
+
+    typedef struct
+    {
+        void* data;
+        DLDevice device;
+        int32_t ndim;
+        DLDataType dtype;
+        int64_t* shape;
+        int64_t* strides;
+        uint64_t byte_offset;
+    } DLTensor;
+
+    typedef struct DLManagedTensor
+    {
+        DLTensor dl_tensor;
+        void* manager_ctx;
+        void (*deleter)(struct DLManagedTensor* self);
+    } DLManagedTensor;
+}
+#endif
+
+template <typename T>
+constexpr auto DLDataTypeOf() -> DLDataType
+{
+    using U = std::remove_cv_t<T>;
+    if constexpr (std::is_same_v<U, Float16>)
+    {
+        return DLDataType{kDLFloat, 16, 1};
+    }
+    else if constexpr (std::is_same_v<U, BFloat16>)
+    {
+        return DLDataType{kDLBfloat, 16, 1};
+    }
+    else
+    {
+        static_assert(std::is_arithmetic_v<U> && !std::is_same_v<U, bool>, "unsupported DLPack element type");
+
+        uint8_t code = std::is_floating_point_v<U> ? kDLFloat : std::is_signed_v<U> ? kDLInt : kDLUInt;
+        return DLDataType{code, static_cast<uint8_t>(sizeof(U) * 8), 1};
+    }
+}
+
+/*
+ * Owner of a tensor exported through DLPack, with the shape and strides the DLTensor points to.
+ */
+template <typename T, size_t Order, typename Allocator>
+struct DLPackExport
+{
+    Tensor<T, Order, Allocator> tensor;
+    std::array<int64_t, Order> shape;
+    std::array<int64_t, Order> strides;
+    DLManagedTensor managed;
+};
+
+/*
+ * Hand a tensor's buffer to another library without copying it.
+ * The returned structure owns the tensor; the consumer calls its deleter when done with it.
+ */
+template <typename T, size_t Order, typename Allocator>
+auto ToDLPack(Tensor<T, Order, Allocator>&& tensor) -> DLManagedTensor*
+{
+    auto* context = new DLPackExport<T, Order, Allocator>{std::move(tensor), {}, {}, {}};
+    auto shape = context->tensor.Shape();
+    auto strides = context->tensor.Strides();
+    for (size_t i = 0; i < Order; ++i)
+    {
+        context->shape[i] = static_cast<int64_t>(shape[i]);
+        context->strides[i] = static_cast<int64_t>(strides[i]);
+    }
+
+    DLTensor& dl = context->managed.dl_tensor;
+    dl.data = context->tensor.Data();
+    dl.device = DLDevice{kDLCPU, 0};
+    dl.ndim = static_cast<int32_t>(Order);
+    dl.dtype = DLDataTypeOf<T>();
+    dl.shape = context->shape.data();
+    dl.strides = context->strides.data();
+    dl.byte_offset = 0;
+
+    context->managed.manager_ctx = context;
+    context->managed.deleter = [](DLManagedTensor* self)
+    {
+        delete static_cast<DLPackExport<T, Order, Allocator>*>(self->manager_ctx);
+    };
+    return &context->managed;
+}
+
+/*
+ * Check that a DLTensor holds CPU elements of type T with the given order, and get the address of its first element.
+ */
+template <typename T, size_t Order>
+auto CheckDLTensor(DLTensor const& dl) -> T*
+{
+    DLDataType expected = DLDataTypeOf<T>();
+    Expect(dl.device.device_type == kDLCPU || dl.device.device_type == kDLCUDAHost, "DLPack tensor is not in host memory");
+    Expect(dl.dtype.code == expected.code && dl.dtype.bits == expected.bits && dl.dtype.lanes == 1, "DLPack tensor element type does not match");
+    Expect(dl.ndim == static_cast<int32_t>(Order), "DLPack tensor order does not match");
+    for (size_t i = 0; i < Order; ++i)
+    {
+        Expect(dl.shape[i] >= 0 && (dl.strides == nullptr || dl.strides[i] >= 0), "DLPack tensor has negative extents or strides");
+    }
+    if (dl.data == nullptr)
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<T*>(static_cast<std::byte*>(dl.data) + dl.byte_offset);
+}
+
+/*
+ * Refer to the elements of a DLTensor, with any non-negative strides, without taking ownership.
+ * Null strides denote a dense row-major layout.
+ */
+template <typename T, size_t Order>
+auto ViewDLPack(DLTensor const& dl) -> View<T, Order>
+{
+    T* data = CheckDLTensor<T, Order>(dl);
+
+    std::array<size_t, Order> shape{};
+    for (size_t i = 0; i < Order; ++i)
+    {
+        shape[i] = static_cast<size_t>(dl.shape[i]);
+    }
+    std::array<size_t, Order> strides = GetStrides(shape);
+    if (dl.strides != nullptr)
+    {
+        for (size_t i = 0; i < Order; ++i)
+        {
+            strides[i] = static_cast<size_t>(dl.strides[i]);
+        }
+    }
+    return View<T, Order>(data, shape, strides, 0);
+}
+
+/*
+ * Take ownership of a tensor from another library without copying it; its deleter is called when the Tensor releases the
+ * buffer. The elements must be dense and row-major, as a Tensor requires; use ViewDLPack for other layouts.
+ * If the import fails, an exception is thrown and ownership stays with the caller.
+ */
+template <typename T, size_t Order>
+auto FromDLPack(DLManagedTensor* managed) -> Tensor<T, Order>
+{
+    Expect(managed != nullptr, "DLPack tensor is null");
+    View<T, Order> view = ViewDLPack<T, Order>(managed->dl_tensor);
+    Expect(IsContiguous(view.Shape(), view.Strides()), "DLPack tensor is not dense and row-major");
+
+    return Tensor<T, Order>(view.Data(), view.Shape(), [managed](T*)
+    {
+        if (managed->deleter != nullptr)
+        {
+            managed->deleter(managed);
+        }
+    });
+}
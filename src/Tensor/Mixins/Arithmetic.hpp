@@ -0,0 +1,162 @@
+#pragma once
+
+#include "../Containers/Expression.hpp"
+
+#include <type_traits>
+#include <utility>
+
+/*
+ * Operand pairs accepted by the elementwise arithmetic operators: two tensor-like operands, or one tensor-like operand
+ * and a scalar.
+ */
+template <typename L, typename R>
+concept ArithmeticOperands = (TensorLike<L> && TensorLike<R>)
+                          || (TensorLike<L> && ExpressionScalar<R>)
+                          || (ExpressionScalar<L> && TensorLike<R>);
+
+/*
+ * Combine two operands into a lazily evaluated binary expression.
+ * Scalars take on the value type of the other operand. Tensor-like operands of different shapes are broadcast to a
+ * common shape with NumPy's rules, e.g. a {3} bias with a {2, 3} matrix, without copying either.
+ */
+template <typename Operation, typename L, typename R>
+    requires ArithmeticOperands<L, R>
+auto MakeBinaryExpression(L const& left, R const& right)
+{
+    if constexpr (ExpressionScalar<L>)
+    {
+        auto rightExpression = MakeExpression(right);
+        auto leftExpression = MakeExpression<typename TensorTraits<decltype(rightExpression)>::value_type>(left);
+        return BinaryExpression<Operation, decltype(leftExpression), decltype(rightExpression)>(leftExpression, rightExpression);
+    }
+    else if constexpr (ExpressionScalar<R>)
+    {
+        auto leftExpression = MakeExpression(left);
+        auto rightExpression = MakeExpression<typename TensorTraits<decltype(leftExpression)>::value_type>(right);
+        return BinaryExpression<Operation, decltype(leftExpression), decltype(rightExpression)>(leftExpression, rightExpression);
+    }
+    else
+    {
+        auto shape = BroadcastShapes(left.Shape(), right.Shape());
+        auto leftExpression = BroadcastExpression(MakeExpression(left), shape);
+        auto rightExpression = BroadcastExpression(MakeExpression(right), shape);
+        return BinaryExpression<Operation, decltype(leftExpression), decltype(rightExpression)>(leftExpression, rightExpression);
+    }
+}
+
+/*
+ * Apply an operation to every element of a tensor-like operand, lazily.
+ */
+template <typename Operation, TensorLike T>
+auto MakeUnaryExpression(T const& operand)
+{
+    auto expression = MakeExpression(operand);
+    return UnaryExpression<Operation, decltype(expression)>(expression);
+}
+
+template <typename L, typename R>
+    requires ArithmeticOperands<L, R>
+auto operator+(L const& left, R const& right)
+{
+    return MakeBinaryExpression<AddOperation>(left, right);
+}
+
+template <typename L, typename R>
+    requires ArithmeticOperands<L, R>
+auto operator-(L const& left, R const& right)
+{
+    return MakeBinaryExpression<SubtractOperation>(left, right);
+}
+
+template <typename L, typename R>
+    requires ArithmeticOperands<L, R>
+auto operator*(L const& left, R const& right)
+{
+    return MakeBinaryExpression<MultiplyOperation>(left, right);
+}
+
+template <typename L, typename R>
+    requires ArithmeticOperands<L, R>
+auto operator/(L const& left, R const& right)
+{
+    return MakeBinaryExpression<DivideOperation>(left, right);
+}
+
+template <TensorLike T>
+auto operator-(T const& operand)
+{
+    return MakeUnaryExpression<NegateOperation>(operand);
+}
+
+template <TensorLike T>
+auto Abs(T const& operand)
+{
+    return MakeUnaryExpression<AbsOperation>(operand);
+}
+
+template <TensorLike T>
+auto Sqrt(T const& operand)
+{
+    return MakeUnaryExpression<SqrtOperation>(operand);
+}
+
+template <TensorLike T>
+auto Exp(T const& operand)
+{
+    return MakeUnaryExpression<ExpOperation>(operand);
+}
+
+template <TensorLike T>
+auto Log(T const& operand)
+{
+    return MakeUnaryExpression<LogOperation>(operand);
+}
+
+/*
+ * Arithmetic mixin for tensor-like classes.
+ * Provides in-place elementwise arithmetic; the binary operators and math functions above build lazy expressions, which
+ * are evaluated in a single fused pass when assigned to a Tensor or View.
+ */
+template <typename Derived>
+class Arithmetic
+{
+public:
+
+    template <typename Other>
+        requires ArithmeticOperands<Derived, Other>
+    auto operator+=(Other const& other) -> Derived&
+    {
+        return Apply<AddOperation>(other);
+    }
+
+    template <typename Other>
+        requires ArithmeticOperands<Derived, Other>
+    auto operator-=(Other const& other) -> Derived&
+    {
+        return Apply<SubtractOperation>(other);
+    }
+
+    template <typename Other>
+        requires ArithmeticOperands<Derived, Other>
+    auto operator*=(Other const& other) -> Derived&
+    {
+        return Apply<MultiplyOperation>(other);
+    }
+
+    template <typename Other>
+        requires ArithmeticOperands<Derived, Other>
+    auto operator/=(Other const& other) -> Derived&
+    {
+        return Apply<DivideOperation>(other);
+    }
+
+private:
+
+    template <typename Operation, typename Other>
+    auto Apply(Other const& other) -> Derived&
+    {
+        auto& self = static_cast<Derived&>(*this);
+        Evaluate(MakeBinaryExpression<Operation>(self, other), self);
+        return self;
+    }
+};
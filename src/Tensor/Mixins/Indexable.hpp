@@ -4,7 +4,7 @@
 
 #include <array>
 #include <cstddef>
-#include <numeric>
+#include <utility>
 
 /*
  * Indexable mixin for tensor-like classes.
@@ -19,13 +19,13 @@ public:
     static constexpr size_t order = TensorTraits<Derived>::order;
     static constexpr bool has_offset = TensorTraits<Derived>::has_offset;
 
-    inline auto operator()(std::array<size_t, order> const& indices) -> value_type&
+    constexpr auto operator()(std::array<size_t, order> const& indices) -> value_type&
     {
         auto& self = static_cast<Derived&>(*this);
         return self.Data()[this->ComputeLinearIndex(indices)];
     }
 
-    inline auto operator()(std::array<size_t, order> const& indices) const -> value_type const&
+    constexpr auto operator()(std::array<size_t, order> const& indices) const -> value_type const&
     {
         auto& self = static_cast<Derived const&>(*this);
         return self.Data()[this->ComputeLinearIndex(indices)];
@@ -33,16 +33,24 @@ public:
 
 private:
 
-    inline auto ComputeLinearIndex(std::array<size_t, order> const& indices) const -> size_t
+    /*
+     * The sum of index and stride products is unrolled at compile time, so indexing containers whose strides are
+     * constants, such as StaticTensor, folds down to a constant offset for constant indices.
+     */
+    constexpr auto ComputeLinearIndex(std::array<size_t, order> const& indices) const -> size_t
     {
         auto& self = static_cast<Derived const&>(*this);
+        auto strides = self.Strides();
+
+        size_t offset = 0;
         if constexpr (has_offset)
         {
-            return std::inner_product(indices.begin(), indices.end(), self.Strides().begin(), self.Offset());
+            offset = self.Offset();
         }
-        else
+
+        return [&]<size_t... I>(std::index_sequence<I...>)
         {
-            return std::inner_product(indices.begin(), indices.end(), self.Strides().begin(), static_cast<size_t>(0));
-        }
+            return (offset + ... + (indices[I] * strides[I]));
+        }(std::make_index_sequence<order>{});
     }
 };
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "../Containers/Traits.hpp"
+#include "../Utilities/Iterator.hpp"
+#include "../Utilities/Layout.hpp"
+#include "../Utilities/Shape.hpp"
+
+#include <cstddef>
+
+/*
+ * Iterable mixin for tensor-like classes.
+ * Provides begin() and end() over the elements in row-major order, making containers usable with range-based for loops,
+ * standard algorithms and std::ranges. Tensors are always dense, so their iterators are plain pointers; views use
+ * StridedIterator.
+ */
+template <typename Derived>
+class Iterable
+{
+private:
+
+    using element_type = TensorTraits<Derived>::value_type;
+    static constexpr size_t rank = TensorTraits<Derived>::order;
+
+    template <typename T, typename Self>
+    static auto Iterator(Self& self, bool end)
+    {
+        size_t size = GetSize(self.Shape());
+        if constexpr (TensorTraits<Derived>::has_offset)
+        {
+            return StridedIterator<T, rank>(Origin(self), self.Shape(), self.Strides(), static_cast<std::ptrdiff_t>(end ? size : 0));
+        }
+        else
+        {
+            return Origin(self) + (end ? size : 0);
+        }
+    }
+
+public:
+
+    auto begin()
+    {
+        return Iterator<element_type>(static_cast<Derived&>(*this), false);
+    }
+
+    auto end()
+    {
+        return Iterator<element_type>(static_cast<Derived&>(*this), true);
+    }
+
+    auto begin() const
+    {
+        return Iterator<element_type const>(static_cast<Derived const&>(*this), false);
+    }
+
+    auto end() const
+    {
+        return Iterator<element_type const>(static_cast<Derived const&>(*this), true);
+    }
+};
@@ -19,24 +19,26 @@ auto operator<<(std::ostream& out, std::array<T, Order> const& arr) -> std::ostr
     return out;
 }
 
-template <typename T, size_t Order>
+/*
+ * Print the elements of a tensor as nested lists, reading them in row-major order from an iterator.
+ */
+template <typename Iterator, size_t Order>
 auto PrintRecursive(std::ostream& out,
-                    T const& tensor,
+                    Iterator& element,
                     std::array<size_t, Order> const& shape,
-                    std::array<size_t, Order>& indices,
                     size_t currentDimension) -> void
 {
     if (currentDimension == Order)
     {
-        out << tensor(indices);
+        out << *element;
+        ++element;
     }
     else
     {
         out << "[";
         for (size_t i = 0; i < shape[currentDimension]; ++i)
         {
-            indices[currentDimension] = i;
-            PrintRecursive(out, tensor, shape, indices, currentDimension + 1);
+            PrintRecursive(out, element, shape, currentDimension + 1);
             if (i + 1 < shape[currentDimension])
             {
                 out << ", ";
@@ -63,8 +65,8 @@ public:
         auto shape = tensor.Shape();
         out << "    Shape = " << shape << std::endl;
         out << "    Data = ";
-        std::array<size_t, order> indices{};
-        PrintRecursive(out, tensor, shape, indices, 0);
+        auto element = tensor.begin();
+        PrintRecursive(out, element, shape, 0);
         out << std::endl
             << "}" << std::endl;
         return out;
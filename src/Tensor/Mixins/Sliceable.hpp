@@ -2,6 +2,7 @@
 
 #include "../Containers/Forward.hpp"
 #include "../Containers/Traits.hpp"
+#include "../Utilities/Shape.hpp"
 
 #include <array>
 #include <concepts>
@@ -70,9 +71,75 @@ auto SliceImpl(T& tensor, Slices&&... slicePack)
     return View<value_type, NewOrder>{tensor.Data(), newShape, newStrides, offset};
 }
 
+/*
+ * Check that the given axes are a permutation of 0, 1, ..., N - 1.
+ */
+template <size_t... Axes>
+constexpr auto IsPermutation() -> bool
+{
+    std::array<size_t, sizeof...(Axes)> axes = {Axes...};
+    std::array<bool, sizeof...(Axes)> seen{};
+    for (size_t axis : axes)
+    {
+        if (axis >= axes.size() || seen[axis])
+        {
+            return false;
+        }
+        seen[axis] = true;
+    }
+    return true;
+}
+
+template <typename T, size_t... Axes>
+auto PermuteImpl(T& tensor)
+{
+    using value_type = TensorTraits<T>::value_type;
+    static constexpr size_t order = TensorTraits<T>::order;
+    static constexpr bool has_offset = TensorTraits<T>::has_offset;
+
+    static_assert(sizeof...(Axes) == order, "Permute requires one axis per dimension");
+    static_assert(IsPermutation<Axes...>(), "Permute requires each axis exactly once");
+
+    size_t offset = 0;
+    if constexpr (has_offset)
+    {
+        offset = tensor.Offset();
+    }
+
+    auto shape = tensor.Shape();
+    auto strides = tensor.Strides();
+    std::array<size_t, order> newShape = {shape[Axes]...};
+    std::array<size_t, order> newStrides = {strides[Axes]...};
+
+    return View<value_type, order>{tensor.Data(), newShape, newStrides, offset};
+}
+
+template <typename T, size_t... I>
+auto TransposeImpl(T& tensor, std::index_sequence<I...>)
+{
+    return PermuteImpl<T, (sizeof...(I) - 1 - I)...>(tensor);
+}
+
+template <typename T, size_t NewOrder>
+auto BroadcastImpl(T& tensor, std::array<size_t, NewOrder> const& shape)
+{
+    using value_type = TensorTraits<T>::value_type;
+    static constexpr bool has_offset = TensorTraits<T>::has_offset;
+
+    size_t offset = 0;
+    if constexpr (has_offset)
+    {
+        offset = tensor.Offset();
+    }
+
+    auto strides = BroadcastStrides(tensor.Shape(), tensor.Strides(), shape);
+    return View<value_type, NewOrder>{tensor.Data(), shape, strides, offset};
+}
+
 /*
  * Sliceable mixin for tensor-like classes.
- * Provides multidimensional slicing via the Slice() function.
+ * Provides multidimensional slicing via the Slice() function, reordering of dimensions via Permute() and Transpose(),
+ * and broadcasting via BroadcastTo(). All of them return views of the same elements, without copying any.
  */
 template <typename Derived, size_t Order>
 class Sliceable
@@ -85,4 +152,35 @@ public:
         auto& self = static_cast<Derived&>(*this);
         return SliceImpl<Derived>(self, std::forward<Slices>(slices)...);
     }
+
+    /*
+     * Dimension i of the returned view is dimension Axes[i] of this container, e.g. Permute<2, 0, 1>() turns HWC into CHW.
+     */
+    template <size_t... Axes>
+    auto Permute()
+    {
+        auto& self = static_cast<Derived&>(*this);
+        return PermuteImpl<Derived, Axes...>(self);
+    }
+
+    /*
+     * Reverse the order of the dimensions, which transposes a matrix.
+     */
+    auto Transpose()
+    {
+        auto& self = static_cast<Derived&>(*this);
+        return TransposeImpl<Derived>(self, std::make_index_sequence<Order>{});
+    }
+
+    /*
+     * View the elements as if they had the given shape, repeating them along dimensions of extent 1 and in front of the
+     * existing dimensions, with NumPy's broadcasting rules. Repeated elements are addressed with a stride of 0, so the
+     * view should only be read from.
+     */
+    template <size_t NewOrder>
+    auto BroadcastTo(std::array<size_t, NewOrder> const& shape)
+    {
+        auto& self = static_cast<Derived&>(*this);
+        return BroadcastImpl<Derived, NewOrder>(self, shape);
+    }
 };
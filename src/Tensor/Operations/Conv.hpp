@@ -0,0 +1,371 @@
+#pragma once
+
+#include "../Containers/Tensor.hpp"
+#include "../Containers/Traits.hpp"
+#include "../Simd/Conv.hpp"
+#include "../Utilities/Copy.hpp"
+#include "../Utilities/Layout.hpp"
+#include "MatMul.hpp"
+
+#include <Expect.hpp>
+#include <ParallelFor.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+
+/*
+ * How a convolution is computed. Direct runs a register-blocked microkernel over the zero-padded input, which suits small
+ * kernels and few channels. Im2Col gathers every receptive field into a column of a matrix and multiplies it with the
+ * weights by Gemm, which suits many channels, at the cost of a matrix kernel-size times larger than the input.
+ */
+enum class ConvAlgorithm
+{
+    Auto,
+    Direct,
+    Im2Col,
+};
+
+struct Conv2DParameters
+{
+    std::array<size_t, 2> stride = {1, 1};
+    std::array<size_t, 2> padding = {0, 0};
+    std::array<size_t, 2> dilation = {1, 1};
+    ConvAlgorithm algorithm = ConvAlgorithm::Auto;
+};
+
+/*
+ * ConvAlgorithm::Auto uses im2col for receptive fields, channels x kernel height x kernel width, of at least this many
+ * taps when the output rows are too narrow to fill half of the direct microkernel's tiles. It also uses im2col for
+ * horizontal strides other than 1, where only the portable direct microkernel applies. Otherwise it uses the direct
+ * microkernel.
+ */
+inline constexpr size_t ConvIm2ColThreshold = 256;
+
+/*
+ * Largest tile, kb x xb, computed by any convolution microkernel.
+ */
+inline constexpr size_t ConvMaxTile = 6 * 32;
+
+/*
+ * Number of output positions along one dimension of a convolution.
+ */
+inline auto Conv2DOutputExtent(size_t extent, size_t kernel, size_t stride, size_t padding, size_t dilation) -> size_t
+{
+    size_t span = dilation * (kernel - 1) + 1;
+    Expect(kernel > 0 && extent + 2 * padding >= span, "convolution kernel is larger than the padded input");
+    return (extent + 2 * padding - span) / stride + 1;
+}
+
+/*
+ * Call `callable` with the whole range on this thread, or with tiles of it in parallel on the dispatcher thread pool.
+ */
+template <size_t N, typename Callable>
+auto ConvFor(bool parallel, IndexRange<N> const& range, std::array<size_t, N> const& tile, Callable&& callable) -> void
+{
+    if (parallel)
+    {
+        ParallelFor(range, tile, callable);
+    }
+    else
+    {
+        callable(range);
+    }
+}
+
+/*
+ * Copy a C x H x W image with any strides into the interior of a zero-filled C x paddedHeight x paddedWidth tensor.
+ */
+template <typename T>
+auto PadImage(T const* input, std::array<size_t, 3> const& shape, std::array<size_t, 3> const& strides, std::array<size_t, 2> const& padding, size_t paddedHeight, size_t paddedWidth) -> Tensor<T, 3>
+{
+    auto [channels, height, width] = shape;
+    Tensor<T, 3> padded({channels, paddedHeight, paddedWidth});
+
+    bool parallel = channels * height * width * sizeof(T) >= ParallelCopyThreshold;
+    ConvFor(parallel, IndexRange<1>{{0}, {channels * height}}, {16}, [&](IndexRange<1> const& rows)
+    {
+        for (size_t row = rows.begin[0]; row < rows.end[0]; ++row)
+        {
+            size_t c = row / height;
+            size_t y = row % height;
+            T* destination = padded.Data() + (c * paddedHeight + y + padding[0]) * paddedWidth + padding[1];
+            CopyRun(input + c * strides[0] + y * strides[1], strides[2], destination, 1, width);
+        }
+    });
+    return padded;
+}
+
+/*
+ * Convolve one C x H x W image with K x C x R x S weights into a K x OH x OW output, by the direct microkernel.
+ * Output rows of each block of kb filters are computed in parallel.
+ */
+template <typename T>
+auto Conv2DDirect(T const* input, std::array<size_t, 3> const& shape, std::array<size_t, 3> const& strides,
+                  T const* weights, std::array<size_t, 4> const& weightShape, std::array<size_t, 4> const& weightStrides,
+                  T* output, std::array<size_t, 3> const& outputShape, std::array<size_t, 3> const& outputStrides,
+                  Conv2DParameters const& parameters) -> void
+{
+    auto [filters, channels, kernelHeight, kernelWidth] = weightShape;
+    size_t outputHeight = outputShape[1];
+    size_t outputWidth = outputShape[2];
+    auto [strideY, strideX] = parameters.stride;
+    auto [dilationY, dilationX] = parameters.dilation;
+
+    ConvKernel<T> kernel = SelectConvKernel<T>(strideX);
+    size_t kb = kernel.kb;
+    size_t xb = kernel.xb;
+    size_t taps = channels * kernelHeight * kernelWidth;
+    size_t filterBlocks = (filters + kb - 1) / kb;
+    size_t columnBlocks = (outputWidth + xb - 1) / xb;
+
+    // the last tile of a row reads a full xb columns, so the padded rows are widened to keep that within the buffer
+    size_t paddedHeight = shape[1] + 2 * parameters.padding[0];
+    size_t paddedWidth = std::max(shape[2] + 2 * parameters.padding[1], (columnBlocks * xb - 1) * strideX + (kernelWidth - 1) * dilationX + 1);
+    Tensor<T, 3> padded = PadImage(input, shape, strides, parameters.padding, paddedHeight, paddedWidth);
+
+    // pack the weights of each block of kb filters tap by tap, padding the last block with zero filters
+    Tensor<T, 2> packed({filterBlocks, taps * kb});
+    for (size_t k = 0; k < filters; ++k)
+    {
+        T* panel = packed.Data() + (k / kb) * taps * kb + k % kb;
+        for (size_t c = 0, tap = 0; c < channels; ++c)
+        {
+            for (size_t r = 0; r < kernelHeight; ++r)
+            {
+                for (size_t s = 0; s < kernelWidth; ++s, ++tap)
+                {
+                    panel[tap * kb] = weights[k * weightStrides[0] + c * weightStrides[1] + r * weightStrides[2] + s * weightStrides[3]];
+                }
+            }
+        }
+    }
+
+    bool parallel = filters * outputHeight * outputWidth * taps >= ParallelGemmThreshold;
+    ConvFor(parallel, IndexRange<2>{{0, 0}, {filterBlocks, outputHeight}}, {1, 1}, [&](IndexRange<2> const& tiles)
+    {
+        alignas(64) T tile[ConvMaxTile];
+        for (size_t block = tiles.begin[0]; block < tiles.end[0]; ++block)
+        {
+            size_t firstFilter = block * kb;
+            size_t rows = std::min(kb, filters - firstFilter);
+            for (size_t y = tiles.begin[1]; y < tiles.end[1]; ++y)
+            {
+                for (size_t x = 0; x < outputWidth; x += xb)
+                {
+                    ConvKernelArguments<T> arguments = {
+                        padded.Data() + y * strideY * paddedWidth + x * strideX,
+                        packed.Data() + block * taps * kb,
+                        channels,
+                        kernelHeight,
+                        kernelWidth,
+                        paddedHeight * paddedWidth,
+                        dilationY * paddedWidth,
+                        dilationX,
+                        strideX,
+                    };
+                    kernel.compute(arguments, tile);
+
+                    size_t columns = std::min(xb, outputWidth - x);
+                    for (size_t i = 0; i < rows; ++i)
+                    {
+                        T* destination = output + (firstFilter + i) * outputStrides[0] + y * outputStrides[1] + x * outputStrides[2];
+                        CopyRun(tile + i * xb, 1, destination, outputStrides[2], columns);
+                    }
+                }
+            }
+        }
+    });
+}
+
+/*
+ * Convolve one C x H x W image with K x C x R x S weights into a K x OH x OW output, by im2col and Gemm.
+ * The receptive field of every output position becomes a column of a (C * R * S) x (OH * OW) matrix, which the K x
+ * (C * R * S) weight matrix is multiplied with.
+ */
+template <typename T>
+auto Conv2DIm2Col(T const* input, std::array<size_t, 3> const& shape, std::array<size_t, 3> const& strides,
+                  T const* weights, std::array<size_t, 4> const& weightShape, std::array<size_t, 4> const& weightStrides,
+                  T* output, std::array<size_t, 3> const& outputShape, std::array<size_t, 3> const& outputStrides,
+                  Conv2DParameters const& parameters) -> void
+{
+    auto [filters, channels, kernelHeight, kernelWidth] = weightShape;
+    size_t outputHeight = outputShape[1];
+    size_t outputWidth = outputShape[2];
+    auto [strideY, strideX] = parameters.stride;
+    auto [dilationY, dilationX] = parameters.dilation;
+
+    size_t taps = channels * kernelHeight * kernelWidth;
+    size_t positions = outputHeight * outputWidth;
+
+    size_t paddedHeight = shape[1] + 2 * parameters.padding[0];
+    size_t paddedWidth = shape[2] + 2 * parameters.padding[1];
+    Tensor<T, 3> padded = PadImage(input, shape, strides, parameters.padding, paddedHeight, paddedWidth);
+
+    Tensor<T, 2> columns({taps, positions}, Uninitialized);
+    bool parallel = taps * positions * sizeof(T) >= ParallelCopyThreshold;
+    ConvFor(parallel, IndexRange<1>{{0}, {taps}}, {1}, [&](IndexRange<1> const& rows)
+    {
+        for (size_t tap = rows.begin[0]; tap < rows.end[0]; ++tap)
+        {
+            size_t c = tap / (kernelHeight * kernelWidth);
+            size_t r = tap / kernelWidth % kernelHeight;
+            size_t s = tap % kernelWidth;
+            T const* source = padded.Data() + (c * paddedHeight + r * dilationY) * paddedWidth + s * dilationX;
+            for (size_t y = 0; y < outputHeight; ++y)
+            {
+                CopyRun(source + y * strideY * paddedWidth, strideX, columns.Data() + tap * positions + y * outputWidth, 1, outputWidth);
+            }
+        }
+    });
+
+    // the weights are read in place when the taps of each filter are dense
+    T const* a = weights;
+    size_t rsa = weightStrides[0];
+    std::optional<Tensor<T, 2>> dense;
+    if (!IsContiguous(std::array<size_t, 3>{channels, kernelHeight, kernelWidth}, {weightStrides[1], weightStrides[2], weightStrides[3]}))
+    {
+        dense.emplace(std::array<size_t, 2>{filters, taps}, Uninitialized);
+        for (size_t k = 0, index = 0; k < filters; ++k)
+        {
+            for (size_t c = 0; c < channels; ++c)
+            {
+                for (size_t r = 0; r < kernelHeight; ++r)
+                {
+                    for (size_t s = 0; s < kernelWidth; ++s)
+                    {
+                        dense->Data()[index++] = weights[k * weightStrides[0] + c * weightStrides[1] + r * weightStrides[2] + s * weightStrides[3]];
+                    }
+                }
+            }
+        }
+        a = dense->Data();
+        rsa = taps;
+    }
+
+    // the output is written in place when its rows and columns collapse into one dimension
+    if (outputStrides[1] == outputWidth * outputStrides[2])
+    {
+        Gemm<T>(filters, positions, taps, a, rsa, 1, columns.Data(), positions, 1, output, outputStrides[0], outputStrides[2]);
+    }
+    else
+    {
+        Tensor<T, 2> result({filters, positions}, Uninitialized);
+        Gemm<T>(filters, positions, taps, a, rsa, 1, columns.Data(), positions, 1, result.Data(), positions, 1);
+        for (size_t k = 0; k < filters; ++k)
+        {
+            for (size_t y = 0; y < outputHeight; ++y)
+            {
+                CopyRun(result.Data() + k * positions + y * outputWidth, 1, output + k * outputStrides[0] + y * outputStrides[1], outputStrides[2], outputWidth);
+            }
+        }
+    }
+}
+
+/*
+ * Convolve one image, choosing the algorithm.
+ */
+template <typename T>
+auto Conv2DImage(T const* input, std::array<size_t, 3> const& shape, std::array<size_t, 3> const& strides,
+                 T const* weights, std::array<size_t, 4> const& weightShape, std::array<size_t, 4> const& weightStrides,
+                 T* output, std::array<size_t, 3> const& outputShape, std::array<size_t, 3> const& outputStrides,
+                 Conv2DParameters const& parameters) -> void
+{
+    if (GetSize(outputShape) == 0)
+    {
+        return;
+    }
+
+    ConvAlgorithm algorithm = parameters.algorithm;
+    if (algorithm == ConvAlgorithm::Auto)
+    {
+        size_t taps = weightShape[1] * weightShape[2] * weightShape[3];
+        size_t xb = SelectConvKernel<T>(parameters.stride[1]).xb;
+        size_t tileColumns = (outputShape[2] + xb - 1) / xb * xb;
+        bool narrow = taps >= ConvIm2ColThreshold && 2 * outputShape[2] < tileColumns;
+        algorithm = parameters.stride[1] != 1 || narrow ? ConvAlgorithm::Im2Col : ConvAlgorithm::Direct;
+    }
+
+    if (algorithm == ConvAlgorithm::Im2Col)
+    {
+        Conv2DIm2Col(input, shape, strides, weights, weightShape, weightStrides, output, outputShape, outputStrides, parameters);
+    }
+    else
+    {
+        Conv2DDirect(input, shape, strides, weights, weightShape, weightStrides, output, outputShape, outputStrides, parameters);
+    }
+}
+
+/*
+ * Shape of the output of Conv2D for the given input and weight shapes.
+ */
+template <size_t Order>
+auto Conv2DOutputShape(std::array<size_t, Order> const& inputShape, std::array<size_t, 4> const& weightShape, Conv2DParameters const& parameters) -> std::array<size_t, Order>
+{
+    static_assert(Order == 3 || Order == 4, "Conv2D requires a C x H x W image or an N x C x H x W batch");
+    Expect(parameters.stride[0] > 0 && parameters.stride[1] > 0 && parameters.dilation[0] > 0 && parameters.dilation[1] > 0, "convolution stride and dilation must be positive");
+    Expect(inputShape[Order - 3] == weightShape[1], "convolution weights must have as many channels as the input");
+
+    std::array<size_t, Order> shape = inputShape;
+    shape[Order - 3] = weightShape[0];
+    for (size_t d = 0; d < 2; ++d)
+    {
+        shape[Order - 2 + d] = Conv2DOutputExtent(inputShape[Order - 2 + d], weightShape[2 + d], parameters.stride[d], parameters.padding[d], parameters.dilation[d]);
+    }
+    return shape;
+}
+
+/*
+ * 2D convolution (strictly, cross-correlation, as in deep learning frameworks) of a C x H x W image, or of each image of
+ * an N x C x H x W batch, with K x C x R x S weights, into an existing K x OH x OW (or N x K x OH x OW) destination:
+ *
+ *     output(k, y, x) = sum over c, r, s of input(c, y * strideY + r * dilationY - padY, x * strideX + s * dilationX - padX) * weights(k, c, r, s)
+ *
+ * where positions outside the input read as zero. Any of input, weights and output may be a strided View.
+ */
+template <TensorLike Input, TensorLike Weights, TensorLike Output>
+auto Conv2D(Input const& input, Weights const& weights, Output& output, Conv2DParameters const& parameters = {}) -> void
+{
+    using value_type = std::remove_const_t<typename TensorTraits<Input>::value_type>;
+    static constexpr size_t order = TensorTraits<Input>::order;
+    static_assert(TensorTraits<Weights>::order == 4, "Conv2D weights must be K x C x R x S");
+    static_assert(TensorTraits<Output>::order == order, "Conv2D destination must have the order of the input");
+    static_assert(std::is_same_v<value_type, std::remove_const_t<typename TensorTraits<Weights>::value_type>>, "Conv2D operands must have the same value type");
+    static_assert(std::is_same_v<value_type, typename TensorTraits<Output>::value_type>, "Conv2D destination must have the value type of its operands");
+
+    auto outputShape = Conv2DOutputShape(input.Shape(), weights.Shape(), parameters);
+    Expect(output.Shape() == outputShape, "convolution destination has the wrong shape");
+
+    auto inputShape = input.Shape();
+    auto inputStrides = input.Strides();
+    auto outputStrides = output.Strides();
+    if constexpr (order == 3)
+    {
+        Conv2DImage<value_type>(Origin(input), inputShape, inputStrides, Origin(weights), weights.Shape(), weights.Strides(), Origin(output), outputShape, outputStrides, parameters);
+    }
+    else
+    {
+        for (size_t n = 0; n < inputShape[0]; ++n)
+        {
+            Conv2DImage<value_type>(Origin(input) + n * inputStrides[0], {inputShape[1], inputShape[2], inputShape[3]}, {inputStrides[1], inputStrides[2], inputStrides[3]},
+                                    Origin(weights), weights.Shape(), weights.Strides(),
+                                    Origin(output) + n * outputStrides[0], {outputShape[1], outputShape[2], outputShape[3]}, {outputStrides[1], outputStrides[2], outputStrides[3]},
+                                    parameters);
+        }
+    }
+}
+
+/*
+ * 2D convolution returning the result as a new Tensor.
+ */
+template <TensorLike Input, TensorLike Weights>
+auto Conv2D(Input const& input, Weights const& weights, Conv2DParameters const& parameters = {}) -> Tensor<std::remove_const_t<typename TensorTraits<Input>::value_type>, TensorTraits<Input>::order>
+{
+    using value_type = std::remove_const_t<typename TensorTraits<Input>::value_type>;
+
+    Tensor<value_type, TensorTraits<Input>::order> output(Conv2DOutputShape(input.Shape(), weights.Shape(), parameters), Uninitialized);
+    Conv2D(input, weights, output, parameters);
+    return output;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "../Containers/Traits.hpp"
+#include "../Utilities/Layout.hpp"
+#include "../Utilities/Shape.hpp"
+
+#include <Dispatch.hpp>
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+/*
+ * Containers with fewer elements than this are visited on the calling thread.
+ */
+inline constexpr size_t ParallelForEachThreshold = size_t{1} << 16;
+
+/*
+ * Call `callable` on every element of a Tensor or View, in parallel on the dispatcher thread pool for large containers.
+ *
+ * A callable accepting a std::span of elements is handed runs of contiguous elements, as long as possible after merging
+ * dimensions, so it can process them with plain pointer loops; if the innermost dimension is strided, each run is a
+ * single element. Any other callable is called with a reference to each element. Runs and elements may be visited in
+ * any order, and concurrently, so the callable must not depend on the order of visits.
+ */
+template <typename Container, typename Callable>
+auto ForEach(Container&& container, Callable&& callable) -> void
+{
+    using Traits = TensorTraits<std::remove_cvref_t<Container>>;
+    using Element = std::remove_pointer_t<decltype(Origin(container))>;
+    constexpr size_t Order = Traits::order;
+    constexpr bool spans = std::invocable<Callable&, std::span<Element>>;
+
+    size_t size = GetSize(container.Shape());
+    if (size == 0)
+    {
+        return;
+    }
+
+    auto layout = CollapseDimensions<Order, 1>(container.Shape(), {container.Strides()});
+    Element* origin = Origin(container);
+    size_t inner = layout.order - 1;
+    size_t rowLength = layout.shape[inner];
+    size_t rowCount = size / rowLength;
+    size_t stride = layout.strides[0][inner];
+
+    // visit `count` elements of a row, starting at linear index `first`
+    auto visit = [&](size_t first, size_t count)
+    {
+        Element* run = origin + CollapsedOffset(layout, first);
+        if constexpr (spans)
+        {
+            if (stride == 1)
+            {
+                callable(std::span<Element>(run, count));
+                return;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                callable(std::span<Element>(run + i * stride, 1));
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                callable(run[i * stride]);
+            }
+        }
+    };
+
+    size_t threads = size >= ParallelForEachThreshold ? GetDispatcherThreadPool().Threads() : 1;
+    bool parallel = threads > 1;
+
+    if (parallel && rowCount < threads)
+    {
+        // too few rows to go around, split each of them into blocks
+        size_t blocksPerRow = (threads + rowCount - 1) / rowCount;
+        size_t blockLength = (rowLength + blocksPerRow - 1) / blocksPerRow;
+        blocksPerRow = (rowLength + blockLength - 1) / blockLength;
+        DispatchRow(rowCount * blocksPerRow, [&](size_t block)
+        {
+            size_t row = block / blocksPerRow;
+            size_t begin = block % blocksPerRow * blockLength;
+            visit(row * rowLength + begin, std::min(blockLength, rowLength - begin));
+        });
+    }
+    else if (parallel)
+    {
+        DispatchRow(rowCount, [&](size_t row)
+        {
+            visit(row * rowLength, rowLength);
+        });
+    }
+    else
+    {
+        for (size_t row = 0; row < rowCount; ++row)
+        {
+            visit(row * rowLength, rowLength);
+        }
+    }
+}
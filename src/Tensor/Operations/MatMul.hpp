@@ -0,0 +1,462 @@
+#pragma once
+
+#include "../Containers/StaticTensor.hpp"
+#include "../Containers/Tensor.hpp"
+#include "../Containers/Traits.hpp"
+#include "../Simd/Gemm.hpp"
+#include "../Simd/GemmInt8.hpp"
+#include "../Utilities/Allocator.hpp"
+#include "../Utilities/Layout.hpp"
+
+#include <Dispatch.hpp>
+#include <Expect.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Cache blocking parameters of the matrix multiplication.
+ * A kc x nr panel of B stays in L1 while a mc x kc block of A stays in L2, and a kc x nc block of B is shared by all
+ * threads from L3. mc and nc are multiples of every microkernel's mr and nr.
+ */
+struct GemmBlocking
+{
+    static constexpr size_t kc = 256;
+    static constexpr size_t mc = 120;
+    static constexpr size_t nc = 3072;
+    static constexpr size_t max_tile = 6 * 32;
+};
+
+/*
+ * Products with fewer multiply-adds than this are computed on the calling thread.
+ */
+inline constexpr size_t ParallelGemmThreshold = size_t{1} << 18;
+
+/*
+ * Products with at most this many multiply-adds, such as those of small static matrices, are computed directly from the
+ * operands, as packing them would cost more than it saves.
+ */
+inline constexpr size_t SmallGemmThreshold = 512;
+
+/*
+ * Compute C = A * B, where A is m x k, B is k x n and C is m x n, each addressed through a row and a column stride.
+ * Arbitrary strides are supported, so transposed or sliced operands are read in place; they are packed block by block
+ * into aligned, contiguous panels for the microkernel. Row blocks of C are computed in parallel on the dispatcher thread
+ * pool. C must not overlap A or B.
+ *
+ * Follows the structure of "Anatomy of High-Performance Matrix Multiplication" (Goto, van de Geijn, 2008).
+ */
+template <typename T>
+auto Gemm(size_t m, size_t n, size_t k,
+          T const* a, size_t rsa, size_t csa,
+          T const* b, size_t rsb, size_t csb,
+          T* c, size_t rsc, size_t csc) -> void
+{
+    if (m == 0 || n == 0)
+    {
+        return;
+    }
+
+    if (k == 0)
+    {
+        for (size_t i = 0; i < m; ++i)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                c[i * rsc + j * csc] = T{};
+            }
+        }
+        return;
+    }
+
+    if (m * n * k <= SmallGemmThreshold)
+    {
+        for (size_t i = 0; i < m; ++i)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                T sum{};
+                for (size_t p = 0; p < k; ++p)
+                {
+                    sum += a[i * rsa + p * csa] * b[p * rsb + j * csb];
+                }
+                c[i * rsc + j * csc] = sum;
+            }
+        }
+        return;
+    }
+
+    GemmKernel<T> kernel = SelectGemmKernel<T>();
+    size_t mr = kernel.mr;
+    size_t nr = kernel.nr;
+
+    size_t threads = m * n * k >= ParallelGemmThreshold ? GetDispatcherThreadPool().Threads() : 1;
+    bool parallel = threads > 1;
+
+    // shrink the row blocks of small products, so that every thread gets at least one
+    size_t mc = std::min(GemmBlocking::mc, ((m + threads - 1) / threads + mr - 1) / mr * mr);
+    size_t rowBlocks = (m + mc - 1) / mc;
+
+    std::vector<T, AlignedAllocator<T>> packedB;
+
+    for (size_t jc = 0; jc < n; jc += GemmBlocking::nc)
+    {
+        size_t ncCurrent = std::min(GemmBlocking::nc, n - jc);
+        size_t panelsB = (ncCurrent + nr - 1) / nr;
+
+        for (size_t pc = 0; pc < k; pc += GemmBlocking::kc)
+        {
+            size_t kcCurrent = std::min(GemmBlocking::kc, k - pc);
+            bool accumulate = pc > 0;
+            packedB.resize(panelsB * kcCurrent * nr);
+
+            // pack B into panels of nr columns, zero padding the last one
+            auto packPanelB = [&](size_t panel)
+            {
+                T* destination = packedB.data() + panel * kcCurrent * nr;
+                size_t column = jc + panel * nr;
+                size_t columns = std::min(nr, n - column);
+                for (size_t p = 0; p < kcCurrent; ++p)
+                {
+                    T const* source = b + (pc + p) * rsb + column * csb;
+                    size_t j = 0;
+                    for (; j < columns; ++j)
+                    {
+                        destination[p * nr + j] = source[j * csb];
+                    }
+                    for (; j < nr; ++j)
+                    {
+                        destination[p * nr + j] = T{};
+                    }
+                }
+            };
+
+            auto computeRowBlock = [&](size_t block)
+            {
+                size_t ic = block * mc;
+                size_t mcCurrent = std::min(mc, m - ic);
+                size_t panelsA = (mcCurrent + mr - 1) / mr;
+
+                // pack A into panels of mr rows, zero padding the last one
+                thread_local std::vector<T, AlignedAllocator<T>> packedA;
+                packedA.resize(panelsA * kcCurrent * mr);
+                for (size_t panel = 0; panel < panelsA; ++panel)
+                {
+                    T* destination = packedA.data() + panel * kcCurrent * mr;
+                    size_t row = ic + panel * mr;
+                    size_t rows = std::min(mr, m - row);
+                    for (size_t p = 0; p < kcCurrent; ++p)
+                    {
+                        T const* source = a + row * rsa + (pc + p) * csa;
+                        size_t i = 0;
+                        for (; i < rows; ++i)
+                        {
+                            destination[p * mr + i] = source[i * rsa];
+                        }
+                        for (; i < mr; ++i)
+                        {
+                            destination[p * mr + i] = T{};
+                        }
+                    }
+                }
+
+                alignas(64) T tile[GemmBlocking::max_tile];
+                for (size_t panelB = 0; panelB < panelsB; ++panelB)
+                {
+                    size_t column = jc + panelB * nr;
+                    size_t columns = std::min(nr, n - column);
+
+                    for (size_t panelA = 0; panelA < panelsA; ++panelA)
+                    {
+                        size_t row = ic + panelA * mr;
+                        size_t rows = std::min(mr, m - row);
+
+                        kernel.compute(kcCurrent, packedA.data() + panelA * kcCurrent * mr, packedB.data() + panelB * kcCurrent * nr, tile);
+
+                        T* destination = c + row * rsc + column * csc;
+                        for (size_t i = 0; i < rows; ++i)
+                        {
+                            for (size_t j = 0; j < columns; ++j)
+                            {
+                                T& element = destination[i * rsc + j * csc];
+                                element = accumulate ? element + tile[i * nr + j] : tile[i * nr + j];
+                            }
+                        }
+                    }
+                }
+            };
+
+            if (parallel)
+            {
+                DispatchRow(panelsB, packPanelB);
+                DispatchRow(rowBlocks, computeRowBlock);
+            }
+            else
+            {
+                for (size_t panel = 0; panel < panelsB; ++panel)
+                {
+                    packPanelB(panel);
+                }
+                for (size_t block = 0; block < rowBlocks; ++block)
+                {
+                    computeRowBlock(block);
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Compute the int32 product C = A * B of 8-bit matrices, with A signed or unsigned and B signed, blocked and packed like
+ * Gemm. Panels hold groups of GemmInt8Group elements along k for the microkernel, so k is padded with zeros to a whole
+ * number of groups. Products are exact as long as the sums fit in 32 bits, which holds for k up to 2^16.
+ */
+template <typename TA>
+auto GemmInt8(size_t m, size_t n, size_t k,
+              TA const* a, size_t rsa, size_t csa,
+              int8_t const* b, size_t rsb, size_t csb,
+              int32_t* c, size_t rsc, size_t csc,
+              GemmInt8Kernel<TA> kernel = SelectGemmInt8Kernel<TA>()) -> void
+{
+    if (m == 0 || n == 0)
+    {
+        return;
+    }
+
+    if (k == 0)
+    {
+        for (size_t i = 0; i < m; ++i)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                c[i * rsc + j * csc] = 0;
+            }
+        }
+        return;
+    }
+
+    constexpr size_t Group = GemmInt8Group;
+    size_t mr = kernel.mr;
+    size_t nr = kernel.nr;
+
+    size_t threads = m * n * k >= ParallelGemmThreshold ? GetDispatcherThreadPool().Threads() : 1;
+    bool parallel = threads > 1;
+
+    size_t mc = std::min(GemmBlocking::mc, ((m + threads - 1) / threads + mr - 1) / mr * mr);
+    size_t rowBlocks = (m + mc - 1) / mc;
+
+    std::vector<int8_t, AlignedAllocator<int8_t>> packedB;
+    std::vector<int32_t> shiftB;
+
+    for (size_t jc = 0; jc < n; jc += GemmBlocking::nc)
+    {
+        size_t ncCurrent = std::min(GemmBlocking::nc, n - jc);
+        size_t panelsB = (ncCurrent + nr - 1) / nr;
+
+        for (size_t pc = 0; pc < k; pc += GemmBlocking::kc)
+        {
+            size_t kcCurrent = std::min(GemmBlocking::kc, k - pc);
+            size_t groups = (kcCurrent + Group - 1) / Group;
+            bool accumulate = pc > 0;
+            packedB.resize(panelsB * groups * Group * nr);
+            shiftB.assign(panelsB * nr, 0);
+
+            // pack B into panels of nr columns, each group of a column contiguous, zero padding k and the last panel
+            auto packPanelB = [&](size_t panel)
+            {
+                int8_t* destination = packedB.data() + panel * groups * Group * nr;
+                size_t column = jc + panel * nr;
+                size_t columns = std::min(nr, n - column);
+                std::fill_n(destination, groups * Group * nr, int8_t{0});
+                for (size_t p = 0; p < kcCurrent; ++p)
+                {
+                    int8_t const* source = b + (pc + p) * rsb + column * csb;
+                    int8_t* group = destination + p / Group * Group * nr + p % Group;
+                    for (size_t j = 0; j < columns; ++j)
+                    {
+                        group[j * Group] = source[j * csb];
+                    }
+                }
+
+                // the kernel adds 128 times the sum of each column, which is taken off again when storing the tile
+                if (kernel.shiftsA)
+                {
+                    int32_t* shift = shiftB.data() + panel * nr;
+                    for (size_t g = 0; g < groups; ++g)
+                    {
+                        for (size_t j = 0; j < nr; ++j)
+                        {
+                            for (size_t q = 0; q < Group; ++q)
+                            {
+                                shift[j] += 128 * destination[(g * nr + j) * Group + q];
+                            }
+                        }
+                    }
+                }
+            };
+
+            auto computeRowBlock = [&](size_t block)
+            {
+                size_t ic = block * mc;
+                size_t mcCurrent = std::min(mc, m - ic);
+                size_t panelsA = (mcCurrent + mr - 1) / mr;
+
+                // pack A into panels of mr rows, each group of a row contiguous, zero padding k and the last panel; signed
+                // elements are flipped to a + 128 for kernels which shiftsA
+                uint8_t flip = kernel.shiftsA ? 0x80 : 0;
+                thread_local std::vector<TA, AlignedAllocator<TA>> packedA;
+                packedA.resize(panelsA * groups * Group * mr);
+                for (size_t panel = 0; panel < panelsA; ++panel)
+                {
+                    TA* destination = packedA.data() + panel * groups * Group * mr;
+                    size_t row = ic + panel * mr;
+                    size_t rows = std::min(mr, m - row);
+                    std::fill_n(destination, groups * Group * mr, TA{0});
+                    for (size_t i = 0; i < rows; ++i)
+                    {
+                        TA const* source = a + (row + i) * rsa + pc * csa;
+                        for (size_t p = 0; p < kcCurrent; ++p)
+                        {
+                            uint8_t element = static_cast<uint8_t>(source[p * csa]) ^ flip;
+                            destination[(p / Group * mr + i) * Group + p % Group] = static_cast<TA>(element);
+                        }
+                    }
+                }
+
+                alignas(64) int32_t tile[GemmBlocking::max_tile];
+                for (size_t panelB = 0; panelB < panelsB; ++panelB)
+                {
+                    size_t column = jc + panelB * nr;
+                    size_t columns = std::min(nr, n - column);
+                    int32_t const* shift = shiftB.data() + panelB * nr;
+
+                    for (size_t panelA = 0; panelA < panelsA; ++panelA)
+                    {
+                        size_t row = ic + panelA * mr;
+                        size_t rows = std::min(mr, m - row);
+
+                        kernel.compute(groups, packedA.data() + panelA * groups * Group * mr, packedB.data() + panelB * groups * Group * nr, tile);
+
+                        int32_t* destination = c + row * rsc + column * csc;
+                        for (size_t i = 0; i < rows; ++i)
+                        {
+                            int32_t const* values = tile + i * nr;
+                            int32_t* target = destination + i * rsc;
+                            if (accumulate)
+                            {
+                                for (size_t j = 0; j < columns; ++j)
+                                {
+                                    target[j * csc] += values[j] - shift[j];
+                                }
+                            }
+                            else
+                            {
+                                for (size_t j = 0; j < columns; ++j)
+                                {
+                                    target[j * csc] = values[j] - shift[j];
+                                }
+                            }
+                        }
+                    }
+                }
+            };
+
+            if (parallel)
+            {
+                DispatchRow(panelsB, packPanelB);
+                DispatchRow(rowBlocks, computeRowBlock);
+            }
+            else
+            {
+                for (size_t panel = 0; panel < panelsB; ++panel)
+                {
+                    packPanelB(panel);
+                }
+                for (size_t block = 0; block < rowBlocks; ++block)
+                {
+                    computeRowBlock(block);
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Whether a product of matrices with the given element types is computed by GemmInt8, into int32_t: 8-bit A, signed or
+ * unsigned, with signed 8-bit B.
+ */
+template <typename TA, typename TB>
+inline constexpr bool IsInt8Product = (std::is_same_v<TA, int8_t> || std::is_same_v<TA, uint8_t>) && std::is_same_v<TB, int8_t>;
+
+/*
+ * The element type of the product of matrices with the given element types.
+ */
+template <typename TA, typename TB>
+using MatMulResultType = std::conditional_t<IsInt8Product<TA, TB>, int32_t, TA>;
+
+/*
+ * Multiply two matrices into an existing destination, c = a * b.
+ * Each of a, b and c may be a Tensor<T, 2> or a (possibly strided) View<T, 2>; c must not overlap a or b. Products of
+ * int8_t or uint8_t with int8_t matrices are computed exactly into int32_t, see GemmInt8.
+ */
+template <typename A, typename B, typename C>
+auto MatMul(A const& a, B const& b, C& c) -> void
+{
+    using value_type = std::remove_const_t<typename TensorTraits<A>::value_type>;
+    using b_value_type = std::remove_const_t<typename TensorTraits<B>::value_type>;
+    using result_type = MatMulResultType<value_type, b_value_type>;
+    static_assert(TensorTraits<A>::order == 2 && TensorTraits<B>::order == 2 && TensorTraits<C>::order == 2, "MatMul requires matrices");
+    static_assert(std::is_same_v<value_type, b_value_type> || IsInt8Product<value_type, b_value_type>, "MatMul operands must have the same value type");
+    static_assert(std::is_same_v<result_type, typename TensorTraits<C>::value_type>, "MatMul destination must have the value type of its operands, or int32_t for int8 operands");
+
+    auto [m, k] = a.Shape();
+    auto [kb, n] = b.Shape();
+    Expect(k == kb, "inner dimensions of matrix multiplication operands must match");
+    Expect(c.Shape() == std::array<size_t, 2>{m, n}, "matrix multiplication destination has the wrong shape");
+
+    auto aStrides = a.Strides();
+    auto bStrides = b.Strides();
+    auto cStrides = c.Strides();
+    if constexpr (IsInt8Product<value_type, b_value_type>)
+    {
+        GemmInt8<value_type>(m, n, k,
+                             Origin(a), aStrides[0], aStrides[1],
+                             Origin(b), bStrides[0], bStrides[1],
+                             Origin(c), cStrides[0], cStrides[1]);
+    }
+    else
+    {
+        Gemm<value_type>(m, n, k,
+                         Origin(a), aStrides[0], aStrides[1],
+                         Origin(b), bStrides[0], bStrides[1],
+                         Origin(c), cStrides[0], cStrides[1]);
+    }
+}
+
+/*
+ * Multiply two matrices, returning the product as a new Tensor.
+ */
+template <typename A, typename B>
+auto MatMul(A const& a, B const& b) -> Tensor<MatMulResultType<std::remove_const_t<typename TensorTraits<A>::value_type>, std::remove_const_t<typename TensorTraits<B>::value_type>>, 2>
+{
+    using value_type = MatMulResultType<std::remove_const_t<typename TensorTraits<A>::value_type>, std::remove_const_t<typename TensorTraits<B>::value_type>>;
+
+    Tensor<value_type, 2> c({a.Shape()[0], b.Shape()[1]}, Uninitialized);
+    MatMul(a, b, c);
+    return c;
+}
+
+/*
+ * Multiply two static matrices, returning the product as a StaticTensor, without touching the heap.
+ */
+template <typename T, size_t M, size_t K, size_t N>
+auto MatMul(StaticTensor<T, Extents<M, K>> const& a, StaticTensor<T, Extents<K, N>> const& b) -> StaticTensor<MatMulResultType<T, T>, Extents<M, N>>
+{
+    StaticTensor<MatMulResultType<T, T>, Extents<M, N>> c;
+    MatMul(a, b, c);
+    return c;
+}
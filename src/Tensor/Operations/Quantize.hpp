@@ -0,0 +1,293 @@
+#pragma once
+
+#include "../Containers/QuantizedTensor.hpp"
+#include "../Containers/Tensor.hpp"
+#include "../Containers/Traits.hpp"
+#include "../Simd/Quantize.hpp"
+#include "../Utilities/Layout.hpp"
+#include "../Utilities/Shape.hpp"
+#include "MatMul.hpp"
+#include "Reduce.hpp"
+
+#include <Dispatch.hpp>
+#include <Expect.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Quantizing or dequantizing fewer elements than this runs on the calling thread.
+ */
+inline constexpr size_t ParallelQuantizeThreshold = size_t{1} << 16;
+
+/*
+ * Elements quantized or dequantized by each task.
+ */
+inline constexpr size_t QuantizeBlock = size_t{1} << 14;
+
+/*
+ * How quantization parameters are chosen from the range of the values.
+ * Asymmetric maps the range onto the full range of the integer type, shifted by a zero point. Symmetric maps the largest
+ * magnitude to 127 and centres zero, at the middle of the type's range, so products need no zero point corrections for
+ * int8_t.
+ */
+enum class QuantizationScheme
+{
+    Asymmetric,
+    Symmetric,
+};
+
+struct QuantizationParameters
+{
+    float scale;
+    int32_t zeroPoint;
+};
+
+/*
+ * Choose the scale and zero point which quantize values in [minimum, maximum] to T. The range is widened to include
+ * zero, and an empty range gets a scale of 1.
+ */
+template <typename T>
+auto ChooseQuantization(float minimum, float maximum, QuantizationScheme scheme = QuantizationScheme::Asymmetric) -> QuantizationParameters
+{
+    Expect(std::isfinite(minimum) && std::isfinite(maximum) && minimum <= maximum, "quantization needs a finite range");
+
+    constexpr int32_t Lowest = std::numeric_limits<T>::lowest();
+    constexpr int32_t Highest = std::numeric_limits<T>::max();
+
+    minimum = std::min(minimum, 0.0f);
+    maximum = std::max(maximum, 0.0f);
+
+    if (scheme == QuantizationScheme::Symmetric)
+    {
+        float magnitude = std::max(-minimum, maximum);
+        float scale = magnitude > 0.0f ? magnitude / 127.0f : 1.0f;
+        return {scale, std::is_signed_v<T> ? 0 : 128};
+    }
+
+    float scale = maximum > minimum ? (maximum - minimum) / static_cast<float>(Highest - Lowest) : 1.0f;
+    float zeroPoint = std::nearbyint(static_cast<float>(Lowest) - minimum / scale);
+    return {scale, static_cast<int32_t>(std::clamp(zeroPoint, static_cast<float>(Lowest), static_cast<float>(Highest)))};
+}
+
+/*
+ * Call `callable(first, count, index)` for runs of the dense elements [0, size) of a tensor which share the index `index`
+ * along the quantization axis, which has `extent` indices each covering `inner` consecutive elements. Runs are visited
+ * in parallel for large tensors.
+ */
+template <typename Callable>
+auto ForEachQuantizationRun(size_t size, size_t inner, size_t extent, Callable&& callable) -> void
+{
+    auto visit = [&](size_t block)
+    {
+        size_t end = std::min(size, (block + 1) * QuantizeBlock);
+        for (size_t first = block * QuantizeBlock; first < end;)
+        {
+            size_t last = std::min(end, (first / inner + 1) * inner);
+            callable(first, last - first, first / inner % extent);
+            first = last;
+        }
+    };
+
+    size_t blocks = (size + QuantizeBlock - 1) / QuantizeBlock;
+    if (size >= ParallelQuantizeThreshold && GetDispatcherThreadPool().Threads() > 1)
+    {
+        DispatchRow(blocks, visit);
+    }
+    else
+    {
+        for (size_t block = 0; block < blocks; ++block)
+        {
+            visit(block);
+        }
+    }
+}
+
+/*
+ * Number of consecutive dense elements sharing an index along the axis of a quantized tensor of the given shape.
+ */
+template <size_t Order>
+auto QuantizationRunLength(std::array<size_t, Order> const& shape, size_t axis) -> size_t
+{
+    size_t inner = 1;
+    for (size_t i = axis == PerTensor ? 0 : axis + 1; i < Order; ++i)
+    {
+        inner *= shape[i];
+    }
+    return std::max<size_t>(inner, 1);
+}
+
+/*
+ * Quantize a float Tensor or View to T with the given quantization, one scale and zero point for the whole tensor, or
+ * one per index along `axis`.
+ */
+template <typename T, typename Input>
+auto Quantize(Input const& input, std::vector<float> scales, std::vector<int32_t> zeroPoints, size_t axis) -> QuantizedTensor<T, TensorTraits<Input>::order>
+{
+    constexpr size_t Order = TensorTraits<Input>::order;
+    static_assert(std::is_same_v<std::remove_const_t<typename TensorTraits<Input>::value_type>, float>, "only float tensors can be quantized");
+
+    auto shape = input.Shape();
+    QuantizedTensor<T, Order> result(Tensor<T, Order>(shape, Uninitialized), std::move(scales), std::move(zeroPoints), axis);
+
+    // strided inputs are made dense first, so the kernels work on whole runs
+    std::optional<Tensor<float, Order>> dense;
+    float const* source = Origin(input);
+    if (!IsContiguous(shape, input.Strides()))
+    {
+        dense.emplace(input);
+        source = dense->Data();
+    }
+
+    T* destination = result.Values().Data();
+    QuantizeKernel<T> kernel = SelectQuantizeKernel<T>();
+    size_t extent = axis == PerTensor ? 1 : shape[axis];
+    ForEachQuantizationRun(GetSize(shape), QuantizationRunLength(shape, axis), extent, [&](size_t first, size_t count, size_t index)
+    {
+        kernel(source + first, destination + first, count, 1.0f / result.Scale(index), result.ZeroPoint(index));
+    });
+    return result;
+}
+
+template <typename T, typename Input>
+auto Quantize(Input const& input, float scale, int32_t zeroPoint) -> QuantizedTensor<T, TensorTraits<Input>::order>
+{
+    return Quantize<T>(input, std::vector<float>{scale}, std::vector<int32_t>{zeroPoint}, PerTensor);
+}
+
+/*
+ * Quantize a float Tensor or View to T, with one scale and zero point chosen from the range of all its elements.
+ */
+template <typename T, typename Input>
+auto Quantize(Input const& input, QuantizationScheme scheme = QuantizationScheme::Asymmetric) -> QuantizedTensor<T, TensorTraits<Input>::order>
+{
+    auto [scale, zeroPoint] = GetSize(input.Shape()) > 0 ? ChooseQuantization<T>(Min(input), Max(input), scheme) : QuantizationParameters{1.0f, 0};
+    return Quantize<T>(input, scale, zeroPoint);
+}
+
+/*
+ * Quantize a float Tensor or View to T, with a scale and zero point for each index along `axis`, chosen from the range
+ * of the elements at that index.
+ */
+template <typename T, typename Input>
+auto QuantizePerAxis(Input const& input, size_t axis, QuantizationScheme scheme = QuantizationScheme::Asymmetric) -> QuantizedTensor<T, TensorTraits<Input>::order>
+{
+    constexpr size_t Order = TensorTraits<Input>::order;
+    Expect(axis < Order, "quantization axis out of range");
+
+    auto shape = input.Shape();
+    Tensor<float, Order> dense(input);
+    size_t extent = shape[axis];
+    std::vector<float> minima(extent, 0.0f);
+    std::vector<float> maxima(extent, 0.0f);
+    size_t inner = QuantizationRunLength(shape, axis);
+    for (size_t first = 0; first < GetSize(shape); first += inner)
+    {
+        size_t index = first / inner % extent;
+        auto [minimum, maximum] = std::minmax_element(dense.Data() + first, dense.Data() + first + inner);
+        minima[index] = std::min(minima[index], *minimum);
+        maxima[index] = std::max(maxima[index], *maximum);
+    }
+
+    std::vector<float> scales(extent);
+    std::vector<int32_t> zeroPoints(extent);
+    for (size_t i = 0; i < extent; ++i)
+    {
+        auto [scale, zeroPoint] = ChooseQuantization<T>(minima[i], maxima[i], scheme);
+        scales[i] = scale;
+        zeroPoints[i] = zeroPoint;
+    }
+    return Quantize<T>(dense, std::move(scales), std::move(zeroPoints), axis);
+}
+
+/*
+ * The real values a quantized tensor stands for.
+ */
+template <typename T, size_t Order>
+auto Dequantize(QuantizedTensor<T, Order> const& input) -> Tensor<float, Order>
+{
+    auto shape = input.Shape();
+    Tensor<float, Order> result(shape, Uninitialized);
+
+    T const* source = input.Values().Data();
+    float* destination = result.Data();
+    DequantizeKernel<T> kernel = SelectDequantizeKernel<T>();
+    size_t extent = input.Axis() == PerTensor ? 1 : shape[input.Axis()];
+    ForEachQuantizationRun(GetSize(shape), QuantizationRunLength(shape, input.Axis()), extent, [&](size_t first, size_t count, size_t index)
+    {
+        kernel(source + first, destination + first, count, input.Scale(index), input.ZeroPoint(index));
+    });
+    return result;
+}
+
+/*
+ * Multiply quantized matrices, returning the real product. The integer product is computed exactly by GemmInt8, and the
+ * zero points are then corrected for with the row sums of a and the column sums of b:
+ * c(i, j) = sa(i) sb(j) (sum(qa(i, p) qb(p, j)) - za(i) sum(qb(p, j)) - zb(j) sum(qa(i, p)) + k za(i) zb(j)).
+ * a may be quantized per row, axis 0, and b per column, axis 1, as their scales then factor out of each dot product.
+ */
+template <typename TA>
+auto MatMul(QuantizedTensor<TA, 2> const& a, QuantizedTensor<int8_t, 2> const& b) -> Tensor<float, 2>
+{
+    size_t m = a.Shape()[0];
+    size_t k = a.Shape()[1];
+    size_t n = b.Shape()[1];
+    Expect(b.Shape()[0] == k, "MatMul operand shapes do not match");
+    Expect(a.Axis() == PerTensor || a.Axis() == 0, "the left operand of a quantized MatMul may only be quantized per row");
+    Expect(b.Axis() == PerTensor || b.Axis() == 1, "the right operand of a quantized MatMul may only be quantized per column");
+
+    Tensor<int32_t, 2> product = MatMul(a.Values(), b.Values());
+
+    TA const* qa = a.Values().Data();
+    int8_t const* qb = b.Values().Data();
+    std::vector<int64_t> rowSums(m, 0);
+    std::vector<int64_t> columnSums(n, 0);
+    for (size_t i = 0; i < m; ++i)
+    {
+        for (size_t p = 0; p < k; ++p)
+        {
+            rowSums[i] += qa[i * k + p];
+        }
+    }
+    for (size_t p = 0; p < k; ++p)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            columnSums[j] += qb[p * n + j];
+        }
+    }
+
+    Tensor<float, 2> result({m, n}, Uninitialized);
+    auto correctRow = [&](size_t i)
+    {
+        float scale = a.Scale(i);
+        int64_t zeroPoint = a.ZeroPoint(i);
+        int32_t const* row = product.Data() + i * n;
+        float* destination = result.Data() + i * n;
+        for (size_t j = 0; j < n; ++j)
+        {
+            int64_t zeroPointB = b.ZeroPoint(j);
+            int64_t value = row[j] - zeroPoint * columnSums[j] - zeroPointB * rowSums[i] + static_cast<int64_t>(k) * zeroPoint * zeroPointB;
+            destination[j] = static_cast<float>(value) * (scale * b.Scale(j));
+        }
+    };
+
+    if (m * n >= ParallelQuantizeThreshold && GetDispatcherThreadPool().Threads() > 1)
+    {
+        DispatchRow(m, correctRow);
+    }
+    else
+    {
+        for (size_t i = 0; i < m; ++i)
+        {
+            correctRow(i);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,751 @@
+#pragma once
+
+#include "../Containers/Expression.hpp"
+#include "../Containers/Tensor.hpp"
+#include "../Containers/Traits.hpp"
+#include "../Utilities/Half.hpp"
+#include "../Utilities/Layout.hpp"
+
+#include <Dispatch.hpp>
+#include <Expect.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+/*
+ * How sums are accumulated.
+ * Naive adds the elements one after another, so the rounding error grows linearly with their number. Pairwise adds
+ * blocks of elements in a balanced tree, so the error grows logarithmically, at nearly the cost of Naive. Kahan carries
+ * a compensation term for the rounding error of every addition (Neumaier's variant), so the error does not grow with
+ * the number of elements, at several times the cost.
+ */
+enum class Summation
+{
+    Naive,
+    Pairwise,
+    Kahan,
+};
+
+/*
+ * Reductions over fewer elements than this run on the calling thread.
+ */
+inline constexpr size_t ParallelReduceThreshold = size_t{1} << 16;
+
+/*
+ * Elements reduced into each partial result of a reduction over all axes.
+ */
+inline constexpr size_t ReduceChunkSize = size_t{1} << 14;
+
+/*
+ * Columns accumulated side by side when reducing over an axis which is not innermost, sized so their partial results
+ * stay in L1.
+ */
+inline constexpr size_t ReduceBlockWidth = 1024;
+
+/*
+ * Axis reductions with fewer independent tasks than this also split the reduced axis into chunks.
+ */
+inline constexpr size_t ReduceMinimumTasks = 64;
+
+/*
+ * Number of elements added naively at the leaves of a pairwise summation.
+ */
+inline constexpr size_t PairwiseBlock = 128;
+
+/*
+ * Running sum and the rounding error lost from it so far, for Kahan summation.
+ */
+template <typename T>
+struct KahanState
+{
+    T sum;
+    T compensation;
+};
+
+/*
+ * Integer sums are accumulated in 64 bits, signed or unsigned like the elements, and returned as such, so that the sum of
+ * small integer elements does not wrap around.
+ */
+template <typename T>
+using SumAccumulatorType = std::conditional_t<std::is_integral_v<T>, std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>, AccumulatorType<T>>;
+
+template <typename T>
+using SumResultType = std::conditional_t<std::is_integral_v<T>, SumAccumulatorType<T>, T>;
+
+/*
+ * Reducers describe a reduction by its partial result, state_type, and four operations on it: Identity creates an empty
+ * partial result, Accumulate adds the element at the given position along the reduction, Combine merges the partial
+ * result of the elements which follow, and Finish produces the result. Elements are split into blocks of at most
+ * `block` elements, whose partial results are combined in a balanced tree.
+ * Sums of the 16-bit floating point types are accumulated in float, see AccumulatorType.
+ */
+template <typename T, Summation Mode>
+struct SumReducer
+{
+    using accumulator_type = SumAccumulatorType<T>;
+
+    static constexpr bool compensated = Mode == Summation::Kahan && std::is_floating_point_v<accumulator_type>;
+    static constexpr size_t block = Mode == Summation::Pairwise ? PairwiseBlock : SIZE_MAX;
+
+    using state_type = std::conditional_t<compensated, KahanState<accumulator_type>, accumulator_type>;
+    using result_type = SumResultType<T>;
+
+    auto Identity() const -> state_type
+    {
+        return {};
+    }
+
+    auto Accumulate(state_type& state, accumulator_type value, size_t) const -> void
+    {
+        if constexpr (compensated)
+        {
+            accumulator_type sum = state.sum + value;
+            if (std::abs(state.sum) >= std::abs(value))
+            {
+                state.compensation += (state.sum - sum) + value;
+            }
+            else
+            {
+                state.compensation += (value - sum) + state.sum;
+            }
+            state.sum = sum;
+        }
+        else
+        {
+            state += value;
+        }
+    }
+
+    /*
+     * Accumulate a dense run of at most `block` elements. Pairwise leaves use eight independent sums, which breaks the
+     * dependency between consecutive additions and lets the loop vectorize.
+     */
+    auto AccumulateDense(state_type& state, T const* data, size_t count) const -> void
+    {
+        if constexpr (Mode == Summation::Pairwise)
+        {
+            accumulator_type partials[8] = {};
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                for (size_t lane = 0; lane < 8; ++lane)
+                {
+                    partials[lane] += data[i + lane];
+                }
+            }
+
+            accumulator_type sum = ((partials[0] + partials[1]) + (partials[2] + partials[3])) + ((partials[4] + partials[5]) + (partials[6] + partials[7]));
+            for (; i < count; ++i)
+            {
+                sum += data[i];
+            }
+            state += sum;
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                Accumulate(state, data[i], i);
+            }
+        }
+    }
+
+    auto Combine(state_type& state, state_type const& other) const -> void
+    {
+        if constexpr (compensated)
+        {
+            Accumulate(state, other.sum, 0);
+            state.compensation += other.compensation;
+        }
+        else
+        {
+            state += other;
+        }
+    }
+
+    /*
+     * The sum in the accumulator type, before it is narrowed to the result.
+     */
+    auto Total(state_type const& state) const -> accumulator_type
+    {
+        if constexpr (compensated)
+        {
+            return state.sum + state.compensation;
+        }
+        else
+        {
+            return state;
+        }
+    }
+
+    auto Finish(state_type const& state) const -> result_type
+    {
+        return static_cast<result_type>(Total(state));
+    }
+};
+
+/*
+ * The sum of `count` elements divided by their number. The division happens in the accumulator type, so that the mean
+ * of small integer or 16-bit floating point elements does not overflow or lose precision where their sum would.
+ */
+template <typename T, Summation Mode>
+struct MeanReducer : SumReducer<T, Mode>
+{
+    using typename SumReducer<T, Mode>::accumulator_type;
+    using typename SumReducer<T, Mode>::state_type;
+    using result_type = T;
+
+    size_t count;
+
+    auto Finish(state_type const& state) const -> result_type
+    {
+        return static_cast<result_type>(this->Total(state) / static_cast<accumulator_type>(count));
+    }
+};
+
+/*
+ * The smallest or largest element. Comparisons with NaN are false, so NaNs are skipped unless every element is NaN.
+ */
+template <typename T, bool Largest>
+struct ExtremumReducer
+{
+    static constexpr size_t block = SIZE_MAX;
+
+    using state_type = T;
+    using result_type = T;
+
+    auto Identity() const -> state_type
+    {
+        if constexpr (std::numeric_limits<T>::has_infinity)
+        {
+            return Largest ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+        }
+        else
+        {
+            return Largest ? std::numeric_limits<T>::lowest() : std::numeric_limits<T>::max();
+        }
+    }
+
+    auto Accumulate(state_type& state, T value, size_t) const -> void
+    {
+        if (Largest ? value > state : value < state)
+        {
+            state = value;
+        }
+    }
+
+    auto Combine(state_type& state, state_type const& other) const -> void
+    {
+        Accumulate(state, other, 0);
+    }
+
+    auto Finish(state_type const& state) const -> T
+    {
+        return state;
+    }
+};
+
+/*
+ * The position of the largest element, taking the first one if several are equal.
+ */
+template <typename T>
+struct ArgMaxReducer
+{
+    static constexpr size_t block = SIZE_MAX;
+    static constexpr size_t none = SIZE_MAX;
+
+    struct state_type
+    {
+        T value;
+        size_t index;
+    };
+
+    using result_type = size_t;
+
+    auto Identity() const -> state_type
+    {
+        return {T{}, none};
+    }
+
+    auto Accumulate(state_type& state, T value, size_t index) const -> void
+    {
+        if (state.index == none || value > state.value)
+        {
+            state = {value, index};
+        }
+    }
+
+    auto Combine(state_type& state, state_type const& other) const -> void
+    {
+        if (other.index != none && (state.index == none || other.value > state.value))
+        {
+            state = other;
+        }
+    }
+
+    auto Finish(state_type const& state) const -> size_t
+    {
+        return state.index;
+    }
+};
+
+/*
+ * Split a reduction of more than `block` elements in two, with a left half which is a whole number of blocks.
+ */
+template <typename Reducer>
+auto SplitReduction(size_t count) -> size_t
+{
+    return (count / 2 + Reducer::block - 1) / Reducer::block * Reducer::block;
+}
+
+/*
+ * Reduce `count` elements, `stride` apart, which are at positions first, first + 1, ... along the reduction.
+ */
+template <typename Reducer, typename T>
+auto ReduceRun(Reducer const& reducer, T const* data, size_t stride, size_t count, size_t first) -> typename Reducer::state_type
+{
+    if (count > Reducer::block)
+    {
+        size_t half = SplitReduction<Reducer>(count);
+        auto state = ReduceRun(reducer, data, stride, half, first);
+        reducer.Combine(state, ReduceRun(reducer, data + half * stride, stride, count - half, first + half));
+        return state;
+    }
+
+    auto state = reducer.Identity();
+    if constexpr (requires { reducer.AccumulateDense(state, data, count); })
+    {
+        if (stride == 1)
+        {
+            reducer.AccumulateDense(state, data, count);
+            return state;
+        }
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        reducer.Accumulate(state, data[i * stride], first + i);
+    }
+    return state;
+}
+
+/*
+ * Reduce `count` rows, `stride` apart, of `width` columns side by side into one partial result per column, walking each
+ * row in memory order. Column j of a row is at `offset(j)` from its start. `scratch` holds the partial results of the
+ * right halves of a pairwise reduction, one row of `width` per level.
+ */
+template <typename Reducer, typename T, typename Offset>
+auto ReduceRows(Reducer const& reducer, T const* data, size_t stride, size_t count, size_t first, Offset const& offset, size_t width,
+                typename Reducer::state_type* states, typename Reducer::state_type* scratch) -> void
+{
+    if (count > Reducer::block)
+    {
+        size_t half = SplitReduction<Reducer>(count);
+        ReduceRows(reducer, data, stride, half, first, offset, width, states, scratch + width);
+        ReduceRows(reducer, data + half * stride, stride, count - half, first + half, offset, width, scratch, scratch + width);
+        for (size_t j = 0; j < width; ++j)
+        {
+            reducer.Combine(states[j], scratch[j]);
+        }
+        return;
+    }
+
+    for (size_t j = 0; j < width; ++j)
+    {
+        states[j] = reducer.Identity();
+    }
+    for (size_t k = 0; k < count; ++k)
+    {
+        T const* row = data + k * stride;
+        for (size_t j = 0; j < width; ++j)
+        {
+            reducer.Accumulate(states[j], row[offset(j)], first + k);
+        }
+    }
+}
+
+/*
+ * Combine `count` partial results, `stride` apart, in a balanced tree.
+ */
+template <typename Reducer>
+auto CombineTree(Reducer const& reducer, typename Reducer::state_type const* states, size_t count, size_t stride) -> typename Reducer::state_type
+{
+    if (count == 1)
+    {
+        return states[0];
+    }
+
+    size_t half = count / 2;
+    auto state = CombineTree(reducer, states, half, stride);
+    reducer.Combine(state, CombineTree(reducer, states + half * stride, count - half, stride));
+    return state;
+}
+
+/*
+ * Whether a reduction over the given number of elements should be split across the dispatcher thread pool.
+ */
+inline auto ParallelReduce(size_t size) -> bool
+{
+    return size >= ParallelReduceThreshold && GetDispatcherThreadPool().Threads() > 1;
+}
+
+/*
+ * Run `callable` for every task, on the dispatcher thread pool if `parallel`.
+ */
+template <typename Callable>
+auto ForEachReduceTask(size_t tasks, bool parallel, Callable&& callable) -> void
+{
+    if (parallel)
+    {
+        DispatchRow(tasks, callable);
+        return;
+    }
+    for (size_t task = 0; task < tasks; ++task)
+    {
+        callable(task);
+    }
+}
+
+/*
+ * Reduce every element of a container to one result, numbered in row-major order.
+ * The elements are split into chunks of a fixed size, whose partial results are combined in a balanced tree, so the
+ * result does not depend on the number of threads.
+ */
+template <typename Reducer, typename Container>
+auto ReduceAll(Reducer const& reducer, Container const& input) -> typename Reducer::result_type
+{
+    constexpr size_t Order = TensorTraits<Container>::order;
+
+    auto shape = input.Shape();
+    auto layout = CollapseDimensions<Order, 1>(shape, {input.Strides()});
+    auto origin = Origin(input);
+
+    size_t size = 1;
+    for (size_t extent : shape)
+    {
+        size *= extent;
+    }
+    if (size == 0)
+    {
+        return reducer.Finish(reducer.Identity());
+    }
+
+    size_t inner = layout.order - 1;
+    size_t chunks = (size + ReduceChunkSize - 1) / ReduceChunkSize;
+    std::vector<typename Reducer::state_type> partials(chunks);
+
+    ForEachReduceTask(chunks, ParallelReduce(size), [&](size_t chunk)
+    {
+        size_t position = chunk * ReduceChunkSize;
+        size_t end = std::min(position + ReduceChunkSize, size);
+
+        auto state = reducer.Identity();
+        while (position < end)
+        {
+            size_t column = position % layout.shape[inner];
+            size_t run = std::min(end - position, layout.shape[inner] - column);
+            reducer.Combine(state, ReduceRun(reducer, origin + CollapsedOffset(layout, position), layout.strides[0][inner], run, position));
+            position += run;
+        }
+        partials[chunk] = state;
+    });
+
+    return reducer.Finish(CombineTree(reducer, partials.data(), chunks, 1));
+}
+
+/*
+ * Reduce a container over one axis, giving a tensor of the remaining axes.
+ *
+ * The container is viewed as outer x axis x inner. When the inner part is a single element, each result reduces one
+ * strided run. Otherwise blocks of inner columns are accumulated side by side, a row at a time, so memory is read in
+ * stride order rather than one column at a time. Outer indices and column blocks are reduced in parallel; when there are
+ * too few of them the axis is also split into chunks, whose partial results are combined in a balanced tree. The split
+ * depends only on the shape, so the result does not depend on the number of threads.
+ */
+template <typename Reducer, typename Container>
+auto ReduceAxis(Reducer const& reducer, Container const& input, size_t axis) -> Tensor<typename Reducer::result_type, TensorTraits<Container>::order - 1>
+{
+    using state_type = typename Reducer::state_type;
+    constexpr size_t Order = TensorTraits<Container>::order;
+    static_assert(Order > 0, "cannot reduce over an axis of an order 0 tensor");
+    Expect(axis < Order, "reduction axis out of range");
+
+    auto shape = input.Shape();
+    auto strides = input.Strides();
+    auto origin = Origin(input);
+
+    std::array<size_t, Order - 1> resultShape{};
+    std::array<size_t, Order> outerShape{};
+    std::array<size_t, Order> innerShape{};
+    size_t outer = 1;
+    size_t inner = 1;
+    for (size_t d = 0; d < Order; ++d)
+    {
+        outerShape[d] = d < axis ? shape[d] : 1;
+        innerShape[d] = d > axis ? shape[d] : 1;
+        outer *= outerShape[d];
+        inner *= innerShape[d];
+        if (d != axis)
+        {
+            resultShape[d < axis ? d : d - 1] = shape[d];
+        }
+    }
+
+    Tensor<typename Reducer::result_type, Order - 1> result(resultShape, Uninitialized);
+    typename Reducer::result_type* destination = result.Data();
+    size_t outputs = outer * inner;
+    if (outputs == 0)
+    {
+        return result;
+    }
+
+    auto outerLayout = CollapseDimensions<Order, 1>(outerShape, {strides});
+    auto innerLayout = CollapseDimensions<Order, 1>(innerShape, {strides});
+    size_t length = shape[axis];
+    size_t axisStride = strides[axis];
+
+    size_t width = std::min(inner, ReduceBlockWidth);
+    size_t columnBlocks = (inner + width - 1) / width;
+
+    // split the axis when there are too few independent tasks, into chunks of whole pairwise blocks
+    size_t chunkLength = std::max<size_t>(length, 1);
+    size_t tasks = outer * columnBlocks;
+    if (tasks < ReduceMinimumTasks && length > PairwiseBlock)
+    {
+        size_t wanted = (ReduceMinimumTasks + tasks - 1) / tasks;
+        chunkLength = ((length + wanted - 1) / wanted + PairwiseBlock - 1) / PairwiseBlock * PairwiseBlock;
+    }
+    size_t chunks = (std::max<size_t>(length, 1) + chunkLength - 1) / chunkLength;
+    std::vector<state_type> partials(chunks > 1 ? chunks * outputs : 0);
+
+    ForEachReduceTask(tasks * chunks, ParallelReduce(outputs * length), [&](size_t task)
+    {
+        size_t chunk = task % chunks;
+        size_t block = task / chunks % columnBlocks;
+        size_t o = task / chunks / columnBlocks;
+
+        size_t first = chunk * chunkLength;
+        size_t count = std::min(chunkLength, length - std::min(first, length));
+        size_t column = block * width;
+        size_t columns = std::min(width, inner - column);
+        auto data = origin + CollapsedOffset(outerLayout, o) + first * axisStride;
+
+        // partial results of this task's columns, followed by scratch for the pairwise tree
+        size_t depth = 1;
+        for (size_t c = count; c > Reducer::block; c = SplitReduction<Reducer>(c))
+        {
+            ++depth;
+        }
+        thread_local std::vector<state_type> states;
+        states.resize(columns * depth);
+
+        if (inner == 1)
+        {
+            states[0] = ReduceRun(reducer, data, axisStride, count, first);
+        }
+        else if (innerLayout.order == 1 && innerLayout.strides[0][0] == 1)
+        {
+            auto offset = [=](size_t j) { return column + j; };
+            ReduceRows(reducer, data, axisStride, count, first, offset, columns, states.data(), states.data() + columns);
+        }
+        else if (innerLayout.order == 1)
+        {
+            size_t innerStride = innerLayout.strides[0][0];
+            auto offset = [=](size_t j) { return (column + j) * innerStride; };
+            ReduceRows(reducer, data, axisStride, count, first, offset, columns, states.data(), states.data() + columns);
+        }
+        else
+        {
+            thread_local std::vector<size_t> offsets;
+            offsets.resize(columns);
+            for (size_t j = 0; j < columns; ++j)
+            {
+                offsets[j] = CollapsedOffset(innerLayout, column + j);
+            }
+            auto offset = [&](size_t j) { return offsets[j]; };
+            ReduceRows(reducer, data, axisStride, count, first, offset, columns, states.data(), states.data() + columns);
+        }
+
+        size_t output = o * inner + column;
+        for (size_t j = 0; j < columns; ++j)
+        {
+            if (chunks > 1)
+            {
+                partials[chunk * outputs + output + j] = states[j];
+            }
+            else
+            {
+                destination[output + j] = reducer.Finish(states[j]);
+            }
+        }
+    });
+
+    if (chunks > 1)
+    {
+        for (size_t output = 0; output < outputs; ++output)
+        {
+            destination[output] = reducer.Finish(CombineTree(reducer, partials.data() + output, chunks, outputs));
+        }
+    }
+
+    return result;
+}
+
+/*
+ * Evaluate an expression into a temporary tensor so it can be reduced; containers are reduced in place.
+ */
+template <TensorLike Input>
+auto ReductionOperand(Input const& input) -> decltype(auto)
+{
+    if constexpr (ExpressionNode<Input>)
+    {
+        return Tensor<typename TensorTraits<Input>::value_type, TensorTraits<Input>::order>(input);
+    }
+    else
+    {
+        return (input);
+    }
+}
+
+template <TensorLike Input>
+using ReductionValue = std::remove_const_t<typename TensorTraits<Input>::value_type>;
+
+template <TensorLike Input>
+using ReductionResult = Tensor<ReductionValue<Input>, TensorTraits<Input>::order - 1>;
+
+template <TensorLike Input>
+using SumValue = SumResultType<ReductionValue<Input>>;
+
+/*
+ * Sum of the elements along one axis, or of every element. Integer elements are summed into int64_t or uint64_t.
+ */
+template <TensorLike Input>
+auto Sum(Input const& input, size_t axis, Summation summation = Summation::Pairwise) -> Tensor<SumValue<Input>, TensorTraits<Input>::order - 1>
+{
+    using T = ReductionValue<Input>;
+    switch (summation)
+    {
+    case Summation::Naive:
+        return ReduceAxis(SumReducer<T, Summation::Naive>{}, ReductionOperand(input), axis);
+    case Summation::Kahan:
+        return ReduceAxis(SumReducer<T, Summation::Kahan>{}, ReductionOperand(input), axis);
+    default:
+        return ReduceAxis(SumReducer<T, Summation::Pairwise>{}, ReductionOperand(input), axis);
+    }
+}
+
+template <TensorLike Input>
+auto Sum(Input const& input, Summation summation = Summation::Pairwise) -> SumValue<Input>
+{
+    using T = ReductionValue<Input>;
+    switch (summation)
+    {
+    case Summation::Naive:
+        return ReduceAll(SumReducer<T, Summation::Naive>{}, ReductionOperand(input));
+    case Summation::Kahan:
+        return ReduceAll(SumReducer<T, Summation::Kahan>{}, ReductionOperand(input));
+    default:
+        return ReduceAll(SumReducer<T, Summation::Pairwise>{}, ReductionOperand(input));
+    }
+}
+
+/*
+ * Arithmetic mean of the elements along one axis, or of every element. Integer means are truncated.
+ */
+template <TensorLike Input>
+auto Mean(Input const& input, size_t axis, Summation summation = Summation::Pairwise) -> ReductionResult<Input>
+{
+    using T = ReductionValue<Input>;
+    Expect(axis < TensorTraits<Input>::order && input.Shape()[axis] > 0, "cannot take the mean of an empty axis");
+    size_t count = input.Shape()[axis];
+    switch (summation)
+    {
+    case Summation::Naive:
+        return ReduceAxis(MeanReducer<T, Summation::Naive>{{}, count}, ReductionOperand(input), axis);
+    case Summation::Kahan:
+        return ReduceAxis(MeanReducer<T, Summation::Kahan>{{}, count}, ReductionOperand(input), axis);
+    default:
+        return ReduceAxis(MeanReducer<T, Summation::Pairwise>{{}, count}, ReductionOperand(input), axis);
+    }
+}
+
+template <TensorLike Input>
+auto Mean(Input const& input, Summation summation = Summation::Pairwise) -> ReductionValue<Input>
+{
+    size_t size = 1;
+    for (size_t extent : input.Shape())
+    {
+        size *= extent;
+    }
+    Expect(size > 0, "cannot take the mean of an empty tensor");
+    using T = ReductionValue<Input>;
+    switch (summation)
+    {
+    case Summation::Naive:
+        return ReduceAll(MeanReducer<T, Summation::Naive>{{}, size}, ReductionOperand(input));
+    case Summation::Kahan:
+        return ReduceAll(MeanReducer<T, Summation::Kahan>{{}, size}, ReductionOperand(input));
+    default:
+        return ReduceAll(MeanReducer<T, Summation::Pairwise>{{}, size}, ReductionOperand(input));
+    }
+}
+
+/*
+ * Smallest element along one axis, or of every element.
+ */
+template <TensorLike Input>
+auto Min(Input const& input, size_t axis) -> ReductionResult<Input>
+{
+    Expect(axis < TensorTraits<Input>::order && input.Shape()[axis] > 0, "cannot take the minimum of an empty axis");
+    return ReduceAxis(ExtremumReducer<ReductionValue<Input>, false>{}, ReductionOperand(input), axis);
+}
+
+template <TensorLike Input>
+auto Min(Input const& input) -> ReductionValue<Input>
+{
+    auto shape = input.Shape();
+    Expect(std::find(shape.begin(), shape.end(), 0) == shape.end(), "cannot take the minimum of an empty tensor");
+    return ReduceAll(ExtremumReducer<ReductionValue<Input>, false>{}, ReductionOperand(input));
+}
+
+/*
+ * Largest element along one axis, or of every element.
+ */
+template <TensorLike Input>
+auto Max(Input const& input, size_t axis) -> ReductionResult<Input>
+{
+    Expect(axis < TensorTraits<Input>::order && input.Shape()[axis] > 0, "cannot take the maximum of an empty axis");
+    return ReduceAxis(ExtremumReducer<ReductionValue<Input>, true>{}, ReductionOperand(input), axis);
+}
+
+template <TensorLike Input>
+auto Max(Input const& input) -> ReductionValue<Input>
+{
+    auto shape = input.Shape();
+    Expect(std::find(shape.begin(), shape.end(), 0) == shape.end(), "cannot take the maximum of an empty tensor");
+    return ReduceAll(ExtremumReducer<ReductionValue<Input>, true>{}, ReductionOperand(input));
+}
+
+/*
+ * Index along one axis of the largest element, or the row-major linear index of the largest element overall.
+ * The first of several equal elements is chosen.
+ */
+template <TensorLike Input>
+auto ArgMax(Input const& input, size_t axis) -> Tensor<size_t, TensorTraits<Input>::order - 1>
+{
+    Expect(axis < TensorTraits<Input>::order && input.Shape()[axis] > 0, "cannot take the maximum of an empty axis");
+    return ReduceAxis(ArgMaxReducer<ReductionValue<Input>>{}, ReductionOperand(input), axis);
+}
+
+template <TensorLike Input>
+auto ArgMax(Input const& input) -> size_t
+{
+    auto shape = input.Shape();
+    Expect(std::find(shape.begin(), shape.end(), 0) == shape.end(), "cannot take the maximum of an empty tensor");
+    return ReduceAll(ArgMaxReducer<ReductionValue<Input>>{}, ReductionOperand(input));
+}
@@ -0,0 +1,278 @@
+#pragma once
+
+#include "../Containers/Sparse.hpp"
+#include "../Containers/Tensor.hpp"
+#include "../Containers/Traits.hpp"
+#include "../Utilities/Half.hpp"
+#include "../Utilities/Layout.hpp"
+
+#include <Dispatch.hpp>
+#include <Expect.hpp>
+#include <ParallelFor.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Sparse products with fewer multiply-adds than this are computed on the calling thread.
+ */
+inline constexpr size_t ParallelSparseThreshold = size_t{1} << 15;
+
+/*
+ * Parts per thread a parallel sparse product is split into. The parts are handed out dynamically, so a thread whose
+ * parts run slower than their nonzero count suggests, such as rows whose columns miss the cache, leaves the parts it did
+ * not get to for the threads which finished early.
+ */
+inline constexpr size_t SparsePartsPerThread = 4;
+
+/*
+ * Split the major indices of a compressed matrix into `parts` consecutive ranges of about the same cost, counting each
+ * nonzero and each major index, for its own output row or column, as one. Returns parts + 1 boundaries. Balancing
+ * by nonzeros rather than by rows keeps a few dense rows, common in graphs, from landing on a single thread.
+ */
+inline auto PartitionNonZeros(std::vector<size_t> const& offsets, size_t parts) -> std::vector<size_t>
+{
+    size_t majors = offsets.size() - 1;
+    size_t total = offsets.back() + majors;
+
+    std::vector<size_t> bounds(parts + 1, majors);
+    bounds[0] = 0;
+    for (size_t part = 1; part < parts; ++part)
+    {
+        // the first major index whose cumulative cost reaches the target
+        size_t target = total / parts * part + total % parts * part / parts;
+        size_t low = bounds[part - 1];
+        size_t high = majors;
+        while (low < high)
+        {
+            size_t middle = low + (high - low) / 2;
+            if (offsets[middle] + middle < target)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        bounds[part] = low;
+    }
+    return bounds;
+}
+
+/*
+ * Call `callable(first, last)` on ranges of the major indices of a compressed matrix, balanced by PartitionNonZeros and
+ * run in parallel on the dispatcher thread pool when the product is large enough, each thread taking the next part left
+ * as it finishes one. `work` is the number of multiply-adds.
+ */
+template <typename Callable>
+auto DispatchNonZeros(std::vector<size_t> const& offsets, size_t work, Callable&& callable) -> void
+{
+    size_t majors = offsets.size() - 1;
+    if (work < ParallelSparseThreshold || majors < 2 || GetDispatcherThreadPool().Threads() == 1)
+    {
+        callable(size_t{0}, majors);
+        return;
+    }
+
+    auto bounds = PartitionNonZeros(offsets, std::min(majors, GetDispatcherThreadPool().Threads() * SparsePartsPerThread));
+    ParallelFor(0, bounds.size() - 1, 1, [&](IndexRange<1> const& parts)
+    {
+        for (size_t part = parts.begin[0]; part < parts.end[0]; ++part)
+        {
+            if (bounds[part] < bounds[part + 1])
+            {
+                callable(bounds[part], bounds[part + 1]);
+            }
+        }
+    }, Schedule::Dynamic);
+}
+
+/*
+ * Dot product of the nonzeros [first, last) of a compressed matrix with a strided dense vector. Four partial sums are
+ * kept, so that consecutive additions do not wait for each other.
+ */
+template <typename T>
+auto SparseDot(T const* values, SparseIndex const* indices, size_t first, size_t last, T const* vector, size_t stride) -> T
+{
+    using accumulator_type = AccumulatorType<T>;
+
+    accumulator_type sums[4] = {};
+    size_t e = first;
+    for (; e + 4 <= last; e += 4)
+    {
+        for (size_t q = 0; q < 4; ++q)
+        {
+            sums[q] += static_cast<accumulator_type>(values[e + q]) * static_cast<accumulator_type>(vector[indices[e + q] * stride]);
+        }
+    }
+    for (; e < last; ++e)
+    {
+        sums[0] += static_cast<accumulator_type>(values[e]) * static_cast<accumulator_type>(vector[indices[e] * stride]);
+    }
+    return static_cast<T>((sums[0] + sums[1]) + (sums[2] + sums[3]));
+}
+
+/*
+ * Multiply a CSR matrix by a dense vector or matrix into an existing destination, c = a * b.
+ * b and c may be Tensors or (possibly strided) Views, of order 1 for a sparse matrix-vector product or of order 2 for a
+ * sparse matrix-dense matrix product; c must not overlap b. Rows of c are computed in parallel, in ranges balanced by
+ * their number of nonzeros.
+ */
+template <typename T, typename B, typename C>
+auto MatMul(CsrMatrix<T> const& a, B const& b, C& c) -> void
+{
+    constexpr size_t Order = TensorTraits<B>::order;
+    static_assert(Order == 1 || Order == 2, "sparse products take a dense vector or matrix");
+    static_assert(TensorTraits<C>::order == Order, "the destination of a sparse product must have the order of its dense operand");
+    static_assert(std::is_same_v<std::remove_const_t<typename TensorTraits<B>::value_type>, T>, "sparse products need operands of the same value type");
+
+    size_t m = a.Shape()[0];
+    size_t k = a.Shape()[1];
+    Expect(b.Shape()[0] == k, "MatMul operand shapes do not match");
+    Expect(c.Shape()[0] == m, "MatMul destination has the wrong shape");
+
+    auto const& offsets = a.Offsets();
+    SparseIndex const* indices = a.Indices().data();
+    T const* values = a.Values().data();
+    auto bStrides = b.Strides();
+    auto cStrides = c.Strides();
+    T const* bOrigin = Origin(b);
+    T* cOrigin = Origin(c);
+
+    if constexpr (Order == 1)
+    {
+        DispatchNonZeros(offsets, a.NonZeros(), [&](size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; ++i)
+            {
+                cOrigin[i * cStrides[0]] = SparseDot(values, indices, offsets[i], offsets[i + 1], bOrigin, bStrides[0]);
+            }
+        });
+    }
+    else
+    {
+        size_t n = b.Shape()[1];
+        Expect(c.Shape()[1] == n, "MatMul destination has the wrong shape");
+
+        // each nonzero adds a multiple of a row of b to a row of c, accumulated as in SparseDot: in place where the row
+        // of c is dense and of the accumulator type, and otherwise in a buffer which is converted once the row is done
+        using accumulator_type = AccumulatorType<T>;
+        bool denseB = bStrides[1] == 1 || n == 1;
+        bool inPlace = std::is_same_v<accumulator_type, T> && (cStrides[1] == 1 || n == 1);
+        DispatchNonZeros(offsets, a.NonZeros() * n, [&](size_t first, size_t last)
+        {
+            std::vector<accumulator_type> buffer(inPlace ? 0 : n);
+            for (size_t i = first; i < last; ++i)
+            {
+                T* row = cOrigin + i * cStrides[0];
+                accumulator_type* sums = buffer.data();
+                if constexpr (std::is_same_v<accumulator_type, T>)
+                {
+                    sums = inPlace ? row : sums;
+                }
+
+                std::fill_n(sums, n, accumulator_type{});
+                for (size_t e = offsets[i]; e < offsets[i + 1]; ++e)
+                {
+                    accumulator_type value = static_cast<accumulator_type>(values[e]);
+                    T const* source = bOrigin + indices[e] * bStrides[0];
+                    if (denseB)
+                    {
+                        for (size_t j = 0; j < n; ++j)
+                        {
+                            sums[j] += value * static_cast<accumulator_type>(source[j]);
+                        }
+                    }
+                    else
+                    {
+                        for (size_t j = 0; j < n; ++j)
+                        {
+                            sums[j] += value * static_cast<accumulator_type>(source[j * bStrides[1]]);
+                        }
+                    }
+                }
+
+                if (!inPlace)
+                {
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        row[j * cStrides[1]] = static_cast<T>(sums[j]);
+                    }
+                }
+            }
+        });
+    }
+}
+
+/*
+ * Multiply a dense matrix by a CSC matrix into an existing destination, c = a * b.
+ * a and c may be Tensors or (possibly strided) Views; c must not overlap a. Each element of c gathers its row of a
+ * through the nonzeros of one column of b. Columns of c are computed in parallel, in ranges balanced by their number of
+ * nonzeros.
+ */
+template <typename A, typename T, typename C>
+auto MatMul(A const& a, CscMatrix<T> const& b, C& c) -> void
+{
+    static_assert(TensorTraits<A>::order == 2 && TensorTraits<C>::order == 2, "dense-sparse products take dense matrices");
+    static_assert(std::is_same_v<std::remove_const_t<typename TensorTraits<A>::value_type>, T>, "sparse products need operands of the same value type");
+
+    size_t m = a.Shape()[0];
+    size_t k = a.Shape()[1];
+    size_t n = b.Shape()[1];
+    Expect(b.Shape()[0] == k, "MatMul operand shapes do not match");
+    Expect(c.Shape()[0] == m && c.Shape()[1] == n, "MatMul destination has the wrong shape");
+
+    auto const& offsets = b.Offsets();
+    SparseIndex const* indices = b.Indices().data();
+    T const* values = b.Values().data();
+    auto aStrides = a.Strides();
+    auto cStrides = c.Strides();
+    T const* aOrigin = Origin(a);
+    T* cOrigin = Origin(c);
+
+    DispatchNonZeros(offsets, b.NonZeros() * m, [&](size_t first, size_t last)
+    {
+        for (size_t i = 0; i < m; ++i)
+        {
+            T const* row = aOrigin + i * aStrides[0];
+            for (size_t j = first; j < last; ++j)
+            {
+                cOrigin[i * cStrides[0] + j * cStrides[1]] = SparseDot(values, indices, offsets[j], offsets[j + 1], row, aStrides[1]);
+            }
+        }
+    });
+}
+
+/*
+ * Multiply a CSR matrix by a dense vector or matrix, returning the product as a new Tensor.
+ */
+template <typename T, typename B>
+auto MatMul(CsrMatrix<T> const& a, B const& b) -> Tensor<T, TensorTraits<B>::order>
+{
+    constexpr size_t Order = TensorTraits<B>::order;
+    std::array<size_t, Order> shape;
+    shape[0] = a.Shape()[0];
+    if constexpr (Order == 2)
+    {
+        shape[1] = b.Shape()[1];
+    }
+
+    Tensor<T, Order> c(shape, Uninitialized);
+    MatMul(a, b, c);
+    return c;
+}
+
+/*
+ * Multiply a dense matrix by a CSC matrix, returning the product as a new Tensor.
+ */
+template <typename A, typename T>
+auto MatMul(A const& a, CscMatrix<T> const& b) -> Tensor<T, 2>
+{
+    Tensor<T, 2> c({a.Shape()[0], b.Shape()[1]}, Uninitialized);
+    MatMul(a, b, c);
+    return c;
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "Cpu.hpp"
+
+#include <cstddef>
+#include <type_traits>
+
+/*
+ * Where a microkernel reads its input and weights. Taps are visited channel by channel, then row by row, then column by
+ * column, matching the order of the packed weights.
+ */
+template <typename T>
+struct ConvKernelArguments
+{
+    T const* input;
+    T const* weights;
+    size_t channels;
+    size_t kernelHeight;
+    size_t kernelWidth;
+    size_t channelStride;
+    size_t rowStep;
+    size_t columnStep;
+    size_t stride;
+};
+
+/*
+ * Register-blocked direct convolution microkernel, computing one KB x XB tile of an output row: KB output channels at XB
+ * consecutive output columns. The input points at the first tap of the tile in channel 0 of a zero-padded image, the
+ * weights are packed as channels x taps panels of KB elements, and the tile is written densely in row-major order.
+ */
+template <typename T>
+struct ConvKernel
+{
+    size_t kb;
+    size_t xb;
+    void (*compute)(ConvKernelArguments<T> const& arguments, T* tile);
+};
+
+/*
+ * Portable microkernel; the accumulators are small enough for the compiler to keep in registers and vectorize.
+ * Supports any horizontal stride.
+ */
+template <typename T, size_t KB, size_t XB>
+auto ConvMicroKernel(ConvKernelArguments<T> const& arguments, T* tile) -> void
+{
+    T accumulators[KB][XB] = {};
+    T const* weights = arguments.weights;
+    for (size_t c = 0; c < arguments.channels; ++c)
+    {
+        for (size_t r = 0; r < arguments.kernelHeight; ++r)
+        {
+            T const* row = arguments.input + c * arguments.channelStride + r * arguments.rowStep;
+            for (size_t s = 0; s < arguments.kernelWidth; ++s)
+            {
+                T const* input = row + s * arguments.columnStep;
+                for (size_t i = 0; i < KB; ++i)
+                {
+                    T weight = weights[i];
+                    for (size_t j = 0; j < XB; ++j)
+                    {
+                        accumulators[i][j] += weight * input[j * arguments.stride];
+                    }
+                }
+                weights += KB;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < KB; ++i)
+    {
+        for (size_t j = 0; j < XB; ++j)
+        {
+            tile[i * XB + j] = accumulators[i][j];
+        }
+    }
+}
+
+#if TENSOR_SIMD_X86
+
+/*
+ * Define a 6 x (2 registers) microkernel for a horizontal stride of 1: every tap loads two registers of consecutive
+ * input columns, and accumulates their product with each of the six broadcast weights of the tap, keeping twelve
+ * accumulators live.
+ */
+#define TENSOR_CONV_KERNEL_6X2(Name, Target, T, Vector, Width, Zero, Load, Store, Broadcast, FusedMultiplyAdd) \
+    TENSOR_SIMD_TARGET(Target)                                                                                  \
+    inline auto Name(ConvKernelArguments<T> const& arguments, T* tile) -> void                                 \
+    {                                                                                                           \
+        Vector c00 = Zero(), c01 = Zero(), c10 = Zero(), c11 = Zero(), c20 = Zero(), c21 = Zero();              \
+        Vector c30 = Zero(), c31 = Zero(), c40 = Zero(), c41 = Zero(), c50 = Zero(), c51 = Zero();              \
+        T const* w = arguments.weights;                                                                         \
+        for (size_t c = 0; c < arguments.channels; ++c)                                                         \
+        {                                                                                                       \
+            for (size_t r = 0; r < arguments.kernelHeight; ++r)                                                 \
+            {                                                                                                   \
+                T const* row = arguments.input + c * arguments.channelStride + r * arguments.rowStep;           \
+                for (size_t s = 0; s < arguments.kernelWidth; ++s)                                              \
+                {                                                                                               \
+                    T const* input = row + s * arguments.columnStep;                                            \
+                    Vector x0 = Load(input);                                                                    \
+                    Vector x1 = Load(input + (Width));                                                          \
+                    Vector value = Broadcast(w + 0);                                                            \
+                    c00 = FusedMultiplyAdd(value, x0, c00);                                                     \
+                    c01 = FusedMultiplyAdd(value, x1, c01);                                                     \
+                    value = Broadcast(w + 1);                                                                   \
+                    c10 = FusedMultiplyAdd(value, x0, c10);                                                     \
+                    c11 = FusedMultiplyAdd(value, x1, c11);                                                     \
+                    value = Broadcast(w + 2);                                                                   \
+                    c20 = FusedMultiplyAdd(value, x0, c20);                                                     \
+                    c21 = FusedMultiplyAdd(value, x1, c21);                                                     \
+                    value = Broadcast(w + 3);                                                                   \
+                    c30 = FusedMultiplyAdd(value, x0, c30);                                                     \
+                    c31 = FusedMultiplyAdd(value, x1, c31);                                                     \
+                    value = Broadcast(w + 4);                                                                   \
+                    c40 = FusedMultiplyAdd(value, x0, c40);                                                     \
+                    c41 = FusedMultiplyAdd(value, x1, c41);                                                     \
+                    value = Broadcast(w + 5);                                                                   \
+                    c50 = FusedMultiplyAdd(value, x0, c50);                                                     \
+                    c51 = FusedMultiplyAdd(value, x1, c51);                                                     \
+                    w += 6;                                                                                     \
+                }                                                                                               \
+            }                                                                                                   \
+        }                                                                                                       \
+        Store(tile + 0 * (Width), c00);                                                                         \
+        Store(tile + 1 * (Width), c01);                                                                         \
+        Store(tile + 2 * (Width), c10);                                                                         \
+        Store(tile + 3 * (Width), c11);                                                                         \
+        Store(tile + 4 * (Width), c20);                                                                         \
+        Store(tile + 5 * (Width), c21);                                                                         \
+        Store(tile + 6 * (Width), c30);                                                                         \
+        Store(tile + 7 * (Width), c31);                                                                         \
+        Store(tile + 8 * (Width), c40);                                                                         \
+        Store(tile + 9 * (Width), c41);                                                                         \
+        Store(tile + 10 * (Width), c50);                                                                        \
+        Store(tile + 11 * (Width), c51);                                                                        \
+    }
+
+#define TENSOR_CONV_BROADCAST_PS_512(p) _mm512_set1_ps(*(p))
+#define TENSOR_CONV_BROADCAST_PD_512(p) _mm512_set1_pd(*(p))
+
+TENSOR_CONV_KERNEL_6X2(ConvKernelFloatAvx2, "avx2,fma", float, __m256, 8, _mm256_setzero_ps, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_broadcast_ss, _mm256_fmadd_ps)
+TENSOR_CONV_KERNEL_6X2(ConvKernelFloatAvx512, "avx512f,avx512bw", float, __m512, 16, _mm512_setzero_ps, _mm512_loadu_ps, _mm512_storeu_ps, TENSOR_CONV_BROADCAST_PS_512, _mm512_fmadd_ps)
+TENSOR_CONV_KERNEL_6X2(ConvKernelDoubleAvx2, "avx2,fma", double, __m256d, 4, _mm256_setzero_pd, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_broadcast_sd, _mm256_fmadd_pd)
+TENSOR_CONV_KERNEL_6X2(ConvKernelDoubleAvx512, "avx512f,avx512bw", double, __m512d, 8, _mm512_setzero_pd, _mm512_loadu_pd, _mm512_storeu_pd, TENSOR_CONV_BROADCAST_PD_512, _mm512_fmadd_pd)
+
+#undef TENSOR_CONV_KERNEL_6X2
+
+#endif
+
+/*
+ * Get the microkernel for the given value type, instruction set level and horizontal stride.
+ * Float and double have hand-written kernels from AVX2 up for a stride of 1; everything else uses the portable kernel.
+ */
+template <typename T>
+auto GetConvKernel(SimdLevel level, size_t stride) -> ConvKernel<T>
+{
+#if TENSOR_SIMD_X86
+    if constexpr (std::is_same_v<T, float>)
+    {
+        if (stride == 1 && level >= SimdLevel::AVX512)
+        {
+            return {6, 32, &ConvKernelFloatAvx512};
+        }
+        if (stride == 1 && level >= SimdLevel::AVX2)
+        {
+            return {6, 16, &ConvKernelFloatAvx2};
+        }
+    }
+    else if constexpr (std::is_same_v<T, double>)
+    {
+        if (stride == 1 && level >= SimdLevel::AVX512)
+        {
+            return {6, 16, &ConvKernelDoubleAvx512};
+        }
+        if (stride == 1 && level >= SimdLevel::AVX2)
+        {
+            return {6, 8, &ConvKernelDoubleAvx2};
+        }
+    }
+#endif
+    return {4, 8, &ConvMicroKernel<T, 4, 8>};
+}
+
+/*
+ * The microkernel for the given value type and horizontal stride on this processor.
+ */
+template <typename T>
+auto SelectConvKernel(size_t stride) -> ConvKernel<T>
+{
+    static ConvKernel<T> unitKernel = GetConvKernel<T>(ActiveSimdLevel(), 1);
+    static ConvKernel<T> stridedKernel = GetConvKernel<T>(ActiveSimdLevel(), 2);
+    return stride == 1 ? unitKernel : stridedKernel;
+}
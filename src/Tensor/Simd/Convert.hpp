@@ -0,0 +1,340 @@
+#pragma once
+
+#include "../Utilities/Half.hpp"
+#include "Cpu.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/*
+ * Kernel converting a dense array to another value type: destination[i] = source[i].
+ */
+template <typename S, typename D>
+using ConvertKernel = void (*)(S const* source, D* destination, size_t count);
+
+/*
+ * Conversion kernels for one pair of value types and instruction set level.
+ * Only specialized for the pairs with a hand-written kernel, between float and the 16-bit types; `available` is false
+ * otherwise. Every level gives the same bits as the scalar conversions in Half.hpp.
+ */
+template <typename S, typename D, SimdLevel Level>
+struct SimdConvert
+{
+    static constexpr bool available = false;
+};
+
+/*
+ * Portable kernels, only provided for the pairs which have a hand-written kernel at some level.
+ */
+template <typename S, typename D>
+    requires(IsHalfType<S> && std::is_same_v<D, float>) || (std::is_same_v<S, float> && IsHalfType<D>)
+struct SimdConvert<S, D, SimdLevel::Scalar>
+{
+    static constexpr bool available = true;
+
+    static auto Apply(S const* source, D* destination, size_t count) -> void
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            destination[i] = static_cast<D>(source[i]);
+        }
+    }
+};
+
+#if TENSOR_SIMD_X86
+
+/*
+ * binary16 uses the F16C instructions, which every processor at the AVX2 level has, or their AVX-512 forms. Rounding is
+ * to nearest even, as in FloatToHalfBits.
+ */
+template <>
+struct SimdConvert<Float16, float, SimdLevel::AVX2>
+{
+    static constexpr bool available = true;
+
+    TENSOR_SIMD_TARGET("avx2,fma,f16c")
+    static auto Apply(Float16 const* source, float* destination, size_t count) -> void
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm256_storeu_ps(destination + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i))));
+        }
+        for (; i < count; ++i)
+        {
+            destination[i] = source[i];
+        }
+    }
+};
+
+template <>
+struct SimdConvert<float, Float16, SimdLevel::AVX2>
+{
+    static constexpr bool available = true;
+
+    TENSOR_SIMD_TARGET("avx2,fma,f16c")
+    static auto Apply(float const* source, Float16* destination, size_t count) -> void
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), half);
+        }
+        for (; i < count; ++i)
+        {
+            destination[i] = source[i];
+        }
+    }
+};
+
+template <>
+struct SimdConvert<Float16, float, SimdLevel::AVX512>
+{
+    static constexpr bool available = true;
+
+    TENSOR_SIMD_TARGET("avx512f,avx512bw")
+    static auto Apply(Float16 const* source, float* destination, size_t count) -> void
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            _mm512_storeu_ps(destination + i, _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(source + i))));
+        }
+        for (; i < count; ++i)
+        {
+            destination[i] = source[i];
+        }
+    }
+};
+
+template <>
+struct SimdConvert<float, Float16, SimdLevel::AVX512>
+{
+    static constexpr bool available = true;
+
+    TENSOR_SIMD_TARGET("avx512f,avx512bw")
+    static auto Apply(float const* source, Float16* destination, size_t count) -> void
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m256i half = _mm512_cvtps_ph(_mm512_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), half);
+        }
+        for (; i < count; ++i)
+        {
+            destination[i] = source[i];
+        }
+    }
+};
+
+/*
+ * bfloat16 is the upper half of a float, so widening is a shift, and narrowing rounds with integer arithmetic as in
+ * FloatToBFloat16Bits. Processors with AVX-512 BF16 narrow with ConvertBFloat16Native instead.
+ */
+template <>
+struct SimdConvert<BFloat16, float, SimdLevel::AVX2>
+{
+    static constexpr bool available = true;
+
+    TENSOR_SIMD_TARGET("avx2,fma")
+    static auto Apply(BFloat16 const* source, float* destination, size_t count) -> void
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_slli_epi32(wide, 16));
+        }
+        for (; i < count; ++i)
+        {
+            destination[i] = source[i];
+        }
+    }
+};
+
+template <>
+struct SimdConvert<float, BFloat16, SimdLevel::AVX2>
+{
+    static constexpr bool available = true;
+
+    TENSOR_SIMD_TARGET("avx2,fma")
+    static auto Apply(float const* source, BFloat16* destination, size_t count) -> void
+    {
+        __m256i const magnitude = _mm256_set1_epi32(0x7fffffff);
+        __m256i const infinity = _mm256_set1_epi32(0x7f800000);
+        __m256i const bias = _mm256_set1_epi32(0x7fff);
+        __m256i const one = _mm256_set1_epi32(1);
+        __m256i const quiet = _mm256_set1_epi32(0x400000);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i bits = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(source + i));
+            __m256i odd = _mm256_and_si256(_mm256_srli_epi32(bits, 16), one);
+            __m256i rounded = _mm256_add_epi32(bits, _mm256_add_epi32(bias, odd));
+            __m256i nan = _mm256_cmpgt_epi32(_mm256_and_si256(bits, magnitude), infinity);
+            __m256i result = _mm256_srli_epi32(_mm256_blendv_epi8(rounded, _mm256_or_si256(bits, quiet), nan), 16);
+
+            // pack the two 128-bit halves separately, as the 256-bit pack would interleave them
+            __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), packed);
+        }
+        for (; i < count; ++i)
+        {
+            destination[i] = source[i];
+        }
+    }
+};
+
+template <>
+struct SimdConvert<BFloat16, float, SimdLevel::AVX512>
+{
+    static constexpr bool available = true;
+
+    TENSOR_SIMD_TARGET("avx512f,avx512bw")
+    static auto Apply(BFloat16 const* source, float* destination, size_t count) -> void
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m512i wide = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(source + i)));
+            _mm512_storeu_si512(static_cast<void*>(destination + i), _mm512_slli_epi32(wide, 16));
+        }
+        for (; i < count; ++i)
+        {
+            destination[i] = source[i];
+        }
+    }
+};
+
+template <>
+struct SimdConvert<float, BFloat16, SimdLevel::AVX512>
+{
+    static constexpr bool available = true;
+
+    TENSOR_SIMD_TARGET("avx512f,avx512bw")
+    static auto Apply(float const* source, BFloat16* destination, size_t count) -> void
+    {
+        __m512i const magnitude = _mm512_set1_epi32(0x7fffffff);
+        __m512i const infinity = _mm512_set1_epi32(0x7f800000);
+        __m512i const bias = _mm512_set1_epi32(0x7fff);
+        __m512i const one = _mm512_set1_epi32(1);
+        __m512i const quiet = _mm512_set1_epi32(0x400000);
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m512i bits = _mm512_loadu_si512(static_cast<void const*>(source + i));
+            __m512i odd = _mm512_and_si512(_mm512_srli_epi32(bits, 16), one);
+            __m512i rounded = _mm512_add_epi32(bits, _mm512_add_epi32(bias, odd));
+            __mmask16 nan = _mm512_cmpgt_epi32_mask(_mm512_and_si512(bits, magnitude), infinity);
+            __m512i result = _mm512_srli_epi32(_mm512_mask_or_epi32(rounded, nan, bits, quiet), 16);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm512_cvtepi32_epi16(result));
+        }
+        for (; i < count; ++i)
+        {
+            destination[i] = source[i];
+        }
+    }
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TENSOR_SIMD_AVX512_BF16 1
+
+/*
+ * Narrowing to bfloat16 with the AVX-512 BF16 instruction VCVTNEPS2BF16, which rounds to nearest even and quiets NaNs
+ * like FloatToBFloat16Bits but flushes subnormal inputs to zero. Blocks holding any subnormal are converted one element
+ * at a time instead, so the results are the same on every processor.
+ */
+struct ConvertBFloat16Native
+{
+    TENSOR_SIMD_TARGET("avx512f,avx512bw,avx512vl,avx512bf16")
+    static auto Apply(float const* source, BFloat16* destination, size_t count) -> void
+    {
+        __m512i const exponent = _mm512_set1_epi32(0x7f800000);
+        __m512i const magnitude = _mm512_set1_epi32(0x7fffffff);
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m512i bits = _mm512_loadu_si512(static_cast<void const*>(source + i));
+            __mmask16 subnormal = _mm512_mask_test_epi32_mask(_mm512_testn_epi32_mask(bits, exponent), bits, magnitude);
+            if (subnormal != 0)
+            {
+                for (size_t j = i; j < i + 16; ++j)
+                {
+                    destination[j] = source[j];
+                }
+                continue;
+            }
+            __m256bh narrowed = _mm512_cvtneps_pbh(_mm512_castsi512_ps(bits));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), (__m256i)narrowed);
+        }
+        for (; i < count; ++i)
+        {
+            destination[i] = source[i];
+        }
+    }
+};
+#endif
+
+#endif
+
+#ifndef TENSOR_SIMD_AVX512_BF16
+#define TENSOR_SIMD_AVX512_BF16 0
+#endif
+
+/*
+ * Whether any instruction set level has a hand-written conversion kernel between the given value types.
+ */
+template <typename S, typename D>
+inline constexpr bool HasConvertKernel = SimdConvert<S, D, SimdLevel::AVX2>::available
+                                      || SimdConvert<S, D, SimdLevel::AVX512>::available;
+
+/*
+ * Get the conversion kernel for the given level, or the best level below it which has one. `avx512Bf16` selects
+ * ConvertBFloat16Native for narrowing to bfloat16 at the AVX512 level.
+ */
+template <typename S, typename D>
+auto GetConvertKernel(SimdLevel level, bool avx512Bf16 = false) -> ConvertKernel<S, D>
+{
+    using enum SimdLevel;
+
+#if TENSOR_SIMD_X86 && TENSOR_SIMD_AVX512_BF16
+    if constexpr (std::is_same_v<S, float> && std::is_same_v<D, BFloat16>)
+    {
+        if (level >= AVX512 && avx512Bf16)
+        {
+            return &ConvertBFloat16Native::Apply;
+        }
+    }
+#endif
+    if constexpr (SimdConvert<S, D, AVX512>::available)
+    {
+        if (level >= AVX512)
+        {
+            return &SimdConvert<S, D, AVX512>::Apply;
+        }
+    }
+    if constexpr (SimdConvert<S, D, AVX2>::available)
+    {
+        if (level >= AVX2)
+        {
+            return &SimdConvert<S, D, AVX2>::Apply;
+        }
+    }
+    return &SimdConvert<S, D, Scalar>::Apply;
+}
+
+/*
+ * The conversion kernel between the given value types on this processor, selected once on first use.
+ */
+template <typename S, typename D>
+auto SelectConvertKernel() -> ConvertKernel<S, D>
+{
+    static ConvertKernel<S, D> kernel = GetConvertKernel<S, D>(ActiveSimdLevel(), DetectAvx512Bf16());
+    return kernel;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define TENSOR_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define TENSOR_SIMD_X86 0
+#endif
+
+/*
+ * Enable an instruction set for a single function, so kernels for several instruction sets can live in one translation
+ * unit built for the baseline architecture. MSVC allows intrinsics for any instruction set without this.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define TENSOR_SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define TENSOR_SIMD_TARGET(isa)
+#endif
+
+/*
+ * Instruction set levels for which kernels are provided, in increasing order of capability.
+ */
+enum class SimdLevel
+{
+    Scalar,
+    SSE42,
+    AVX2,
+    AVX512,
+};
+
+inline constexpr SimdLevel SimdLevels[] = {SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512};
+
+/*
+ * Query the processor (and operating system support for the wider registers) for the best available instruction set.
+ * AVX2 also requires FMA and F16C, and AVX512 requires the F and BW subsets, as kernels at those levels may use them.
+ */
+inline auto DetectSimdLevel() -> SimdLevel
+{
+#if TENSOR_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c"))
+    {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        return SimdLevel::SSE42;
+    }
+    return SimdLevel::Scalar;
+#elif TENSOR_SIMD_X86 && defined(_MSC_VER)
+    int registers[4];
+    __cpuid(registers, 0);
+    int highest = registers[0];
+
+    __cpuid(registers, 1);
+    bool sse42 = (registers[2] & (1 << 20)) != 0;
+    bool fma = (registers[2] & (1 << 12)) != 0;
+    bool f16c = (registers[2] & (1 << 29)) != 0;
+    bool osxsave = (registers[2] & (1 << 27)) != 0;
+
+    bool avx2 = false;
+    bool avx512 = false;
+    if (highest >= 7 && osxsave)
+    {
+        unsigned long long xcr0 = _xgetbv(0);
+        bool ymm = (xcr0 & 0x6) == 0x6;
+        bool zmm = (xcr0 & 0xe6) == 0xe6;
+
+        __cpuidex(registers, 7, 0);
+        avx2 = ymm && fma && f16c && (registers[1] & (1 << 5)) != 0;
+        avx512 = zmm && (registers[1] & (1 << 16)) != 0 && (registers[1] & (1 << 30)) != 0;
+    }
+
+    if (avx512)
+    {
+        return SimdLevel::AVX512;
+    }
+    if (avx2)
+    {
+        return SimdLevel::AVX2;
+    }
+    return sse42 ? SimdLevel::SSE42 : SimdLevel::Scalar;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+/*
+ * The instruction set level used by the kernels in this process, detected once on first use.
+ */
+inline auto ActiveSimdLevel() -> SimdLevel
+{
+    static SimdLevel level = DetectSimdLevel();
+    return level;
+}
+
+/*
+ * Query the processor for the AVX-512 BF16 extension, which is not part of any level and only used for conversions to
+ * bfloat16 at the AVX512 level.
+ */
+inline auto DetectAvx512Bf16() -> bool
+{
+#if TENSOR_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512bf16") && DetectSimdLevel() >= SimdLevel::AVX512;
+#elif TENSOR_SIMD_X86 && defined(_MSC_VER)
+    int registers[4];
+    __cpuid(registers, 0);
+    if (registers[0] < 7)
+    {
+        return false;
+    }
+    __cpuidex(registers, 7, 1);
+    return (registers[0] & (1 << 5)) != 0 && DetectSimdLevel() >= SimdLevel::AVX512;
+#else
+    return false;
+#endif
+}
+
+/*
+ * Query the processor for the AVX-512 VNNI extension, which is not part of any level and only used by the int8 matrix
+ * multiplication at the AVX512 level.
+ */
+inline auto DetectAvx512Vnni() -> bool
+{
+#if TENSOR_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512vnni") && DetectSimdLevel() >= SimdLevel::AVX512;
+#elif TENSOR_SIMD_X86 && defined(_MSC_VER)
+    int registers[4];
+    __cpuid(registers, 0);
+    if (registers[0] < 7)
+    {
+        return false;
+    }
+    __cpuidex(registers, 7, 0);
+    return (registers[2] & (1 << 11)) != 0 && DetectSimdLevel() >= SimdLevel::AVX512;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "../Utilities/Operations.hpp"
+#include "Cpu.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/*
+ * Kernel applying a binary operation to two dense arrays: output[i] = left[i] op right[i].
+ */
+template <typename T>
+using BinaryKernel = void (*)(T const* left, T const* right, T* output, size_t count);
+
+/*
+ * Kernel applying a binary operation to a dense array and a scalar: output[i] = left[i] op right.
+ */
+template <typename T>
+using BinaryScalarKernel = void (*)(T const* left, T right, T* output, size_t count);
+
+/*
+ * Elementwise kernels for one value type, operation and instruction set level.
+ * Only specialized for the combinations with a hand-written kernel; `available` is false otherwise.
+ */
+template <typename T, typename Operation, SimdLevel Level>
+struct SimdBinary
+{
+    static constexpr bool available = false;
+};
+
+/*
+ * Portable kernels, which the compiler may still vectorize for the baseline instruction set.
+ */
+template <typename T, typename Operation>
+struct SimdBinary<T, Operation, SimdLevel::Scalar>
+{
+    static constexpr bool available = true;
+
+    static auto Apply(T const* left, T const* right, T* output, size_t count) -> void
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            output[i] = Operation{}(left[i], right[i]);
+        }
+    }
+
+    static auto ApplyScalar(T const* left, T right, T* output, size_t count) -> void
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            output[i] = Operation{}(left[i], right);
+        }
+    }
+};
+
+#if TENSOR_SIMD_X86
+
+/*
+ * Define the kernels of one value type, operation and level. The main loop processes a full register per iteration, and
+ * the remaining elements are processed one at a time.
+ */
+#define TENSOR_SIMD_BINARY(T, Operation, Level, Target, Width, Load, Store, Broadcast, VectorOperation, ScalarOperation) \
+    template <>                                                                                                          \
+    struct SimdBinary<T, Operation, SimdLevel::Level>                                                                    \
+    {                                                                                                                    \
+        static constexpr bool available = true;                                                                          \
+                                                                                                                         \
+        TENSOR_SIMD_TARGET(Target)                                                                                       \
+        static auto Apply(T const* left, T const* right, T* output, size_t count) -> void                               \
+        {                                                                                                                \
+            size_t i = 0;                                                                                                \
+            for (; i + (Width) <= count; i += (Width))                                                                   \
+            {                                                                                                            \
+                Store(output + i, VectorOperation(Load(left + i), Load(right + i)));                                     \
+            }                                                                                                            \
+            for (; i < count; ++i)                                                                                       \
+            {                                                                                                            \
+                output[i] = static_cast<T>(left[i] ScalarOperation right[i]);                                            \
+            }                                                                                                            \
+        }                                                                                                                \
+                                                                                                                         \
+        TENSOR_SIMD_TARGET(Target)                                                                                       \
+        static auto ApplyScalar(T const* left, T right, T* output, size_t count) -> void                                \
+        {                                                                                                                \
+            auto broadcast = Broadcast(right);                                                                           \
+            size_t i = 0;                                                                                                \
+            for (; i + (Width) <= count; i += (Width))                                                                   \
+            {                                                                                                            \
+                Store(output + i, VectorOperation(Load(left + i), broadcast));                                           \
+            }                                                                                                            \
+            for (; i < count; ++i)                                                                                       \
+            {                                                                                                            \
+                output[i] = static_cast<T>(left[i] ScalarOperation right);                                               \
+            }                                                                                                            \
+        }                                                                                                                \
+    };
+
+#define TENSOR_SIMD_LOAD_128(p) _mm_loadu_si128(reinterpret_cast<__m128i const*>(p))
+#define TENSOR_SIMD_STORE_128(p, v) _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v)
+#define TENSOR_SIMD_LOAD_256(p) _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p))
+#define TENSOR_SIMD_STORE_256(p, v) _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v)
+#define TENSOR_SIMD_LOAD_512(p) _mm512_loadu_si512(static_cast<void const*>(p))
+#define TENSOR_SIMD_STORE_512(p, v) _mm512_storeu_si512(static_cast<void*>(p), v)
+#define TENSOR_SIMD_SET1_EPI8_128(v) _mm_set1_epi8(static_cast<char>(v))
+#define TENSOR_SIMD_SET1_EPI8_256(v) _mm256_set1_epi8(static_cast<char>(v))
+#define TENSOR_SIMD_SET1_EPI8_512(v) _mm512_set1_epi8(static_cast<char>(v))
+
+// float
+TENSOR_SIMD_BINARY(float, AddOperation, SSE42, "sse4.2", 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, _mm_add_ps, +)
+TENSOR_SIMD_BINARY(float, SubtractOperation, SSE42, "sse4.2", 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, _mm_sub_ps, -)
+TENSOR_SIMD_BINARY(float, MultiplyOperation, SSE42, "sse4.2", 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, _mm_mul_ps, *)
+TENSOR_SIMD_BINARY(float, DivideOperation, SSE42, "sse4.2", 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, _mm_div_ps, /)
+TENSOR_SIMD_BINARY(float, AddOperation, AVX2, "avx2,fma", 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_add_ps, +)
+TENSOR_SIMD_BINARY(float, SubtractOperation, AVX2, "avx2,fma", 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_sub_ps, -)
+TENSOR_SIMD_BINARY(float, MultiplyOperation, AVX2, "avx2,fma", 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_mul_ps, *)
+TENSOR_SIMD_BINARY(float, DivideOperation, AVX2, "avx2,fma", 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_div_ps, /)
+TENSOR_SIMD_BINARY(float, AddOperation, AVX512, "avx512f,avx512bw", 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, _mm512_add_ps, +)
+TENSOR_SIMD_BINARY(float, SubtractOperation, AVX512, "avx512f,avx512bw", 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, _mm512_sub_ps, -)
+TENSOR_SIMD_BINARY(float, MultiplyOperation, AVX512, "avx512f,avx512bw", 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, _mm512_mul_ps, *)
+TENSOR_SIMD_BINARY(float, DivideOperation, AVX512, "avx512f,avx512bw", 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, _mm512_div_ps, /)
+
+// double
+TENSOR_SIMD_BINARY(double, AddOperation, SSE42, "sse4.2", 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_add_pd, +)
+TENSOR_SIMD_BINARY(double, SubtractOperation, SSE42, "sse4.2", 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_sub_pd, -)
+TENSOR_SIMD_BINARY(double, MultiplyOperation, SSE42, "sse4.2", 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_mul_pd, *)
+TENSOR_SIMD_BINARY(double, DivideOperation, SSE42, "sse4.2", 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_div_pd, /)
+TENSOR_SIMD_BINARY(double, AddOperation, AVX2, "avx2,fma", 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_add_pd, +)
+TENSOR_SIMD_BINARY(double, SubtractOperation, AVX2, "avx2,fma", 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_sub_pd, -)
+TENSOR_SIMD_BINARY(double, MultiplyOperation, AVX2, "avx2,fma", 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_mul_pd, *)
+TENSOR_SIMD_BINARY(double, DivideOperation, AVX2, "avx2,fma", 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_div_pd, /)
+TENSOR_SIMD_BINARY(double, AddOperation, AVX512, "avx512f,avx512bw", 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_add_pd, +)
+TENSOR_SIMD_BINARY(double, SubtractOperation, AVX512, "avx512f,avx512bw", 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_sub_pd, -)
+TENSOR_SIMD_BINARY(double, MultiplyOperation, AVX512, "avx512f,avx512bw", 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_mul_pd, *)
+TENSOR_SIMD_BINARY(double, DivideOperation, AVX512, "avx512f,avx512bw", 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_div_pd, /)
+
+// int32, there is no integer division instruction
+TENSOR_SIMD_BINARY(int32_t, AddOperation, SSE42, "sse4.2", 4, TENSOR_SIMD_LOAD_128, TENSOR_SIMD_STORE_128, _mm_set1_epi32, _mm_add_epi32, +)
+TENSOR_SIMD_BINARY(int32_t, SubtractOperation, SSE42, "sse4.2", 4, TENSOR_SIMD_LOAD_128, TENSOR_SIMD_STORE_128, _mm_set1_epi32, _mm_sub_epi32, -)
+TENSOR_SIMD_BINARY(int32_t, MultiplyOperation, SSE42, "sse4.2", 4, TENSOR_SIMD_LOAD_128, TENSOR_SIMD_STORE_128, _mm_set1_epi32, _mm_mullo_epi32, *)
+TENSOR_SIMD_BINARY(int32_t, AddOperation, AVX2, "avx2,fma", 8, TENSOR_SIMD_LOAD_256, TENSOR_SIMD_STORE_256, _mm256_set1_epi32, _mm256_add_epi32, +)
+TENSOR_SIMD_BINARY(int32_t, SubtractOperation, AVX2, "avx2,fma", 8, TENSOR_SIMD_LOAD_256, TENSOR_SIMD_STORE_256, _mm256_set1_epi32, _mm256_sub_epi32, -)
+TENSOR_SIMD_BINARY(int32_t, MultiplyOperation, AVX2, "avx2,fma", 8, TENSOR_SIMD_LOAD_256, TENSOR_SIMD_STORE_256, _mm256_set1_epi32, _mm256_mullo_epi32, *)
+TENSOR_SIMD_BINARY(int32_t, AddOperation, AVX512, "avx512f,avx512bw", 16, TENSOR_SIMD_LOAD_512, TENSOR_SIMD_STORE_512, _mm512_set1_epi32, _mm512_add_epi32, +)
+TENSOR_SIMD_BINARY(int32_t, SubtractOperation, AVX512, "avx512f,avx512bw", 16, TENSOR_SIMD_LOAD_512, TENSOR_SIMD_STORE_512, _mm512_set1_epi32, _mm512_sub_epi32, -)
+TENSOR_SIMD_BINARY(int32_t, MultiplyOperation, AVX512, "avx512f,avx512bw", 16, TENSOR_SIMD_LOAD_512, TENSOR_SIMD_STORE_512, _mm512_set1_epi32, _mm512_mullo_epi32, *)
+
+// uint8, wrapping like the scalar operations; there are no 8-bit multiplication or division instructions
+TENSOR_SIMD_BINARY(uint8_t, AddOperation, SSE42, "sse4.2", 16, TENSOR_SIMD_LOAD_128, TENSOR_SIMD_STORE_128, TENSOR_SIMD_SET1_EPI8_128, _mm_add_epi8, +)
+TENSOR_SIMD_BINARY(uint8_t, SubtractOperation, SSE42, "sse4.2", 16, TENSOR_SIMD_LOAD_128, TENSOR_SIMD_STORE_128, TENSOR_SIMD_SET1_EPI8_128, _mm_sub_epi8, -)
+TENSOR_SIMD_BINARY(uint8_t, AddOperation, AVX2, "avx2,fma", 32, TENSOR_SIMD_LOAD_256, TENSOR_SIMD_STORE_256, TENSOR_SIMD_SET1_EPI8_256, _mm256_add_epi8, +)
+TENSOR_SIMD_BINARY(uint8_t, SubtractOperation, AVX2, "avx2,fma", 32, TENSOR_SIMD_LOAD_256, TENSOR_SIMD_STORE_256, TENSOR_SIMD_SET1_EPI8_256, _mm256_sub_epi8, -)
+TENSOR_SIMD_BINARY(uint8_t, AddOperation, AVX512, "avx512f,avx512bw", 64, TENSOR_SIMD_LOAD_512, TENSOR_SIMD_STORE_512, TENSOR_SIMD_SET1_EPI8_512, _mm512_add_epi8, +)
+TENSOR_SIMD_BINARY(uint8_t, SubtractOperation, AVX512, "avx512f,avx512bw", 64, TENSOR_SIMD_LOAD_512, TENSOR_SIMD_STORE_512, TENSOR_SIMD_SET1_EPI8_512, _mm512_sub_epi8, -)
+
+#undef TENSOR_SIMD_BINARY
+
+#endif
+
+/*
+ * Whether any instruction set level has a hand-written kernel for the given value type and operation.
+ */
+template <typename T, typename Operation>
+inline constexpr bool HasSimdKernel = SimdBinary<T, Operation, SimdLevel::SSE42>::available
+                                   || SimdBinary<T, Operation, SimdLevel::AVX2>::available
+                                   || SimdBinary<T, Operation, SimdLevel::AVX512>::available;
+
+/*
+ * Get the kernels for the given level, or the best level below it which has one.
+ */
+template <typename T, typename Operation>
+auto GetBinaryKernels(SimdLevel level) -> std::pair<BinaryKernel<T>, BinaryScalarKernel<T>>
+{
+    using enum SimdLevel;
+
+    if constexpr (SimdBinary<T, Operation, AVX512>::available)
+    {
+        if (level >= AVX512)
+        {
+            return {&SimdBinary<T, Operation, AVX512>::Apply, &SimdBinary<T, Operation, AVX512>::ApplyScalar};
+        }
+    }
+    if constexpr (SimdBinary<T, Operation, AVX2>::available)
+    {
+        if (level >= AVX2)
+        {
+            return {&SimdBinary<T, Operation, AVX2>::Apply, &SimdBinary<T, Operation, AVX2>::ApplyScalar};
+        }
+    }
+    if constexpr (SimdBinary<T, Operation, SSE42>::available)
+    {
+        if (level >= SSE42)
+        {
+            return {&SimdBinary<T, Operation, SSE42>::Apply, &SimdBinary<T, Operation, SSE42>::ApplyScalar};
+        }
+    }
+    return {&SimdBinary<T, Operation, Scalar>::Apply, &SimdBinary<T, Operation, Scalar>::ApplyScalar};
+}
+
+/*
+ * The kernel for the given value type and operation on this processor, selected once on first use.
+ */
+template <typename T, typename Operation>
+auto SelectBinaryKernel() -> BinaryKernel<T>
+{
+    static BinaryKernel<T> kernel = GetBinaryKernels<T, Operation>(ActiveSimdLevel()).first;
+    return kernel;
+}
+
+template <typename T, typename Operation>
+auto SelectBinaryScalarKernel() -> BinaryScalarKernel<T>
+{
+    static BinaryScalarKernel<T> kernel = GetBinaryKernels<T, Operation>(ActiveSimdLevel()).second;
+    return kernel;
+}
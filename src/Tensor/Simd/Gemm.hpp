@@ -0,0 +1,156 @@
+#pragma once
+
+#include "Cpu.hpp"
+
+#include <cstddef>
+#include <type_traits>
+
+/*
+ * Register-blocked matrix multiplication microkernel, computing one MR x NR tile of a product from packed panels.
+ * The A panel holds k columns of MR elements, the B panel holds k rows of NR elements, and the tile is written densely
+ * in row-major order, overwriting its previous contents.
+ */
+template <typename T>
+struct GemmKernel
+{
+    size_t mr;
+    size_t nr;
+    void (*compute)(size_t k, T const* a, T const* b, T* tile);
+};
+
+/*
+ * Portable microkernel; the accumulators are small enough for the compiler to keep in registers and vectorize.
+ */
+template <typename T, size_t MR, size_t NR>
+auto GemmMicroKernel(size_t k, T const* a, T const* b, T* tile) -> void
+{
+    T accumulators[MR][NR] = {};
+    for (size_t p = 0; p < k; ++p)
+    {
+        for (size_t i = 0; i < MR; ++i)
+        {
+            T value = a[i];
+            for (size_t j = 0; j < NR; ++j)
+            {
+                accumulators[i][j] += value * b[j];
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+
+    for (size_t i = 0; i < MR; ++i)
+    {
+        for (size_t j = 0; j < NR; ++j)
+        {
+            tile[i * NR + j] = accumulators[i][j];
+        }
+    }
+}
+
+#if TENSOR_SIMD_X86
+
+/*
+ * Define a 6 x (2 registers) microkernel: every iteration loads one row of the B panel into two registers, and
+ * accumulates its product with each of the six broadcast elements of the A panel, keeping twelve accumulators live.
+ */
+#define TENSOR_GEMM_KERNEL_6X2(Name, Target, T, Vector, Width, Zero, Load, Store, Broadcast, FusedMultiplyAdd) \
+    TENSOR_SIMD_TARGET(Target)                                                                                  \
+    inline auto Name(size_t k, T const* a, T const* b, T* tile) -> void                                        \
+    {                                                                                                           \
+        Vector c00 = Zero(), c01 = Zero(), c10 = Zero(), c11 = Zero(), c20 = Zero(), c21 = Zero();              \
+        Vector c30 = Zero(), c31 = Zero(), c40 = Zero(), c41 = Zero(), c50 = Zero(), c51 = Zero();              \
+        for (size_t p = 0; p < k; ++p)                                                                          \
+        {                                                                                                       \
+            Vector b0 = Load(b);                                                                                \
+            Vector b1 = Load(b + (Width));                                                                      \
+            Vector value = Broadcast(a + 0);                                                                    \
+            c00 = FusedMultiplyAdd(value, b0, c00);                                                             \
+            c01 = FusedMultiplyAdd(value, b1, c01);                                                             \
+            value = Broadcast(a + 1);                                                                           \
+            c10 = FusedMultiplyAdd(value, b0, c10);                                                             \
+            c11 = FusedMultiplyAdd(value, b1, c11);                                                             \
+            value = Broadcast(a + 2);                                                                           \
+            c20 = FusedMultiplyAdd(value, b0, c20);                                                             \
+            c21 = FusedMultiplyAdd(value, b1, c21);                                                             \
+            value = Broadcast(a + 3);                                                                           \
+            c30 = FusedMultiplyAdd(value, b0, c30);                                                             \
+            c31 = FusedMultiplyAdd(value, b1, c31);                                                             \
+            value = Broadcast(a + 4);                                                                           \
+            c40 = FusedMultiplyAdd(value, b0, c40);                                                             \
+            c41 = FusedMultiplyAdd(value, b1, c41);                                                             \
+            value = Broadcast(a + 5);                                                                           \
+            c50 = FusedMultiplyAdd(value, b0, c50);                                                             \
+            c51 = FusedMultiplyAdd(value, b1, c51);                                                             \
+            a += 6;                                                                                             \
+            b += 2 * (Width);                                                                                   \
+        }                                                                                                       \
+        Store(tile + 0 * (Width), c00);                                                                         \
+        Store(tile + 1 * (Width), c01);                                                                         \
+        Store(tile + 2 * (Width), c10);                                                                         \
+        Store(tile + 3 * (Width), c11);                                                                         \
+        Store(tile + 4 * (Width), c20);                                                                         \
+        Store(tile + 5 * (Width), c21);                                                                         \
+        Store(tile + 6 * (Width), c30);                                                                         \
+        Store(tile + 7 * (Width), c31);                                                                         \
+        Store(tile + 8 * (Width), c40);                                                                         \
+        Store(tile + 9 * (Width), c41);                                                                         \
+        Store(tile + 10 * (Width), c50);                                                                        \
+        Store(tile + 11 * (Width), c51);                                                                        \
+    }
+
+#define TENSOR_GEMM_BROADCAST_PS_512(p) _mm512_set1_ps(*(p))
+#define TENSOR_GEMM_BROADCAST_PD_512(p) _mm512_set1_pd(*(p))
+
+TENSOR_GEMM_KERNEL_6X2(GemmKernelFloatAvx2, "avx2,fma", float, __m256, 8, _mm256_setzero_ps, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_broadcast_ss, _mm256_fmadd_ps)
+TENSOR_GEMM_KERNEL_6X2(GemmKernelFloatAvx512, "avx512f,avx512bw", float, __m512, 16, _mm512_setzero_ps, _mm512_loadu_ps, _mm512_storeu_ps, TENSOR_GEMM_BROADCAST_PS_512, _mm512_fmadd_ps)
+TENSOR_GEMM_KERNEL_6X2(GemmKernelDoubleAvx2, "avx2,fma", double, __m256d, 4, _mm256_setzero_pd, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_broadcast_sd, _mm256_fmadd_pd)
+TENSOR_GEMM_KERNEL_6X2(GemmKernelDoubleAvx512, "avx512f,avx512bw", double, __m512d, 8, _mm512_setzero_pd, _mm512_loadu_pd, _mm512_storeu_pd, TENSOR_GEMM_BROADCAST_PD_512, _mm512_fmadd_pd)
+
+#undef TENSOR_GEMM_KERNEL_6X2
+
+#endif
+
+/*
+ * Get the microkernel for the given value type and instruction set level.
+ * Float and double have hand-written kernels from AVX2 up; everything else uses the portable kernel.
+ */
+template <typename T>
+auto GetGemmKernel(SimdLevel level) -> GemmKernel<T>
+{
+#if TENSOR_SIMD_X86
+    if constexpr (std::is_same_v<T, float>)
+    {
+        if (level >= SimdLevel::AVX512)
+        {
+            return {6, 32, &GemmKernelFloatAvx512};
+        }
+        if (level >= SimdLevel::AVX2)
+        {
+            return {6, 16, &GemmKernelFloatAvx2};
+        }
+    }
+    else if constexpr (std::is_same_v<T, double>)
+    {
+        if (level >= SimdLevel::AVX512)
+        {
+            return {6, 16, &GemmKernelDoubleAvx512};
+        }
+        if (level >= SimdLevel::AVX2)
+        {
+            return {6, 8, &GemmKernelDoubleAvx2};
+        }
+    }
+#endif
+    return {4, 8, &GemmMicroKernel<T, 4, 8>};
+}
+
+/*
+ * The microkernel for the given value type on this processor, selected once on first use.
+ */
+template <typename T>
+auto SelectGemmKernel() -> GemmKernel<T>
+{
+    static GemmKernel<T> kernel = GetGemmKernel<T>(ActiveSimdLevel());
+    return kernel;
+}
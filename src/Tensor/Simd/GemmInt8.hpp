@@ -0,0 +1,240 @@
+#pragma once
+
+#include "Cpu.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*
+ * Number of consecutive elements along k which the int8 microkernels multiply and add in one instruction. Panels are
+ * packed in groups of this many, zero padded at the end of k.
+ */
+inline constexpr size_t GemmInt8Group = 4;
+
+/*
+ * Register-blocked int8 matrix multiplication microkernel, computing one MR x NR tile of an int32 product of 8-bit A,
+ * signed or unsigned, and signed B, from packed panels. For each group of GemmInt8Group elements along k, the A panel
+ * holds the group of each of its MR rows, and the B panel the group of each of its NR columns. The tile is written
+ * densely in row-major order, overwriting its previous contents.
+ * Kernels which `shiftsA` take signed A packed as a + 128, its bits flipped by XOR 0x80, as VNNI only multiplies
+ * unsigned by signed bytes; the caller subtracts 128 times the column sums of B.
+ */
+template <typename TA>
+struct GemmInt8Kernel
+{
+    size_t mr;
+    size_t nr;
+    bool shiftsA;
+    void (*compute)(size_t groups, TA const* a, int8_t const* b, int32_t* tile);
+};
+
+/*
+ * Portable microkernel.
+ */
+template <typename TA, size_t MR, size_t NR>
+auto GemmInt8MicroKernel(size_t groups, TA const* a, int8_t const* b, int32_t* tile) -> void
+{
+    int32_t accumulators[MR][NR] = {};
+    for (size_t g = 0; g < groups; ++g)
+    {
+        for (size_t i = 0; i < MR; ++i)
+        {
+            for (size_t j = 0; j < NR; ++j)
+            {
+                int32_t sum = 0;
+                for (size_t q = 0; q < GemmInt8Group; ++q)
+                {
+                    sum += static_cast<int32_t>(a[i * GemmInt8Group + q]) * static_cast<int32_t>(b[j * GemmInt8Group + q]);
+                }
+                accumulators[i][j] += sum;
+            }
+        }
+        a += MR * GemmInt8Group;
+        b += NR * GemmInt8Group;
+    }
+
+    for (size_t i = 0; i < MR; ++i)
+    {
+        for (size_t j = 0; j < NR; ++j)
+        {
+            tile[i * NR + j] = accumulators[i][j];
+        }
+    }
+}
+
+#if TENSOR_SIMD_X86
+
+/*
+ * The group of one row of an A panel, as a 32-bit integer.
+ */
+template <typename TA>
+inline auto LoadGemmInt8Group(TA const* a) -> int32_t
+{
+    int32_t group;
+    std::memcpy(&group, a, sizeof(group));
+    return group;
+}
+
+/*
+ * 4 x 8 microkernel for AVX2. Elements are widened to 16 bits, where VPMADDWD multiplies them exactly and adds pairs of
+ * products into 32-bit lanes. Each column then has two lanes, for the first and second half of every group, which are
+ * added when the tile is stored.
+ */
+template <typename TA>
+TENSOR_SIMD_TARGET("avx2,fma")
+inline auto GemmInt8KernelAvx2(size_t groups, TA const* a, int8_t const* b, int32_t* tile) -> void
+{
+    __m256i accumulators[4][2];
+    for (size_t i = 0; i < 4; ++i)
+    {
+        accumulators[i][0] = _mm256_setzero_si256();
+        accumulators[i][1] = _mm256_setzero_si256();
+    }
+
+    for (size_t g = 0; g < groups; ++g)
+    {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b));
+        __m256i b0 = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(bytes));
+        __m256i b1 = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(bytes, 1));
+        for (size_t i = 0; i < 4; ++i)
+        {
+            __m128i group = _mm_cvtsi32_si128(LoadGemmInt8Group(a + i * GemmInt8Group));
+            __m128i wide = std::is_signed_v<TA> ? _mm_cvtepi8_epi16(group) : _mm_cvtepu8_epi16(group);
+            __m256i broadcast = _mm256_broadcastq_epi64(wide);
+            accumulators[i][0] = _mm256_add_epi32(accumulators[i][0], _mm256_madd_epi16(broadcast, b0));
+            accumulators[i][1] = _mm256_add_epi32(accumulators[i][1], _mm256_madd_epi16(broadcast, b1));
+        }
+        a += 4 * GemmInt8Group;
+        b += 8 * GemmInt8Group;
+    }
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        alignas(32) int32_t halves[16];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(halves), accumulators[i][0]);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(halves + 8), accumulators[i][1]);
+        for (size_t j = 0; j < 8; ++j)
+        {
+            tile[i * 8 + j] = halves[2 * j] + halves[2 * j + 1];
+        }
+    }
+}
+
+/*
+ * 6 x 16 microkernel for AVX-512 without VNNI, widening to 16 bits like the AVX2 kernel.
+ */
+template <typename TA>
+TENSOR_SIMD_TARGET("avx512f,avx512bw")
+inline auto GemmInt8KernelAvx512(size_t groups, TA const* a, int8_t const* b, int32_t* tile) -> void
+{
+    __m512i accumulators[6][2];
+    for (size_t i = 0; i < 6; ++i)
+    {
+        accumulators[i][0] = _mm512_setzero_si512();
+        accumulators[i][1] = _mm512_setzero_si512();
+    }
+
+    for (size_t g = 0; g < groups; ++g)
+    {
+        __m512i b0 = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(b)));
+        __m512i b1 = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + 32)));
+        for (size_t i = 0; i < 6; ++i)
+        {
+            __m128i group = _mm_cvtsi32_si128(LoadGemmInt8Group(a + i * GemmInt8Group));
+            __m128i wide = std::is_signed_v<TA> ? _mm_cvtepi8_epi16(group) : _mm_cvtepu8_epi16(group);
+            __m512i broadcast = _mm512_broadcastq_epi64(wide);
+            accumulators[i][0] = _mm512_add_epi32(accumulators[i][0], _mm512_madd_epi16(broadcast, b0));
+            accumulators[i][1] = _mm512_add_epi32(accumulators[i][1], _mm512_madd_epi16(broadcast, b1));
+        }
+        a += 6 * GemmInt8Group;
+        b += 16 * GemmInt8Group;
+    }
+
+    for (size_t i = 0; i < 6; ++i)
+    {
+        alignas(64) int32_t halves[32];
+        _mm512_store_si512(static_cast<void*>(halves), accumulators[i][0]);
+        _mm512_store_si512(static_cast<void*>(halves + 16), accumulators[i][1]);
+        for (size_t j = 0; j < 16; ++j)
+        {
+            tile[i * 16 + j] = halves[2 * j] + halves[2 * j + 1];
+        }
+    }
+}
+
+/*
+ * 6 x 32 microkernel for AVX-512 VNNI: VPDPBUSD multiplies four unsigned bytes of A with four signed bytes of B and
+ * adds the products into a 32-bit lane, so each column is a single lane. Signed A comes shifted by 128 to make it
+ * unsigned, see GemmInt8Kernel.
+ */
+template <typename TA>
+TENSOR_SIMD_TARGET("avx512f,avx512bw,avx512vnni")
+inline auto GemmInt8KernelAvx512Vnni(size_t groups, TA const* a, int8_t const* b, int32_t* tile) -> void
+{
+    __m512i accumulators[6][2];
+    for (size_t i = 0; i < 6; ++i)
+    {
+        accumulators[i][0] = _mm512_setzero_si512();
+        accumulators[i][1] = _mm512_setzero_si512();
+    }
+
+    for (size_t g = 0; g < groups; ++g)
+    {
+        __m512i b0 = _mm512_loadu_si512(static_cast<void const*>(b));
+        __m512i b1 = _mm512_loadu_si512(static_cast<void const*>(b + 64));
+        for (size_t i = 0; i < 6; ++i)
+        {
+            __m512i broadcast = _mm512_set1_epi32(LoadGemmInt8Group(a + i * GemmInt8Group));
+            accumulators[i][0] = _mm512_dpbusd_epi32(accumulators[i][0], broadcast, b0);
+            accumulators[i][1] = _mm512_dpbusd_epi32(accumulators[i][1], broadcast, b1);
+        }
+        a += 6 * GemmInt8Group;
+        b += 32 * GemmInt8Group;
+    }
+
+    for (size_t i = 0; i < 6; ++i)
+    {
+        _mm512_storeu_si512(static_cast<void*>(tile + i * 32), accumulators[i][0]);
+        _mm512_storeu_si512(static_cast<void*>(tile + i * 32 + 16), accumulators[i][1]);
+    }
+}
+
+#endif
+
+/*
+ * Get the int8 microkernel for the given instruction set level; `vnni` selects the AVX-512 VNNI kernel at the AVX512
+ * level.
+ */
+template <typename TA>
+auto GetGemmInt8Kernel(SimdLevel level, bool vnni = false) -> GemmInt8Kernel<TA>
+{
+    static_assert(std::is_same_v<TA, int8_t> || std::is_same_v<TA, uint8_t>, "int8 matrix multiplication requires 8-bit A");
+
+#if TENSOR_SIMD_X86
+    if (level >= SimdLevel::AVX512 && vnni)
+    {
+        return {6, 32, std::is_signed_v<TA>, &GemmInt8KernelAvx512Vnni<TA>};
+    }
+    if (level >= SimdLevel::AVX512)
+    {
+        return {6, 16, false, &GemmInt8KernelAvx512<TA>};
+    }
+    if (level >= SimdLevel::AVX2)
+    {
+        return {4, 8, false, &GemmInt8KernelAvx2<TA>};
+    }
+#endif
+    return {4, 8, false, &GemmInt8MicroKernel<TA, 4, 8>};
+}
+
+/*
+ * The int8 microkernel on this processor, selected once on first use.
+ */
+template <typename TA>
+auto SelectGemmInt8Kernel() -> GemmInt8Kernel<TA>
+{
+    static GemmInt8Kernel<TA> kernel = GetGemmInt8Kernel<TA>(ActiveSimdLevel(), DetectAvx512Vnni());
+    return kernel;
+}
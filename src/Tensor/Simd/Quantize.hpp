@@ -0,0 +1,234 @@
+#pragma once
+
+#include "Cpu.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/*
+ * Kernel quantizing a dense array of floats with one scale and zero point:
+ * destination[i] = clamp(round(source[i] * inverseScale + zeroPoint)), rounding to nearest even and clamping to the
+ * range of T. NaN quantizes to the lowest value of T.
+ */
+template <typename T>
+using QuantizeKernel = void (*)(float const* source, T* destination, size_t count, float inverseScale, int32_t zeroPoint);
+
+/*
+ * Kernel dequantizing a dense array with one scale and zero point: destination[i] = (source[i] - zeroPoint) * scale.
+ */
+template <typename T>
+using DequantizeKernel = void (*)(T const* source, float* destination, size_t count, float scale, int32_t zeroPoint);
+
+/*
+ * Quantization kernels for one 8-bit value type and instruction set level. Every level gives the same results as the
+ * scalar kernels: scaled values are clamped to the range of T less the zero point, rounded, and the zero point is added
+ * as an integer, so there is no addition which a compiler could fuse with the multiplication.
+ */
+template <typename T, SimdLevel Level>
+struct SimdQuantize
+{
+    static constexpr bool available = false;
+};
+
+template <typename T>
+    requires std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t>
+struct SimdQuantize<T, SimdLevel::Scalar>
+{
+    static constexpr bool available = true;
+
+    static auto Quantize(float const* source, T* destination, size_t count, float inverseScale, int32_t zeroPoint) -> void
+    {
+        float const lowest = static_cast<float>(std::numeric_limits<T>::lowest() - zeroPoint);
+        float const highest = static_cast<float>(std::numeric_limits<T>::max() - zeroPoint);
+        for (size_t i = 0; i < count; ++i)
+        {
+            // ordered like the SIMD maximum and minimum, so NaN becomes the lowest value
+            float value = source[i] * inverseScale;
+            value = value > lowest ? value : lowest;
+            value = value < highest ? value : highest;
+            destination[i] = static_cast<T>(static_cast<int32_t>(std::nearbyint(value)) + zeroPoint);
+        }
+    }
+
+    static auto Dequantize(T const* source, float* destination, size_t count, float scale, int32_t zeroPoint) -> void
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            destination[i] = static_cast<float>(static_cast<int32_t>(source[i]) - zeroPoint) * scale;
+        }
+    }
+};
+
+#if TENSOR_SIMD_X86
+
+template <typename T>
+    requires std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t>
+struct SimdQuantize<T, SimdLevel::AVX2>
+{
+    static constexpr bool available = true;
+
+    TENSOR_SIMD_TARGET("avx2,fma")
+    static auto Quantize(float const* source, T* destination, size_t count, float inverseScale, int32_t zeroPoint) -> void
+    {
+        __m256 const scale = _mm256_set1_ps(inverseScale);
+        __m256i const offset = _mm256_set1_epi32(zeroPoint);
+        __m256 const lowest = _mm256_set1_ps(static_cast<float>(std::numeric_limits<T>::lowest() - zeroPoint));
+        __m256 const highest = _mm256_set1_ps(static_cast<float>(std::numeric_limits<T>::max() - zeroPoint));
+
+        // the 256-bit packs work within 128-bit lanes, leaving groups of four elements in this order
+        __m256i const order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+        __m256i rounded[4];
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32)
+        {
+            for (size_t r = 0; r < 4; ++r)
+            {
+                __m256 value = _mm256_mul_ps(_mm256_loadu_ps(source + i + 8 * r), scale);
+                rounded[r] = _mm256_add_epi32(_mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(value, lowest), highest)), offset);
+            }
+            __m256i low = _mm256_packs_epi32(rounded[0], rounded[1]);
+            __m256i high = _mm256_packs_epi32(rounded[2], rounded[3]);
+            __m256i bytes = std::is_signed_v<T> ? _mm256_packs_epi16(low, high) : _mm256_packus_epi16(low, high);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_permutevar8x32_epi32(bytes, order));
+        }
+        SimdQuantize<T, SimdLevel::Scalar>::Quantize(source + i, destination + i, count - i, inverseScale, zeroPoint);
+    }
+
+    TENSOR_SIMD_TARGET("avx2,fma")
+    static auto Dequantize(T const* source, float* destination, size_t count, float scale, int32_t zeroPoint) -> void
+    {
+        __m256 const factor = _mm256_set1_ps(scale);
+        __m256i const offset = _mm256_set1_epi32(zeroPoint);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i bytes = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(source + i));
+            __m256i wide = std::is_signed_v<T> ? _mm256_cvtepi8_epi32(bytes) : _mm256_cvtepu8_epi32(bytes);
+            __m256 value = _mm256_cvtepi32_ps(_mm256_sub_epi32(wide, offset));
+            _mm256_storeu_ps(destination + i, _mm256_mul_ps(value, factor));
+        }
+        SimdQuantize<T, SimdLevel::Scalar>::Dequantize(source + i, destination + i, count - i, scale, zeroPoint);
+    }
+};
+
+template <typename T>
+    requires std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t>
+struct SimdQuantize<T, SimdLevel::AVX512>
+{
+    static constexpr bool available = true;
+
+    TENSOR_SIMD_TARGET("avx512f,avx512bw")
+    static auto Quantize(float const* source, T* destination, size_t count, float inverseScale, int32_t zeroPoint) -> void
+    {
+        __m512 const scale = _mm512_set1_ps(inverseScale);
+        __m512i const offset = _mm512_set1_epi32(zeroPoint);
+        __m512 const lowest = _mm512_set1_ps(static_cast<float>(std::numeric_limits<T>::lowest() - zeroPoint));
+        __m512 const highest = _mm512_set1_ps(static_cast<float>(std::numeric_limits<T>::max() - zeroPoint));
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m512 value = _mm512_mul_ps(_mm512_loadu_ps(source + i), scale);
+            __m512i rounded = _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(value, lowest), highest));
+            rounded = _mm512_add_epi32(rounded, offset);
+
+            // already within the range of T, so truncating to bytes keeps the value
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm512_cvtepi32_epi8(rounded));
+        }
+        SimdQuantize<T, SimdLevel::Scalar>::Quantize(source + i, destination + i, count - i, inverseScale, zeroPoint);
+    }
+
+    TENSOR_SIMD_TARGET("avx512f,avx512bw")
+    static auto Dequantize(T const* source, float* destination, size_t count, float scale, int32_t zeroPoint) -> void
+    {
+        __m512 const factor = _mm512_set1_ps(scale);
+        __m512i const offset = _mm512_set1_epi32(zeroPoint);
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i));
+            __m512i wide = std::is_signed_v<T> ? _mm512_cvtepi8_epi32(bytes) : _mm512_cvtepu8_epi32(bytes);
+            __m512 value = _mm512_cvtepi32_ps(_mm512_sub_epi32(wide, offset));
+            _mm512_storeu_ps(destination + i, _mm512_mul_ps(value, factor));
+        }
+        SimdQuantize<T, SimdLevel::Scalar>::Dequantize(source + i, destination + i, count - i, scale, zeroPoint);
+    }
+};
+
+#endif
+
+/*
+ * Get the quantization kernel for the given level, or the best level below it which has one.
+ */
+template <typename T>
+auto GetQuantizeKernel(SimdLevel level) -> QuantizeKernel<T>
+{
+    using enum SimdLevel;
+
+    if constexpr (SimdQuantize<T, AVX512>::available)
+    {
+        if (level >= AVX512)
+        {
+            return &SimdQuantize<T, AVX512>::Quantize;
+        }
+    }
+    if constexpr (SimdQuantize<T, AVX2>::available)
+    {
+        if (level >= AVX2)
+        {
+            return &SimdQuantize<T, AVX2>::Quantize;
+        }
+    }
+    return &SimdQuantize<T, Scalar>::Quantize;
+}
+
+/*
+ * Get the dequantization kernel for the given level, or the best level below it which has one.
+ */
+template <typename T>
+auto GetDequantizeKernel(SimdLevel level) -> DequantizeKernel<T>
+{
+    using enum SimdLevel;
+
+    if constexpr (SimdQuantize<T, AVX512>::available)
+    {
+        if (level >= AVX512)
+        {
+            return &SimdQuantize<T, AVX512>::Dequantize;
+        }
+    }
+    if constexpr (SimdQuantize<T, AVX2>::available)
+    {
+        if (level >= AVX2)
+        {
+            return &SimdQuantize<T, AVX2>::Dequantize;
+        }
+    }
+    return &SimdQuantize<T, Scalar>::Dequantize;
+}
+
+/*
+ * The quantization kernel for T on this processor, selected once on first use.
+ */
+template <typename T>
+auto SelectQuantizeKernel() -> QuantizeKernel<T>
+{
+    static QuantizeKernel<T> kernel = GetQuantizeKernel<T>(ActiveSimdLevel());
+    return kernel;
+}
+
+/*
+ * The dequantization kernel for T on this processor, selected once on first use.
+ */
+template <typename T>
+auto SelectDequantizeKernel() -> DequantizeKernel<T>
+{
+    static DequantizeKernel<T> kernel = GetDequantizeKernel<T>(ActiveSimdLevel());
+    return kernel;
+}
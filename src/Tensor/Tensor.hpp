@@ -1,4 +1,16 @@
 #pragma once
 
+#include "Containers/QuantizedTensor.hpp"
+#include "Containers/Sparse.hpp"
+#include "Containers/StaticTensor.hpp"
 #include "Containers/Tensor.hpp"
 #include "Containers/View.hpp"
+#include "IO/ChunkedTensor.hpp"
+#include "IO/TensorFile.hpp"
+#include "Interop/DLPack.hpp"
+#include "Operations/Conv.hpp"
+#include "Operations/ForEach.hpp"
+#include "Operations/MatMul.hpp"
+#include "Operations/Quantize.hpp"
+#include "Operations/Reduce.hpp"
+#include "Operations/Sparse.hpp"
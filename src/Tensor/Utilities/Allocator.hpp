@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+/*
+ * Tag type selecting the constructors that allocate storage without initializing any elements.
+ * Only the allocation is performed, so the contents must be written before they are read.
+ */
+struct Uninitialized_t
+{
+    explicit Uninitialized_t() = default;
+};
+
+inline constexpr Uninitialized_t Uninitialized{};
+
+/*
+ * Allocator returning buffers aligned to the given boundary (a cache line by default).
+ * Aligned buffers keep SIMD loads from straddling cache lines.
+ */
+template <typename T, size_t Alignment = 64>
+class AlignedAllocator
+{
+public:
+
+    static_assert(Alignment >= alignof(T), "alignment must satisfy the alignment of the value type");
+    static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+
+    using value_type = T;
+    static constexpr size_t alignment = Alignment;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(AlignedAllocator<U, Alignment> const&) noexcept
+    {}
+
+    auto allocate(size_t count) -> T*
+    {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    auto deallocate(T* pointer, size_t) noexcept -> void
+    {
+        ::operator delete(pointer, std::align_val_t{Alignment});
+    }
+
+    template <typename U>
+    auto operator==(AlignedAllocator<U, Alignment> const&) const noexcept -> bool
+    {
+        return true;
+    }
+};
+
+/*
+ * Allocator for large buffers which should be backed by transparent huge pages.
+ * Buffers are aligned to the huge page size and, on Linux, advised as huge page candidates, which reduces TLB misses on
+ * multi-megabyte tensors. Small requests fall back to cache line alignment, as they would waste most of a huge page.
+ */
+template <typename T>
+class HugePageAllocator
+{
+public:
+
+    using value_type = T;
+    static constexpr size_t huge_page_size = size_t{2} << 20;
+    static constexpr size_t alignment = 64;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = HugePageAllocator<U>;
+    };
+
+    HugePageAllocator() noexcept = default;
+
+    template <typename U>
+    HugePageAllocator(HugePageAllocator<U> const&) noexcept
+    {}
+
+    auto allocate(size_t count) -> T*
+    {
+        size_t bytes = count * sizeof(T);
+        if (bytes < huge_page_size)
+        {
+            return static_cast<T*>(::operator new(bytes, std::align_val_t{alignment}));
+        }
+
+        // round up to a whole number of huge pages so the tail of the buffer is eligible as well
+        size_t rounded = (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+        void* pointer = ::operator new(rounded, std::align_val_t{huge_page_size});
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        madvise(pointer, rounded, MADV_HUGEPAGE);
+#endif
+        return static_cast<T*>(pointer);
+    }
+
+    auto deallocate(T* pointer, size_t count) noexcept -> void
+    {
+        if (count * sizeof(T) < huge_page_size)
+        {
+            ::operator delete(pointer, std::align_val_t{alignment});
+        }
+        else
+        {
+            ::operator delete(pointer, std::align_val_t{huge_page_size});
+        }
+    }
+
+    template <typename U>
+    auto operator==(HugePageAllocator<U> const&) const noexcept -> bool
+    {
+        return true;
+    }
+};
+
+/*
+ * Deleter used by Tensor to destroy its elements and return the buffer to the allocator it came from.
+ * Buffers adopted from elsewhere carry their own release function instead, called with `context`, and their elements
+ * are left for it to destroy.
+ */
+template <typename T, typename Allocator>
+struct AllocatorDeleter
+{
+    [[no_unique_address]] Allocator allocator;
+    size_t size = 0;
+    void (*release)(T*, void*) = nullptr;
+    void* context = nullptr;
+
+    auto operator()(T* pointer) noexcept -> void
+    {
+        if (release)
+        {
+            release(pointer, context);
+            return;
+        }
+        std::destroy_n(pointer, size);
+        allocator.deallocate(pointer, size);
+    }
+};
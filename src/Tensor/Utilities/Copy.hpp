@@ -1,37 +1,346 @@
 #pragma once
 
+#include "../Containers/Traits.hpp"
+#include "../Simd/Convert.hpp"
+#include "Layout.hpp"
+#include "Shape.hpp"
+
+#include <Dispatch.hpp>
 #include <Expect.hpp>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*
+ * Copies moving at least this many bytes are split across the dispatcher thread pool.
+ */
+inline constexpr size_t ParallelCopyThreshold = size_t{1} << 22;
+
+/*
+ * Newly allocated buffers of at least this many bytes are initialized in parallel by ParallelInitialize. Adjustable at
+ * runtime, e.g. `ParallelInitializeThreshold() = size_t{1} << 20;`, and defaults to ParallelCopyThreshold.
+ */
+inline auto ParallelInitializeThreshold() -> std::atomic<size_t>&
+{
+    static std::atomic<size_t> threshold = ParallelCopyThreshold;
+    return threshold;
+}
+
+/*
+ * Initialize a buffer of `size` elements by calling `initialize(first, count)` over consecutive blocks of it.
+ * Large buffers are split across the dispatcher thread pool into one contiguous block per thread, the same partition
+ * Evaluate uses, with block boundaries moved to page boundaries. Each page is therefore first touched, and on NUMA
+ * systems placed, by a thread of the pool rather than all on the allocating thread. Initializers which may throw always
+ * run on the calling thread, so a failure never leaves other blocks constructed behind it.
+ */
+template <typename T, typename Initialize>
+auto ParallelInitialize(T* data, size_t size, Initialize&& initialize) -> void
+{
+    constexpr size_t PageSize = 4096;
+
+    // the pool is only looked up for work large enough to split, so small tensors never create it
+    bool parallel = std::is_nothrow_invocable_v<Initialize&, T*, size_t>
+                 && size * sizeof(T) >= ParallelInitializeThreshold().load(std::memory_order_relaxed)
+                 && GetDispatcherThreadPool().Threads() > 1;
+    if (!parallel)
+    {
+        initialize(data, size);
+        return;
+    }
+
+    size_t blockCount = GetDispatcherThreadPool().Threads();
+    size_t blockLength = (size + blockCount - 1) / blockCount;
+
+    // index of the first element of a block, advanced to the next page boundary
+    auto boundary = [&](size_t block) -> size_t
+    {
+        size_t index = std::min(block * blockLength, size);
+        size_t address = reinterpret_cast<std::uintptr_t>(data + index);
+        size_t padding = (PageSize - address % PageSize) % PageSize;
+        return std::min(index + padding / sizeof(T), size);
+    };
+
+    DispatchRow(blockCount, [&](size_t block)
+    {
+        size_t start = block == 0 ? 0 : boundary(block);
+        size_t stop = block + 1 == blockCount ? size : boundary(block + 1);
+        if (start < stop)
+        {
+            initialize(data + start, stop - start);
+        }
+    });
+}
+
+/*
+ * Strided runs converted with a SIMD kernel are gathered and scattered through buffers of this many elements.
+ */
+inline constexpr size_t ConvertBlock = 256;
+
+/*
+ * Convert a run of elements between two strided buffers with the conversion kernel for their value types. Dense runs
+ * are converted in place; strided sides go through a small buffer on the stack, so the kernel always sees dense arrays.
+ */
+template <typename S, typename D>
+auto ConvertRun(S const* source, size_t sourceStride, D* destination, size_t destinationStride, size_t count) -> void
+{
+    ConvertKernel<S, D> kernel = SelectConvertKernel<S, D>();
+    if (sourceStride == 1 && destinationStride == 1)
+    {
+        kernel(source, destination, count);
+        return;
+    }
+
+    S gathered[ConvertBlock];
+    D converted[ConvertBlock];
+    for (size_t start = 0; start < count; start += ConvertBlock)
+    {
+        size_t length = std::min(ConvertBlock, count - start);
+
+        S const* input = source + start * sourceStride;
+        if (sourceStride != 1)
+        {
+            for (size_t i = 0; i < length; ++i)
+            {
+                gathered[i] = input[i * sourceStride];
+            }
+            input = gathered;
+        }
+
+        D* output = destinationStride == 1 ? destination + start : converted;
+        kernel(input, output, length);
+        if (destinationStride != 1)
+        {
+            for (size_t i = 0; i < length; ++i)
+            {
+                destination[(start + i) * destinationStride] = converted[i];
+            }
+        }
+    }
+}
+
+/*
+ * Copy a run of elements between two strided buffers, converting each element to the destination type.
+ * Runs which are dense on both sides are copied with memcpy when no conversion is needed, and with a plain loop the
+ * compiler can vectorize otherwise. Conversions with a hand-written kernel, between float and the 16-bit floating
+ * point types, use ConvertRun instead.
+ */
+template <typename S, typename D>
+auto CopyRun(S const* source, size_t sourceStride, D* destination, size_t destinationStride, size_t count) -> void
+{
+    if constexpr (HasConvertKernel<std::remove_const_t<S>, D>)
+    {
+        ConvertRun<std::remove_const_t<S>, D>(source, sourceStride, destination, destinationStride, count);
+    }
+    else if (sourceStride == 1 && destinationStride == 1)
+    {
+        if constexpr (std::is_same_v<S, D> && std::is_trivially_copyable_v<D>)
+        {
+            std::memcpy(destination, source, count * sizeof(D));
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                destination[i] = static_cast<D>(source[i]);
+            }
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            destination[i * destinationStride] = static_cast<D>(source[i * sourceStride]);
+        }
+    }
+}
+
+/*
+ * Blocks of a transposing copy are split until both sides fit within this many elements.
+ */
+inline constexpr size_t TransposeTile = 32;
+
+/*
+ * Copy a rows x columns block between two strided buffers whose fast dimensions differ, as in a transpose.
+ * The block is halved along its longer side until it fits within TransposeTile x TransposeTile elements, so the lines
+ * touched on both sides stay in cache at every level without knowing the cache sizes.
+ */
+template <typename S, typename D>
+auto CopyTransposed(S const* source, std::array<size_t, 2> const& sourceStrides, D* destination, std::array<size_t, 2> const& destinationStrides, size_t rows, size_t columns) -> void
+{
+    if (rows <= TransposeTile && columns <= TransposeTile)
+    {
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t j = 0; j < columns; ++j)
+            {
+                destination[i * destinationStrides[0] + j * destinationStrides[1]] = static_cast<D>(source[i * sourceStrides[0] + j * sourceStrides[1]]);
+            }
+        }
+    }
+    else if (rows >= columns)
+    {
+        size_t half = rows / 2;
+        CopyTransposed(source, sourceStrides, destination, destinationStrides, half, columns);
+        CopyTransposed(source + half * sourceStrides[0], sourceStrides, destination + half * destinationStrides[0], destinationStrides, rows - half, columns);
+    }
+    else
+    {
+        size_t half = columns / 2;
+        CopyTransposed(source, sourceStrides, destination, destinationStrides, rows, half);
+        CopyTransposed(source + half * sourceStrides[1], sourceStrides, destination + half * destinationStrides[1], destinationStrides, rows, columns - half);
+    }
+}
 
 /*
  * Copy the contents of the source container into the destination container, element-by-element.
  * For use when one of the containers is non-contiguous, and memory can't be copied directly.
- * Recursively visits every permutation of possible indices and copies the elements between the two containers.
+ * Dimensions which are contiguous in both containers are merged first, so the copy runs over as few, as long rows as
+ * possible, and each row is copied with CopyRun. When the innermost dimension is strided on one side but another
+ * dimension is dense there, as when materializing a transposed or permuted view, rows would touch a new cache line per
+ * element; instead the planes spanned by those two dimensions are copied with CopyTransposed. Large copies are split
+ * across the dispatcher thread pool.
  */
 template <typename T1, typename T2, size_t Order>
 void CopyElementwise(const T1& source, T2& destination)
 {
+    Expect(source.Shape() == destination.Shape());
+
+    auto shape = source.Shape();
+    size_t size = GetSize(shape);
+    if (size == 0)
+    {
+        return;
+    }
+
+    auto layout = CollapseDimensions<Order, 2>(shape, {source.Strides(), destination.Strides()});
+    auto const* sourceOrigin = Origin(source);
+    auto* destinationOrigin = Origin(destination);
+
+    size_t inner = layout.order - 1;
+    size_t rowLength = layout.shape[inner];
+    size_t rowCount = size / rowLength;
+    size_t sourceStride = layout.strides[0][inner];
+    size_t destinationStride = layout.strides[1][inner];
+
+    // compute the offsets of the first element of a row from its index among all rows
+    auto rowOffsets = [&](size_t row) -> std::array<size_t, 2>
+    {
+        std::array<size_t, 2> offsets{};
+        for (size_t i = inner; i-- > 0;)
+        {
+            size_t index = row % layout.shape[i];
+            row /= layout.shape[i];
+            offsets[0] += index * layout.strides[0][i];
+            offsets[1] += index * layout.strides[1][i];
+        }
+        return offsets;
+    };
+
     using value_type = TensorTraits<T2>::value_type;
+    size_t threads = size * sizeof(value_type) >= ParallelCopyThreshold ? GetDispatcherThreadPool().Threads() : 1;
+    bool parallel = threads > 1;
 
-    Expect(source.Shape() == destination.Shape());
-    std::array<size_t, Order> currentIndices{};
+    // an outer dimension which is dense on a side where the innermost dimension is not
+    size_t across = inner;
+    for (size_t i = 0; i < inner; ++i)
+    {
+        if ((sourceStride != 1 && layout.strides[0][i] == 1) || (destinationStride != 1 && layout.strides[1][i] == 1))
+        {
+            across = i;
+        }
+    }
 
-    auto copyRecursive = [&](auto&& copyRecursive, size_t currentDimension) -> void
+    if (across != inner)
     {
-        if (currentDimension == Order) // base case
+        size_t planeRows = layout.shape[across];
+        size_t planeCount = rowCount / planeRows;
+        std::array<size_t, 2> sourceStrides = {layout.strides[0][across], sourceStride};
+        std::array<size_t, 2> destinationStrides = {layout.strides[1][across], destinationStride};
+
+        // large planes are cut into strips of rows, so that there is a task for every thread
+        size_t strips = parallel && planeCount < threads ? (threads + planeCount - 1) / planeCount : 1;
+        size_t stripRows = ((planeRows + strips - 1) / strips + TransposeTile - 1) / TransposeTile * TransposeTile;
+        strips = (planeRows + stripRows - 1) / stripRows;
+
+        auto copyStrip = [&](size_t task)
         {
-            destination(currentIndices) = static_cast<value_type>(source(currentIndices));
+            size_t plane = task / strips;
+            size_t start = task % strips * stripRows;
+
+            // unravel the plane index over the dimensions other than the two spanning the plane
+            std::array<size_t, 2> offsets = {start * sourceStrides[0], start * destinationStrides[0]};
+            for (size_t i = inner; i-- > 0;)
+            {
+                if (i != across)
+                {
+                    size_t index = plane % layout.shape[i];
+                    plane /= layout.shape[i];
+                    offsets[0] += index * layout.strides[0][i];
+                    offsets[1] += index * layout.strides[1][i];
+                }
+            }
+
+            CopyTransposed(sourceOrigin + offsets[0], sourceStrides, destinationOrigin + offsets[1], destinationStrides, std::min(stripRows, planeRows - start), rowLength);
+        };
+
+        if (parallel)
+        {
+            DispatchRow(planeCount * strips, copyStrip);
         }
-        else // recursive case
+        else
         {
-            for (size_t i = 0; i < source.Shape()[currentDimension]; ++i)
+            for (size_t task = 0; task < planeCount * strips; ++task)
             {
-                currentIndices[currentDimension] = i;
-                copyRecursive(copyRecursive, currentDimension + 1);
+                copyStrip(task);
             }
         }
-    };
+    }
+    else if (parallel && rowCount == 1)
+    {
+        // a single long run, split it into blocks
+        size_t blockLength = std::max<size_t>(rowLength / threads, 1);
+        size_t blockCount = (rowLength + blockLength - 1) / blockLength;
+        DispatchRow(blockCount, [&](size_t block)
+        {
+            size_t start = block * blockLength;
+            size_t count = std::min(blockLength, rowLength - start);
+            CopyRun(sourceOrigin + start * sourceStride, sourceStride, destinationOrigin + start * destinationStride, destinationStride, count);
+        });
+    }
+    else if (parallel)
+    {
+        DispatchRow(rowCount, [&](size_t row)
+        {
+            auto [sourceOffset, destinationOffset] = rowOffsets(row);
+            CopyRun(sourceOrigin + sourceOffset, sourceStride, destinationOrigin + destinationOffset, destinationStride, rowLength);
+        });
+    }
+    else
+    {
+        // walk the outer dimensions like an odometer, updating the offsets incrementally
+        std::array<size_t, CollapsedLayout<Order, 2>::capacity> indices{};
+        size_t sourceOffset = 0;
+        size_t destinationOffset = 0;
+        for (size_t row = 0; row < rowCount; ++row)
+        {
+            CopyRun(sourceOrigin + sourceOffset, sourceStride, destinationOrigin + destinationOffset, destinationStride, rowLength);
 
-    copyRecursive(copyRecursive, 0);
+            for (size_t i = inner; i-- > 0;)
+            {
+                sourceOffset += layout.strides[0][i];
+                destinationOffset += layout.strides[1][i];
+                if (++indices[i] < layout.shape[i])
+                {
+                    break;
+                }
+                sourceOffset -= indices[i] * layout.strides[0][i];
+                destinationOffset -= indices[i] * layout.strides[1][i];
+                indices[i] = 0;
+            }
+        }
+    }
 }
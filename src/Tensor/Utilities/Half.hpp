@@ -0,0 +1,275 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/*
+ * Convert a float to IEEE 754 binary16 bits, rounding to nearest even. Overflow gives infinity, NaNs stay quiet NaNs
+ * with the upper bits of their payload, as with the F16C instructions.
+ */
+constexpr auto FloatToHalfBits(float value) -> uint16_t
+{
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+    uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    uint32_t magnitude = bits & 0x7fffffff;
+
+    if (magnitude >= 0x7f800000)
+    {
+        uint16_t nan = magnitude > 0x7f800000 ? static_cast<uint16_t>(0x200 | ((magnitude >> 13) & 0x3ff)) : 0;
+        return sign | 0x7c00 | nan;
+    }
+    if (magnitude >= 0x477ff000)
+    {
+        // at least 65520, halfway between the largest half and the next power of two
+        return sign | 0x7c00;
+    }
+    if (magnitude < 0x38800000)
+    {
+        // below the smallest normal half, 2^-14: count units of 2^-24, rounding the dropped bits
+        if (magnitude <= 0x33000000)
+        {
+            return sign;
+        }
+        uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+        uint32_t shift = 126 - (magnitude >> 23);
+        uint32_t rounded = (mantissa + (uint32_t{1} << (shift - 1)) - 1 + ((mantissa >> shift) & 1)) >> shift;
+        return sign | static_cast<uint16_t>(rounded);
+    }
+
+    // rebias the exponent from 127 to 15, then round away the 13 extra mantissa bits; a carry moves into the exponent
+    uint32_t rebiased = magnitude - 0x38000000;
+    return sign | static_cast<uint16_t>((rebiased + 0xfff + ((rebiased >> 13) & 1)) >> 13);
+}
+
+/*
+ * Convert IEEE 754 binary16 bits to a float, which is always exact.
+ */
+constexpr auto HalfBitsToFloat(uint16_t half) -> float
+{
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+
+    if (exponent == 0x1f)
+    {
+        uint32_t quiet = mantissa != 0 ? 0x400000 : 0;
+        return std::bit_cast<float>(sign | 0x7f800000 | quiet | (mantissa << 13));
+    }
+    if (exponent == 0)
+    {
+        // zero or subnormal, a multiple of 2^-24
+        float magnitude = static_cast<float>(mantissa) * 5.9604644775390625e-8f;
+        return std::bit_cast<float>(sign | std::bit_cast<uint32_t>(magnitude));
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+/*
+ * Convert a float to bfloat16 bits, its upper half, rounding to nearest even. NaNs stay quiet NaNs.
+ */
+constexpr auto FloatToBFloat16Bits(float value) -> uint16_t
+{
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+    if ((bits & 0x7fffffff) > 0x7f800000)
+    {
+        return static_cast<uint16_t>((bits >> 16) | 0x40);
+    }
+    return static_cast<uint16_t>((bits + 0x7fff + ((bits >> 16) & 1)) >> 16);
+}
+
+constexpr auto BFloat16BitsToFloat(uint16_t bfloat) -> float
+{
+    return std::bit_cast<float>(static_cast<uint32_t>(bfloat) << 16);
+}
+
+/*
+ * The two 16-bit formats: IEEE 754 binary16, with 5 exponent and 10 mantissa bits, and bfloat16, the upper half of a
+ * float, with 8 exponent and 7 mantissa bits.
+ */
+struct Binary16Format
+{
+    static constexpr auto Encode(float value) -> uint16_t
+    {
+        return FloatToHalfBits(value);
+    }
+
+    static constexpr auto Decode(uint16_t bits) -> float
+    {
+        return HalfBitsToFloat(bits);
+    }
+};
+
+struct BFloat16Format
+{
+    static constexpr auto Encode(float value) -> uint16_t
+    {
+        return FloatToBFloat16Bits(value);
+    }
+
+    static constexpr auto Decode(uint16_t bits) -> float
+    {
+        return BFloat16BitsToFloat(bits);
+    }
+};
+
+/*
+ * A 16-bit floating point storage type. Values convert implicitly to and from float, and arithmetic is carried out in
+ * float, so the type can be used as the value type of a tensor to halve its footprint and memory traffic.
+ */
+template <typename Format>
+class HalfFloat
+{
+private:
+
+    uint16_t mBits = 0;
+
+public:
+
+    constexpr HalfFloat() = default;
+
+    constexpr HalfFloat(float value)
+        : mBits(Format::Encode(value))
+    {}
+
+    template <typename U>
+        requires(std::is_arithmetic_v<U> && !std::is_same_v<U, float>)
+    constexpr HalfFloat(U value)
+        : HalfFloat(static_cast<float>(value))
+    {}
+
+    static constexpr auto FromBits(uint16_t bits) -> HalfFloat
+    {
+        HalfFloat value;
+        value.mBits = bits;
+        return value;
+    }
+
+    constexpr auto Bits() const -> uint16_t
+    {
+        return mBits;
+    }
+
+    constexpr operator float() const
+    {
+        return Format::Decode(mBits);
+    }
+
+    /*
+     * Negation only flips the sign bit, so it is exact and stays in the 16-bit type.
+     */
+    constexpr auto operator-() const -> HalfFloat
+    {
+        return FromBits(static_cast<uint16_t>(mBits ^ 0x8000));
+    }
+
+    constexpr auto operator+=(float other) -> HalfFloat&
+    {
+        return *this = static_cast<float>(*this) + other;
+    }
+
+    constexpr auto operator-=(float other) -> HalfFloat&
+    {
+        return *this = static_cast<float>(*this) - other;
+    }
+
+    constexpr auto operator*=(float other) -> HalfFloat&
+    {
+        return *this = static_cast<float>(*this) * other;
+    }
+
+    constexpr auto operator/=(float other) -> HalfFloat&
+    {
+        return *this = static_cast<float>(*this) / other;
+    }
+};
+
+using Float16 = HalfFloat<Binary16Format>;
+using BFloat16 = HalfFloat<BFloat16Format>;
+
+static_assert(sizeof(Float16) == 2 && std::is_trivially_copyable_v<Float16>);
+static_assert(sizeof(BFloat16) == 2 && std::is_trivially_copyable_v<BFloat16>);
+
+/*
+ * Whether T is one of the 16-bit floating point storage types.
+ */
+template <typename T>
+inline constexpr bool IsHalfType = std::is_same_v<std::remove_cv_t<T>, Float16> || std::is_same_v<std::remove_cv_t<T>, BFloat16>;
+
+/*
+ * The type in which sums of T are accumulated: float for the 16-bit types, whose own precision would soon stop small
+ * elements from adding up, and T itself otherwise.
+ */
+template <typename T>
+using AccumulatorType = std::conditional_t<IsHalfType<T>, float, T>;
+
+/*
+ * A 16-bit type combined with another arithmetic type, as when adding a Float16 tensor to a float one, computes in float
+ * or in the wider type, as a float would. Without this the implicit conversions both ways would make them ambiguous.
+ */
+template <typename Format, typename U>
+    requires std::is_arithmetic_v<U>
+struct std::common_type<HalfFloat<Format>, U>
+{
+    using type = std::common_type_t<float, U>;
+};
+
+template <typename U, typename Format>
+    requires std::is_arithmetic_v<U>
+struct std::common_type<U, HalfFloat<Format>>
+{
+    using type = std::common_type_t<U, float>;
+};
+
+template <typename LeftFormat, typename RightFormat>
+    requires(!std::is_same_v<LeftFormat, RightFormat>)
+struct std::common_type<HalfFloat<LeftFormat>, HalfFloat<RightFormat>>
+{
+    using type = float;
+};
+
+/*
+ * Limits of the 16-bit types, so that code asking std::numeric_limits, such as the Min and Max reductions, works.
+ */
+template <>
+struct std::numeric_limits<Float16>
+{
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr int digits = 11;
+    static constexpr int radix = 2;
+
+    static constexpr auto min() -> Float16 { return Float16::FromBits(0x0400); }
+    static constexpr auto max() -> Float16 { return Float16::FromBits(0x7bff); }
+    static constexpr auto lowest() -> Float16 { return Float16::FromBits(0xfbff); }
+    static constexpr auto epsilon() -> Float16 { return Float16::FromBits(0x1400); }
+    static constexpr auto infinity() -> Float16 { return Float16::FromBits(0x7c00); }
+    static constexpr auto quiet_NaN() -> Float16 { return Float16::FromBits(0x7e00); }
+    static constexpr auto denorm_min() -> Float16 { return Float16::FromBits(0x0001); }
+};
+
+template <>
+struct std::numeric_limits<BFloat16>
+{
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr int digits = 8;
+    static constexpr int radix = 2;
+
+    static constexpr auto min() -> BFloat16 { return BFloat16::FromBits(0x0080); }
+    static constexpr auto max() -> BFloat16 { return BFloat16::FromBits(0x7f7f); }
+    static constexpr auto lowest() -> BFloat16 { return BFloat16::FromBits(0xff7f); }
+    static constexpr auto epsilon() -> BFloat16 { return BFloat16::FromBits(0x3c00); }
+    static constexpr auto infinity() -> BFloat16 { return BFloat16::FromBits(0x7f80); }
+    static constexpr auto quiet_NaN() -> BFloat16 { return BFloat16::FromBits(0x7fc0); }
+    static constexpr auto denorm_min() -> BFloat16 { return BFloat16::FromBits(0x0001); }
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "Layout.hpp"
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+/*
+ * Random access iterator over the elements of a strided container, in row-major order.
+ * Dimensions are collapsed up front, and stepping updates the offset of the current element incrementally, carrying
+ * into outer dimensions only at the end of a run; jumps unravel the new position once.
+ */
+template <typename T, size_t Order>
+class StridedIterator
+{
+private:
+
+    using Layout = CollapsedLayout<Order, 1>;
+    static constexpr size_t capacity = Layout::capacity;
+
+    T* mBase = nullptr;
+    Layout mLayout{};
+    std::array<size_t, capacity> mIndex{};
+    size_t mOffset = 0;
+    std::ptrdiff_t mPosition = 0;
+
+    auto Stride(size_t d) const -> size_t
+    {
+        return mLayout.strides[0][d];
+    }
+
+    auto Seek(std::ptrdiff_t position) -> void
+    {
+        mPosition = position;
+        mOffset = 0;
+        mIndex = {};
+        if (position == 0)
+        {
+            // also the end of an empty container, whose extents cannot be divided by
+            return;
+        }
+
+        size_t remaining = static_cast<size_t>(position);
+        for (size_t d = mLayout.order; d-- > 1;)
+        {
+            mIndex[d] = remaining % mLayout.shape[d];
+            remaining /= mLayout.shape[d];
+            mOffset += mIndex[d] * Stride(d);
+        }
+        // the outermost index reaches its extent at the end
+        mIndex[0] = remaining;
+        mOffset += mIndex[0] * Stride(0);
+    }
+
+public:
+
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    StridedIterator() = default;
+
+    StridedIterator(T* origin, std::array<size_t, Order> const& shape, std::array<size_t, Order> const& strides, std::ptrdiff_t position)
+        : mBase(origin)
+        , mLayout(CollapseDimensions<Order, 1>(shape, {strides}))
+    {
+        Seek(position);
+    }
+
+    auto operator*() const -> T&
+    {
+        return mBase[mOffset];
+    }
+
+    auto operator->() const -> T*
+    {
+        return mBase + mOffset;
+    }
+
+    auto operator[](difference_type n) const -> T&
+    {
+        return *(*this + n);
+    }
+
+    auto operator++() -> StridedIterator&
+    {
+        ++mPosition;
+        size_t d = mLayout.order - 1;
+        mOffset += Stride(d);
+        while (++mIndex[d] == mLayout.shape[d] && d > 0)
+        {
+            mOffset -= mLayout.shape[d] * Stride(d);
+            mIndex[d] = 0;
+            --d;
+            mOffset += Stride(d);
+        }
+        return *this;
+    }
+
+    auto operator--() -> StridedIterator&
+    {
+        --mPosition;
+        size_t d = mLayout.order - 1;
+        while (mIndex[d] == 0 && d > 0)
+        {
+            mIndex[d] = mLayout.shape[d] - 1;
+            mOffset += mIndex[d] * Stride(d);
+            --d;
+        }
+        --mIndex[d];
+        mOffset -= Stride(d);
+        return *this;
+    }
+
+    auto operator++(int) -> StridedIterator
+    {
+        StridedIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    auto operator--(int) -> StridedIterator
+    {
+        StridedIterator previous = *this;
+        --*this;
+        return previous;
+    }
+
+    auto operator+=(difference_type n) -> StridedIterator&
+    {
+        Seek(mPosition + n);
+        return *this;
+    }
+
+    auto operator-=(difference_type n) -> StridedIterator&
+    {
+        Seek(mPosition - n);
+        return *this;
+    }
+
+    friend auto operator+(StridedIterator iterator, difference_type n) -> StridedIterator
+    {
+        return iterator += n;
+    }
+
+    friend auto operator+(difference_type n, StridedIterator iterator) -> StridedIterator
+    {
+        return iterator += n;
+    }
+
+    friend auto operator-(StridedIterator iterator, difference_type n) -> StridedIterator
+    {
+        return iterator -= n;
+    }
+
+    friend auto operator-(StridedIterator const& left, StridedIterator const& right) -> difference_type
+    {
+        return left.mPosition - right.mPosition;
+    }
+
+    friend auto operator==(StridedIterator const& left, StridedIterator const& right) -> bool
+    {
+        return left.mPosition == right.mPosition;
+    }
+
+    friend auto operator<=>(StridedIterator const& left, StridedIterator const& right) -> std::strong_ordering
+    {
+        return left.mPosition <=> right.mPosition;
+    }
+};
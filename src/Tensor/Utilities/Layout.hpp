@@ -0,0 +1,135 @@
+#pragma once
+
+#include "../Containers/Traits.hpp"
+#include "Shape.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+/*
+ * Get a pointer to the first element of a tensor-like container, taking the offset of views into account.
+ */
+template <typename Container>
+auto Origin(Container& container)
+{
+    if constexpr (TensorTraits<std::remove_const_t<Container>>::has_offset)
+    {
+        return container.Data() + container.Offset();
+    }
+    else
+    {
+        return container.Data();
+    }
+}
+
+/*
+ * Check whether the given strides describe a dense, row-major layout of the given shape.
+ * Dimensions of extent 1 are ignored, as their stride is never used to address an element.
+ */
+template <size_t Order>
+auto IsContiguous(std::array<size_t, Order> const& shape, std::array<size_t, Order> const& strides) -> bool
+{
+    size_t expected = 1;
+    for (size_t i = Order; i-- > 0;)
+    {
+        if (shape[i] != 1 && strides[i] != expected)
+        {
+            return false;
+        }
+        expected *= shape[i];
+    }
+    return true;
+}
+
+/*
+ * A shape and one or more stride sets over it, with mergeable dimensions folded together.
+ * Only the first `order` entries of each array are meaningful; dimension `order - 1` is the innermost. The layout
+ * always has at least one dimension, so order 0 tensors collapse to a single element.
+ */
+template <size_t Order, size_t Count>
+struct CollapsedLayout
+{
+    static constexpr size_t capacity = Order > 0 ? Order : 1;
+
+    size_t order;
+    std::array<size_t, capacity> shape;
+    std::array<std::array<size_t, capacity>, Count> strides;
+};
+
+/*
+ * Fold together every pair of adjacent dimensions which can be addressed as one in all of the given stride sets, and drop
+ * dimensions of extent 1. A dense tensor collapses to a single dimension, while a slice of rows collapses to two.
+ * Walking the collapsed layout visits the same elements in the same order as walking the original.
+ */
+template <size_t Order, size_t Count>
+auto CollapseDimensions(std::array<size_t, Order> const& shape, std::array<std::array<size_t, Order>, Count> const& strides) -> CollapsedLayout<Order, Count>
+{
+    CollapsedLayout<Order, Count> layout{};
+    layout.order = 0;
+
+    // build the layout innermost first, then reverse it
+    for (size_t i = Order; i-- > 0;)
+    {
+        if (shape[i] == 1)
+        {
+            continue;
+        }
+
+        if (layout.order > 0)
+        {
+            size_t last = layout.order - 1;
+            bool mergeable = true;
+            for (size_t k = 0; k < Count; ++k)
+            {
+                mergeable = mergeable && strides[k][i] == layout.strides[k][last] * layout.shape[last];
+            }
+            if (mergeable)
+            {
+                layout.shape[last] *= shape[i];
+                continue;
+            }
+        }
+
+        layout.shape[layout.order] = shape[i];
+        for (size_t k = 0; k < Count; ++k)
+        {
+            layout.strides[k][layout.order] = strides[k][i];
+        }
+        ++layout.order;
+    }
+
+    if (layout.order == 0)
+    {
+        // every dimension had extent 1, so there is a single element
+        layout.order = 1;
+        layout.shape[0] = 1;
+        for (size_t k = 0; k < Count; ++k)
+        {
+            layout.strides[k][0] = 1;
+        }
+        return layout;
+    }
+
+    std::reverse(layout.shape.begin(), layout.shape.begin() + layout.order);
+    for (size_t k = 0; k < Count; ++k)
+    {
+        std::reverse(layout.strides[k].begin(), layout.strides[k].begin() + layout.order);
+    }
+    return layout;
+}
+
+/*
+ * Offset, in the first stride set, of the element at linear index `index` of a collapsed layout.
+ */
+template <size_t Order, size_t Count>
+auto CollapsedOffset(CollapsedLayout<Order, Count> const& layout, size_t index) -> size_t
+{
+    size_t offset = 0;
+    for (size_t d = layout.order; d-- > 0;)
+    {
+        offset += (index % layout.shape[d]) * layout.strides[0][d];
+        index /= layout.shape[d];
+    }
+    return offset;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cmath>
+#include <type_traits>
+
+/*
+ * Function objects for the elementwise operations supported by tensor expressions.
+ * Binary operations take both operands in the same type, which the caller converts them to.
+ */
+struct AddOperation
+{
+    template <typename T>
+    constexpr auto operator()(T left, T right) const -> T
+    {
+        return left + right;
+    }
+};
+
+struct SubtractOperation
+{
+    template <typename T>
+    constexpr auto operator()(T left, T right) const -> T
+    {
+        return left - right;
+    }
+};
+
+struct MultiplyOperation
+{
+    template <typename T>
+    constexpr auto operator()(T left, T right) const -> T
+    {
+        return left * right;
+    }
+};
+
+struct DivideOperation
+{
+    template <typename T>
+    constexpr auto operator()(T left, T right) const -> T
+    {
+        return left / right;
+    }
+};
+
+struct NegateOperation
+{
+    template <typename T>
+    constexpr auto operator()(T value) const -> T
+    {
+        return -value;
+    }
+};
+
+struct AbsOperation
+{
+    template <typename T>
+    auto operator()(T value) const
+    {
+        if constexpr (std::is_unsigned_v<T>)
+        {
+            return value;
+        }
+        else
+        {
+            return static_cast<T>(std::abs(value));
+        }
+    }
+};
+
+struct SqrtOperation
+{
+    template <typename T>
+    auto operator()(T value) const
+    {
+        return std::sqrt(value);
+    }
+};
+
+struct ExpOperation
+{
+    template <typename T>
+    auto operator()(T value) const
+    {
+        return std::exp(value);
+    }
+};
+
+struct LogOperation
+{
+    template <typename T>
+    auto operator()(T value) const
+    {
+        return std::log(value);
+    }
+};
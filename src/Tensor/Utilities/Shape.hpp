@@ -1,6 +1,12 @@
 #pragma once
 
+#include <Expect.hpp>
+
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <functional>
+#include <numeric>
 
 /*
  * Calculate the total size of the buffer required to hold the given shape.
@@ -21,3 +27,42 @@ auto GetStrides(const std::array<size_t, Order>& shape) -> std::array<size_t, Or
     std::exclusive_scan(shape.rbegin(), shape.rend(), strides.rbegin(), static_cast<size_t>(1), std::multiplies<>());
     return strides;
 }
+
+/*
+ * Calculate the shape two shapes broadcast to, following NumPy's rules: shapes are aligned at their last dimension, and
+ * each pair of extents must be equal, or one of them 1. Missing leading dimensions count as extent 1.
+ */
+template <size_t LeftOrder, size_t RightOrder>
+auto BroadcastShapes(std::array<size_t, LeftOrder> const& left, std::array<size_t, RightOrder> const& right) -> std::array<size_t, std::max(LeftOrder, RightOrder)>
+{
+    constexpr size_t Order = std::max(LeftOrder, RightOrder);
+
+    std::array<size_t, Order> shape{};
+    for (size_t i = 0; i < Order; ++i)
+    {
+        size_t leftExtent = i >= Order - LeftOrder ? left[i - (Order - LeftOrder)] : 1;
+        size_t rightExtent = i >= Order - RightOrder ? right[i - (Order - RightOrder)] : 1;
+        Expect(leftExtent == rightExtent || leftExtent == 1 || rightExtent == 1, "operand shapes cannot be broadcast together");
+        shape[i] = leftExtent == 1 ? rightExtent : leftExtent;
+    }
+    return shape;
+}
+
+/*
+ * Calculate strides which address a buffer of the given shape and strides as if it had the target shape. Dimensions
+ * which are broadcast, having extent 1 or being missing at the front, get a stride of 0, so repeat the same elements.
+ */
+template <size_t Order, size_t TargetOrder>
+auto BroadcastStrides(std::array<size_t, Order> const& shape, std::array<size_t, Order> const& strides, std::array<size_t, TargetOrder> const& target) -> std::array<size_t, TargetOrder>
+{
+    static_assert(Order <= TargetOrder, "cannot broadcast to fewer dimensions");
+
+    std::array<size_t, TargetOrder> broadcastStrides{};
+    for (size_t i = 0; i < Order; ++i)
+    {
+        size_t t = TargetOrder - Order + i;
+        Expect(shape[i] == target[t] || shape[i] == 1, "shape cannot be broadcast to the target shape");
+        broadcastStrides[t] = shape[i] == target[t] ? strides[i] : 0;
+    }
+    return broadcastStrides;
+}
@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+
+#include <Tensor.hpp>
+
+TEST(ArithmeticTests, FusedExpression)
+{
+    Tensor<float, 2> a({3, 4}, 2.0f);
+    Tensor<float, 2> b({3, 4}, 3.0f);
+    Tensor<float, 2> c({3, 4}, 4.0f);
+
+    Tensor<float, 2> d = a * b + c;
+
+    EXPECT_EQ(d.Shape(), (std::array<size_t, 2>{3, 4}));
+    for (size_t y = 0; y < 3; ++y)
+    {
+        for (size_t x = 0; x < 4; ++x)
+        {
+            EXPECT_EQ(d({y, x}), 10.0f);
+        }
+    }
+}
+
+TEST(ArithmeticTests, ExpressionIsLazy)
+{
+    Tensor<int, 1> a({4}, 1);
+    Tensor<int, 1> b({4}, 2);
+
+    auto expression = a + b;
+    std::fill_n(a.Data(), 4, 10);
+
+    Tensor<int, 1> c = expression;
+    EXPECT_EQ(c({0}), 12);
+    EXPECT_EQ(c({3}), 12);
+}
+
+TEST(ArithmeticTests, MixedTensorAndView)
+{
+    Tensor<int, 2> a({4, 4});
+    std::iota(a.Data(), a.Data() + 16, 0);
+    Tensor<int, 2> b({2, 2}, 100);
+
+    View<int, 2> block = a.Slice(Range{1, 3}, Range{1, 3});
+    Tensor<int, 2> c = block + b - block * 2;
+
+    EXPECT_EQ(c({0, 0}), 100 - 5);
+    EXPECT_EQ(c({0, 1}), 100 - 6);
+    EXPECT_EQ(c({1, 0}), 100 - 9);
+    EXPECT_EQ(c({1, 1}), 100 - 10);
+}
+
+TEST(ArithmeticTests, ScalarBroadcasting)
+{
+    Tensor<float, 1> a({3});
+    std::iota(a.Data(), a.Data() + 3, 1.0f);
+
+    Tensor<float, 1> b = 1.0 - a / 2.0 * 4;
+
+    EXPECT_EQ(b({0}), -1.0f);
+    EXPECT_EQ(b({1}), -3.0f);
+    EXPECT_EQ(b({2}), -5.0f);
+
+    static_assert(std::is_same_v<TensorTraits<decltype(a * 2.0)>::value_type, float>);
+}
+
+TEST(ArithmeticTests, UnaryMath)
+{
+    Tensor<double, 1> a({3});
+    a({0}) = 1.0;
+    a({1}) = 4.0;
+    a({2}) = 9.0;
+
+    Tensor<double, 1> b = -Sqrt(a) + Abs(-a) + Log(Exp(a));
+
+    EXPECT_DOUBLE_EQ(b({0}), -1.0 + 1.0 + 1.0);
+    EXPECT_DOUBLE_EQ(b({1}), -2.0 + 4.0 + 4.0);
+    EXPECT_DOUBLE_EQ(b({2}), -3.0 + 9.0 + 9.0);
+}
+
+TEST(ArithmeticTests, AssignToTensor)
+{
+    Tensor<int, 1> a({3}, 1);
+    Tensor<int, 1> b({3}, 2);
+    const int* data = a.Data();
+
+    // same shape, evaluated in place
+    a = a + b;
+    EXPECT_EQ(a.Data(), data);
+    EXPECT_EQ(a({2}), 3);
+
+    // different shape, reallocated after evaluation
+    a = a.Slice(Range{0, 2}) * 3;
+    EXPECT_EQ(a.Shape(), (std::array<size_t, 1>{2}));
+    EXPECT_EQ(a({1}), 9);
+}
+
+TEST(ArithmeticTests, AssignToView)
+{
+    Tensor<int, 2> a({3, 3}, 1);
+
+    auto center = a.Slice(Range{1, 2}, Range{0, 3});
+    center = center * 5;
+    center += 1;
+    a.Slice(Range{0, 3}, 0) *= 2;
+
+    EXPECT_EQ(a({0, 0}), 2);
+    EXPECT_EQ(a({0, 1}), 1);
+    EXPECT_EQ(a({1, 0}), 12);
+    EXPECT_EQ(a({1, 1}), 6);
+    EXPECT_EQ(a({2, 0}), 2);
+}
+
+TEST(ArithmeticTests, LargeExpression)
+{
+    size_t height = 1024;
+    size_t width = 1536;
+
+    Tensor<float, 2> a({height, width}, 1.5f);
+    Tensor<float, 2> b({height, width}, 2.0f);
+
+    Tensor<float, 2> c = a * b - 1.0f;
+    Tensor<float, 2> d = a.Slice(Range{0, height}, Range{1, width}) + b.Slice(Range{0, height}, Range{0, width - 1});
+
+    EXPECT_TRUE(std::all_of(c.Data(), c.Data() + height * width, [](float value)
+    {
+        return value == 2.0f;
+    }));
+    EXPECT_TRUE(std::all_of(d.Data(), d.Data() + height * (width - 1), [](float value)
+    {
+        return value == 3.5f;
+    }));
+}
+
+TEST(ArithmeticTests, ShapeMismatch)
+{
+    Tensor<int, 1> a({3});
+    Tensor<int, 1> b({4});
+
+    EXPECT_THROW(a + b, std::runtime_error);
+}
+
+TEST(ArithmeticTests, BroadcastToView)
+{
+    Tensor<int, 1> bias({3});
+    std::iota(bias.Data(), bias.Data() + 3, 1);
+
+    auto rows = bias.BroadcastTo(std::array<size_t, 2>{4, 3});
+    EXPECT_EQ(rows.Shape(), (std::array<size_t, 2>{4, 3}));
+    EXPECT_EQ(rows.Strides(), (std::array<size_t, 2>{0, 1}));
+    EXPECT_EQ(rows({3, 2}), 3);
+
+    Tensor<int, 2> column({3, 1});
+    std::iota(column.Data(), column.Data() + 3, 10);
+    Tensor<int, 2> repeated(column.BroadcastTo(std::array<size_t, 2>{3, 5}));
+    EXPECT_EQ(repeated({2, 4}), 12);
+    EXPECT_EQ(repeated({0, 3}), 10);
+
+    EXPECT_THROW(bias.BroadcastTo(std::array<size_t, 2>{4, 2}), std::runtime_error);
+}
+
+TEST(ArithmeticTests, BroadcastingOperands)
+{
+    // a per-channel scale and bias applied to an HWC image, without replicating them
+    Tensor<float, 3> image({4, 5, 3}, 1.0f);
+    Tensor<float, 1> scale({3});
+    std::iota(scale.Data(), scale.Data() + 3, 1.0f);
+    Tensor<float, 1> bias({3}, 0.5f);
+
+    Tensor<float, 3> result = image * scale + bias;
+    EXPECT_EQ(result.Shape(), (std::array<size_t, 3>{4, 5, 3}));
+    for (size_t y = 0; y < 4; ++y)
+    {
+        for (size_t x = 0; x < 5; ++x)
+        {
+            for (size_t c = 0; c < 3; ++c)
+            {
+                EXPECT_EQ(result({y, x, c}), static_cast<float>(c) + 1.5f);
+            }
+        }
+    }
+
+    // both operands expanded: an outer sum of a column and a row
+    Tensor<int, 2> column({3, 1});
+    std::iota(column.Data(), column.Data() + 3, 0);
+    Tensor<int, 1> row({4});
+    std::iota(row.Data(), row.Data() + 4, 0);
+
+    Tensor<int, 2> table = column * 10 + row;
+    EXPECT_EQ(table.Shape(), (std::array<size_t, 2>{3, 4}));
+    EXPECT_EQ(table({2, 3}), 23);
+
+    image = image - bias;
+    EXPECT_EQ(image({3, 4, 2}), 0.5f);
+
+    Tensor<int, 2> mismatched({3, 2});
+    EXPECT_THROW(mismatched + row, std::runtime_error);
+}
+
+TEST(ArithmeticTests, OverlappingOperands)
+{
+    // a destination shifted by one element over its operand reads elements it has already written in place
+    Tensor<float, 1> a({6});
+    std::iota(a.Data(), a.Data() + 6, 0.0f);
+    View<float, 1> d = a.Slice(Range{1, 6});
+    d += a.Slice(Range{0, 5});
+    float const shifted[] = {0.0f, 1.0f, 3.0f, 5.0f, 7.0f, 9.0f};
+    for (size_t i = 0; i < 6; ++i)
+    {
+        EXPECT_EQ(a({i}), shifted[i]) << "at " << i;
+    }
+
+    Tensor<float, 2> m({3, 3});
+    std::iota(m.Data(), m.Data() + 9, 0.0f);
+    Tensor<float, 2> expected({3, 3});
+    for (size_t i = 0; i < 3; ++i)
+    {
+        for (size_t j = 0; j < 3; ++j)
+        {
+            expected({i, j}) = static_cast<float>(3 * i + j + 3 * j + i);
+        }
+    }
+    m += m.Transpose();
+    for (size_t i = 0; i < 3; ++i)
+    {
+        for (size_t j = 0; j < 3; ++j)
+        {
+            EXPECT_EQ(m({i, j}), expected({i, j})) << "at (" << i << ", " << j << ")";
+        }
+    }
+
+    Tensor<float, 2> b({3, 3});
+    std::iota(b.Data(), b.Data() + 9, 0.0f);
+    b = b.Transpose() * 1.0f;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        for (size_t j = 0; j < 3; ++j)
+        {
+            EXPECT_EQ(b({i, j}), static_cast<float>(3 * j + i)) << "at (" << i << ", " << j << ")";
+        }
+    }
+
+    // the same elements at the same positions are still updated in place
+    Tensor<float, 2> c({3, 3}, 1.0f);
+    float* data = c.Data();
+    c = c * 2.0f + c;
+    EXPECT_EQ(c.Data(), data);
+    EXPECT_EQ(c({2, 2}), 3.0f);
+}
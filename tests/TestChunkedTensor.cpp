@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+
+#include <Tensor.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class ChunkedTensorTests : public ::testing::Test
+{
+protected:
+
+    std::string mPath;
+
+    void SetUp() override
+    {
+        auto name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        mPath = (std::filesystem::temp_directory_path() / (std::string("chunked_tensor_") + name + ".chunks")).string();
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(mPath);
+    }
+};
+
+auto MakeVolume(size_t depth, size_t height, size_t width) -> Tensor<float, 3>
+{
+    Tensor<float, 3> volume({depth, height, width});
+    for (size_t i = 0; i < depth * height * width; ++i)
+    {
+        volume.Data()[i] = static_cast<float>(i) * 0.5f;
+    }
+    return volume;
+}
+
+template <typename Container>
+void ExpectBlockEqual(Container const& actual, Tensor<float, 3> const& expected, std::array<size_t, 3> const& origin)
+{
+    auto shape = actual.Shape();
+    for (size_t i = 0; i < shape[0]; ++i)
+    {
+        for (size_t j = 0; j < shape[1]; ++j)
+        {
+            for (size_t k = 0; k < shape[2]; ++k)
+            {
+                ASSERT_EQ(actual({i, j, k}), expected({origin[0] + i, origin[1] + j, origin[2] + k})) << "at (" << i << ", " << j << ", " << k << ")";
+            }
+        }
+    }
+}
+
+TEST_F(ChunkedTensorTests, RoundTrip)
+{
+    Tensor<float, 3> volume = MakeVolume(37, 50, 23);
+    {
+        ChunkedTensor<float, 3> chunked(mPath, {37, 50, 23}, {8, 16, 10});
+        EXPECT_EQ(chunked.ChunkGrid(), (std::array<size_t, 3>{5, 4, 3}));
+        EXPECT_EQ(chunked.ChunkCount(), 60u);
+
+        // every element starts as zero
+        EXPECT_EQ(chunked.Slice(Range{36, 37}, Range{49, 50}, Range{22, 23}).view({0, 0, 0}), 0.0f);
+        chunked.Write({0, 0, 0}, volume);
+    }
+
+    ChunkedTensor<float, 3> chunked(mPath);
+    EXPECT_EQ(chunked.Shape(), volume.Shape());
+    EXPECT_EQ(chunked.ChunkShape(), (std::array<size_t, 3>{8, 16, 10}));
+    auto whole = chunked.Slice(Range{0, 37}, Range{0, 50}, Range{0, 23});
+    ExpectBlockEqual(whole.view, volume, {0, 0, 0});
+
+    // within one chunk, in place in the cache
+    auto inside = chunked.Slice(Range{9, 15}, Range{17, 30}, Range{20, 23});
+    auto again = chunked.Slice(Range{8, 9}, Range{16, 17}, Range{20, 21});
+    EXPECT_EQ(inside.owner, again.owner);
+    static_assert(std::is_same_v<decltype(inside.view), View<float const, 3>>, "slices are read-only");
+    EXPECT_EQ(inside.owner->Shape(), chunked.ChunkShape());
+    ExpectBlockEqual(inside.view, volume, {9, 17, 20});
+
+    // across chunks, assembled into a copy
+    auto across = chunked.Slice(Range{5, 30}, Range{15, 17}, Range{3, 21});
+    EXPECT_EQ(across.owner->Shape(), (std::array<size_t, 3>{25, 2, 18}));
+    ExpectBlockEqual(across.view, volume, {5, 15, 3});
+
+    // a strided block written over the chunk boundaries
+    Tensor<float, 3> block = MakeVolume(4, 20, 30);
+    View<float, 3> transposed = block.Permute<0, 2, 1>().Slice(Range{0, 4}, Range{0, 20}, Range{0, 20});
+    chunked.Write({6, 10, 3}, transposed);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        for (size_t j = 0; j < 20; ++j)
+        {
+            for (size_t k = 0; k < 20; ++k)
+            {
+                volume({6 + i, 10 + j, 3 + k}) = transposed({i, j, k});
+            }
+        }
+    }
+    ExpectBlockEqual(chunked.Slice(Range{0, 37}, Range{0, 50}, Range{0, 23}).view, volume, {0, 0, 0});
+
+    EXPECT_THROW(chunked.Slice(Range{0, 38}, Range{0, 1}, Range{0, 1}), std::runtime_error);
+    EXPECT_THROW(chunked.Write({30, 0, 0}, volume), std::runtime_error);
+    EXPECT_THROW((ChunkedTensor<double, 3>(mPath)), std::runtime_error);
+    EXPECT_THROW((ChunkedTensor<float, 2>(mPath)), std::runtime_error);
+}
+
+TEST_F(ChunkedTensorTests, Eviction)
+{
+    Tensor<float, 3> volume = MakeVolume(20, 20, 20);
+    size_t chunkBytes = 5 * 5 * 20 * sizeof(float);
+    {
+        // room for three of the sixteen chunks, so that modified chunks are written back on eviction
+        ChunkedTensor<float, 3> chunked(mPath, {20, 20, 20}, {5, 5, 20}, {3 * chunkBytes, 2});
+        chunked.Write({0, 0, 0}, volume);
+        EXPECT_LE(chunked.ResidentBytes(), 3 * chunkBytes);
+        ExpectBlockEqual(chunked.Slice(Range{0, 20}, Range{0, 20}, Range{0, 20}).view, volume, {0, 0, 0});
+        EXPECT_LE(chunked.ResidentBytes(), 3 * chunkBytes);
+
+        // chunks in use are kept past the budget, and evicted once released
+        std::vector<ChunkedSlice<float, 3>> slices;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            slices.push_back(chunked.Slice(Range{i * 5, i * 5 + 1}, Range{0, 5}, Range{0, 20}));
+        }
+        slices.push_back(chunked.Slice(Range{0, 5}, Range{5, 10}, Range{0, 20}));
+        EXPECT_EQ(chunked.ResidentBytes(), 5 * chunkBytes);
+        slices.clear();
+        chunked.Slice(Range{19, 20}, Range{19, 20}, Range{0, 20});
+        EXPECT_LE(chunked.ResidentBytes(), 3 * chunkBytes);
+
+        // prefetched chunks are resident once the handle completes
+        ChunkedTensor<float, 3> reader(mPath);
+        EXPECT_EQ(reader.ResidentBytes(), 0u);
+        reader.Prefetch(Range{0, 10}, Range{3, 7}, Range{0, 1}).Wait();
+        EXPECT_EQ(reader.ResidentBytes(), 4 * chunkBytes);
+    }
+
+    ChunkedTensor<float, 3> chunked(mPath);
+    ExpectBlockEqual(chunked.Slice(Range{0, 20}, Range{0, 20}, Range{0, 20}).view, volume, {0, 0, 0});
+}
+
+TEST_F(ChunkedTensorTests, ConcurrentWriteBack)
+{
+    Tensor<float, 3> volume = MakeVolume(16, 16, 16);
+    size_t chunkBytes = 4 * 4 * 16 * sizeof(float);
+    {
+        // threads writing and reading their own rows of chunks evict each other's modified chunks as they go
+        ChunkedTensor<float, 3> chunked(mPath, {16, 16, 16}, {4, 4, 16}, {2 * chunkBytes, 2});
+        DispatchRow(4, [&](size_t row)
+        {
+            for (size_t pass = 0; pass < 3; ++pass)
+            {
+                for (size_t column = 0; column < 4; ++column)
+                {
+                    View<float, 3> block = volume.Slice(Range{row * 4, row * 4 + 4}, Range{column * 4, column * 4 + 4}, Range{0, 16});
+                    chunked.Write({row * 4, column * 4, 0}, block);
+                    auto slice = chunked.Slice(Range{row * 4, row * 4 + 4}, Range{column * 4, column * 4 + 4}, Range{0, 16});
+                    ExpectBlockEqual(slice.view, volume, {row * 4, column * 4, 0});
+                }
+            }
+        });
+        chunked.Flush();
+    }
+
+    ChunkedTensor<float, 3> chunked(mPath);
+    ExpectBlockEqual(chunked.Slice(Range{0, 16}, Range{0, 16}, Range{0, 16}).view, volume, {0, 0, 0});
+}
+
+TEST_F(ChunkedTensorTests, ForEachChunk)
+{
+    size_t chunkBytes = 4 * 7 * 9 * sizeof(float);
+    {
+        ChunkedTensor<float, 3> chunked(mPath, {10, 30, 19}, {4, 7, 9}, {6 * chunkBytes, 1});
+
+        // each element becomes the sum of its coordinates
+        std::atomic<size_t> visited = 0;
+        chunked.ForEachChunk([&](View<float, 3> chunk, std::array<size_t, 3> origin)
+        {
+            auto shape = chunk.Shape();
+            for (size_t d = 0; d < 3; ++d)
+            {
+                EXPECT_EQ(origin[d] % chunked.ChunkShape()[d], 0u);
+                EXPECT_EQ(shape[d], std::min(chunked.ChunkShape()[d], chunked.Shape()[d] - origin[d]));
+            }
+            for (size_t i = 0; i < shape[0]; ++i)
+            {
+                for (size_t j = 0; j < shape[1]; ++j)
+                {
+                    for (size_t k = 0; k < shape[2]; ++k)
+                    {
+                        chunk({i, j, k}) = static_cast<float>(origin[0] + i + origin[1] + j + origin[2] + k);
+                    }
+                }
+            }
+            ++visited;
+        }, ChunkAccess::ReadWrite);
+        EXPECT_EQ(visited, chunked.ChunkCount());
+    }
+
+    ChunkedTensor<float, 3> chunked(mPath, {chunkBytes, 2});
+    std::mutex mutex;
+    double total = 0.0;
+    chunked.ForEachChunk([&](View<float, 3> chunk, std::array<size_t, 3>)
+    {
+        double sum = 0.0;
+        for (float value : chunk)
+        {
+            sum += value;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        total += sum;
+    });
+
+    // the sum over all elements of i + j + k, from their means
+    EXPECT_EQ(total, 10 * 30 * 19 * (4.5 + 14.5 + 9.0));
+
+    EXPECT_THROW(chunked.ForEachChunk([](View<float, 3>, std::array<size_t, 3>)
+    {
+        throw std::runtime_error("failed");
+    }), std::runtime_error);
+}
+
+TEST_F(ChunkedTensorTests, OverflowingLayout)
+{
+    {
+        ChunkedTensor<float, 3> tensor(mPath, {2, 2, 2}, {1, 1, 1});
+    }
+
+    // so many chunks that the end of the last one wraps around to before the end of the file
+    uint64_t extent = uint64_t{1} << 62;
+    std::fstream file(mPath, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(sizeof(ChunkedTensorHeader));
+    file.write(reinterpret_cast<char const*>(&extent), sizeof(extent));
+    file.close();
+
+    EXPECT_THROW((ChunkedTensor<float, 3>(mPath)), std::runtime_error);
+    EXPECT_THROW((ChunkedTensor<float, 3>(mPath, {extent, 4, 1}, {1, 1, 1})), std::runtime_error);
+}
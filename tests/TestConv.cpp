@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include "TestData.hpp"
+
+#include <Tensor.hpp>
+
+#include <cmath>
+
+template <typename Input, typename Weights>
+auto NaiveConv2D(Input const& input, Weights const& weights, Conv2DParameters const& parameters)
+{
+    using value_type = std::remove_const_t<typename TensorTraits<Input>::value_type>;
+
+    auto [channels, height, width] = input.Shape();
+    auto [filters, weightChannels, kernelHeight, kernelWidth] = weights.Shape();
+    auto outputShape = Conv2DOutputShape(input.Shape(), weights.Shape(), parameters);
+
+    Tensor<value_type, 3> output(outputShape);
+    for (size_t k = 0; k < filters; ++k)
+    {
+        for (size_t y = 0; y < outputShape[1]; ++y)
+        {
+            for (size_t x = 0; x < outputShape[2]; ++x)
+            {
+                value_type sum{};
+                for (size_t c = 0; c < channels; ++c)
+                {
+                    for (size_t r = 0; r < kernelHeight; ++r)
+                    {
+                        for (size_t s = 0; s < kernelWidth; ++s)
+                        {
+                            auto iy = static_cast<std::ptrdiff_t>(y * parameters.stride[0] + r * parameters.dilation[0]) - static_cast<std::ptrdiff_t>(parameters.padding[0]);
+                            auto ix = static_cast<std::ptrdiff_t>(x * parameters.stride[1] + s * parameters.dilation[1]) - static_cast<std::ptrdiff_t>(parameters.padding[1]);
+                            if (iy >= 0 && ix >= 0 && iy < static_cast<std::ptrdiff_t>(height) && ix < static_cast<std::ptrdiff_t>(width))
+                            {
+                                sum += input({c, static_cast<size_t>(iy), static_cast<size_t>(ix)}) * weights({k, c, r, s});
+                            }
+                        }
+                    }
+                }
+                output({k, y, x}) = sum;
+            }
+        }
+    }
+    return output;
+}
+
+template <typename A, typename B>
+auto ExpectNear(A const& actual, B const& expected, double tolerance) -> void
+{
+    ASSERT_EQ(actual.Shape(), expected.Shape());
+    auto e = expected.begin();
+    for (auto value : actual)
+    {
+        ASSERT_NEAR(value, *e++, tolerance);
+    }
+}
+
+TEST(ConvTests, OutputShape)
+{
+    Conv2DParameters parameters = {.stride = {2, 1}, .padding = {1, 2}, .dilation = {1, 2}};
+    auto shape = Conv2DOutputShape(std::array<size_t, 3>{3, 9, 10}, {8, 3, 3, 3}, parameters);
+    EXPECT_EQ(shape, (std::array<size_t, 3>{8, 5, 10}));
+
+    EXPECT_THROW(Conv2DOutputShape(std::array<size_t, 3>{3, 2, 2}, {8, 3, 3, 3}, {}), std::runtime_error);
+    EXPECT_THROW(Conv2DOutputShape(std::array<size_t, 3>{4, 9, 9}, {8, 3, 3, 3}, {}), std::runtime_error);
+}
+
+TEST(ConvTests, MatchesReference)
+{
+    std::array<Conv2DParameters, 4> cases = {{
+        {},
+        {.padding = {1, 1}},
+        {.stride = {2, 2}, .padding = {1, 0}},
+        {.stride = {1, 3}, .padding = {2, 2}, .dilation = {2, 2}},
+    }};
+
+    auto input = MakeSequence<float, 3>({5, 23, 41}, 1);
+    auto weights = MakeSequence<float, 4>({7, 5, 3, 3}, 2);
+
+    for (auto parameters : cases)
+    {
+        auto expected = NaiveConv2D(input, weights, parameters);
+        for (auto algorithm : {ConvAlgorithm::Direct, ConvAlgorithm::Im2Col})
+        {
+            parameters.algorithm = algorithm;
+            ExpectNear(Conv2D(input, weights, parameters), expected, 1e-3);
+        }
+    }
+}
+
+TEST(ConvTests, ValueTypes)
+{
+    Conv2DParameters parameters = {.padding = {2, 2}};
+
+    auto input = MakeSequence<double, 3>({3, 17, 19}, 3);
+    auto weights = MakeSequence<double, 4>({13, 3, 5, 5}, 4);
+    auto expected = NaiveConv2D(input, weights, parameters);
+    ExpectNear(Conv2D(input, weights, parameters), expected, 1e-9);
+
+    auto integers = MakeSequence<int, 3>({2, 8, 8}, 5);
+    auto integerWeights = MakeSequence<int, 4>({3, 2, 3, 3}, 6);
+    Tensor<int, 3> result = Conv2D(integers, integerWeights, parameters);
+    Tensor<int, 3> integerExpected = NaiveConv2D(integers, integerWeights, parameters);
+    EXPECT_TRUE(std::equal(result.begin(), result.end(), integerExpected.begin()));
+}
+
+TEST(ConvTests, StridedViews)
+{
+    // an HWC image convolved as CHW through a permuted view, into every other channel of a wider destination
+    auto hwc = MakeSequence<float, 3>({20, 30, 4}, 7);
+    auto chw = hwc.Permute<2, 0, 1>();
+    auto allWeights = MakeSequence<float, 4>({4, 6, 3, 3}, 8);
+    auto weights = allWeights.Slice(Range{0, 4}, Range{1, 5}, Range{0, 3}, Range{0, 3});
+    Conv2DParameters parameters = {.padding = {1, 1}};
+
+    Tensor<float, 3> expected = NaiveConv2D(chw, weights, parameters);
+    for (auto algorithm : {ConvAlgorithm::Direct, ConvAlgorithm::Im2Col})
+    {
+        parameters.algorithm = algorithm;
+        Tensor<float, 3> destination({8, 20, 30});
+        auto channels = View<float, 3>(destination.Data(), {4, 20, 30}, {1200, 30, 1}, 600);
+        Conv2D(chw, weights, channels, parameters);
+        ExpectNear(channels, expected, 1e-3);
+
+        // a transposed destination
+        Tensor<float, 3> transposed({30, 20, 4});
+        auto destinationView = transposed.Permute<2, 1, 0>();
+        Conv2D(chw, weights, destinationView, parameters);
+        ExpectNear(destinationView, expected, 1e-3);
+    }
+}
+
+TEST(ConvTests, Batch)
+{
+    auto batch = MakeSequence<float, 4>({3, 2, 12, 14}, 9);
+    auto weights = MakeSequence<float, 4>({5, 2, 3, 3}, 10);
+    Conv2DParameters parameters = {.stride = {2, 2}, .padding = {1, 1}};
+
+    auto output = Conv2D(batch, weights, parameters);
+    EXPECT_EQ(output.Shape(), (std::array<size_t, 4>{3, 5, 6, 7}));
+    for (size_t n = 0; n < 3; ++n)
+    {
+        ExpectNear(output.Slice(n, Range{0, 5}, Range{0, 6}, Range{0, 7}), NaiveConv2D(batch.Slice(n, Range{0, 2}, Range{0, 12}, Range{0, 14}), weights, parameters), 1e-3);
+    }
+
+    Tensor<float, 4> wrongShape({3, 5, 6, 6});
+    EXPECT_THROW(Conv2D(batch, weights, wrongShape, parameters), std::runtime_error);
+}
+
+TEST(ConvTests, ManyChannels)
+{
+    // large enough to take the parallel paths of both algorithms
+    auto input = MakeSequence<float, 3>({64, 33, 35}, 11);
+    auto weights = MakeSequence<float, 4>({19, 64, 3, 3}, 12);
+    Conv2DParameters parameters = {.padding = {1, 1}};
+
+    auto expected = NaiveConv2D(input, weights, parameters);
+    for (auto algorithm : {ConvAlgorithm::Direct, ConvAlgorithm::Im2Col})
+    {
+        parameters.algorithm = algorithm;
+        ExpectNear(Conv2D(input, weights, parameters), expected, 1e-2);
+    }
+}
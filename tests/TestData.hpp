@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Tensor.hpp>
+
+#include <array>
+#include <cstddef>
+
+/*
+ * Make a tensor of small integers in [-5, 5], varying with `seed`, whose products and sums stay exact in floating point,
+ * so results can be compared with a naive reference exactly or within a tight tolerance.
+ */
+template <typename T, size_t Order>
+auto MakeSequence(std::array<size_t, Order> const& shape, size_t seed) -> Tensor<T, Order>
+{
+    Tensor<T, Order> tensor(shape);
+    for (size_t i = 0; i < GetSize(shape); ++i)
+    {
+        tensor.Data()[i] = static_cast<T>((i * 7 + seed) % 11) - static_cast<T>(5);
+    }
+    return tensor;
+}
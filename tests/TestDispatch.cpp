@@ -2,6 +2,13 @@
 
 #include <Dispatch.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 TEST(DispatchTests, DispatchElementMatrixAdd)
 {
     size_t height = 512;
@@ -50,3 +57,228 @@ TEST(DispatchTests, DispatchRowMatrixAdd)
         }
     }
 }
+
+TEST(DispatchTests, DispatchRowAsyncHandle)
+{
+    std::vector<int> rows(1000, 0);
+
+    DispatchHandle handle = DispatchRowAsync(rows.size(), [&](size_t y)
+    {
+        rows[y] = static_cast<int>(y);
+    });
+    handle.Wait();
+
+    EXPECT_TRUE(handle.IsDone());
+    for (size_t y = 0; y < rows.size(); ++y)
+    {
+        EXPECT_EQ(rows[y], static_cast<int>(y));
+    }
+
+    EXPECT_TRUE(DispatchHandle().IsDone());
+    EXPECT_TRUE(DispatchRowAsync(0, [](size_t) {}).IsDone());
+}
+
+TEST(DispatchTests, ContinuationsRunInOrder)
+{
+    std::vector<int> values(256, 1);
+    std::atomic<int> total = 0;
+
+    DispatchHandle handle = DispatchRowAsync(values.size(), [&](size_t y)
+    {
+        values[y] *= 2;
+    }).Then([&]()
+    {
+        for (int& value : values)
+        {
+            value += 1;
+        }
+    }).Then([&]()
+    {
+        for (int value : values)
+        {
+            total += value;
+        }
+    });
+    handle.Wait();
+
+    EXPECT_EQ(total.load(), 256 * 3);
+}
+
+TEST(DispatchTests, WhenAllJoinsDispatches)
+{
+    std::atomic<int> counter = 0;
+    std::vector<DispatchHandle> handles;
+    for (int i = 0; i < 8; ++i)
+    {
+        handles.push_back(DispatchAsync([&]()
+        {
+            counter.fetch_add(1);
+        }));
+    }
+
+    int seen = 0;
+    WhenAll(handles).Then([&]()
+    {
+        seen = counter.load();
+    }).Wait();
+
+    EXPECT_EQ(seen, 8);
+    EXPECT_TRUE(WhenAll({}).IsDone());
+
+    // the join belongs to the pool of the handles it waits for
+    ThreadPool pool(2);
+    std::atomic<bool> release = false;
+    DispatchHandle pending = DispatchTasks(pool, 1, [&](size_t)
+    {
+        while (!release.load())
+        {
+            std::this_thread::yield();
+        }
+    });
+    DispatchHandle joined = WhenAll({DispatchHandle(), pending});
+    EXPECT_EQ(&joined.Pool(), &pool);
+    release = true;
+    joined.Wait();
+}
+
+TEST(DispatchTests, ExceptionsReachTheWaiter)
+{
+    bool continued = false;
+    DispatchHandle failed = DispatchRowAsync(64, [](size_t y)
+    {
+        if (y == 17)
+        {
+            throw std::runtime_error("row failed");
+        }
+    });
+    DispatchHandle continuation = failed.Then([&]()
+    {
+        continued = true;
+    });
+
+    EXPECT_THROW(failed.Wait(), std::runtime_error);
+    EXPECT_THROW(continuation.Wait(), std::runtime_error);
+    EXPECT_FALSE(continued);
+    EXPECT_THROW(DispatchRow(4, [](size_t) { throw std::runtime_error("row failed"); }), std::runtime_error);
+}
+
+TEST(DispatchTests, WaitIgnoresUnrelatedWork)
+{
+    // a second worker is left free while the first is blocked
+    ThreadPool pool(2);
+
+    // a long-running dispatch from another caller occupies one worker until released
+    std::atomic<bool> release = false;
+    DispatchHandle blocker = DispatchTasks(pool, 1, [&](size_t)
+    {
+        while (!release.load())
+        {
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<int> rows(64, 0);
+    DispatchTasks(pool, rows.size(), [&](size_t y)
+    {
+        rows[y] = 1;
+    }).Wait();
+    EXPECT_FALSE(blocker.IsDone());
+    EXPECT_EQ(std::count(rows.begin(), rows.end(), 1), 64);
+
+    release = true;
+    blocker.Wait();
+}
+
+TEST(DispatchTests, NestedDispatch)
+{
+    size_t height = 64;
+    size_t width = 64;
+    std::vector<std::vector<int>> m(height, std::vector<int>(width, 0));
+
+    DispatchRow(8, [&](size_t block)
+    {
+        DispatchElement(height / 8, width, [&](size_t y, size_t x)
+        {
+            m[block * height / 8 + y][x] += 1;
+        });
+    });
+
+    for (auto const& row : m)
+    {
+        EXPECT_EQ(std::count(row.begin(), row.end(), 1), static_cast<long>(width));
+    }
+}
+
+static auto ParallelFibonacci(size_t n) -> size_t
+{
+    if (n < 2)
+    {
+        return n;
+    }
+
+    size_t a = 0;
+    size_t b = 0;
+    TaskGroup group;
+    group.Run([&]() { a = ParallelFibonacci(n - 1); });
+    group.Run([&]() { b = ParallelFibonacci(n - 2); });
+    group.Wait();
+    return a + b;
+}
+
+TEST(DispatchTests, TaskGroupRecursion)
+{
+    EXPECT_EQ(ParallelFibonacci(16), 987u);
+}
+
+TEST(DispatchTests, TaskGroupReuseAndErrors)
+{
+    std::atomic<int> counter = 0;
+    TaskGroup group;
+    for (int i = 0; i < 100; ++i)
+    {
+        group.Run([&]()
+        {
+            counter.fetch_add(1);
+            group.Run([&]() { counter.fetch_add(1); });
+        });
+    }
+    group.Wait();
+    EXPECT_EQ(counter.load(), 200);
+
+    group.Run([]() { throw std::runtime_error("task failed"); });
+    group.Run([&]() { counter.fetch_add(1); });
+    EXPECT_THROW(group.Wait(), std::runtime_error);
+    EXPECT_EQ(counter.load(), 201);
+
+    group.Wait();
+}
+
+#if TENSOR_POOL_METRICS
+TEST(DispatchTests, TaskGroupReleasesStates)
+{
+    size_t before = DispatchState::Live();
+    for (int i = 0; i < 100; ++i)
+    {
+        TaskGroup group;
+        group.Run([]() {});
+        group.Wait();
+        group.Run([]() {});
+    }
+
+    // the last task's worker may still be releasing its state after the group was woken
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (DispatchState::Live() > before && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+    EXPECT_LE(DispatchState::Live(), before);
+}
+#endif
+
+TEST(DispatchTests, ConfigureAfterFirstUse)
+{
+    ThreadPool& pool = GetDispatcherThreadPool();
+    EXPECT_THROW(ConfigureDispatcherThreadPool(ThreadPoolOptions{.threads = 2, .affinity = Affinity::Compact, .cpus = {}}), std::runtime_error);
+    EXPECT_THROW(SetDispatcherThreadPool(pool), std::runtime_error);
+    EXPECT_EQ(&GetDispatcherThreadPool(), &pool);
+}
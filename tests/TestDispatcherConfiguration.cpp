@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include <Tensor.hpp>
+
+#include <cstdint>
+
+// built as its own executable, so that nothing else has created the dispatcher thread pool yet
+
+TEST(DispatcherConfigurationTests, SmallOperationsLeaveThePoolUnused)
+{
+    Tensor<float, 2> a({4, 4});
+    Tensor<float, 2> b({4, 4}, 2.0f);
+    for (size_t i = 0; i < 16; ++i)
+    {
+        a.Data()[i] = static_cast<float>(i);
+    }
+
+    Tensor<float, 2> sum = a + b * 3.0f;
+    Tensor<float, 2> transposed(a.Transpose());
+    Tensor<float, 2> product = MatMul(a, b);
+    EXPECT_EQ(sum({1, 2}), 12.0f);
+    EXPECT_EQ(transposed({1, 2}), 9.0f);
+    EXPECT_EQ(product({1, 0}), 44.0f);
+    EXPECT_EQ(Sum(a), 120.0f);
+    EXPECT_EQ(Sum(a, 1)({3}), 54.0f);
+
+    ForEach(a, [](float& element) { element += 1.0f; });
+    EXPECT_EQ(a({0, 0}), 1.0f);
+
+    CsrMatrix<float> csr(b);
+    EXPECT_EQ(MatMul(csr, a)({0, 0}), 56.0f);
+
+    Tensor<uint8_t, 2> bytes({4, 4}, uint8_t{1});
+    Tensor<int8_t, 2> weights({4, 4}, int8_t{-1});
+    EXPECT_EQ(MatMul(bytes, weights)({2, 3}), -4);
+
+    ConfigureDispatcherThreadPool(ThreadPoolOptions{.threads = 2, .affinity = Affinity::None, .cpus = {}});
+    EXPECT_EQ(GetDispatcherThreadPool().Threads(), 2u);
+}
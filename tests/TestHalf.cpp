@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+
+#include <Tensor.hpp>
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+auto IsNaNBits(uint16_t bits, uint16_t exponentMask) -> bool
+{
+    return (bits & exponentMask) == exponentMask && (bits & ~exponentMask & 0x7fff) != 0;
+}
+
+TEST(HalfTests, Float16Values)
+{
+    EXPECT_EQ(Float16(1.0f).Bits(), 0x3c00);
+    EXPECT_EQ(Float16(-2.0f).Bits(), 0xc000);
+    EXPECT_EQ(Float16(65504.0f).Bits(), 0x7bff);
+    EXPECT_EQ(Float16(0.1f).Bits(), 0x2e66);
+
+    // values past the largest half round to infinity from halfway, 65520, onwards
+    EXPECT_EQ(Float16(65519.0f).Bits(), 0x7bff);
+    EXPECT_EQ(Float16(65520.0f).Bits(), 0x7c00);
+    EXPECT_EQ(Float16(-1e10f).Bits(), 0xfc00);
+
+    // subnormals, and ties rounding to even
+    EXPECT_EQ(Float16(std::ldexp(1.0f, -24)).Bits(), 0x0001);
+    EXPECT_EQ(Float16(std::ldexp(1.0f, -25)).Bits(), 0x0000);
+    EXPECT_EQ(Float16(std::ldexp(3.0f, -25)).Bits(), 0x0002);
+    EXPECT_EQ(Float16(1.0f + std::ldexp(1.0f, -11)).Bits(), 0x3c00);
+    EXPECT_EQ(Float16(1.0f + std::ldexp(3.0f, -11)).Bits(), 0x3c02);
+
+    EXPECT_TRUE(std::isnan(static_cast<float>(Float16(std::numeric_limits<float>::quiet_NaN()))));
+    EXPECT_EQ(static_cast<float>(std::numeric_limits<Float16>::max()), 65504.0f);
+    EXPECT_EQ(static_cast<float>(std::numeric_limits<Float16>::epsilon()), std::ldexp(1.0f, -10));
+}
+
+TEST(HalfTests, BFloat16Values)
+{
+    EXPECT_EQ(BFloat16(1.0f).Bits(), 0x3f80);
+    EXPECT_EQ(BFloat16(-2.0f).Bits(), 0xc000);
+    EXPECT_EQ(BFloat16(3.0f).Bits(), 0x4040);
+    EXPECT_EQ(static_cast<float>(std::numeric_limits<BFloat16>::max()), 3.38953139e38f);
+
+    // 1 + 2^-8 is halfway between 1 and 1 + 2^-7, and rounds to even
+    EXPECT_EQ(BFloat16(1.0f + std::ldexp(1.0f, -8)).Bits(), 0x3f80);
+    EXPECT_EQ(BFloat16(1.0f + std::ldexp(3.0f, -8)).Bits(), 0x3f82);
+
+    EXPECT_EQ(BFloat16(std::numeric_limits<float>::infinity()).Bits(), 0x7f80);
+    EXPECT_TRUE(std::isnan(static_cast<float>(BFloat16(std::numeric_limits<float>::quiet_NaN()))));
+    EXPECT_EQ(static_cast<float>(std::numeric_limits<BFloat16>::min()), std::numeric_limits<float>::min());
+}
+
+TEST(HalfTests, RoundTripEveryValue)
+{
+    for (uint32_t bits = 0; bits <= 0xffff; ++bits)
+    {
+        uint16_t half = static_cast<uint16_t>(bits);
+
+        uint16_t float16 = Float16(static_cast<float>(Float16::FromBits(half))).Bits();
+        if (IsNaNBits(half, 0x7c00))
+        {
+            EXPECT_EQ(float16, half | 0x200) << std::hex << bits;
+        }
+        else
+        {
+            EXPECT_EQ(float16, half) << std::hex << bits;
+        }
+
+        uint16_t bfloat16 = BFloat16(static_cast<float>(BFloat16::FromBits(half))).Bits();
+        if (IsNaNBits(half, 0x7f80))
+        {
+            EXPECT_EQ(bfloat16, half | 0x40) << std::hex << bits;
+        }
+        else
+        {
+            EXPECT_EQ(bfloat16, half) << std::hex << bits;
+        }
+    }
+}
+
+template <typename H>
+void ExpectConvertKernelsMatchScalar()
+{
+    // floats of every magnitude, including subnormals, infinities and NaNs, and exact ties
+    std::vector<float> floats;
+    uint32_t state = 12345;
+    for (size_t i = 0; i < 4099; ++i)
+    {
+        state = state * 1664525 + 1013904223;
+        floats.push_back(std::bit_cast<float>(state));
+    }
+    floats.push_back(1.0f + std::ldexp(1.0f, -11));
+    floats.push_back(1.0f + std::ldexp(1.0f, -8));
+    floats.push_back(std::ldexp(1.0f, -140));
+    floats.push_back(std::numeric_limits<float>::infinity());
+
+    std::vector<H> halves(floats.size());
+    for (size_t i = 0; i < floats.size(); ++i)
+    {
+        halves[i] = H::FromBits(static_cast<uint16_t>(i * 16 + i / 4096));
+    }
+
+    // every level, then the AVX-512 BF16 kernel where there is one
+    for (auto [level, avx512Bf16] : {std::pair{SimdLevel::Scalar, false}, {SimdLevel::SSE42, false}, {SimdLevel::AVX2, false},
+                                     {SimdLevel::AVX512, false}, {SimdLevel::AVX512, true}})
+    {
+        if (level > DetectSimdLevel() || (avx512Bf16 && !DetectAvx512Bf16()))
+        {
+            continue;
+        }
+
+        // lengths which are not a multiple of any register width, so the tails are exercised as well
+        for (size_t count : {size_t{0}, size_t{7}, size_t{33}, floats.size()})
+        {
+            std::vector<H> narrowed(count);
+            GetConvertKernel<float, H>(level, avx512Bf16)(floats.data(), narrowed.data(), count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                ASSERT_EQ(narrowed[i].Bits(), H(floats[i]).Bits()) << "level " << static_cast<int>(level) << ", index " << i;
+            }
+
+            std::vector<float> widened(count);
+            GetConvertKernel<H, float>(level)(halves.data(), widened.data(), count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                ASSERT_EQ(std::bit_cast<uint32_t>(widened[i]), std::bit_cast<uint32_t>(static_cast<float>(halves[i])))
+                    << "level " << static_cast<int>(level) << ", index " << i;
+            }
+        }
+    }
+}
+
+TEST(HalfTests, Float16Kernels)
+{
+    ExpectConvertKernelsMatchScalar<Float16>();
+}
+
+TEST(HalfTests, BFloat16Kernels)
+{
+    ExpectConvertKernelsMatchScalar<BFloat16>();
+}
+
+TEST(HalfTests, TensorConversion)
+{
+    Tensor<float, 2> a({300, 70});
+    for (size_t i = 0; i < 300; ++i)
+    {
+        for (size_t j = 0; j < 70; ++j)
+        {
+            a({i, j}) = static_cast<float>(i) - static_cast<float>(j) * 0.25f;
+        }
+    }
+
+    // dense, strided and transposing copies
+    Tensor<Float16, 2> dense(a);
+    Tensor<BFloat16, 2> strided(a.Slice(Range{0, 300}, Range{1, 70}));
+    Tensor<Float16, 2> transposed(a.Permute<1, 0>());
+    Tensor<float, 2> back(dense);
+
+    for (size_t i = 0; i < 300; ++i)
+    {
+        for (size_t j = 0; j < 70; ++j)
+        {
+            EXPECT_EQ(dense({i, j}).Bits(), Float16(a({i, j})).Bits());
+            EXPECT_EQ(transposed({j, i}).Bits(), Float16(a({i, j})).Bits());
+            EXPECT_EQ(back({i, j}), static_cast<float>(Float16(a({i, j}))));
+            if (j > 0)
+            {
+                EXPECT_EQ(strided({i, j - 1}).Bits(), BFloat16(a({i, j})).Bits());
+            }
+        }
+    }
+}
+
+TEST(HalfTests, TensorArithmetic)
+{
+    Tensor<Float16, 1> a({5}, Float16(1.5f));
+    Tensor<Float16, 1> b({5}, Float16(0.25f));
+    Tensor<float, 1> c({5}, 2.0f);
+
+    Tensor<Float16, 1> sum = a + b * 2.0f;
+    EXPECT_EQ(static_cast<float>(sum({4})), 2.0f);
+
+    // a Float16 and a float tensor combine in float
+    auto mixed = a + c;
+    static_assert(std::is_same_v<TensorTraits<decltype(mixed)>::value_type, float>);
+    Tensor<float, 1> result = mixed;
+    EXPECT_EQ(result({0}), 3.5f);
+
+    a += b;
+    EXPECT_EQ(static_cast<float>(a({2})), 1.75f);
+}
+
+TEST(HalfTests, SumAccumulatesInFloat)
+{
+    // past 2048, adding 1 to a half no longer changes it
+    Tensor<Float16, 1> ones({5000}, Float16(1.0f));
+    EXPECT_EQ(static_cast<float>(Sum(ones, Summation::Naive)), 5000.0f);
+    EXPECT_EQ(static_cast<float>(Sum(ones, Summation::Kahan)), 5000.0f);
+    EXPECT_EQ(static_cast<float>(Mean(ones)), 1.0f);
+
+    Tensor<BFloat16, 2> matrix({2, 3}, BFloat16(2.0f));
+    matrix({1, 2}) = 5.0f;
+    EXPECT_EQ(static_cast<float>(Max(matrix)), 5.0f);
+    EXPECT_EQ(ArgMax(matrix), 5u);
+    EXPECT_EQ(static_cast<float>(Sum(matrix, 1)({1})), 9.0f);
+}
+
+TEST(HalfTests, MeanDividesInFloat)
+{
+    // the sum of 1000 hundreds overflows a half, and the sum of 70000 halves is past the point where 0.5 rounds away
+    Tensor<Float16, 1> hundreds({1000}, Float16(100.0f));
+    EXPECT_EQ(static_cast<float>(Mean(hundreds)), 100.0f);
+    EXPECT_EQ(static_cast<float>(Mean(hundreds, Summation::Kahan)), 100.0f);
+
+    Tensor<Float16, 2> halves({2, 70000}, Float16(0.5f));
+    EXPECT_EQ(static_cast<float>(Mean(halves)), 0.5f);
+    EXPECT_EQ(static_cast<float>(Mean(halves, 1)({1})), 0.5f);
+    EXPECT_EQ(static_cast<float>(Mean(halves, 1, Summation::Naive)({0})), 0.5f);
+
+    Tensor<BFloat16, 2> columns({5000, 3}, BFloat16(3.0f));
+    EXPECT_EQ(static_cast<float>(Mean(columns, 0)({2})), 3.0f);
+}
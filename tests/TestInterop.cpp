@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <Tensor.hpp>
+
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+TEST(InteropTests, AdoptBuffer)
+{
+    float* buffer = new float[6];
+    std::iota(buffer, buffer + 6, 0.0f);
+    int released = 0;
+
+    {
+        Tensor<float, 2> tensor(buffer, {2, 3}, [&](float* data)
+        {
+            EXPECT_EQ(data, buffer);
+            ++released;
+            delete[] data;
+        });
+        EXPECT_EQ(tensor.Data(), buffer);
+        EXPECT_EQ(tensor({1, 2}), 5.0f);
+
+        // moving keeps the same buffer and release function
+        Tensor<float, 2> moved = std::move(tensor);
+        moved += 1.0f;
+        EXPECT_EQ(moved({1, 2}), 6.0f);
+        EXPECT_EQ(released, 0);
+    }
+    EXPECT_EQ(released, 1);
+
+    EXPECT_THROW((Tensor<float, 1>(buffer, {6}, nullptr)), std::runtime_error);
+
+    // the release function is kept out of line, so the deleter of every tensor stays small
+    static_assert(sizeof(AllocatorDeleter<float, AlignedAllocator<float>>) == 3 * sizeof(void*));
+}
+
+TEST(InteropTests, Release)
+{
+    Tensor<int, 2> tensor({2, 2}, 7);
+    int* data = tensor.Data();
+
+    auto buffer = tensor.Release();
+    EXPECT_EQ(buffer.get(), data);
+    EXPECT_EQ(buffer[3], 7);
+    EXPECT_EQ(tensor.Data(), nullptr);
+    EXPECT_EQ(tensor.Shape(), (std::array<size_t, 2>{0, 0}));
+}
+
+TEST(InteropTests, DLPackRoundTrip)
+{
+    Tensor<uint16_t, 3> tensor({2, 3, 4});
+    std::iota(tensor.Data(), tensor.Data() + 24, uint16_t{0});
+    uint16_t* data = tensor.Data();
+
+    DLManagedTensor* managed = ToDLPack(std::move(tensor));
+    DLTensor const& dl = managed->dl_tensor;
+    EXPECT_EQ(dl.data, data);
+    EXPECT_EQ(dl.ndim, 3);
+    EXPECT_EQ(dl.dtype.code, kDLUInt);
+    EXPECT_EQ(dl.dtype.bits, 16);
+    EXPECT_EQ(dl.shape[2], 4);
+    EXPECT_EQ(dl.strides[0], 12);
+
+    EXPECT_THROW((FromDLPack<int16_t, 3>(managed)), std::runtime_error);
+    EXPECT_THROW((FromDLPack<uint16_t, 2>(managed)), std::runtime_error);
+
+    Tensor<uint16_t, 3> imported = FromDLPack<uint16_t, 3>(managed);
+    EXPECT_EQ(imported.Data(), data);
+    EXPECT_EQ(imported({1, 2, 3}), 23);
+}
+
+TEST(InteropTests, DLPackEmpty)
+{
+    // producers commonly export empty tensors without a buffer, which must still be handed back exactly once
+    static int deleted = 0;
+    deleted = 0;
+    int64_t shape[2] = {0, 3};
+    DLManagedTensor managed{};
+    managed.dl_tensor = DLTensor{nullptr, DLDevice{kDLCPU, 0}, 2, DLDataTypeOf<float>(), shape, nullptr, 0};
+    managed.deleter = [](DLManagedTensor*) { ++deleted; };
+
+    {
+        Tensor<float, 2> imported = FromDLPack<float, 2>(&managed);
+        EXPECT_EQ(imported.Data(), nullptr);
+        EXPECT_EQ(imported.Shape(), (std::array<size_t, 2>{0, 3}));
+    }
+    EXPECT_EQ(deleted, 1);
+
+    // a null buffer with elements is rejected, leaving ownership with the producer
+    shape[0] = 2;
+    EXPECT_THROW((FromDLPack<float, 2>(&managed)), std::runtime_error);
+    EXPECT_EQ(deleted, 1);
+}
+
+TEST(InteropTests, DLPackStrided)
+{
+    // a frame with padded rows, as a capture driver might produce
+    std::vector<float> frame(4 * 8);
+    std::iota(frame.begin(), frame.end(), 0.0f);
+    int64_t shape[2] = {4, 6};
+    int64_t strides[2] = {8, 1};
+    DLManagedTensor managed{};
+    managed.dl_tensor = DLTensor{frame.data(), DLDevice{kDLCPU, 0}, 2, DLDataTypeOf<float>(), shape, strides, sizeof(float)};
+
+    View<float, 2> view = ViewDLPack<float, 2>(managed.dl_tensor);
+    EXPECT_EQ(view.Shape(), (std::array<size_t, 2>{4, 6}));
+    EXPECT_EQ(view({0, 0}), 1.0f);
+    EXPECT_EQ(view({2, 5}), 22.0f);
+
+    EXPECT_THROW((FromDLPack<float, 2>(&managed)), std::runtime_error);
+
+    managed.dl_tensor.device.device_type = kDLCUDA;
+    EXPECT_THROW((ViewDLPack<float, 2>(managed.dl_tensor)), std::runtime_error);
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <Tensor.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <vector>
+
+static_assert(std::ranges::contiguous_range<Tensor<float, 2>>);
+static_assert(std::ranges::random_access_range<View<float, 3>>);
+static_assert(std::ranges::sized_range<View<float, 3> const>);
+static_assert(std::random_access_iterator<StridedIterator<int const, 2>>);
+
+TEST(IterationTests, TensorIsContiguous)
+{
+    Tensor<int, 2> tensor({3, 4});
+    std::iota(tensor.begin(), tensor.end(), 0);
+
+    EXPECT_EQ(tensor.end() - tensor.begin(), 12);
+    EXPECT_EQ(tensor({2, 3}), 11);
+
+    int sum = 0;
+    for (int element : tensor)
+    {
+        sum += element;
+    }
+    EXPECT_EQ(sum, 66);
+}
+
+TEST(IterationTests, ViewRowMajorOrder)
+{
+    Tensor<int, 3> tensor({3, 4, 5});
+    std::iota(tensor.Data(), tensor.Data() + 60, 0);
+    View<int, 3> view = tensor.Slice(Range{1, 3}, Range{0, 4}, Range{1, 4});
+
+    std::vector<int> expected;
+    for (size_t i = 0; i < 2; ++i)
+    {
+        for (size_t j = 0; j < 4; ++j)
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                expected.push_back(view({i, j, k}));
+            }
+        }
+    }
+
+    std::vector<int> forward(view.begin(), view.end());
+    EXPECT_EQ(forward, expected);
+
+    std::vector<int> backward;
+    for (auto it = view.end(); it != view.begin();)
+    {
+        backward.push_back(*--it);
+    }
+    std::reverse(backward.begin(), backward.end());
+    EXPECT_EQ(backward, expected);
+
+    // random access agrees with stepping
+    auto begin = view.begin();
+    for (size_t n = 0; n < expected.size(); ++n)
+    {
+        EXPECT_EQ(begin[static_cast<std::ptrdiff_t>(n)], expected[n]);
+        EXPECT_EQ(*(view.end() - static_cast<std::ptrdiff_t>(expected.size() - n)), expected[n]);
+    }
+}
+
+TEST(IterationTests, Algorithms)
+{
+    Tensor<int, 2> tensor({4, 4});
+    std::iota(tensor.Data(), tensor.Data() + 16, 0);
+    View<int, 1> column = tensor.Slice(Range{0, 4}, 1);
+
+    std::ranges::reverse(column);
+    EXPECT_EQ(tensor({0, 1}), 13);
+    EXPECT_EQ(tensor({3, 1}), 1);
+    EXPECT_EQ(tensor({0, 0}), 0);
+
+    std::ranges::sort(column);
+    EXPECT_TRUE(std::ranges::is_sorted(column));
+
+    View<int, 2> block = tensor.Slice(Range{1, 3}, Range{1, 3});
+    std::ranges::transform(block, block.begin(), [](int x) { return -x; });
+    EXPECT_EQ(tensor({2, 2}), -10);
+    EXPECT_EQ(std::reduce(block.begin(), block.end()), -(5 + 6 + 9 + 10));
+
+    View<int, 2> const& constant = block;
+    EXPECT_EQ(std::ranges::count_if(constant, [](int x) { return x < 0; }), 4);
+}
+
+TEST(IterationTests, Empty)
+{
+    Tensor<int, 2> tensor({0, 3});
+    View<int, 2> view = tensor.Slice(Range{0, 0}, Range{0, 3});
+    EXPECT_EQ(view.begin(), view.end());
+    EXPECT_TRUE(std::ranges::empty(view));
+}
+
+TEST(IterationTests, ForEachElement)
+{
+    Tensor<float, 3> tensor({4, 5, 6}, 1.0f);
+    View<float, 3> view = tensor.Slice(Range{0, 4}, Range{1, 4}, Range{0, 6});
+
+    ForEach(view, [](float& element) { element *= 2.0f; });
+    EXPECT_EQ(tensor({0, 0, 0}), 1.0f);
+    EXPECT_EQ(tensor({3, 3, 5}), 2.0f);
+    EXPECT_EQ(Sum(tensor), 120.0f + 72.0f);
+}
+
+TEST(IterationTests, ForEachSpan)
+{
+    Tensor<int, 2> tensor({6, 8});
+    std::iota(tensor.Data(), tensor.Data() + 48, 0);
+
+    // the whole tensor is one run
+    size_t runs = 0;
+    ForEach(tensor, [&](std::span<int const> run) { runs++; EXPECT_EQ(run.size(), 48u); });
+    EXPECT_EQ(runs, 1u);
+
+    // rows of a block, and single elements of a column
+    std::vector<size_t> lengths;
+    ForEach(tensor.Slice(Range{1, 4}, Range{2, 7}), [&](std::span<int> run) { lengths.push_back(run.size()); });
+    EXPECT_EQ(lengths, (std::vector<size_t>{5, 5, 5}));
+
+    int sum = 0;
+    ForEach(tensor.Slice(Range{0, 6}, 3), [&](std::span<int> run) { EXPECT_EQ(run.size(), 1u); sum += run[0]; });
+    EXPECT_EQ(sum, 3 + 11 + 19 + 27 + 35 + 43);
+}
+
+TEST(IterationTests, ForEachLarge)
+{
+    // large enough to be split across the dispatcher thread pool
+    Tensor<int, 2> tensor({3, 100000}, 1);
+    std::atomic<long> sum = 0;
+    ForEach(tensor.Slice(Range{0, 3}, Range{0, 99999}), [&](std::span<int> run)
+    {
+        sum += std::accumulate(run.begin(), run.end(), 0L);
+        std::ranges::fill(run, 2);
+    });
+    EXPECT_EQ(sum, 299997);
+    EXPECT_EQ(Sum(tensor), 2 * 299997 + 3);
+}
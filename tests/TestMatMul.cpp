@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include "TestData.hpp"
+
+#include <Tensor.hpp>
+
+#include <cmath>
+
+template <typename A, typename B>
+auto NaiveMatMul(A const& a, B const& b)
+{
+    using value_type = TensorTraits<A>::value_type;
+
+    size_t m = a.Shape()[0];
+    size_t k = a.Shape()[1];
+    size_t n = b.Shape()[1];
+
+    Tensor<value_type, 2> c({m, n});
+    for (size_t i = 0; i < m; ++i)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            value_type sum{};
+            for (size_t p = 0; p < k; ++p)
+            {
+                sum += a({i, p}) * b({p, j});
+            }
+            c({i, j}) = sum;
+        }
+    }
+    return c;
+}
+
+template <typename T>
+void ExpectMatricesEqual(Tensor<T, 2> const& actual, Tensor<T, 2> const& expected)
+{
+    ASSERT_EQ(actual.Shape(), expected.Shape());
+    for (size_t i = 0; i < actual.Shape()[0]; ++i)
+    {
+        for (size_t j = 0; j < actual.Shape()[1]; ++j)
+        {
+            // small integer inputs keep every partial sum exact
+            ASSERT_EQ(actual({i, j}), expected({i, j})) << "at (" << i << ", " << j << ")";
+        }
+    }
+}
+
+TEST(MatMulTests, SmallSquare)
+{
+    Tensor<float, 2> a({2, 2});
+    Tensor<float, 2> b({2, 2});
+    std::iota(a.Data(), a.Data() + 4, 1.0f);
+    std::iota(b.Data(), b.Data() + 4, 5.0f);
+
+    auto c = MatMul(a, b);
+
+    EXPECT_EQ(c({0, 0}), 19.0f);
+    EXPECT_EQ(c({0, 1}), 22.0f);
+    EXPECT_EQ(c({1, 0}), 43.0f);
+    EXPECT_EQ(c({1, 1}), 50.0f);
+}
+
+TEST(MatMulTests, OddShapes)
+{
+    // sizes which are not multiples of any microkernel tile or cache block
+    for (auto [m, k, n] : {std::array<size_t, 3>{1, 1, 1}, {7, 5, 3}, {37, 300, 45}, {130, 17, 71}, {5, 513, 33}})
+    {
+        auto a = MakeSequence<float, 2>({m, k}, 1);
+        auto b = MakeSequence<float, 2>({k, n}, 2);
+        ExpectMatricesEqual(MatMul(a, b), NaiveMatMul(a, b));
+
+        auto ad = MakeSequence<double, 2>({m, k}, 3);
+        auto bd = MakeSequence<double, 2>({k, n}, 4);
+        ExpectMatricesEqual(MatMul(ad, bd), NaiveMatMul(ad, bd));
+
+        auto ai = MakeSequence<int, 2>({m, k}, 5);
+        auto bi = MakeSequence<int, 2>({k, n}, 6);
+        ExpectMatricesEqual(MatMul(ai, bi), NaiveMatMul(ai, bi));
+    }
+}
+
+TEST(MatMulTests, StridedViews)
+{
+    auto a = MakeSequence<float, 2>({40, 60}, 1);
+    auto b = MakeSequence<float, 2>({70, 50}, 2);
+
+    // a transposed view of b, and a sliced block of a
+    View<float, 2> bTransposed(b.Data(), {50, 70}, {1, 50}, 0);
+    auto aBlock = a.Slice(Range{3, 33}, Range{10, 60});
+
+    ExpectMatricesEqual(MatMul(aBlock, bTransposed), NaiveMatMul(aBlock, bTransposed));
+}
+
+TEST(MatMulTests, IntoView)
+{
+    auto a = MakeSequence<double, 2>({9, 8}, 1);
+    auto b = MakeSequence<double, 2>({8, 7}, 2);
+
+    Tensor<double, 2> c({12, 12}, -1.0);
+    auto block = c.Slice(Range{2, 11}, Range{3, 10});
+    MatMul(a, b, block);
+
+    auto expected = NaiveMatMul(a, b);
+    for (size_t i = 0; i < 12; ++i)
+    {
+        for (size_t j = 0; j < 12; ++j)
+        {
+            bool inside = i >= 2 && i < 11 && j >= 3 && j < 10;
+            EXPECT_EQ(c({i, j}), inside ? expected({i - 2, j - 3}) : -1.0);
+        }
+    }
+}
+
+TEST(MatMulTests, EveryKernelLevel)
+{
+    auto a = MakeSequence<float, 2>({23, 19}, 1);
+    auto b = MakeSequence<float, 2>({19, 41}, 2);
+    auto expected = NaiveMatMul(a, b);
+
+    for (SimdLevel level : SimdLevels)
+    {
+        if (level > DetectSimdLevel())
+        {
+            continue;
+        }
+
+        GemmKernel<float> kernel = GetGemmKernel<float>(level);
+
+        // one tile from hand-packed panels
+        std::vector<float> packedA(kernel.mr * 19);
+        std::vector<float> packedB(kernel.nr * 19);
+        for (size_t p = 0; p < 19; ++p)
+        {
+            for (size_t i = 0; i < kernel.mr; ++i)
+            {
+                packedA[p * kernel.mr + i] = a({i, p});
+            }
+            for (size_t j = 0; j < kernel.nr; ++j)
+            {
+                packedB[p * kernel.nr + j] = b({p, j});
+            }
+        }
+
+        std::vector<float> tile(kernel.mr * kernel.nr);
+        kernel.compute(19, packedA.data(), packedB.data(), tile.data());
+
+        for (size_t i = 0; i < kernel.mr; ++i)
+        {
+            for (size_t j = 0; j < kernel.nr; ++j)
+            {
+                EXPECT_EQ(tile[i * kernel.nr + j], expected({i, j}));
+            }
+        }
+    }
+}
+
+TEST(MatMulTests, ShapeMismatch)
+{
+    Tensor<float, 2> a({2, 3});
+    Tensor<float, 2> b({4, 2});
+
+    EXPECT_THROW(MatMul(a, b), std::runtime_error);
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <ParallelFor.hpp>
+
+#include <atomic>
+#include <vector>
+
+static constexpr Schedule Schedules[] = {Schedule::Static, Schedule::Dynamic, Schedule::Guided};
+
+TEST(ParallelForTests, OneDimensional)
+{
+    for (Schedule schedule : Schedules)
+    {
+        std::vector<std::atomic<int>> visits(1000);
+        ParallelFor(3, 1000, 64, [&](IndexRange<1> const& range)
+        {
+            EXPECT_LE(range.Extent(0), 64u);
+            for (size_t i = range.begin[0]; i < range.end[0]; ++i)
+            {
+                visits[i]++;
+            }
+        }, schedule);
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            ASSERT_EQ(visits[i], i < 3 ? 0 : 1) << "at " << i;
+        }
+    }
+}
+
+TEST(ParallelForTests, TwoDimensionalTiles)
+{
+    size_t height = 100;
+    size_t width = 70;
+    for (Schedule schedule : Schedules)
+    {
+        std::vector<std::atomic<int>> visits(height * width);
+        std::atomic<size_t> tiles = 0;
+        ParallelFor(IndexRange<2>{{0, 0}, {height, width}}, {16, 32}, [&](IndexRange<2> const& range)
+        {
+            tiles++;
+            EXPECT_EQ(range.begin[0] % 16, 0u);
+            EXPECT_EQ(range.begin[1] % 32, 0u);
+            for (size_t y = range.begin[0]; y < range.end[0]; ++y)
+            {
+                for (size_t x = range.begin[1]; x < range.end[1]; ++x)
+                {
+                    visits[y * width + x]++;
+                }
+            }
+        }, schedule);
+
+        EXPECT_EQ(tiles, 7u * 3u);
+        for (auto const& count : visits)
+        {
+            ASSERT_EQ(count, 1);
+        }
+    }
+}
+
+TEST(ParallelForTests, ThreeDimensional)
+{
+    std::atomic<size_t> total = 0;
+    ParallelFor(IndexRange<3>{{1, 2, 3}, {5, 7, 11}}, {2, 2, 2}, [&](IndexRange<3> const& range)
+    {
+        total += range.Size();
+    }, Schedule::Guided);
+    EXPECT_EQ(total, 4u * 5u * 8u);
+}
+
+TEST(ParallelForTests, EmptyRange)
+{
+    bool called = false;
+    ParallelFor(IndexRange<2>{{4, 0}, {4, 10}}, {1, 1}, [&](IndexRange<2> const&) { called = true; });
+    ParallelFor(10, 2, 1, [&](IndexRange<1> const&) { called = true; });
+    EXPECT_FALSE(called);
+}
+
+TEST(ParallelForTests, Nested)
+{
+    std::atomic<size_t> total = 0;
+    ParallelFor(0, 8, 1, [&](IndexRange<1> const&)
+    {
+        ParallelFor(0, 100, 10, [&](IndexRange<1> const& inner) { total += inner.Size(); }, Schedule::Dynamic);
+    });
+    EXPECT_EQ(total, 800u);
+}
@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+
+#include <Tensor.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+template <typename T>
+auto MakeBytes(size_t height, size_t width, uint32_t seed) -> Tensor<T, 2>
+{
+    Tensor<T, 2> matrix({height, width});
+    for (size_t i = 0; i < height * width; ++i)
+    {
+        seed = seed * 1664525 + 1013904223;
+        matrix.Data()[i] = static_cast<T>(seed >> 24);
+    }
+    return matrix;
+}
+
+template <typename TA, typename B>
+auto NaiveGemmInt8(Tensor<TA, 2> const& a, B const& b) -> Tensor<int32_t, 2>
+{
+    size_t m = a.Shape()[0];
+    size_t k = a.Shape()[1];
+    size_t n = b.Shape()[1];
+
+    Tensor<int32_t, 2> c({m, n});
+    for (size_t i = 0; i < m; ++i)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            int32_t sum = 0;
+            for (size_t p = 0; p < k; ++p)
+            {
+                sum += static_cast<int32_t>(a({i, p})) * static_cast<int32_t>(b({p, j}));
+            }
+            c({i, j}) = sum;
+        }
+    }
+    return c;
+}
+
+template <typename TA>
+void ExpectGemmInt8KernelsExact()
+{
+    // odd sizes, k not a multiple of the group and longer than one cache block, and a transposed B
+    for (auto [m, n, k] : {std::array<size_t, 3>{1, 1, 1}, {7, 13, 5}, {13, 37, 300}, {50, 70, 64}})
+    {
+        Tensor<TA, 2> a = MakeBytes<TA>(m, k, 1);
+        Tensor<int8_t, 2> bTransposed = MakeBytes<int8_t>(n, k, 2);
+        View<int8_t, 2> b = bTransposed.Transpose();
+        Tensor<int32_t, 2> expected = NaiveGemmInt8(a, b);
+
+        for (auto [level, vnni] : {std::pair{SimdLevel::Scalar, false}, {SimdLevel::AVX2, false}, {SimdLevel::AVX512, false}, {SimdLevel::AVX512, true}})
+        {
+            if (level > DetectSimdLevel() || (vnni && !DetectAvx512Vnni()))
+            {
+                continue;
+            }
+
+            Tensor<int32_t, 2> c({m, n}, -1);
+            auto bStrides = b.Strides();
+            GemmInt8<TA>(m, n, k, a.Data(), k, 1, Origin(b), bStrides[0], bStrides[1], c.Data(), n, 1, GetGemmInt8Kernel<TA>(level, vnni));
+            for (size_t i = 0; i < m * n; ++i)
+            {
+                ASSERT_EQ(c.Data()[i], expected.Data()[i]) << "level " << static_cast<int>(level) << ", vnni " << vnni << ", " << m << "x" << n << "x" << k << ", index " << i;
+            }
+        }
+    }
+}
+
+TEST(QuantizeTests, GemmInt8SignedKernels)
+{
+    ExpectGemmInt8KernelsExact<int8_t>();
+}
+
+TEST(QuantizeTests, GemmInt8UnsignedKernels)
+{
+    ExpectGemmInt8KernelsExact<uint8_t>();
+}
+
+TEST(QuantizeTests, MatMulInt8)
+{
+    Tensor<uint8_t, 2> a = MakeBytes<uint8_t>(65, 130, 3);
+    Tensor<int8_t, 2> b = MakeBytes<int8_t>(130, 90, 4);
+
+    // the extremes of both types, whose products only just fit in 16 bits
+    a({0, 0}) = 255;
+    b({0, 0}) = -128;
+    a({0, 1}) = 255;
+    b({1, 0}) = -128;
+
+    auto c = MatMul(a, b);
+    static_assert(std::is_same_v<decltype(c), Tensor<int32_t, 2>>);
+    Tensor<int32_t, 2> expected = NaiveGemmInt8(a, b);
+    for (size_t i = 0; i < 65 * 90; ++i)
+    {
+        ASSERT_EQ(c.Data()[i], expected.Data()[i]) << "index " << i;
+    }
+}
+
+template <typename T>
+void ExpectQuantizeKernelsMatchScalar()
+{
+    std::vector<float> values;
+    for (size_t i = 0; i < 1003; ++i)
+    {
+        values.push_back(static_cast<float>(i % 397) * 0.37f - 70.0f);
+    }
+
+    // exact ties, values past either end, infinities and NaN
+    values.insert(values.end(), {0.5f, 1.5f, -2.5f, 1e9f, -1e9f, std::numeric_limits<float>::infinity(),
+                                 -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN()});
+
+    for (SimdLevel level : {SimdLevel::AVX2, SimdLevel::AVX512})
+    {
+        if (level > DetectSimdLevel())
+        {
+            continue;
+        }
+
+        for (int32_t zeroPoint : {0, 3, std::is_signed_v<T> ? -128 : 255})
+        {
+            for (size_t count : {size_t{5}, size_t{33}, values.size()})
+            {
+                std::vector<T> expected(count);
+                std::vector<T> actual(count);
+                SimdQuantize<T, SimdLevel::Scalar>::Quantize(values.data(), expected.data(), count, 2.0f, zeroPoint);
+                GetQuantizeKernel<T>(level)(values.data(), actual.data(), count, 2.0f, zeroPoint);
+                ASSERT_EQ(actual, expected) << "level " << static_cast<int>(level) << ", zero point " << zeroPoint;
+
+                std::vector<float> expectedFloats(count);
+                std::vector<float> actualFloats(count);
+                SimdQuantize<T, SimdLevel::Scalar>::Dequantize(expected.data(), expectedFloats.data(), count, 0.25f, zeroPoint);
+                GetDequantizeKernel<T>(level)(expected.data(), actualFloats.data(), count, 0.25f, zeroPoint);
+                ASSERT_EQ(actualFloats, expectedFloats) << "level " << static_cast<int>(level) << ", zero point " << zeroPoint;
+            }
+        }
+    }
+
+    T quantized[4];
+    float special[4] = {0.5f, 1.5f, 1e9f, std::numeric_limits<float>::quiet_NaN()};
+    SimdQuantize<T, SimdLevel::Scalar>::Quantize(special, quantized, 4, 1.0f, 0);
+    EXPECT_EQ(quantized[0], 0);
+    EXPECT_EQ(quantized[1], 2);
+    EXPECT_EQ(quantized[2], std::numeric_limits<T>::max());
+    EXPECT_EQ(quantized[3], std::numeric_limits<T>::lowest());
+}
+
+TEST(QuantizeTests, SignedKernels)
+{
+    ExpectQuantizeKernelsMatchScalar<int8_t>();
+}
+
+TEST(QuantizeTests, UnsignedKernels)
+{
+    ExpectQuantizeKernelsMatchScalar<uint8_t>();
+}
+
+TEST(QuantizeTests, RoundTrip)
+{
+    Tensor<float, 3> tensor({4, 130, 130});
+    for (size_t i = 0; i < 4 * 130 * 130; ++i)
+    {
+        tensor.Data()[i] = std::sin(static_cast<float>(i)) * static_cast<float>(i % 4 + 1);
+    }
+
+    auto perTensor = Quantize<uint8_t>(tensor);
+    EXPECT_EQ(perTensor.Axis(), PerTensor);
+    Tensor<float, 3> restored = Dequantize(perTensor);
+    for (size_t i = 0; i < 4 * 130 * 130; ++i)
+    {
+        ASSERT_LE(std::abs(restored.Data()[i] - tensor.Data()[i]), perTensor.Scale() * 0.5001f) << "index " << i;
+    }
+
+    // per-axis along the innermost axis, where each run is a single element, and of a strided view
+    auto perColumn = QuantizePerAxis<int8_t>(tensor, 2, QuantizationScheme::Symmetric);
+    EXPECT_EQ(perColumn.Scales().size(), 130u);
+    EXPECT_EQ(perColumn.ZeroPoint(5), 0);
+    restored = Dequantize(perColumn);
+    for (size_t i = 0; i < 4 * 130 * 130; ++i)
+    {
+        ASSERT_LE(std::abs(restored.Data()[i] - tensor.Data()[i]), perColumn.Scale(i % 130) * 0.5001f) << "index " << i;
+    }
+
+    View<float, 3> strided = tensor.Slice(Range{0, 4}, Range{10, 130}, Range{1, 130});
+    auto quantizedView = Quantize<int8_t>(strided, 0.0625f, -3);
+    EXPECT_EQ(quantizedView.Values()({1, 2, 3}), static_cast<int8_t>(std::nearbyint(strided({1, 2, 3}) * 16.0f) - 3.0f));
+}
+
+TEST(QuantizeTests, Parameters)
+{
+    auto [scale, zeroPoint] = ChooseQuantization<uint8_t>(-1.0f, 3.0f);
+    EXPECT_FLOAT_EQ(scale, 4.0f / 255.0f);
+    EXPECT_EQ(zeroPoint, 64);
+
+    // the range always includes zero, which is then exact
+    auto positive = ChooseQuantization<int8_t>(2.0f, 4.0f);
+    EXPECT_EQ(positive.zeroPoint, -128);
+    auto symmetric = ChooseQuantization<uint8_t>(-1.0f, 0.5f, QuantizationScheme::Symmetric);
+    EXPECT_EQ(symmetric.zeroPoint, 128);
+    EXPECT_FLOAT_EQ(symmetric.scale, 1.0f / 127.0f);
+
+    Tensor<int8_t, 2> values({2, 3});
+    EXPECT_THROW((QuantizedTensor<int8_t, 2>(values, 0.0f, 0)), std::runtime_error);
+    EXPECT_THROW((QuantizedTensor<int8_t, 2>(values, 1.0f, 200)), std::runtime_error);
+    EXPECT_THROW((QuantizedTensor<int8_t, 2>(values, {1.0f, 1.0f}, {0, 0}, 1)), std::runtime_error);
+    EXPECT_THROW((QuantizedTensor<int8_t, 2>(values, {1.0f, 1.0f}, {0, 0}, 2)), std::runtime_error);
+    EXPECT_THROW((ChooseQuantization<int8_t>(0.0f, std::numeric_limits<float>::infinity())), std::runtime_error);
+}
+
+TEST(QuantizeTests, QuantizedMatMul)
+{
+    size_t m = 40;
+    size_t k = 300;
+    size_t n = 50;
+    Tensor<float, 2> a({m, k});
+    Tensor<float, 2> b({k, n});
+    for (size_t i = 0; i < m * k; ++i)
+    {
+        a.Data()[i] = std::cos(static_cast<float>(i)) + 0.5f;
+    }
+    for (size_t i = 0; i < k * n; ++i)
+    {
+        b.Data()[i] = std::sin(static_cast<float>(i) * 0.7f) * static_cast<float>(i % n + 1) * 0.1f;
+    }
+
+    auto qa = QuantizePerAxis<uint8_t>(a, 0);
+    auto qb = QuantizePerAxis<int8_t>(b, 1);
+    Tensor<float, 2> c = MatMul(qa, qb);
+
+    // the zero point corrections are exact, so the result matches multiplying the dequantized matrices
+    Tensor<float, 2> expected = MatMul(Dequantize(qa), Dequantize(qb));
+    Tensor<float, 2> reference = MatMul(a, b);
+    for (size_t i = 0; i < m; ++i)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            ASSERT_NEAR(c({i, j}), expected({i, j}), 1e-3f * (1.0f + std::abs(expected({i, j})))) << "at (" << i << ", " << j << ")";
+            ASSERT_NEAR(c({i, j}), reference({i, j}), 0.02f * std::sqrt(static_cast<float>(k)) * static_cast<float>(j + 1) * 0.1f) << "at (" << i << ", " << j << ")";
+        }
+    }
+
+    EXPECT_THROW(MatMul(QuantizePerAxis<uint8_t>(a, 1), qb), std::runtime_error);
+}
@@ -0,0 +1,261 @@
+#include <gtest/gtest.h>
+
+#include <ParallelFor.hpp>
+#include <Tensor.hpp>
+
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+template <typename T>
+auto MakeCube(size_t d0, size_t d1, size_t d2) -> Tensor<T, 3>
+{
+    Tensor<T, 3> cube({d0, d1, d2});
+    for (size_t i = 0; i < d0 * d1 * d2; ++i)
+    {
+        cube.Data()[i] = static_cast<T>((i * 37) % 101) - static_cast<T>(50);
+    }
+    return cube;
+}
+
+TEST(ReduceTests, SumEveryAxis)
+{
+    auto cube = MakeCube<int>(3, 4, 5);
+
+    auto sum0 = Sum(cube, 0);
+    auto sum1 = Sum(cube, 1);
+    auto sum2 = Sum(cube, 2);
+    EXPECT_EQ(sum0.Shape(), (std::array<size_t, 2>{4, 5}));
+    EXPECT_EQ(sum1.Shape(), (std::array<size_t, 2>{3, 5}));
+    EXPECT_EQ(sum2.Shape(), (std::array<size_t, 2>{3, 4}));
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        for (size_t j = 0; j < 4; ++j)
+        {
+            for (size_t k = 0; k < 5; ++k)
+            {
+                int expected0 = 0, expected1 = 0, expected2 = 0;
+                for (size_t r = 0; r < 3; ++r)
+                {
+                    expected0 += cube({r, j, k});
+                }
+                for (size_t r = 0; r < 4; ++r)
+                {
+                    expected1 += cube({i, r, k});
+                }
+                for (size_t r = 0; r < 5; ++r)
+                {
+                    expected2 += cube({i, j, r});
+                }
+                EXPECT_EQ(sum0({j, k}), expected0);
+                EXPECT_EQ(sum1({i, k}), expected1);
+                EXPECT_EQ(sum2({i, j}), expected2);
+            }
+        }
+    }
+}
+
+TEST(ReduceTests, AllAxes)
+{
+    Tensor<int, 2> a({3, 4});
+    std::iota(a.Data(), a.Data() + 12, -5);
+    a({1, 2}) = 100;
+    a({2, 3}) = 100;
+
+    EXPECT_EQ(Sum(a), std::accumulate(a.Data(), a.Data() + 12, 0));
+    EXPECT_EQ(Min(a), -5);
+    EXPECT_EQ(Max(a), 100);
+    EXPECT_EQ(ArgMax(a), 6u);
+    EXPECT_EQ(Mean(Tensor<float, 1>({4}, 2.5f)), 2.5f);
+}
+
+TEST(ReduceTests, SmallIntegers)
+{
+    // the sums wrap around in 8 bits, but not in 64
+    Tensor<uint8_t, 1> bytes({300}, uint8_t{200});
+    static_assert(std::is_same_v<decltype(Sum(bytes)), uint64_t>);
+    EXPECT_EQ(Sum(bytes), 60000u);
+    EXPECT_EQ(Sum(bytes, Summation::Naive), 60000u);
+    EXPECT_EQ(Mean(bytes), 200);
+
+    Tensor<int8_t, 2> signedBytes({3, 1000}, int8_t{-100});
+    signedBytes({2, 0}) = 100;
+    static_assert(std::is_same_v<decltype(Sum(signedBytes, 1)), Tensor<int64_t, 1>>);
+    auto rows = Sum(signedBytes, 1, Summation::Kahan);
+    EXPECT_EQ(rows({0}), -100000);
+    EXPECT_EQ(rows({2}), -99800);
+    EXPECT_EQ(Mean(signedBytes, 1)({0}), -100);
+    EXPECT_EQ(Mean(signedBytes, 1)({2}), -99);
+    EXPECT_EQ(Mean(signedBytes), -99);
+}
+
+TEST(ReduceTests, OrderOne)
+{
+    Tensor<float, 1> a({5});
+    std::iota(a.Data(), a.Data() + 5, 1.0f);
+
+    Tensor<float, 0> sum = Sum(a, 0);
+    EXPECT_EQ(sum.Data()[0], 15.0f);
+    EXPECT_EQ(ArgMax(a, 0).Data()[0], 4u);
+}
+
+TEST(ReduceTests, StridedView)
+{
+    auto cube = MakeCube<int>(6, 7, 8);
+    View<int, 3> view = cube.Slice(Range{1, 5}, Range{2, 7}, Range{3, 6});
+
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        auto min = Min(view, axis);
+        auto max = Max(view, axis);
+        auto argmax = ArgMax(view, axis);
+
+        auto shape = view.Shape();
+        std::array<size_t, 3> index{};
+        for (index[0] = 0; index[0] < shape[0]; ++index[0])
+        {
+            for (index[1] = 0; index[1] < shape[1]; ++index[1])
+            {
+                for (index[2] = 0; index[2] < shape[2]; ++index[2])
+                {
+                    std::array<size_t, 2> reduced{};
+                    for (size_t d = 0, r = 0; d < 3; ++d)
+                    {
+                        if (d != axis)
+                        {
+                            reduced[r++] = index[d];
+                        }
+                    }
+                    EXPECT_LE(min(reduced), view(index));
+                    EXPECT_GE(max(reduced), view(index));
+                    if (view(index) == max(reduced))
+                    {
+                        EXPECT_LE(argmax(reduced), index[axis]);
+                    }
+                }
+            }
+        }
+    }
+
+    EXPECT_EQ(Sum(view), Sum(Tensor<int, 3>(view)));
+}
+
+TEST(ReduceTests, ArgMaxPicksFirst)
+{
+    Tensor<float, 2> a({2, 4}, 1.0f);
+    a({0, 1}) = 3.0f;
+    a({0, 3}) = 3.0f;
+    a({1, 2}) = 3.0f;
+    a({1, 0}) = 3.0f;
+
+    auto argmax = ArgMax(a, 1);
+    EXPECT_EQ(argmax({0}), 1u);
+    EXPECT_EQ(argmax({1}), 0u);
+    EXPECT_EQ(ArgMax(a), 1u);
+}
+
+TEST(ReduceTests, Expression)
+{
+    Tensor<int, 2> a({2, 3}, 2);
+    Tensor<int, 2> b({2, 3}, 5);
+
+    EXPECT_EQ(Sum(a * b), 60);
+    auto rows = Sum(a * b, 1);
+    EXPECT_EQ(rows({0}), 30);
+    EXPECT_EQ(rows({1}), 30);
+}
+
+TEST(ReduceTests, LargeAxes)
+{
+    // long reduced axes split into chunks, and many short ones, along and across memory order
+    for (auto [height, width] : {std::array<size_t, 2>{2, 300000}, {300000, 3}, {1000, 1000}})
+    {
+        Tensor<float, 2> a({height, width});
+        for (size_t i = 0; i < height * width; ++i)
+        {
+            a.Data()[i] = static_cast<float>(i % 7);
+        }
+
+        auto columns = Sum(a, 0);
+        auto rows = Sum(a, 1);
+        auto argmax = ArgMax(a, 0);
+        for (size_t x = 0; x < width; ++x)
+        {
+            double expected = 0.0;
+            size_t expectedIndex = 0;
+            for (size_t y = 0; y < height; ++y)
+            {
+                expected += a({y, x});
+                if (a({y, x}) > a({expectedIndex, x}))
+                {
+                    expectedIndex = y;
+                }
+            }
+            ASSERT_EQ(columns({x}), static_cast<float>(expected));
+            ASSERT_EQ(argmax({x}), expectedIndex);
+        }
+        for (size_t y = 0; y < height; ++y)
+        {
+            double expected = 0.0;
+            for (size_t x = 0; x < width; ++x)
+            {
+                expected += a({y, x});
+            }
+            ASSERT_EQ(rows({y}), static_cast<float>(expected));
+        }
+        EXPECT_EQ(Max(a), 6.0f);
+    }
+}
+
+TEST(ReduceTests, SummationAccuracy)
+{
+    size_t size = size_t{1} << 22;
+    Tensor<float, 1> a({size}, 0.1f);
+    double exact = static_cast<double>(0.1f) * static_cast<double>(size);
+
+    double naive = std::abs(Sum(a, Summation::Naive) - exact) / exact;
+    double pairwise = std::abs(Sum(a, Summation::Pairwise) - exact) / exact;
+    double kahan = std::abs(Sum(a, Summation::Kahan) - exact) / exact;
+
+    EXPECT_LT(pairwise, 1e-6);
+    EXPECT_LT(kahan, 1e-6);
+    EXPECT_LE(pairwise, naive);
+
+    // the same modes along an axis which is not innermost
+    Tensor<float, 2> b({size / 4, 4}, 0.1f);
+    auto columns = Sum(b, 0, Summation::Kahan);
+    EXPECT_LT(std::abs(columns({0}) - exact / 4) / (exact / 4), 1e-6);
+    EXPECT_NEAR(Mean(b, 0)({3}), 0.1f, 1e-6);
+}
+
+TEST(ReduceTests, EmptyAxis)
+{
+    Tensor<float, 2> a({0, 3});
+
+    auto sum = Sum(a, 0);
+    EXPECT_EQ(sum({2}), 0.0f);
+    EXPECT_EQ(Sum(a, 1).Shape(), (std::array<size_t, 1>{0}));
+    EXPECT_THROW(Max(a, 0), std::runtime_error);
+    EXPECT_THROW(Mean(a), std::runtime_error);
+    EXPECT_THROW(Sum(a, 2), std::runtime_error);
+}
+
+TEST(ReduceTests, InsideParallelLoop)
+{
+    // every batch is large enough for its reduction to be split across the pool itself
+    auto batches = MakeCube<double>(4, 256, 512);
+    std::vector<double> sums(4);
+
+    ParallelFor(0, 4, 1, [&](IndexRange<1> const& batch)
+    {
+        size_t b = batch.begin[0];
+        sums[b] = Sum(batches.Slice(b, Range{0, 256}, Range{0, 512}));
+    });
+
+    for (size_t b = 0; b < 4; ++b)
+    {
+        EXPECT_EQ(sums[b], Sum(Tensor<double, 2>(batches.Slice(b, Range{0, 256}, Range{0, 512}))));
+    }
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <Tensor.hpp>
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+template <typename T, typename Operation>
+void ExpectKernelsMatchScalar(T scalar)
+{
+    // lengths which are not a multiple of any register width, so the tails are exercised as well
+    for (size_t count : {0, 1, 3, 17, 63, 130, 1027})
+    {
+        std::vector<T> left(count);
+        std::vector<T> right(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            left[i] = static_cast<T>(i % 97 + 1);
+            right[i] = static_cast<T>(i % 13 + 1);
+        }
+
+        for (SimdLevel level : SimdLevels)
+        {
+            if (level > DetectSimdLevel())
+            {
+                continue;
+            }
+
+            auto [kernel, scalarKernel] = GetBinaryKernels<T, Operation>(level);
+
+            std::vector<T> output(count);
+            kernel(left.data(), right.data(), output.data(), count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                ASSERT_EQ(output[i], Operation{}(left[i], right[i])) << "level " << static_cast<int>(level) << ", index " << i;
+            }
+
+            scalarKernel(left.data(), scalar, output.data(), count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                ASSERT_EQ(output[i], Operation{}(left[i], scalar)) << "level " << static_cast<int>(level) << ", index " << i;
+            }
+        }
+    }
+}
+
+TEST(SimdTests, FloatKernels)
+{
+    ExpectKernelsMatchScalar<float, AddOperation>(1.5f);
+    ExpectKernelsMatchScalar<float, SubtractOperation>(1.5f);
+    ExpectKernelsMatchScalar<float, MultiplyOperation>(1.5f);
+    ExpectKernelsMatchScalar<float, DivideOperation>(1.5f);
+}
+
+TEST(SimdTests, DoubleKernels)
+{
+    ExpectKernelsMatchScalar<double, AddOperation>(2.5);
+    ExpectKernelsMatchScalar<double, SubtractOperation>(2.5);
+    ExpectKernelsMatchScalar<double, MultiplyOperation>(2.5);
+    ExpectKernelsMatchScalar<double, DivideOperation>(2.5);
+}
+
+TEST(SimdTests, Int32Kernels)
+{
+    ExpectKernelsMatchScalar<int32_t, AddOperation>(-7);
+    ExpectKernelsMatchScalar<int32_t, SubtractOperation>(-7);
+    ExpectKernelsMatchScalar<int32_t, MultiplyOperation>(-7);
+    ExpectKernelsMatchScalar<int32_t, DivideOperation>(-7);
+}
+
+TEST(SimdTests, Uint8Kernels)
+{
+    // wraps around like the scalar operations
+    ExpectKernelsMatchScalar<uint8_t, AddOperation>(250);
+    ExpectKernelsMatchScalar<uint8_t, SubtractOperation>(250);
+    ExpectKernelsMatchScalar<uint8_t, MultiplyOperation>(3);
+}
+
+TEST(SimdTests, ActiveLevelIsDetected)
+{
+    EXPECT_EQ(ActiveSimdLevel(), DetectSimdLevel());
+}
+
+// whether Evaluate hands an expression of float elements to a SIMD kernel
+template <typename Expression>
+concept HasEvaluateKernel = requires(Expression const& expression, float* output)
+{
+    EvaluateKernel(expression, output, size_t{0}, size_t{0});
+};
+
+TEST(SimdTests, TensorExpressionsUseKernels)
+{
+    Tensor<float, 2> a({31, 33});
+    Tensor<float, 2> b({31, 33});
+    std::iota(a.Data(), a.Data() + 31 * 33, 0.0f);
+    std::iota(b.Data(), b.Data() + 31 * 33, 1.0f);
+
+    // a single operation between leaves, or a leaf and a scalar, is evaluated by a kernel rather than the generic loop
+    using SumExpression = decltype(a + b);
+    using ScaledExpression = decltype(a * 0.5f);
+    using NestedExpression = decltype(a + b * 0.5f);
+    static_assert(HasEvaluateKernel<SumExpression>);
+    static_assert(HasEvaluateKernel<ScaledExpression>);
+    static_assert(!HasEvaluateKernel<NestedExpression>);
+
+    // the kernel for the active level, or the best below it
+    EXPECT_EQ((SelectBinaryKernel<float, AddOperation>()), (GetBinaryKernels<float, AddOperation>(ActiveSimdLevel()).first));
+    EXPECT_EQ((SelectBinaryScalarKernel<float, MultiplyOperation>()), (GetBinaryKernels<float, MultiplyOperation>(ActiveSimdLevel()).second));
+
+    Tensor<float, 2> sum = a + b;
+    Tensor<float, 2> scaled = a * 0.5f;
+
+    for (size_t i = 0; i < 31 * 33; ++i)
+    {
+        EXPECT_EQ(sum.Data()[i], a.Data()[i] + b.Data()[i]);
+        EXPECT_EQ(scaled.Data()[i], a.Data()[i] * 0.5f);
+    }
+}
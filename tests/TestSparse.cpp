@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <Tensor.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// a matrix with about one nonzero in `sparsity`, with a few dense rows and some empty ones, like a graph with hubs
+auto MakeSparseDense(size_t height, size_t width, size_t sparsity) -> Tensor<double, 2>
+{
+    Tensor<double, 2> dense({height, width});
+    uint32_t state = 7;
+    for (size_t i = 0; i < height; ++i)
+    {
+        for (size_t j = 0; j < width; ++j)
+        {
+            state = state * 1664525 + 1013904223;
+            if (i % 50 == 3 || state % sparsity == 0)
+            {
+                dense({i, j}) = static_cast<double>(state >> 24) - 128.0;
+            }
+        }
+    }
+    return dense;
+}
+
+auto MakeDense(size_t height, size_t width) -> Tensor<double, 2>
+{
+    Tensor<double, 2> dense({height, width});
+    for (size_t i = 0; i < height * width; ++i)
+    {
+        dense.Data()[i] = static_cast<double>(i % 13) - 6.0;
+    }
+    return dense;
+}
+
+void ExpectMatricesEqual(Tensor<double, 2> const& actual, Tensor<double, 2> const& expected)
+{
+    ASSERT_EQ(actual.Shape(), expected.Shape());
+    for (size_t i = 0; i < actual.Shape()[0]; ++i)
+    {
+        for (size_t j = 0; j < actual.Shape()[1]; ++j)
+        {
+            // small integer values keep every sum exact
+            ASSERT_EQ(actual({i, j}), expected({i, j})) << "at (" << i << ", " << j << ")";
+        }
+    }
+}
+
+TEST(SparseTests, Conversions)
+{
+    Tensor<double, 2> dense = MakeSparseDense(37, 23, 9);
+
+    CooMatrix<double> coo(dense);
+    CsrMatrix<double> csr(dense);
+    CscMatrix<double> csc(dense);
+    EXPECT_EQ(coo.NonZeros(), csr.NonZeros());
+    EXPECT_EQ(csr.NonZeros(), csc.NonZeros());
+    EXPECT_EQ(csr.Offsets().size(), 38u);
+    EXPECT_EQ(csc.Offsets().size(), 24u);
+
+    ExpectMatricesEqual(coo.ToDense(), dense);
+    ExpectMatricesEqual(csr.ToDense(), dense);
+    ExpectMatricesEqual(csc.ToDense(), dense);
+    ExpectMatricesEqual(CsrMatrix<double>(coo).ToDense(), dense);
+    ExpectMatricesEqual(CscMatrix<double>(coo).ToDense(), dense);
+    ExpectMatricesEqual(CsrMatrix<double>(csc).ToDense(), dense);
+    ExpectMatricesEqual(CscMatrix<double>(csr).ToDense(), dense);
+
+    // the same arrays, read the other way round
+    ExpectMatricesEqual(csr.Transpose().ToDense(), Tensor<double, 2>(dense.Transpose()));
+    EXPECT_EQ(CsrMatrix<double>(csc).Indices(), csr.Indices());
+
+    // from a strided view
+    View<double, 2> block = dense.Slice(Range{5, 30}, Range{2, 20});
+    ExpectMatricesEqual(CsrMatrix<double>(block).ToDense(), Tensor<double, 2>(block));
+}
+
+TEST(SparseTests, CooDuplicates)
+{
+    CooMatrix<float> coo({3, 4});
+    coo.Insert(2, 1, 1.5f);
+    coo.Insert(0, 3, 2.0f);
+    coo.Insert(2, 1, 0.5f);
+    coo.Insert(2, 0, 4.0f);
+    EXPECT_THROW(coo.Insert(3, 0, 1.0f), std::runtime_error);
+
+    CsrMatrix<float> csr(coo);
+    EXPECT_EQ(csr.NonZeros(), 3u);
+    EXPECT_EQ(csr.Offsets(), (std::vector<size_t>{0, 1, 1, 3}));
+    EXPECT_EQ(csr.Indices(), (std::vector<SparseIndex>{3, 0, 1}));
+    EXPECT_EQ(csr.Values(), (std::vector<float>{2.0f, 4.0f, 2.0f}));
+    EXPECT_EQ(coo.ToDense()({2, 1}), 2.0f);
+}
+
+TEST(SparseTests, MatrixVector)
+{
+    Tensor<double, 2> dense = MakeSparseDense(300, 200, 20);
+    CsrMatrix<double> csr(dense);
+    Tensor<double, 2> x = MakeDense(200, 2);
+
+    // a dense vector, and a strided column of a matrix
+    View<double, 1> column = x.Slice(Range{0, 200}, 1);
+    Tensor<double, 1> expected = MatMul(dense, Tensor<double, 2>(x)).Slice(Range{0, 300}, 1);
+    Tensor<double, 1> y = MatMul(csr, Tensor<double, 1>(column));
+    Tensor<double, 1> z = MatMul(csr, column);
+    for (size_t i = 0; i < 300; ++i)
+    {
+        ASSERT_EQ(y({i}), expected({i})) << "at " << i;
+        ASSERT_EQ(z({i}), expected({i})) << "at " << i;
+    }
+}
+
+TEST(SparseTests, MatrixMatrix)
+{
+    // enough work to be split into nonzero-balanced parts
+    Tensor<double, 2> dense = MakeSparseDense(400, 300, 30);
+    Tensor<double, 2> b = MakeDense(300, 70);
+    Tensor<double, 2> expected = MatMul(dense, b);
+
+    CsrMatrix<double> csr(dense);
+    ExpectMatricesEqual(MatMul(csr, b), expected);
+
+    // strided operands and destination
+    Tensor<double, 2> bTransposed(b.Transpose());
+    Tensor<double, 2> c({70, 400});
+    View<double, 2> cTransposed = c.Transpose();
+    MatMul(csr, bTransposed.Transpose(), cTransposed);
+    ExpectMatricesEqual(Tensor<double, 2>(cTransposed), expected);
+
+    // dense times CSC, here (b^T dense^T)^T
+    CscMatrix<double> csc(Tensor<double, 2>(dense.Transpose()));
+    ExpectMatricesEqual(Tensor<double, 2>(MatMul(bTransposed, csc).Transpose()), expected);
+
+    EXPECT_THROW(MatMul(csr, MakeDense(299, 4)), std::runtime_error);
+}
+
+TEST(SparseTests, MatrixMatrixBFloat16)
+{
+    // integers small enough for bfloat16, whose sums along the dense rows are exact in float but not in bfloat16
+    Tensor<double, 2> dense = MakeSparseDense(300, 200, 20);
+    Tensor<double, 2> b = MakeDense(200, 8);
+    Tensor<BFloat16, 2> denseHalf(dense.Shape());
+    Tensor<BFloat16, 2> bHalf(b.Shape());
+    std::transform(dense.Data(), dense.Data() + 300 * 200, denseHalf.Data(), [](double x) { return BFloat16(static_cast<float>(x)); });
+    std::transform(b.Data(), b.Data() + 200 * 8, bHalf.Data(), [](double x) { return BFloat16(static_cast<float>(x)); });
+
+    // the matrix product accumulates in float like the matrix-vector product, so both round each sum once
+    CsrMatrix<BFloat16> csr(denseHalf);
+    Tensor<BFloat16, 2> product = MatMul(csr, bHalf);
+    for (size_t j = 0; j < 8; ++j)
+    {
+        Tensor<BFloat16, 1> column = MatMul(csr, bHalf.Slice(Range{0, 200}, j));
+        for (size_t i = 0; i < 300; ++i)
+        {
+            ASSERT_EQ(product({i, j}).Bits(), column({i}).Bits()) << "at (" << i << ", " << j << ")";
+        }
+    }
+}
+
+TEST(SparseTests, Partition)
+{
+    // one row holds half of the nonzeros
+    std::vector<size_t> offsets = {0, 1, 2, 102, 103, 104, 105, 106, 200};
+    auto bounds = PartitionNonZeros(offsets, 4);
+    EXPECT_EQ(bounds.front(), 0u);
+    EXPECT_EQ(bounds.back(), 8u);
+    for (size_t part = 0; part < 4; ++part)
+    {
+        EXPECT_LE(bounds[part], bounds[part + 1]);
+    }
+
+    // the dense row ends the first part, and the rows after it make up the rest
+    EXPECT_EQ(bounds[1], 3u);
+
+    // an empty matrix gives empty parts
+    EXPECT_EQ(PartitionNonZeros(std::vector<size_t>{0}, 3), (std::vector<size_t>{0, 0, 0, 0}));
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <Tensor.hpp>
+
+#include <numeric>
+
+using Matrix4 = StaticTensor<float, Extents<4, 4>>;
+
+TEST(StaticTensorTests, CompileTimeLayout)
+{
+    static_assert(Extents<2, 3, 4>::size == 24);
+    static_assert(Extents<2, 3, 4>::strides == std::array<size_t, 3>{12, 4, 1});
+    static_assert(Matrix4::Shape() == std::array<size_t, 2>{4, 4});
+
+    // the elements are stored inline, with nothing on the heap
+    EXPECT_EQ(sizeof(Matrix4), 16 * sizeof(float));
+}
+
+TEST(StaticTensorTests, Constructors)
+{
+    Matrix4 zeros;
+    EXPECT_TRUE(std::all_of(zeros.begin(), zeros.end(), [](float x) { return x == 0.0f; }));
+
+    Matrix4 ones(1.0f);
+    EXPECT_TRUE(std::all_of(ones.begin(), ones.end(), [](float x) { return x == 1.0f; }));
+
+    StaticTensor<int, Extents<2, 3>> tensor({0, 1, 2, 3, 4, 5});
+    EXPECT_EQ(tensor({1, 0}), 3);
+    EXPECT_EQ(tensor({1, 2}), 5);
+}
+
+TEST(StaticTensorTests, ConstantIndexing)
+{
+    constexpr auto value = []
+    {
+        StaticTensor<int, Extents<3, 3>> tensor;
+        tensor({1, 2}) = 7;
+        return tensor({1, 2}) + tensor.Data()[5];
+    }();
+    EXPECT_EQ(value, 14);
+}
+
+TEST(StaticTensorTests, SliceIntoView)
+{
+    StaticTensor<int, Extents<4, 4>> tensor;
+    std::iota(tensor.begin(), tensor.end(), 0);
+
+    auto column = tensor.Slice(Range{0, 4}, 2);
+    EXPECT_EQ(column.Shape(), (std::array<size_t, 1>{4}));
+    EXPECT_EQ(column({3}), 14);
+
+    column({0}) = -1;
+    EXPECT_EQ(tensor({0, 2}), -1);
+}
+
+TEST(StaticTensorTests, CopyToAndFromTensor)
+{
+    Tensor<float, 2> dynamic({4, 4});
+    std::iota(dynamic.Data(), dynamic.Data() + 16, 0.0f);
+
+    // copied from a transposed view, through CopyElementwise
+    auto transposed = View<float, 2>(dynamic.Data(), {4, 4}, {1, 4}, 0);
+    Matrix4 matrix(transposed);
+    EXPECT_EQ(matrix({1, 0}), 1.0f);
+    EXPECT_EQ(matrix({0, 1}), 4.0f);
+
+    Tensor<float, 2> back(matrix);
+    EXPECT_EQ(back({0, 1}), 4.0f);
+
+    EXPECT_THROW((StaticTensor<float, Extents<3, 4>>(dynamic)), std::runtime_error);
+}
+
+TEST(StaticTensorTests, Arithmetic)
+{
+    Matrix4 a(2.0f);
+    Matrix4 b;
+    std::iota(b.begin(), b.end(), 0.0f);
+
+    Matrix4 c = a * b + 1.0f;
+    EXPECT_EQ(c({3, 3}), 31.0f);
+
+    c = c - b;
+    EXPECT_EQ(c({3, 3}), 16.0f);
+
+    Tensor<float, 2> mixed = c + Tensor<float, 2>({4, 4}, 1.0f);
+    EXPECT_EQ(mixed({0, 0}), 2.0f);
+}
+
+TEST(StaticTensorTests, MatMul)
+{
+    Matrix4 identity;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        identity({i, i}) = 1.0f;
+    }
+    Matrix4 b;
+    std::iota(b.begin(), b.end(), 0.0f);
+
+    Matrix4 product;
+    MatMul(identity, b, product);
+    EXPECT_TRUE(std::equal(product.begin(), product.end(), b.begin()));
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <Tensor.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+
+/*
+ * Count the heap allocations made by each thread, through replacements of the global allocation functions. Built as
+ * its own executable, so that the replacements do not affect any other test.
+ */
+thread_local size_t gAllocations = 0;
+
+auto operator new(size_t size) -> void*
+{
+    ++gAllocations;
+    if (void* pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+auto operator new(size_t size, std::align_val_t alignment) -> void*
+{
+    ++gAllocations;
+    size_t bytes = (std::max<size_t>(size, 1) + static_cast<size_t>(alignment) - 1) / static_cast<size_t>(alignment) * static_cast<size_t>(alignment);
+    if (void* pointer = std::aligned_alloc(static_cast<size_t>(alignment), bytes))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+// kept out of line, so that the compiler does not pair the free with the new expression it was inlined into
+[[gnu::noinline]] static auto Release(void* pointer) noexcept -> void
+{
+    std::free(pointer);
+}
+
+auto operator delete(void* pointer) noexcept -> void
+{
+    Release(pointer);
+}
+
+auto operator delete(void* pointer, size_t) noexcept -> void
+{
+    Release(pointer);
+}
+
+auto operator delete(void* pointer, std::align_val_t) noexcept -> void
+{
+    Release(pointer);
+}
+
+auto operator delete(void* pointer, size_t, std::align_val_t) noexcept -> void
+{
+    Release(pointer);
+}
+
+TEST(StaticTensorAllocationTests, NoHeapAllocations)
+{
+    using Matrix3 = StaticTensor<float, Extents<3, 3>>;
+    Matrix3 a(2.0f);
+    Matrix3 b;
+    std::iota(b.begin(), b.end(), 0.0f);
+    Matrix3 c;
+
+    // once the dispatcher thread pool has been created
+    GetDispatcherThreadPool();
+    size_t before = gAllocations;
+    c = a + b;
+    c += a;
+    c = a * b - c;
+    Matrix3 d = c * 2.0f;
+    Matrix3 product = MatMul(a, b);
+    MatMul(d, b, c);
+    EXPECT_EQ(gAllocations, before);
+
+    EXPECT_EQ(d({2, 2}), 2.0f * (2.0f * 8.0f - (2.0f + 8.0f + 2.0f)));
+    EXPECT_EQ(product({1, 2}), 2.0f * (2.0f + 5.0f + 8.0f));
+    EXPECT_EQ(c({0, 0}), d({0, 0}) * 0.0f + d({0, 1}) * 3.0f + d({0, 2}) * 6.0f);
+}
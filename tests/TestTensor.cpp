@@ -2,6 +2,9 @@
 
 #include <Tensor.hpp>
 
+#include <numeric>
+#include <string>
+
 std::string RemoveWhitespace(const std::string& str)
 {
     std::string out;
@@ -24,6 +27,58 @@ TEST(TensorTests, DefaultConstructor)
     EXPECT_EQ(tensor.Strides(), (std::array<size_t, 2>{width, 1}));
 }
 
+TEST(TensorTests, DefaultConstructorValueInitializes)
+{
+    auto tensor = Tensor<int, 2>({16, 16});
+
+    EXPECT_TRUE(std::all_of(tensor.Data(), tensor.Data() + 256, [](int value)
+    {
+        return value == 0;
+    }));
+}
+
+TEST(TensorTests, UninitializedConstructor)
+{
+    size_t height = 2;
+    size_t width = 3;
+
+    auto tensor = Tensor<int, 2>({height, width}, Uninitialized);
+
+    EXPECT_NE(tensor.Data(), nullptr);
+    EXPECT_EQ(tensor.Shape(), (std::array<size_t, 2>{height, width}));
+    EXPECT_EQ(tensor.Strides(), (std::array<size_t, 2>{width, 1}));
+}
+
+TEST(TensorTests, DefaultAllocatorAlignment)
+{
+    auto tensor = Tensor<float, 2>({3, 5});
+
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(tensor.Data()) % 64, 0);
+}
+
+TEST(TensorTests, CustomAllocatorAlignment)
+{
+    auto tensor = Tensor<float, 1, AlignedAllocator<float, 256>>({7}, 1.0f);
+
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(tensor.Data()) % 256, 0);
+    EXPECT_EQ(tensor({6}), 1.0f);
+}
+
+TEST(TensorTests, HugePageAllocator)
+{
+    size_t height = 1024;
+    size_t width = 1024;
+
+    auto t1 = Tensor<float, 2, HugePageAllocator<float>>({height, width}, 2.0f);
+    auto t2 = t1;
+
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(t1.Data()) % HugePageAllocator<float>::huge_page_size, 0);
+    EXPECT_EQ(t2({height - 1, width - 1}), 2.0f);
+
+    Tensor<float, 2> t3(t2);
+    EXPECT_EQ(t3({0, 0}), 2.0f);
+}
+
 TEST(TensorTests, FillConstructor)
 {
     size_t height = 2;
@@ -130,6 +185,39 @@ TEST(TensorTests, MoveAssignment)
     }
 }
 
+TEST(TensorTests, ParallelInitialization)
+{
+    // lower the threshold so that even modest tensors are initialized across the pool, in blocks cut at page boundaries
+    auto& threshold = ParallelInitializeThreshold();
+    size_t previous = threshold.exchange(0);
+
+    size_t height = 37;
+    size_t width = 1001;
+
+    auto zeros = Tensor<double, 2>({height, width});
+    EXPECT_TRUE(std::all_of(zeros.Data(), zeros.Data() + height * width, [](double x) { return x == 0.0; }));
+
+    auto filled = Tensor<float, 2>({height, width}, 3.0f);
+    EXPECT_TRUE(std::all_of(filled.Data(), filled.Data() + height * width, [](float x) { return x == 3.0f; }));
+
+    std::iota(filled.Data(), filled.Data() + height * width, 0.0f);
+    auto copy = filled;
+    EXPECT_TRUE(std::equal(filled.Data(), filled.Data() + height * width, copy.Data()));
+
+    // assignment into a buffer of the same size reuses it
+    copy = Tensor<float, 2>({height, width}, 1.0f);
+    float* buffer = copy.Data();
+    copy = filled;
+    EXPECT_EQ(copy.Data(), buffer);
+    EXPECT_TRUE(std::equal(filled.Data(), filled.Data() + height * width, copy.Data()));
+
+    auto strings = Tensor<std::string, 1>({100}, "first touch");
+    auto stringsCopy = strings;
+    EXPECT_EQ(stringsCopy({99}), "first touch");
+
+    threshold = previous;
+}
+
 TEST(TensorTests, Indexing)
 {
     size_t height = 2;
@@ -230,6 +318,67 @@ TEST(TensorTests, SlicePixels)
     EXPECT_EQ(p3({0, 0}), 3);
 }
 
+TEST(TensorTests, PermuteView)
+{
+    auto hwc = Tensor<int, 3>({2, 3, 4});
+    std::iota(hwc.Data(), hwc.Data() + 24, 0);
+
+    auto chw = hwc.Permute<2, 0, 1>();
+    EXPECT_EQ(chw.Shape(), (std::array<size_t, 3>{4, 2, 3}));
+    EXPECT_EQ(chw.Strides(), (std::array<size_t, 3>{1, 12, 4}));
+    EXPECT_EQ(chw.Data(), hwc.Data());
+    EXPECT_EQ(chw({3, 1, 2}), hwc({1, 2, 3}));
+
+    // permuting a slice keeps its offset
+    auto block = hwc.Slice(1, Range{1, 3}, Range{0, 4}).Transpose();
+    EXPECT_EQ(block.Shape(), (std::array<size_t, 2>{4, 2}));
+    EXPECT_EQ(block({3, 0}), hwc({1, 1, 3}));
+}
+
+TEST(TensorTests, TransposeCopy)
+{
+    // large enough to be split across the pool, with sizes which are not multiples of the tile
+    size_t height = 1037;
+    size_t width = 1201;
+
+    auto matrix = Tensor<float, 2>({height, width});
+    std::iota(matrix.Data(), matrix.Data() + height * width, 0.0f);
+
+    auto transposed = Tensor<float, 2>(matrix.Transpose());
+    EXPECT_EQ(transposed.Shape(), (std::array<size_t, 2>{width, height}));
+    for (size_t y = 0; y < width; y += 7)
+    {
+        for (size_t x = 0; x < height; x += 3)
+        {
+            ASSERT_EQ(transposed({y, x}), matrix({x, y}));
+        }
+    }
+
+    // and back, writing through a transposed destination with a conversion
+    auto roundTrip = Tensor<double, 2>({height, width});
+    auto destination = roundTrip.Transpose();
+    CopyElementwise<Tensor<float, 2>, decltype(destination), 2>(transposed, destination);
+    EXPECT_TRUE(std::equal(matrix.Data(), matrix.Data() + height * width, roundTrip.Data()));
+}
+
+TEST(TensorTests, PermuteCopy)
+{
+    auto hwc = Tensor<int, 3>({45, 67, 3});
+    std::iota(hwc.Data(), hwc.Data() + 45 * 67 * 3, 0);
+
+    auto chw = Tensor<int, 3>(hwc.Permute<2, 0, 1>());
+    for (size_t c = 0; c < 3; ++c)
+    {
+        for (size_t y = 0; y < 45; ++y)
+        {
+            for (size_t x = 0; x < 67; ++x)
+            {
+                ASSERT_EQ(chw({c, y, x}), hwc({y, x, c}));
+            }
+        }
+    }
+}
+
 TEST(TensorTests, ViewCopyConstructor)
 {
     Tensor<int, 2> t1({2, 2}, 42);
@@ -249,6 +398,73 @@ TEST(TensorTests, ViewCopyConstructor)
     }
 }
 
+TEST(TensorTests, CollapseDimensions)
+{
+    Tensor<int, 3> tensor({4, 5, 6});
+
+    auto dense = CollapseDimensions<3, 1>(tensor.Shape(), {tensor.Strides()});
+    EXPECT_EQ(dense.order, 1);
+    EXPECT_EQ(dense.shape[0], 120);
+
+    auto rows = tensor.Slice(Range{0, 4}, Range{1, 3}, Range{0, 6});
+    auto collapsed = CollapseDimensions<3, 1>(rows.Shape(), {rows.Strides()});
+    EXPECT_EQ(collapsed.order, 2);
+    EXPECT_EQ(collapsed.shape[0], 4);
+    EXPECT_EQ(collapsed.shape[1], 12);
+    EXPECT_EQ(collapsed.strides[0][0], 30);
+    EXPECT_EQ(collapsed.strides[0][1], 1);
+}
+
+TEST(TensorTests, ViewCopyNonContiguous)
+{
+    Tensor<int, 3> t1({4, 5, 6});
+    std::iota(t1.Data(), t1.Data() + 120, 0);
+
+    auto block = t1.Slice(Range{1, 4}, Range{2, 4}, Range{1, 5});
+    Tensor<int, 3> t2(block);
+
+    EXPECT_EQ(t2.Shape(), (std::array<size_t, 3>{3, 2, 4}));
+    for (size_t z = 0; z < 3; ++z)
+    {
+        for (size_t y = 0; y < 2; ++y)
+        {
+            for (size_t x = 0; x < 4; ++x)
+            {
+                EXPECT_EQ(t2({z, y, x}), t1({z + 1, y + 2, x + 1}));
+            }
+        }
+    }
+
+    auto column = t1.Slice(Range{0, 4}, 3, 2);
+    Tensor<double, 1> t3(column);
+    for (size_t z = 0; z < 4; ++z)
+    {
+        EXPECT_EQ(t3({z}), static_cast<double>(t1({z, 3, 2})));
+    }
+}
+
+TEST(TensorTests, ViewCopyLarge)
+{
+    size_t height = 1100;
+    size_t width = 2000;
+
+    Tensor<float, 2> t1({height, width});
+    std::iota(t1.Data(), t1.Data() + height * width, 0.0f);
+
+    // rows above the parallel copy threshold, and a single long run
+    Tensor<float, 2> t2(t1.Slice(Range{50, height}, Range{1, width}));
+    Tensor<float, 2> t3(t1.Slice(Range{0, height}, Range{0, width}));
+
+    for (size_t y = 0; y < height - 50; ++y)
+    {
+        for (size_t x = 0; x < width - 1; ++x)
+        {
+            ASSERT_EQ(t2({y, x}), t1({y + 50, x + 1}));
+        }
+    }
+    EXPECT_TRUE(std::equal(t1.Data(), t1.Data() + height * width, t3.Data()));
+}
+
 TEST(TensorTests, PrintTensor)
 {
     Tensor<int, 2> tensor({3, 2});
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <Tensor.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+class TensorFileTests : public ::testing::Test
+{
+protected:
+
+    std::string mPath;
+
+    void SetUp() override
+    {
+        auto name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        mPath = (std::filesystem::temp_directory_path() / (std::string("tensor_file_") + name + ".tensor")).string();
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(mPath);
+    }
+};
+
+TEST_F(TensorFileTests, RoundTrip)
+{
+    Tensor<float, 3> tensor({2, 3, 4});
+    std::iota(tensor.Data(), tensor.Data() + 24, 0.5f);
+    Save(mPath, tensor);
+
+    auto [owner, view] = LoadMapped<float, 3>(mPath);
+    EXPECT_EQ(view.Shape(), tensor.Shape());
+    EXPECT_EQ(view.Strides(), tensor.Strides());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(view.Data()) % TensorFileAlignment, 0u);
+    for (size_t i = 0; i < 24; ++i)
+    {
+        EXPECT_EQ(view.Data()[i], tensor.Data()[i]);
+    }
+
+    Tensor<float, 3> loaded = Load<float, 3>(mPath);
+    EXPECT_EQ(loaded({1, 2, 3}), tensor({1, 2, 3}));
+}
+
+TEST_F(TensorFileTests, SaveView)
+{
+    Tensor<int32_t, 2> tensor({4, 5});
+    std::iota(tensor.Data(), tensor.Data() + 20, 0);
+    View<int32_t, 2> column = tensor.Slice(Range{0, 4}, Range{2, 4});
+    Save(mPath, column);
+
+    auto mapped = LoadMapped<int32_t, 2>(mPath);
+    EXPECT_EQ(mapped.view.Shape(), (std::array<size_t, 2>{4, 2}));
+    for (size_t y = 0; y < 4; ++y)
+    {
+        for (size_t x = 0; x < 2; ++x)
+        {
+            EXPECT_EQ(mapped.view({y, x}), tensor({y, x + 2}));
+        }
+    }
+}
+
+TEST_F(TensorFileTests, MappingIsCopyOnWrite)
+{
+    Save(mPath, Tensor<double, 1>({8}, 1.0));
+
+    {
+        auto mapped = LoadMapped<double, 1>(mPath);
+        mapped.view({3}) = 42.0;
+        EXPECT_EQ(mapped.view({3}), 42.0);
+
+        // slices keep referring to the mapping while the owner is alive
+        View<double, 1> slice = mapped.view.Slice(Range{2, 6});
+        EXPECT_EQ(slice({1}), 42.0);
+    }
+
+    auto reloaded = LoadMapped<double, 1>(mPath);
+    EXPECT_EQ(reloaded.view({3}), 1.0);
+}
+
+TEST_F(TensorFileTests, Mismatches)
+{
+    Save(mPath, Tensor<float, 2>({2, 2}, 1.0f));
+
+    EXPECT_THROW((LoadMapped<double, 2>(mPath)), std::runtime_error);
+    EXPECT_THROW((LoadMapped<int32_t, 2>(mPath)), std::runtime_error);
+    EXPECT_THROW((LoadMapped<float, 3>(mPath)), std::runtime_error);
+    EXPECT_THROW((LoadMapped<float, 2>(mPath + ".missing")), std::runtime_error);
+
+    std::fstream file(mPath, std::ios::binary | std::ios::in | std::ios::out);
+    file.write("NOTATENS", 8);
+    file.close();
+    EXPECT_THROW((LoadMapped<float, 2>(mPath)), std::runtime_error);
+}
+
+TEST_F(TensorFileTests, HalfPrecision)
+{
+    Tensor<Float16, 2> tensor({3, 5}, Float16(0.1f));
+    tensor({2, 4}) = -7.5f;
+    Save(mPath, tensor);
+
+    auto loaded = Load<Float16, 2>(mPath);
+    EXPECT_EQ(loaded({0, 0}).Bits(), Float16(0.1f).Bits());
+    EXPECT_EQ(static_cast<float>(loaded({2, 4})), -7.5f);
+
+    // the same size but another format
+    EXPECT_THROW((LoadMapped<BFloat16, 2>(mPath)), std::runtime_error);
+    EXPECT_THROW((LoadMapped<int16_t, 2>(mPath)), std::runtime_error);
+}
+
+TEST_F(TensorFileTests, Truncated)
+{
+    Save(mPath, Tensor<uint16_t, 2>({64, 64}, uint16_t{7}));
+    std::filesystem::resize_file(mPath, std::filesystem::file_size(mPath) - 2);
+
+    EXPECT_THROW((LoadMapped<uint16_t, 2>(mPath)), std::runtime_error);
+}
+
+TEST_F(TensorFileTests, OverflowingStrides)
+{
+    Save(mPath, Tensor<uint16_t, 2>({2, 2}, uint16_t{7}));
+
+    // a stride whose byte extent wraps around to a few bytes, which would pass an unchecked bounds test
+    uint64_t stride = uint64_t{1} << 63;
+    std::fstream file(mPath, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(sizeof(TensorFileHeader) + 2 * sizeof(uint64_t));
+    file.write(reinterpret_cast<char const*>(&stride), sizeof(stride));
+    file.close();
+
+    EXPECT_THROW((LoadMapped<uint16_t, 2>(mPath)), std::runtime_error);
+}
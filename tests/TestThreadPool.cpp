@@ -2,9 +2,14 @@
 
 #include <ThreadPool.hpp>
 
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <vector>
 
 TEST(ThreadPoolTests, ConstructorMaximumThreadCount)
 {
@@ -104,3 +109,233 @@ TEST(ThreadPoolTests, UseAfterShutdown)
 
     EXPECT_THROW(pool.Enqueue([]() {}), std::runtime_error);
 }
+
+TEST(ThreadPoolTests, EnqueueWithArguments)
+{
+    ThreadPool pool(4);
+
+    std::atomic<int> counter = 0;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        pool.Enqueue([&counter](int amount)
+        {
+            counter.fetch_add(amount);
+        }, i);
+    }
+
+    pool.Wait();
+
+    EXPECT_EQ(counter.load(), 4950);
+}
+
+TEST(ThreadPoolTests, LargeCallable)
+{
+    ThreadPool pool(4);
+
+    std::array<int, 64> values{};
+    values.fill(1);
+    std::atomic<int> counter = 0;
+
+    static_assert(!Task::IsInline<decltype([values]() {})>());
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+        pool.Enqueue([values, &counter]()
+        {
+            counter.fetch_add(values[63]);
+        });
+    }
+
+    pool.Wait();
+
+    EXPECT_EQ(counter.load(), 100);
+}
+
+TEST(ThreadPoolTests, TasksEnqueueTasks)
+{
+    ThreadPool pool(4);
+
+    std::atomic<int> counter = 0;
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+        pool.Enqueue([&pool, &counter]()
+        {
+            for (size_t j = 0; j < 10; ++j)
+            {
+                pool.Enqueue([&counter]()
+                {
+                    counter.fetch_add(1);
+                });
+            }
+        });
+    }
+
+    pool.Wait();
+
+    EXPECT_EQ(counter.load(), 1000);
+}
+
+TEST(ThreadPoolTests, ConcurrentProducers)
+{
+    ThreadPool pool(4);
+
+    std::atomic<int> counter = 0;
+
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < 4; ++p)
+    {
+        producers.emplace_back([&pool, &counter]()
+        {
+            // more tasks than the inboxes can hold at once
+            for (size_t i = 0; i < 10000; ++i)
+            {
+                pool.Enqueue([&counter]()
+                {
+                    counter.fetch_add(1);
+                });
+            }
+        });
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    pool.Wait();
+
+    EXPECT_EQ(counter.load(), 40000);
+}
+
+TEST(ThreadPoolTests, Metrics)
+{
+    ThreadPool pool(2);
+    if (!pool.Metrics().enabled)
+    {
+        GTEST_SKIP() << "thread pool metrics are compiled out";
+    }
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+        pool.Enqueue([]()
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+        });
+    }
+    pool.Wait();
+
+    ThreadPoolMetrics metrics = pool.Metrics();
+    EXPECT_EQ(metrics.tasks_enqueued, 100u);
+    EXPECT_EQ(metrics.tasks_completed, 100u);
+    EXPECT_EQ(metrics.external_tasks, 0u);
+    EXPECT_EQ(metrics.queue_depth, 0u);
+    EXPECT_GE(metrics.peak_queue_depth, 1u);
+    EXPECT_EQ(metrics.latency.Count(), 100u);
+    EXPECT_EQ(metrics.waits, 1u);
+
+    ASSERT_EQ(metrics.workers.size(), 2u);
+    EXPECT_EQ(metrics.workers[0].tasks + metrics.workers[1].tasks, 100u);
+    EXPECT_GE(metrics.workers[0].busy_ns + metrics.workers[1].busy_ns, 100u * 10000u);
+    EXPECT_EQ(metrics.workers[0].busy_ns + metrics.workers[0].idle_ns, metrics.elapsed_ns);
+    EXPECT_GT(metrics.Utilization(), 0.0);
+    EXPECT_LE(metrics.Utilization(), 1.0);
+
+    std::string json = metrics.ToJson();
+    EXPECT_NE(json.find("\"tasks_completed\": 100"), std::string::npos);
+    EXPECT_NE(json.find("\"workers\": [{\"tasks\": "), std::string::npos);
+
+    pool.ResetMetrics();
+    metrics = pool.Metrics();
+    EXPECT_EQ(metrics.tasks_enqueued, 0u);
+    EXPECT_EQ(metrics.tasks_completed, 0u);
+    EXPECT_EQ(metrics.latency.Count(), 0u);
+}
+
+TEST(ThreadPoolTests, LatencyHistogram)
+{
+    EXPECT_EQ(LatencyHistogram::Bucket(0), 0u);
+    EXPECT_EQ(LatencyHistogram::Bucket(1), 0u);
+    EXPECT_EQ(LatencyHistogram::Bucket(2), 1u);
+    EXPECT_EQ(LatencyHistogram::Bucket(1000), 9u);
+    EXPECT_EQ(LatencyHistogram::Bucket(~uint64_t{0}), LatencyHistogram::bucket_count - 1);
+
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.Quantile(0.5), 0u);
+    histogram.buckets[LatencyHistogram::Bucket(100)] = 90;
+    histogram.buckets[LatencyHistogram::Bucket(5000)] = 10;
+    EXPECT_EQ(histogram.Quantile(0.5), 128u);
+    EXPECT_EQ(histogram.Quantile(0.99), 8192u);
+}
+
+TEST(ThreadPoolTests, ParseCpuList)
+{
+    EXPECT_EQ(ParseCpuList("0-3,8,10-11\n"), (std::vector<size_t>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(ParseCpuList("5"), (std::vector<size_t>{5}));
+    EXPECT_TRUE(ParseCpuList("").empty());
+}
+
+TEST(ThreadPoolTests, PlaceWorkers)
+{
+    CpuTopology topology{{{0, 1}, {2, 3}}};
+    auto cpus = [](std::vector<WorkerPlacement> const& placements)
+    {
+        std::vector<size_t> cpus;
+        for (WorkerPlacement const& placement : placements)
+        {
+            cpus.push_back(placement.cpu);
+        }
+        return cpus;
+    };
+
+    auto compact = PlaceWorkers({.threads = 4, .affinity = Affinity::Compact, .cpus = {}}, topology);
+    EXPECT_EQ(cpus(compact), (std::vector<size_t>{0, 1, 2, 3}));
+    EXPECT_EQ(compact[1].node, 0u);
+    EXPECT_EQ(compact[2].node, 1u);
+
+    auto scatter = PlaceWorkers({.threads = 5, .affinity = Affinity::Scatter, .cpus = {}}, topology);
+    EXPECT_EQ(cpus(scatter), (std::vector<size_t>{0, 2, 1, 3, 0}));
+    EXPECT_EQ(scatter[1].node, 1u);
+
+    auto listed = PlaceWorkers({.threads = 3, .affinity = Affinity::Explicit, .cpus = {3, 1}}, topology);
+    EXPECT_EQ(cpus(listed), (std::vector<size_t>{3, 1, 3}));
+    EXPECT_EQ(listed[0].node, 1u);
+    EXPECT_EQ(listed[1].node, 0u);
+
+    auto unpinned = PlaceWorkers({.threads = 0, .affinity = Affinity::None, .cpus = {}}, topology);
+    EXPECT_EQ(unpinned.size(), 4u);
+    EXPECT_EQ(unpinned[3].cpu, AnyCpu);
+
+    EXPECT_THROW(PlaceWorkers({.threads = 2, .affinity = Affinity::Explicit, .cpus = {}}, topology), std::runtime_error);
+}
+
+TEST(ThreadPoolTests, PinnedWorkers)
+{
+    CpuTopology topology = DetectTopology();
+    ASSERT_GT(topology.Cpus(), 0u);
+    size_t cpu = topology.nodes[0][0];
+
+    ThreadPool pool(ThreadPoolOptions{.threads = 2, .affinity = Affinity::Explicit, .cpus = {cpu}});
+    EXPECT_EQ(pool.Threads(), 2u);
+    EXPECT_EQ(pool.WorkerCpu(1), cpu);
+    EXPECT_EQ(pool.Nodes(), topology.NodeOf(cpu) + 1);
+
+#if defined(__linux__)
+    std::array<int, 2> seen = {-1, -1};
+    for (size_t worker = 0; worker < 2; ++worker)
+    {
+        pool.EnqueueTo(worker, [&seen, worker]()
+        {
+            seen[worker] = sched_getcpu();
+        });
+    }
+    pool.Wait();
+    EXPECT_EQ(seen[0], static_cast<int>(cpu));
+    EXPECT_EQ(seen[1], static_cast<int>(cpu));
+#endif
+
+    // a worker the operating system refuses to pin is reported as unpinned
+    ThreadPool refused(ThreadPoolOptions{.threads = 1, .affinity = Affinity::Explicit, .cpus = {size_t{1} << 20}});
+    EXPECT_EQ(refused.WorkerCpu(0), AnyCpu);
+}